@@ -35,7 +35,7 @@
     #define RGCONV
 #endif // defined(_WIN32)
 
-#define RG_RTGL_VERSION_API "1.03.0000"
+#define RG_RTGL_VERSION_API "1.04.0000"
 
 #ifdef RG_USE_SURFACE_WIN32
     #include <windows.h>
@@ -422,6 +422,49 @@ RGAPI RgResult RGCONV rgUploadMeshPrimitive( RgInstance                 instance
                                              const RgMeshInfo*          pMesh,
                                              const RgMeshPrimitiveInfo* pPrimitive );
 
+// Same as calling rgUploadMeshPrimitive for each primitive of each mesh, but in one call.
+// pPrimitives contains pPrimitiveCounts[0] primitives of pMeshes[0], then
+// pPrimitiveCounts[1] primitives of pMeshes[1], etc.
+RGAPI RgResult RGCONV rgUploadMeshPrimitives( RgInstance                 instance,
+                                              uint32_t                   meshCount,
+                                              const RgMeshInfo*          pMeshes,
+                                              const uint32_t*            pPrimitiveCounts,
+                                              const RgMeshPrimitiveInfo* pPrimitives );
+
+// Retained mesh: primitives are copied once on creation, and drawn with
+// rgDrawMeshInstance on each frame until rgDestroyMesh. Vertex data is kept
+// in GPU memory from the next rgStartFrame, so an instance adds only its transform.
+RG_DEFINE_NON_DISPATCHABLE_HANDLE( RgMesh )
+
+typedef struct RgMeshCreateInfo
+{
+    // Name and primitive index is used to override meshes.
+    const char*                     pMeshName;
+    uint32_t                        primitiveCount;
+    const RgMeshPrimitiveInfo*      pPrimitives;
+} RgMeshCreateInfo;
+
+typedef struct RgMeshInstanceInfo
+{
+    // Must be unique among the instances and meshes in a frame.
+    uint32_t                        uniqueObjectID;
+    RgTransform                     transform;
+    RgBool32                        isExportable;
+    const char*                     animationName;
+    float                           animationTime;
+    // If true, 'color' is used for all primitives instead of their own colors.
+    RgBool32                        overrideColor;
+    RgColor4DPacked32               color;
+} RgMeshInstanceInfo;
+
+RGAPI RgResult RGCONV rgCreateMesh( RgInstance              instance,
+                                    const RgMeshCreateInfo* pInfo,
+                                    RgMesh*                 pResult );
+RGAPI RgResult RGCONV rgDrawMeshInstance( RgInstance                instance,
+                                          RgMesh                    mesh,
+                                          const RgMeshInstanceInfo* pInfo );
+RGAPI RgResult RGCONV rgDestroyMesh( RgInstance instance, RgMesh mesh );
+
 RGAPI RgResult RGCONV rgUploadNonWorldPrimitive( RgInstance                 instance,
                                                  const RgMeshPrimitiveInfo* pPrimitive,
                                                  const float*               pViewProjection,
@@ -554,6 +597,9 @@ typedef struct RgOriginalTextureInfo
     RgSamplerFilter         filter;
     RgSamplerAddressMode    addressModeU;
     RgSamplerAddressMode    addressModeV;
+    // If true, the pixels can be changed later with rgUpdateOriginalTextureRegion.
+    // Ignored, if there's a replacement file for the texture.
+    RgBool32                isUpdateable;
 } RgOriginalTextureInfo;
 
 typedef struct RgOriginalCubemapInfo
@@ -573,6 +619,22 @@ RGAPI RgResult RGCONV rgProvideOriginalTexture( RgInstance instance, const RgOri
 RGAPI RgResult RGCONV rgProvideOriginalCubemapTexture( RgInstance instance, const RgOriginalCubemapInfo* pInfo );
 RGAPI RgResult RGCONV rgMarkOriginalTextureAsDeleted( RgInstance instance, const char* pTextureName );
 
+typedef struct RgOriginalTextureRegionInfo
+{
+    // Texture that was provided with isUpdateable=true.
+    const char*             pTextureName;
+    // R8G8B8A8 pixel data of the region.
+    const void*             pPixels;
+    uint32_t                offsetX;
+    uint32_t                offsetY;
+    RgExtent2D              size;
+    // Byte distance between the rows in pPixels. If 0, the rows are tightly packed.
+    uint32_t                rowPitch;
+} RgOriginalTextureRegionInfo;
+
+// Changed pixels are copied to the texture at the start of rgDrawFrame.
+RGAPI RgResult RGCONV rgUpdateOriginalTextureRegion( RgInstance instance, const RgOriginalTextureRegionInfo* pInfo );
+
 
 
 typedef struct RgStartFrameInfo
@@ -693,6 +755,11 @@ typedef struct RgDrawFrameIlluminationParams
     uint64_t*       lightUniqueIdIgnoreFirstPersonViewerShadows;
     uint32_t        lightstyleValuesCount;
     const float*    pLightstyleValues;
+    // Imported static geometry with many triangles also has a simplified version.
+    // Indirect and shadow rays that start further than this distance from the camera use it.
+    // If 0.0, the simplified geometry is not used.
+    // Default: 50.0
+    float           coarseLodDistance;
 } RgDrawFrameIlluminationParams;
 
 typedef struct RgDrawFrameVolumetricParams
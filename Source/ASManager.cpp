@@ -693,10 +693,17 @@ void RTGL1::ASManager::UpdateBLAS( BLASComponent& blas, const VertexCollector& v
                         blas.GetFilter() & VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE );
 }
 
-RTGL1::StaticGeometryToken RTGL1::ASManager::BeginStaticGeometry()
+RTGL1::StaticGeometryToken RTGL1::ASManager::BeginStaticGeometry( bool     reuseVertexData,
+                                                                  uint32_t maxVertexCount,
+                                                                  uint32_t maxIndexCount )
 {
-    // the whole static vertex data must be recreated, clear previous data
-    collectorStatic->Reset();
+    // static geometry is collected again, but unchanged vertex data can stay in the buffers
+    if( !collectorStatic->ResetStatic( reuseVertexData, maxVertexCount, maxIndexCount ) &&
+        reuseVertexData )
+    {
+        debug::Info( "Not enough space to keep the unchanged static vertex data, "
+                     "all of it is copied again" );
+    }
     geomInfoMgr->ResetOnlyStatic();
 
     return StaticGeometryToken( InitAsExisting );
@@ -763,8 +770,8 @@ void RTGL1::ASManager::SubmitStaticGeometry( StaticGeometryToken& token )
     Utils::WaitAndResetFence( device, staticCopyFence );
 }
 
-RTGL1::DynamicGeometryToken RTGL1::ASManager::BeginDynamicGeometry( VkCommandBuffer cmd,
-                                                                    uint32_t        frameIndex )
+RTGL1::DynamicGeometryToken RTGL1::ASManager::BeginDynamicGeometry(
+    VkCommandBuffer cmd, uint32_t frameIndex, const RetainedMeshes& retained )
 {
     scratchBuffer->Reset();
 
@@ -774,6 +781,7 @@ RTGL1::DynamicGeometryToken RTGL1::ASManager::BeginDynamicGeometry( VkCommandBuf
 
     // dynamic AS must be recreated
     collectorDynamic[ frameIndex ]->Reset();
+    collectorDynamic[ frameIndex ]->SetRetained( retained );
 
     return DynamicGeometryToken( InitAsExisting );
 }
@@ -784,15 +792,27 @@ bool RTGL1::ASManager::AddMeshPrimitive( uint32_t                   frameIndex,
                                          uint64_t                   uniqueID,
                                          bool                       isStatic,
                                          const TextureManager&      textureManager,
-                                         GeomInfoManager&           geomInfoManager )
+                                         GeomInfoManager&           geomInfoManager,
+                                         GeometryLod                lod,
+                                         float                      lodMaxDeviation,
+                                         std::optional< uint64_t >  retainedPrimitiveID )
 {
     auto textures = textureManager.GetTexturesForLayers( primitive );
     auto colors   = textureManager.GetColorForLayers( primitive );
 
     auto& collector = isStatic ? collectorStatic : collectorDynamic[ frameIndex ];
 
-    return collector->AddPrimitive(
-        frameIndex, isStatic, mesh, primitive, uniqueID, textures, colors, geomInfoManager );
+    return collector->AddPrimitive( frameIndex,
+                                    isStatic,
+                                    mesh,
+                                    primitive,
+                                    uniqueID,
+                                    textures,
+                                    colors,
+                                    geomInfoManager,
+                                    lod,
+                                    lodMaxDeviation,
+                                    retainedPrimitiveID );
 }
 
 void RTGL1::ASManager::SubmitDynamicGeometry( DynamicGeometryToken& token,
@@ -877,7 +897,19 @@ bool RTGL1::ASManager::SetupTLASInstanceFromBLAS( const BLASComponent& blas,
         // also check rayCullMaskWorld, if world part is not included in the cull mask,
         // then don't add it to BLAS at all, it helps culling PT_REFLECT if it was a world part
 
-        if( filter & FT::PV_WORLD_0 )
+        if( filter & ( FT::PV_WORLD_0_DETAIL | FT::PV_WORLD_0_COARSE ) )
+        {
+            instance.mask = filter & FT::PV_WORLD_0_DETAIL ? INSTANCE_MASK_WORLD_0_DETAIL
+                                                           : INSTANCE_MASK_WORLD_0_COARSE;
+
+            // both levels of detail are a part of world 0
+            if( !( rayCullMaskWorld & INSTANCE_MASK_WORLD_0 ) )
+            {
+                instance = {};
+                return false;
+            }
+        }
+        else if( filter & FT::PV_WORLD_0 )
         {
             instance.mask = INSTANCE_MASK_WORLD_0;
 
@@ -939,7 +971,14 @@ bool RTGL1::ASManager::SetupTLASInstanceFromBLAS( const BLASComponent& blas,
     }
 
 
-    if( filter & FT::PT_ALPHA_TESTED )
+    if( filter & FT::PV_WORLD_0_COARSE )
+    {
+        // any-hit skips the coarse surface near the ray origin, see RtCoarseLod.rahit
+        instance.instanceShaderBindingTableRecordOffset = SBT_INDEX_HITGROUP_COARSE_LOD;
+        instance.flags = VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR |
+                         VK_GEOMETRY_INSTANCE_TRIANGLE_FRONT_COUNTERCLOCKWISE_BIT_KHR;
+    }
+    else if( filter & FT::PT_ALPHA_TESTED )
     {
         instance.instanceShaderBindingTableRecordOffset = SBT_INDEX_HITGROUP_ALPHA_TESTED;
         instance.flags = VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR |
@@ -1042,9 +1081,8 @@ std::pair< RTGL1::ASManager::TLASPrepareResult, RTGL1::ShVertPreprocessing > RTG
                 // mark bit if dynamic
                 if( isDynamic )
                 {
-                    push.tlasInstanceIsDynamicBits[ r.instanceCount /
-                                                    MAX_TOP_LEVEL_INSTANCE_COUNT ] |=
-                        1 << ( r.instanceCount % MAX_TOP_LEVEL_INSTANCE_COUNT );
+                    push.tlasInstanceIsDynamicBits[ r.instanceCount / 32 ] |=
+                        1u << ( r.instanceCount % 32 );
                 }
 
                 WriteInstanceGeomInfo(
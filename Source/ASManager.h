@@ -33,6 +33,7 @@ namespace RTGL1
 {
 
 struct ShVertPreprocessing;
+class RetainedMeshes;
 
 class ASManager
 {
@@ -60,14 +61,20 @@ public:
     ASManager& operator=( ASManager&& other ) noexcept = delete;
 
 
-    [[nodiscard]] StaticGeometryToken BeginStaticGeometry();
+    // If 'reuseVertexData', the static primitives with the same data ID as in the previous
+    // static geometry don't copy their vertex data. 'maxVertexCount' / 'maxIndexCount'
+    // are how much new vertex data may be added
+    [[nodiscard]] StaticGeometryToken BeginStaticGeometry( bool     reuseVertexData,
+                                                           uint32_t maxVertexCount,
+                                                           uint32_t maxIndexCount );
     // Submitting static geometry to the building is a heavy operation
     // with waiting for it to complete.
     void                              SubmitStaticGeometry( StaticGeometryToken& token );
 
 
-    [[nodiscard]] DynamicGeometryToken BeginDynamicGeometry( VkCommandBuffer cmd,
-                                                             uint32_t        frameIndex );
+    [[nodiscard]] DynamicGeometryToken BeginDynamicGeometry( VkCommandBuffer       cmd,
+                                                             uint32_t              frameIndex,
+                                                             const RetainedMeshes& retained );
     void                               SubmitDynamicGeometry( DynamicGeometryToken& token,
                                                               VkCommandBuffer       cmd,
                                                               uint32_t              frameIndex );
@@ -79,7 +86,10 @@ public:
                            uint64_t                   uniqueID,
                            bool                       isStatic,
                            const TextureManager&      textureManager,
-                           GeomInfoManager&           geomInfoManager );
+                           GeomInfoManager&           geomInfoManager,
+                           GeometryLod                lod                 = GeometryLod::None,
+                           float                      lodMaxDeviation     = 0.0f,
+                           std::optional< uint64_t >  retainedPrimitiveID = std::nullopt );
 
 
     // Prepare data for building TLAS.
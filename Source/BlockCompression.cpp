@@ -0,0 +1,447 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "BlockCompression.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace RTGL1;
+
+namespace
+{
+
+constexpr uint32_t BlockDim    = 4;
+constexpr uint32_t BlockPixels = BlockDim * BlockDim;
+constexpr uint32_t Channels    = 4;
+
+constexpr uint16_t To565( const float c[ 3 ] )
+{
+    auto q = []( float v, uint32_t maxv ) {
+        return uint32_t( std::clamp( v, 0.0f, 255.0f ) * float( maxv ) / 255.0f + 0.5f );
+    };
+    return uint16_t( ( q( c[ 0 ], 31 ) << 11 ) | ( q( c[ 1 ], 63 ) << 5 ) | q( c[ 2 ], 31 ) );
+}
+
+constexpr void From565( uint16_t c, int32_t dst[ 3 ] )
+{
+    int32_t r = ( c >> 11 ) & 31;
+    int32_t g = ( c >> 5 ) & 63;
+    int32_t b = c & 31;
+
+    dst[ 0 ] = ( r << 3 ) | ( r >> 2 );
+    dst[ 1 ] = ( g << 2 ) | ( g >> 4 );
+    dst[ 2 ] = ( b << 3 ) | ( b >> 2 );
+}
+
+// Endpoints are the extremes of the block's pixels projected on the principal axis
+void EncodeColorBlock( const uint8_t ( &block )[ BlockPixels ][ Channels ], uint8_t* dst )
+{
+    float mean[ 3 ] = {};
+    for( const auto& p : block )
+    {
+        mean[ 0 ] += p[ 0 ];
+        mean[ 1 ] += p[ 1 ];
+        mean[ 2 ] += p[ 2 ];
+    }
+    for( float& m : mean )
+    {
+        m /= float( BlockPixels );
+    }
+
+    // covariance: xx, xy, xz, yy, yz, zz
+    float cov[ 6 ] = {};
+    for( const auto& p : block )
+    {
+        float d[ 3 ] = { p[ 0 ] - mean[ 0 ], p[ 1 ] - mean[ 1 ], p[ 2 ] - mean[ 2 ] };
+
+        cov[ 0 ] += d[ 0 ] * d[ 0 ];
+        cov[ 1 ] += d[ 0 ] * d[ 1 ];
+        cov[ 2 ] += d[ 0 ] * d[ 2 ];
+        cov[ 3 ] += d[ 1 ] * d[ 1 ];
+        cov[ 4 ] += d[ 1 ] * d[ 2 ];
+        cov[ 5 ] += d[ 2 ] * d[ 2 ];
+    }
+
+    // power iteration
+    float axis[ 3 ] = { 1.0f, 1.0f, 1.0f };
+    for( int iter = 0; iter < 8; iter++ )
+    {
+        float n[ 3 ] = {
+            cov[ 0 ] * axis[ 0 ] + cov[ 1 ] * axis[ 1 ] + cov[ 2 ] * axis[ 2 ],
+            cov[ 1 ] * axis[ 0 ] + cov[ 3 ] * axis[ 1 ] + cov[ 4 ] * axis[ 2 ],
+            cov[ 2 ] * axis[ 0 ] + cov[ 4 ] * axis[ 1 ] + cov[ 5 ] * axis[ 2 ],
+        };
+
+        float len = std::max( { std::abs( n[ 0 ] ), std::abs( n[ 1 ] ), std::abs( n[ 2 ] ) } );
+        if( len < 0.0001f )
+        {
+            break;
+        }
+
+        axis[ 0 ] = n[ 0 ] / len;
+        axis[ 1 ] = n[ 1 ] / len;
+        axis[ 2 ] = n[ 2 ] / len;
+    }
+
+    uint32_t iMin = 0, iMax = 0;
+    float    tMin = +INFINITY, tMax = -INFINITY;
+    for( uint32_t i = 0; i < BlockPixels; i++ )
+    {
+        float t = block[ i ][ 0 ] * axis[ 0 ] + block[ i ][ 1 ] * axis[ 1 ] +
+                  block[ i ][ 2 ] * axis[ 2 ];
+        if( t < tMin )
+        {
+            tMin = t;
+            iMin = i;
+        }
+        if( t > tMax )
+        {
+            tMax = t;
+            iMax = i;
+        }
+    }
+
+    const float e0[ 3 ] = {
+        float( block[ iMax ][ 0 ] ), float( block[ iMax ][ 1 ] ), float( block[ iMax ][ 2 ] ) };
+    const float e1[ 3 ] = {
+        float( block[ iMin ][ 0 ] ), float( block[ iMin ][ 1 ] ), float( block[ iMin ][ 2 ] ) };
+
+    uint16_t c0 = To565( e0 );
+    uint16_t c1 = To565( e1 );
+
+    // c0 > c1 for 4-color mode
+    if( c0 < c1 )
+    {
+        std::swap( c0, c1 );
+    }
+
+    uint32_t indices = 0;
+
+    if( c0 != c1 )
+    {
+        int32_t palette[ 4 ][ 3 ];
+        From565( c0, palette[ 0 ] );
+        From565( c1, palette[ 1 ] );
+        for( int k = 0; k < 3; k++ )
+        {
+            palette[ 2 ][ k ] = ( 2 * palette[ 0 ][ k ] + palette[ 1 ][ k ] ) / 3;
+            palette[ 3 ][ k ] = ( palette[ 0 ][ k ] + 2 * palette[ 1 ][ k ] ) / 3;
+        }
+
+        for( uint32_t i = 0; i < BlockPixels; i++ )
+        {
+            uint32_t best     = 0;
+            int32_t  bestDist = INT32_MAX;
+
+            for( uint32_t c = 0; c < 4; c++ )
+            {
+                int32_t dr   = int32_t( block[ i ][ 0 ] ) - palette[ c ][ 0 ];
+                int32_t dg   = int32_t( block[ i ][ 1 ] ) - palette[ c ][ 1 ];
+                int32_t db   = int32_t( block[ i ][ 2 ] ) - palette[ c ][ 2 ];
+                int32_t dist = dr * dr + dg * dg + db * db;
+
+                if( dist < bestDist )
+                {
+                    bestDist = dist;
+                    best     = c;
+                }
+            }
+
+            indices |= best << ( 2 * i );
+        }
+    }
+
+    dst[ 0 ] = uint8_t( c0 & 0xFF );
+    dst[ 1 ] = uint8_t( c0 >> 8 );
+    dst[ 2 ] = uint8_t( c1 & 0xFF );
+    dst[ 3 ] = uint8_t( c1 >> 8 );
+    dst[ 4 ] = uint8_t( ( indices >> 0 ) & 0xFF );
+    dst[ 5 ] = uint8_t( ( indices >> 8 ) & 0xFF );
+    dst[ 6 ] = uint8_t( ( indices >> 16 ) & 0xFF );
+    dst[ 7 ] = uint8_t( ( indices >> 24 ) & 0xFF );
+}
+
+// BC4 in 8-value mode
+void EncodeAlphaBlock( const uint8_t ( &block )[ BlockPixels ][ Channels ], uint8_t* dst )
+{
+    uint8_t a0 = 0, a1 = 255;
+    for( const auto& p : block )
+    {
+        a0 = std::max( a0, p[ 3 ] );
+        a1 = std::min( a1, p[ 3 ] );
+    }
+
+    uint64_t indices = 0;
+
+    if( a0 != a1 )
+    {
+        int32_t palette[ 8 ] = { a0, a1 };
+        for( int32_t k = 2; k < 8; k++ )
+        {
+            palette[ k ] = ( ( 8 - k ) * a0 + ( k - 1 ) * a1 ) / 7;
+        }
+
+        for( uint32_t i = 0; i < BlockPixels; i++ )
+        {
+            uint64_t best     = 0;
+            int32_t  bestDist = INT32_MAX;
+
+            for( uint32_t k = 0; k < 8; k++ )
+            {
+                int32_t dist = std::abs( int32_t( block[ i ][ 3 ] ) - palette[ k ] );
+                if( dist < bestDist )
+                {
+                    bestDist = dist;
+                    best     = k;
+                }
+            }
+
+            indices |= best << ( 3 * i );
+        }
+    }
+
+    dst[ 0 ] = a0;
+    dst[ 1 ] = a1;
+    for( uint32_t b = 0; b < 6; b++ )
+    {
+        dst[ 2 + b ] = uint8_t( ( indices >> ( 8 * b ) ) & 0xFF );
+    }
+}
+
+void CompressLevel( const uint8_t* pRgba8,
+                    uint32_t       width,
+                    uint32_t       height,
+                    bool           withAlpha,
+                    uint8_t*       dst,
+                    ThreadPool*    threadPool )
+{
+    const uint32_t blocksX   = ( width + BlockDim - 1 ) / BlockDim;
+    const uint32_t blocksY   = ( height + BlockDim - 1 ) / BlockDim;
+    const uint32_t blockSize = withAlpha ? 16 : 8;
+
+    auto encodeRows = [ & ]( size_t byBegin, size_t byEnd ) {
+        for( uint32_t by = uint32_t( byBegin ); by < uint32_t( byEnd ); by++ )
+        {
+            for( uint32_t bx = 0; bx < blocksX; bx++ )
+            {
+                uint8_t block[ BlockPixels ][ Channels ];
+
+                // replicate edge pixels for partial blocks
+                for( uint32_t j = 0; j < BlockDim; j++ )
+                {
+                    for( uint32_t i = 0; i < BlockDim; i++ )
+                    {
+                        uint32_t x = std::min( bx * BlockDim + i, width - 1 );
+                        uint32_t y = std::min( by * BlockDim + j, height - 1 );
+
+                        memcpy( block[ j * BlockDim + i ],
+                                &pRgba8[ ( size_t( y ) * width + x ) * Channels ],
+                                Channels );
+                    }
+                }
+
+                uint8_t* pBlock = &dst[ ( size_t( by ) * blocksX + bx ) * blockSize ];
+
+                if( withAlpha )
+                {
+                    EncodeAlphaBlock( block, pBlock );
+                    EncodeColorBlock( block, pBlock + 8 );
+                }
+                else
+                {
+                    EncodeColorBlock( block, pBlock );
+                }
+            }
+        }
+    };
+
+    if( threadPool )
+    {
+        threadPool->ParallelFor( blocksY, 4, encodeRows );
+    }
+    else
+    {
+        encodeRows( 0, blocksY );
+    }
+}
+
+float SRGBToLinear( uint8_t c )
+{
+    static const auto lut = [] {
+        std::array< float, 256 > arr{};
+        for( uint32_t i = 0; i < arr.size(); i++ )
+        {
+            float v  = float( i ) / 255.0f;
+            arr[ i ] = v <= 0.04045f ? v / 12.92f : std::pow( ( v + 0.055f ) / 1.055f, 2.4f );
+        }
+        return arr;
+    }();
+    return lut[ c ];
+}
+
+uint8_t LinearToSRGB( float v )
+{
+    v = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow( v, 1.0f / 2.4f ) - 0.055f;
+    return uint8_t( std::clamp( v, 0.0f, 1.0f ) * 255.0f + 0.5f );
+}
+
+// If isSRGB, color channels are averaged in linear space; alpha is always linear
+std::vector< uint8_t > Downsample( const uint8_t* src,
+                                   uint32_t       srcWidth,
+                                   uint32_t       srcHeight,
+                                   bool           isSRGB )
+{
+    const uint32_t dstWidth  = std::max( 1u, srcWidth / 2 );
+    const uint32_t dstHeight = std::max( 1u, srcHeight / 2 );
+
+    auto dst = std::vector< uint8_t >( size_t( dstWidth ) * dstHeight * Channels );
+
+    for( uint32_t y = 0; y < dstHeight; y++ )
+    {
+        for( uint32_t x = 0; x < dstWidth; x++ )
+        {
+            uint32_t x0 = std::min( 2 * x, srcWidth - 1 ), x1 = std::min( 2 * x + 1, srcWidth - 1 );
+            uint32_t y0 = std::min( 2 * y, srcHeight - 1 ), y1 = std::min( 2 * y + 1, srcHeight - 1 );
+
+            const uint8_t* p00 = &src[ ( size_t( y0 ) * srcWidth + x0 ) * Channels ];
+            const uint8_t* p01 = &src[ ( size_t( y0 ) * srcWidth + x1 ) * Channels ];
+            const uint8_t* p10 = &src[ ( size_t( y1 ) * srcWidth + x0 ) * Channels ];
+            const uint8_t* p11 = &src[ ( size_t( y1 ) * srcWidth + x1 ) * Channels ];
+
+            uint8_t* d = &dst[ ( size_t( y ) * dstWidth + x ) * Channels ];
+
+            for( uint32_t c = 0; c < Channels; c++ )
+            {
+                if( isSRGB && c < 3 )
+                {
+                    float sum = SRGBToLinear( p00[ c ] ) + SRGBToLinear( p01[ c ] ) +
+                                SRGBToLinear( p10[ c ] ) + SRGBToLinear( p11[ c ] );
+
+                    d[ c ] = LinearToSRGB( sum / 4.0f );
+                }
+                else
+                {
+                    uint32_t sum = p00[ c ] + p01[ c ] + p10[ c ] + p11[ c ];
+
+                    d[ c ] = uint8_t( ( sum + 2 ) / 4 );
+                }
+            }
+        }
+    }
+
+    return dst;
+}
+
+bool IsOpaque( const uint8_t* pRgba8, const RgExtent2D& size )
+{
+    const size_t count = size_t( size.width ) * size.height;
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( pRgba8[ i * Channels + 3 ] != 255 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+uint32_t BlockCompression::GetBlockSize( VkFormat format )
+{
+    switch( format )
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK: return 16;
+        default: assert( 0 ); return 0;
+    }
+}
+
+uint32_t BlockCompression::GetCompressedSize( VkFormat format, uint32_t width, uint32_t height )
+{
+    return ( ( width + BlockDim - 1 ) / BlockDim ) * ( ( height + BlockDim - 1 ) / BlockDim ) *
+           GetBlockSize( format );
+}
+
+BlockCompression::Result BlockCompression::CompressWithMipmaps( const uint8_t*    pRgba8,
+                                                                const RgExtent2D& size,
+                                                                bool              isSRGB,
+                                                                ThreadPool*       threadPool )
+{
+    assert( pRgba8 );
+    assert( size.width > 0 && size.height > 0 );
+
+    const bool     withAlpha = !IsOpaque( pRgba8, size );
+    const VkFormat format = withAlpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+
+    // same count as in TextureUploader, so the mip chain is full
+    const uint32_t levelCount = std::min(
+        uint32_t( std::log2( std::min( size.width, size.height ) ) ) + 1,
+        MAX_PREGENERATED_MIPMAP_LEVELS );
+
+    Result result = {
+        .data         = {},
+        .levelOffsets = {},
+        .levelSizes   = {},
+        .levelCount   = levelCount,
+        .baseSize     = size,
+        .format       = format,
+    };
+
+    uint32_t totalSize = 0;
+    for( uint32_t level = 0; level < levelCount; level++ )
+    {
+        result.levelOffsets[ level ] = totalSize;
+        result.levelSizes[ level ] =
+            GetCompressedSize( format, std::max( 1u, size.width >> level ), std::max( 1u, size.height >> level ) );
+
+        totalSize += result.levelSizes[ level ];
+    }
+    result.data.resize( totalSize );
+
+
+    std::vector< uint8_t > downsampled;
+    const uint8_t*         pLevel = pRgba8;
+
+    for( uint32_t level = 0; level < levelCount; level++ )
+    {
+        const uint32_t w = std::max( 1u, size.width >> level );
+        const uint32_t h = std::max( 1u, size.height >> level );
+
+        CompressLevel(
+            pLevel, w, h, withAlpha, &result.data[ result.levelOffsets[ level ] ], threadPool );
+
+        if( level + 1 < levelCount )
+        {
+            downsampled = Downsample( pLevel, w, h, isSRGB );
+            pLevel      = downsampled.data();
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "Const.h"
+
+#include <vector>
+
+namespace RTGL1
+{
+
+class ThreadPool;
+
+// Fast CPU encoder of RGBA8 images into BC1 / BC3 blocks.
+// Not as good as offline tools, but enough to have shipped-like memory in the developer mode.
+namespace BlockCompression
+{
+    struct Result
+    {
+        std::vector< uint8_t > data;
+        uint32_t               levelOffsets[ MAX_PREGENERATED_MIPMAP_LEVELS ];
+        uint32_t               levelSizes[ MAX_PREGENERATED_MIPMAP_LEVELS ];
+        uint32_t               levelCount;
+        RgExtent2D             baseSize;
+        // UNORM, it's up to the caller to change to SRGB
+        VkFormat               format;
+    };
+
+    // BC1 if all pixels are opaque, BC3 otherwise. Mip chain is generated with a box filter,
+    // in linear space if isSRGB. If threadPool is null, the encoding is done on the calling thread.
+    Result CompressWithMipmaps( const uint8_t*    pRgba8,
+                                const RgExtent2D& size,
+                                bool              isSRGB,
+                                ThreadPool*       threadPool );
+
+    uint32_t GetBlockSize( VkFormat format );
+    uint32_t GetCompressedSize( VkFormat format, uint32_t width, uint32_t height );
+}
+
+}
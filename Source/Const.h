@@ -27,6 +27,10 @@ namespace RTGL1
 
 constexpr uint32_t ALLOCATOR_BLOCK_SIZE_STAGING_TEXTURES = 64 * 512 * 512 * 4;
 constexpr uint32_t ALLOCATOR_BLOCK_SIZE_TEXTURES         = 64 * 512 * 512 * 4;
+// per frame in flight, two of them fit into one staging block
+constexpr uint32_t TEXTURE_STAGING_RING_SIZE             = 32 * 512 * 512 * 4;
+// cubemaps are rare, larger than 256x256 ones spill to dedicated buffers
+constexpr uint32_t CUBEMAP_STAGING_RING_SIZE             = 6 * 256 * 256 * 4;
 
 constexpr uint32_t TEXTURE_FILE_PATH_MAX_LENGTH      = 512;
 constexpr uint32_t TEXTURE_FILE_NAME_MAX_LENGTH      = 256;
@@ -51,6 +55,9 @@ constexpr uint32_t MAX_PREGENERATED_MIPMAP_LEVELS = 20;
 
 constexpr float MESH_TRANSLUCENT_ALPHA_THRESHOLD = 0.98f;
 
+// Max average surface deviation of a coarse LOD, relative to the diagonal of the mesh bounds
+constexpr float COARSE_LOD_MAX_ERROR = 0.01f;
+
 // Use WORLD2 mask bit as SKY
 #define RAYCULLMASK_SKY_IS_WORLD2 1
 
@@ -58,6 +65,7 @@ constexpr float MESH_TRANSLUCENT_ALPHA_THRESHOLD = 0.98f;
 
 constexpr std::string_view TEXTURES_FOLDER           = "mat";
 constexpr std::string_view TEXTURES_FOLDER_DEV       = "mat_dev";
+constexpr std::string_view TEXTURES_FOLDER_DEV_CACHE = "mat_dev_cache";
 constexpr std::string_view TEXTURES_FOLDER_ORIGINALS = "mat_src";
 constexpr std::string_view SCENES_FOLDER             = "scenes";
 constexpr std::string_view SHADERS_FOLDER            = "shaders";
@@ -22,6 +22,9 @@
 
 #include "Hashmap/robin_hood.h"
 
+#include <string>
+#include <string_view>
+
 namespace rgl
 {
 
@@ -31,4 +34,20 @@ using unordered_map = robin_hood::unordered_map< Key, T >;
 template< typename Key >
 using unordered_set = robin_hood::unordered_set< Key >;
 
+// Allows find / contains by std::string_view or const char* without a temporary std::string
+struct string_hash
+{
+    using is_transparent = void;
+
+    size_t operator()( std::string_view str ) const noexcept
+    {
+        return robin_hood::hash_bytes( str.data(), str.size() );
+    }
+};
+
+template< typename T >
+using string_map = robin_hood::unordered_map< std::string, T, string_hash, std::equal_to<> >;
+
+using string_set = robin_hood::unordered_set< std::string, string_hash, std::equal_to<> >;
+
 }
\ No newline at end of file
@@ -81,16 +81,19 @@ void CheckIfFaceCorrect( const RTGL1::ImageLoader::ResultInfo& face,
 RTGL1::CubemapManager::CubemapManager( VkDevice                           _device,
                                        std::shared_ptr< MemoryAllocator > _allocator,
                                        std::shared_ptr< SamplerManager >  _samplerManager,
-                                       CommandBufferManager&              _cmdManager )
+                                       CommandBufferManager&              _cmdManager,
+                                       std::shared_ptr< ThreadPool >      _threadPool )
     : device( _device )
     , allocator( std::move( _allocator ) )
     , samplerManager( std::move( _samplerManager ) )
+    , threadPool( std::move( _threadPool ) )
     , cubemaps( MAX_CUBEMAP_COUNT )
 {
     imageLoader = std::make_shared< ImageLoader >();
     cubemapDesc = std::make_shared< TextureDescriptors >(
         device, samplerManager, MAX_CUBEMAP_COUNT, BINDING_CUBEMAPS );
-    cubemapUploader = std::make_shared< CubemapUploader >( device, allocator );
+    cubemapUploader =
+        std::make_shared< CubemapUploader >( device, allocator, CUBEMAP_STAGING_RING_SIZE );
 
     VkCommandBuffer cmd = _cmdManager.StartGraphicsCmd();
     {
@@ -126,6 +129,9 @@ void RTGL1::CubemapManager::CreateEmptyCubemap( VkCommandBuffer cmd )
 
 RTGL1::CubemapManager::~CubemapManager()
 {
+    // tasks don't reference this instance, so no need to wait for them
+    pendingLoads.clear();
+
     for( const auto& [ name, t ] : cubemaps )
     {
         assert( ( t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE ) ||
@@ -167,7 +173,12 @@ bool RTGL1::CubemapManager::TryCreateCubemap( VkCommandBuffer              cmd,
     };
 
     auto loaders = TextureOverrides::Loader{ std::make_tuple( imageLoader.get() ) };
-    
+
+    // a single KTX2 file has a priority over per-face overrides, so don't load them,
+    // until the file is decoded, the original data is used
+    bool isLoadingKTX2 = TryStartLoadingKTX2( info.pTextureName, ovrdFolder );
+    std::filesystem::path faceOvrdFolder = isLoadingKTX2 ? std::filesystem::path() : ovrdFolder;
+
     RgExtent2D size = { info.sideSize, info.sideSize };
 
     std::string faceNames[] = {
@@ -182,12 +193,12 @@ bool RTGL1::CubemapManager::TryCreateCubemap( VkCommandBuffer              cmd,
 
     // clang-format off
     TextureOverrides ovrd[] = {
-        TextureOverrides( ovrdFolder, faceNames[ 0 ], "", facePixels[ 0 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
-        TextureOverrides( ovrdFolder, faceNames[ 1 ], "", facePixels[ 1 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
-        TextureOverrides( ovrdFolder, faceNames[ 2 ], "", facePixels[ 2 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
-        TextureOverrides( ovrdFolder, faceNames[ 3 ], "", facePixels[ 3 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
-        TextureOverrides( ovrdFolder, faceNames[ 4 ], "", facePixels[ 4 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
-        TextureOverrides( ovrdFolder, faceNames[ 5 ], "", facePixels[ 5 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 0 ], "", facePixels[ 0 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 1 ], "", facePixels[ 1 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 2 ], "", facePixels[ 2 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 3 ], "", facePixels[ 3 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 4 ], "", facePixels[ 4 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
+        TextureOverrides( faceOvrdFolder, faceNames[ 5 ], "", facePixels[ 5 ], size, VK_FORMAT_R8G8B8A8_SRGB, loaders ),
     };
     // clang-format on
 
@@ -254,6 +265,16 @@ bool RTGL1::CubemapManager::TryCreateCubemap( VkCommandBuffer              cmd,
             // if original data is not valid
             if( facePixels[ i ] == nullptr )
             {
+                if( isLoadingKTX2 )
+                {
+                    // keep an empty slot, until the file is decoded
+                    auto [ iter, insertednew ] = cubemaps.try_emplace( info.pTextureName );
+                    if( !insertednew && iter->second.image != VK_NULL_HANDLE )
+                    {
+                        AddForDeletion( frameIndex, iter->second );
+                    }
+                    return true;
+                }
                 return false;
             }
 
@@ -300,7 +321,10 @@ bool RTGL1::CubemapManager::TryCreateCubemap( VkCommandBuffer              cmd,
         Texture& existing = iter->second;
 
         // destroy old, overwrite with new
-        AddForDeletion( frameIndex, existing );
+        if( existing.image != VK_NULL_HANDLE )
+        {
+            AddForDeletion( frameIndex, existing );
+        }
         existing = txd;
     }
 
@@ -319,6 +343,102 @@ void RTGL1::CubemapManager::AddForDeletion( uint32_t frameIndex, Texture& txd )
     txd = {};
 }
 
+bool RTGL1::CubemapManager::TryStartLoadingKTX2( std::string_view             name,
+                                                 const std::filesystem::path& ovrdFolder )
+{
+    if( ovrdFolder.empty() || !threadPool )
+    {
+        return false;
+    }
+
+    auto path = TextureOverrides::GetTexturePath(
+        ovrdFolder / ImageLoader::GetFolder(), name, "", ImageLoader::GetExtensions()[ 0 ] );
+
+    std::error_code ec;
+    if( !std::filesystem::is_regular_file( path, ec ) )
+    {
+        return false;
+    }
+
+    // decoding and repacking a large sky might take a while, so do it on a worker
+    pendingLoads[ std::string( name ) ] = threadPool->Enqueue(
+        [ path = std::move( path ) ] { return ImageLoader::LoadCubemap( path ); } );
+    return true;
+}
+
+void RTGL1::CubemapManager::UploadLoadedCubemaps( VkCommandBuffer cmd, uint32_t frameIndex )
+{
+    for( auto it = pendingLoads.begin(); it != pendingLoads.end(); )
+    {
+        if( it->second.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+        {
+            ++it;
+            continue;
+        }
+
+        const std::string& name   = it->first;
+        auto               loaded = it->second.get();
+
+        auto existing = cubemaps.find( name );
+
+        if( !loaded )
+        {
+            debug::Warning( "Failed to load KTX2 cubemap: {}", name );
+        }
+        else if( existing != cubemaps.end() )
+        {
+            TextureUploader::UploadInfo upload = {
+                .cmd                    = cmd,
+                .frameIndex             = frameIndex,
+                .pData                  = nullptr,
+                .dataSize               = loaded->faceSize,
+                .cubemap                = {},
+                .baseSize               = loaded->baseSize,
+                .format                 = Utils::ToSRGB( loaded->format ),
+                .useMipmaps             = true,
+                .pregeneratedLevelCount = loaded->levelCount,
+                .pLevelDataOffsets      = loaded->levelOffsets,
+                .pLevelDataSizes        = loaded->levelSizes,
+                .isUpdateable           = false,
+                .pDebugName             = name.c_str(),
+                .isCubemap              = true,
+            };
+
+            // faces are stored one after another, each with its mip chain
+            for( uint32_t f = 0; f < 6; f++ )
+            {
+                upload.cubemap.pFaces[ f ] = &loaded->data[ size_t( f ) * loaded->faceSize ];
+            }
+
+            auto i = cubemapUploader->UploadImage( upload );
+            if( i.wasUploaded )
+            {
+                if( existing->second.image != VK_NULL_HANDLE )
+                {
+                    AddForDeletion( frameIndex, existing->second );
+                }
+
+                existing->second = Texture{
+                    .image         = i.image,
+                    .view          = i.view,
+                    .format        = upload.format,
+                    .samplerHandle = SamplerManager::Handle( RG_SAMPLER_FILTER_LINEAR,
+                                                             RG_SAMPLER_ADDRESS_MODE_CLAMP,
+                                                             RG_SAMPLER_ADDRESS_MODE_CLAMP ),
+                    .swizzling     = std::nullopt,
+                    .filepath      = {},
+                };
+            }
+            else
+            {
+                debug::Warning( "Failed to upload KTX2 cubemap: {}", name );
+            }
+        }
+
+        it = pendingLoads.erase( it );
+    }
+}
+
 bool RTGL1::CubemapManager::TryDestroyCubemap( uint32_t frameIndex, const char* pTextureName )
 {
     if( Utils::IsCstrEmpty( pTextureName ) )
@@ -332,7 +452,12 @@ bool RTGL1::CubemapManager::TryDestroyCubemap( uint32_t frameIndex, const char*
         return false;
     }
 
-    AddForDeletion( frameIndex, it->second );
+    pendingLoads.erase( it->first );
+
+    if( it->second.image != VK_NULL_HANDLE )
+    {
+        AddForDeletion( frameIndex, it->second );
+    }
     cubemaps.erase( it );
 
     return true;
@@ -362,6 +487,16 @@ void RTGL1::CubemapManager::PrepareForFrame( uint32_t frameIndex )
     cubemapUploader->ClearStaging( frameIndex );
 }
 
+bool RTGL1::CubemapManager::IsStagingExhausted( uint32_t frameIndex ) const
+{
+    return cubemapUploader->IsStagingExhausted( frameIndex );
+}
+
+void RTGL1::CubemapManager::ResetStaging( uint32_t frameIndex )
+{
+    cubemapUploader->ClearStaging( frameIndex );
+}
+
 void RTGL1::CubemapManager::SubmitDescriptors( uint32_t frameIndex )
 {
     // update desc set with current values
@@ -414,6 +549,12 @@ uint32_t RTGL1::CubemapManager::TryGetDescriptorIndex( const char* pTextureName
         iter++;
     }
 
+    // still decoding, empty cubemap is used meanwhile
+    if( pendingLoads.contains( pTextureName ) )
+    {
+        return 0;
+    }
+
     debug::Error( "Can't find cubemap with name: {}", Utils::SafeCstr( pTextureName ) );
     return 0;
 }
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <future>
 #include <vector>
 #include <string>
 
@@ -32,6 +33,7 @@
 #include "CubemapUploader.h"
 #include "CommandBufferManager.h"
 #include "ImageLoader.h"
+#include "ThreadPool.h"
 
 namespace RTGL1
 {
@@ -42,7 +44,8 @@ public:
     CubemapManager( VkDevice                           device,
                     std::shared_ptr< MemoryAllocator > allocator,
                     std::shared_ptr< SamplerManager >  samplerManager,
-                    CommandBufferManager&              cmdManager );
+                    CommandBufferManager&              cmdManager,
+                    std::shared_ptr< ThreadPool >      threadPool );
     ~CubemapManager();
 
     CubemapManager( const CubemapManager& other )                = delete;
@@ -57,6 +60,9 @@ public:
                            const std::filesystem::path& folder );
     bool TryDestroyCubemap( uint32_t frameIndex, const char* pTextureName );
 
+    // Replace cubemaps with their KTX2 overrides that were decoded on a worker thread
+    void UploadLoadedCubemaps( VkCommandBuffer cmd, uint32_t frameIndex );
+
 
     uint32_t TryGetDescriptorIndex( const char* pTextureName );
 
@@ -67,11 +73,16 @@ public:
     void PrepareForFrame( uint32_t frameIndex );
     void SubmitDescriptors( uint32_t frameIndex );
 
+    // Same as TextureManager::IsStagingExhausted / ResetStaging
+    bool IsStagingExhausted( uint32_t frameIndex ) const;
+    void ResetStaging( uint32_t frameIndex );
+
     bool IsCubemapValid( uint32_t cubemapIndex ) const;
 
 private:
     void CreateEmptyCubemap( VkCommandBuffer cmd );
     void AddForDeletion( uint32_t frameIndex, Texture& txd );
+    bool TryStartLoadingKTX2( std::string_view name, const std::filesystem::path& ovrdFolder );
 
 private:
     VkDevice device;
@@ -81,9 +92,13 @@ private:
     std::shared_ptr< SamplerManager >     samplerManager;
     std::shared_ptr< TextureDescriptors > cubemapDesc;
     std::shared_ptr< CubemapUploader >    cubemapUploader;
+    std::shared_ptr< ThreadPool >         threadPool;
 
     std::unordered_map< std::string, Texture > cubemaps;
     std::vector< Texture >                     cubemapsToDestroy[ MAX_FRAMES_IN_FLIGHT ];
+
+    using PendingLoad = std::future< std::optional< ImageLoader::CubemapResult > >;
+    std::unordered_map< std::string, PendingLoad > pendingLoads;
 };
 
 }
\ No newline at end of file
@@ -28,63 +28,42 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage( const
 
     constexpr uint32_t FaceCount = 6;
 
-    VkImage            image;
-    VkBuffer           stagingBuffers[ FaceCount ] = {};
-    void*              mappedData[ FaceCount ]     = {};
+    VkImage      image;
+    VkBuffer     stagingBuffers[ FaceCount ] = {};
+    VkDeviceSize stagingOffsets[ FaceCount ] = {};
 
 
-    // allocate and fill buffer
-    const auto         faceSize = VkDeviceSize( info.dataSize );
+    bool wasCreated = CreateImage( info, &image );
+    if( !wasCreated )
+    {
+        return UploadResult{};
+    }
 
-    VkBufferCreateInfo stagingInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size  = faceSize,
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    };
+
+    // allocate and fill buffer
+    const auto faceSize = VkDeviceSize( info.dataSize );
 
     for( uint32_t i = 0; i < FaceCount; i++ )
     {
-        stagingBuffers[ i ] = memAllocator->CreateStagingSrcTextureBuffer(
-            &stagingInfo, info.pDebugName, &mappedData[ i ] );
+        StagingAllocation staging = AllocateStaging( info.frameIndex, faceSize, info.pDebugName );
 
-        // if couldn't allocate memory
-        if( stagingBuffers[ i ] == VK_NULL_HANDLE )
+        // if couldn't allocate memory,
+        // the already allocated staging will be freed with the frame
+        if( staging.buffer == VK_NULL_HANDLE )
         {
-            // clear allocated
-            for( uint32_t j = 0; j < i; j++ )
-            {
-                memAllocator->DestroyStagingSrcTextureBuffer( stagingBuffers[ j ] );
-            }
-
+            memAllocator->DestroyTextureImage( image );
             return UploadResult{};
         }
 
-        SET_DEBUG_NAME( device, stagingBuffers[ i ], VK_OBJECT_TYPE_BUFFER, info.pDebugName );
-    }
-
-
-    bool wasCreated = CreateImage( info, &image );
-    if( !wasCreated )
-    {
-        // clean created resources
-        for( VkBuffer b : stagingBuffers )
-        {
-            memAllocator->DestroyStagingSrcTextureBuffer( b );
-        }
-
-        return UploadResult{};
-    }
-
+        memcpy( staging.mapped, info.cubemap.pFaces[ i ], faceSize );
 
-    // copy image data to buffer
-    for( uint32_t i = 0; i < FaceCount; i++ )
-    {
-        memcpy( mappedData[ i ], info.cubemap.pFaces[ i ], faceSize );
+        stagingBuffers[ i ] = staging.buffer;
+        stagingOffsets[ i ] = staging.offset;
     }
 
 
     // and copy it to image
-    PrepareImage( image, stagingBuffers, info, ImagePrepareType::INIT );
+    PrepareImage( image, stagingBuffers, stagingOffsets, info, ImagePrepareType::INIT );
 
 
     // create image view
@@ -96,13 +75,6 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage( const
     SET_DEBUG_NAME( device, imageView, VK_OBJECT_TYPE_IMAGE_VIEW, info.pDebugName );
 
 
-    // push staging buffer to be deleted when it won't be in use
-    for( VkBuffer b : stagingBuffers )
-    {
-        stagingToFree[ info.frameIndex ].push_back( b );
-    }
-
-
     // return results
 
     return UploadResult{
@@ -65,6 +65,7 @@ namespace detail
             .lightUniqueIdIgnoreFirstPersonViewerShadows = nullptr,
             .lightstyleValuesCount                       = 0,
             .pLightstyleValues                           = nullptr,
+            .coarseLodDistance                           = 50.0f,
         };
     };
 
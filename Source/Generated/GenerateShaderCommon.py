@@ -236,7 +236,7 @@ CONST = {
     # used for first-person geometries
     "LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT"   : 1 << 8,
     
-    "MAX_TOP_LEVEL_INSTANCE_COUNT"          : 45,
+    "MAX_TOP_LEVEL_INSTANCE_COUNT"          : 47,
     
     "BINDING_VERTEX_BUFFER_STATIC"              : 0,
     "BINDING_VERTEX_BUFFER_DYNAMIC"             : 1,
@@ -265,6 +265,7 @@ CONST = {
     "BINDING_LIGHT_SOURCES_INDEX_CUR_TO_PREV"   : 3,
     "BINDING_INITIAL_LIGHTS_GRID"               : 4,
     "BINDING_INITIAL_LIGHTS_GRID_PREV"          : 5,
+    "BINDING_LIGHT_TREE"                        : 6,
     "BINDING_LENS_FLARES_CULLING_INPUT"         : 0,
     "BINDING_LENS_FLARES_DRAW_CMDS"             : 1,
     "BINDING_DRAW_LENS_FLARES_INSTANCES"        : 0,
@@ -288,8 +289,8 @@ CONST = {
     "INSTANCE_MASK_WORLD_0"                 : BIT( 0 ),
     "INSTANCE_MASK_WORLD_1"                 : BIT( 1 ),
     "INSTANCE_MASK_WORLD_2"                 : BIT( 2 ),
-    "INSTANCE_MASK_RESERVED_0"              : BIT( 3 ),
-    "INSTANCE_MASK_RESERVED_1"              : BIT( 4 ),
+    "INSTANCE_MASK_WORLD_0_DETAIL"          : BIT( 3 ),
+    "INSTANCE_MASK_WORLD_0_COARSE"          : BIT( 4 ),
     "INSTANCE_MASK_REFRACT"                 : BIT( 5 ),
     "INSTANCE_MASK_FIRST_PERSON"            : BIT( 6 ),
     "INSTANCE_MASK_FIRST_PERSON_VIEWER"     : BIT( 7 ),
@@ -309,6 +310,7 @@ CONST = {
     "SBT_INDEX_MISS_SHADOW"                 : 1,
     "SBT_INDEX_HITGROUP_FULLY_OPAQUE"       : 0,
     "SBT_INDEX_HITGROUP_ALPHA_TESTED"       : 1,
+    "SBT_INDEX_HITGROUP_COARSE_LOD"         : 2,
     
     "MATERIAL_NO_TEXTURE"                   : 0,
 
@@ -426,6 +428,7 @@ CONST = {
     "LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET"     : 1,
 
     "LIGHT_INDEX_NONE"                      : ((1 << 15) - 1),
+    "LIGHT_TREE_NODE_LEAF_BIT"              : BIT( 31 ),
 
     "LIGHT_GRID_SIZE_X"                     : 16,
     "LIGHT_GRID_SIZE_Y"                     : 16,
@@ -590,7 +593,7 @@ GLOBAL_UNIFORM_STRUCT = [
 
     (TYPE_UINT32,       1,      "rayCullMaskWorld_Shadow",          1),
     (TYPE_UINT32,       1,      "volumeAllowTintUnderwater",        1),
-    (TYPE_UINT32,       1,      "_unused2",                         1),
+    (TYPE_FLOAT32,      1,      "coarseLodDistance",                1),
     (TYPE_UINT32,       1,      "twirlPortalNormal",                1),
 
     (TYPE_UINT32,       1,      "lightIndexIgnoreFPVShadows",       1),
@@ -659,7 +662,7 @@ GEOM_INSTANCE_STRUCT = [
     (TYPE_UINT32,       1,      "firstVertex_Layer2",   1),
     (TYPE_UINT32,       1,      "firstVertex_Layer3",   1),
 
-    (TYPE_UINT32,       1,      "_unused3",             1),
+    (TYPE_FLOAT32,      1,      "coarseLodMaxDeviation", 1),
     (TYPE_UINT32,       1,      "_unused4",             1),
     (TYPE_UINT32,       1,      "_unused5",             1),
     (TYPE_UINT32,       1,      "_unused6",             1),
@@ -687,6 +690,15 @@ LIGHT_IN_CELL = [
     (TYPE_FLOAT32,      1,      "weightSum",            1),
 ]
 
+# If LIGHT_TREE_NODE_LEAF_BIT is set, other bits are a light index,
+# otherwise, it's an index of the left child, and the right one is next to it
+LIGHT_TREE_NODE_STRUCT = [
+    (TYPE_FLOAT32,      3,      "boundsMin",            1),
+    (TYPE_UINT32,       1,      "childOrLightIndex",    1),
+    (TYPE_FLOAT32,      3,      "boundsMax",            1),
+    (TYPE_FLOAT32,      1,      "power",                1),
+]
+
 TONEMAPPING_STRUCT = [
     (TYPE_UINT32,       1,      "histogram",            CONST["COMPUTE_LUM_HISTOGRAM_BIN_COUNT"]),
     (TYPE_FLOAT32,      1,      "avgLuminance",         1),
@@ -749,6 +761,7 @@ STRUCTS = {
     "ShTonemapping":            (TONEMAPPING_STRUCT,            False,  0,                          0),
     "ShLightEncoded":           (LIGHT_ENCODED_STRUCT,          False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShLightInCell":            (LIGHT_IN_CELL,                 False,  STRUCT_ALIGNMENT_STD430,    0),
+    "ShLightTreeNode":          (LIGHT_TREE_NODE_STRUCT,        False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShVertPreprocessing":      (VERT_PREPROC_PUSH_STRUCT,      False,  0,                          0),
     "ShIndirectDrawCommand":    (INDIRECT_DRAW_CMD_STRUCT,      False,  STRUCT_ALIGNMENT_STD430,    0),
     # TODO: should be STRUCT_ALIGNMENT_STD430, but current generator is not great as it just adds pads at the end, so it's 0
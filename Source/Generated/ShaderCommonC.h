@@ -15,7 +15,7 @@ namespace RTGL1
 #define MAX_GEOMETRY_PRIMITIVE_COUNT (1048576)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT_POW (20)
 #define LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT (256)
-#define MAX_TOP_LEVEL_INSTANCE_COUNT (45)
+#define MAX_TOP_LEVEL_INSTANCE_COUNT (47)
 #define BINDING_VERTEX_BUFFER_STATIC (0)
 #define BINDING_VERTEX_BUFFER_DYNAMIC (1)
 #define BINDING_INDEX_BUFFER_STATIC (2)
@@ -43,6 +43,7 @@ namespace RTGL1
 #define BINDING_LIGHT_SOURCES_INDEX_CUR_TO_PREV (3)
 #define BINDING_INITIAL_LIGHTS_GRID (4)
 #define BINDING_INITIAL_LIGHTS_GRID_PREV (5)
+#define BINDING_LIGHT_TREE (6)
 #define BINDING_LENS_FLARES_CULLING_INPUT (0)
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
@@ -64,8 +65,8 @@ namespace RTGL1
 #define INSTANCE_MASK_WORLD_0 (1 << 0)
 #define INSTANCE_MASK_WORLD_1 (1 << 1)
 #define INSTANCE_MASK_WORLD_2 (1 << 2)
-#define INSTANCE_MASK_RESERVED_0 (1 << 3)
-#define INSTANCE_MASK_RESERVED_1 (1 << 4)
+#define INSTANCE_MASK_WORLD_0_DETAIL (1 << 3)
+#define INSTANCE_MASK_WORLD_0_COARSE (1 << 4)
 #define INSTANCE_MASK_REFRACT (1 << 5)
 #define INSTANCE_MASK_FIRST_PERSON (1 << 6)
 #define INSTANCE_MASK_FIRST_PERSON_VIEWER (1 << 7)
@@ -83,6 +84,7 @@ namespace RTGL1
 #define SBT_INDEX_MISS_SHADOW (1)
 #define SBT_INDEX_HITGROUP_FULLY_OPAQUE (0)
 #define SBT_INDEX_HITGROUP_ALPHA_TESTED (1)
+#define SBT_INDEX_HITGROUP_COARSE_LOD (2)
 #define MATERIAL_NO_TEXTURE (0)
 #define MATERIAL_BLENDING_TYPE_OPAQUE (0)
 #define MATERIAL_BLENDING_TYPE_ALPHA (1)
@@ -177,6 +179,7 @@ namespace RTGL1
 #define LIGHT_ARRAY_DIRECTIONAL_LIGHT_OFFSET (0)
 #define LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET (1)
 #define LIGHT_INDEX_NONE (32767)
+#define LIGHT_TREE_NODE_LEAF_BIT (1 << 31)
 #define LIGHT_GRID_SIZE_X (16)
 #define LIGHT_GRID_SIZE_Y (16)
 #define LIGHT_GRID_SIZE_Z (16)
@@ -278,7 +281,7 @@ struct ShGlobalUniform
     float primaryRayMinDist;
     uint32_t rayCullMaskWorld_Shadow;
     uint32_t volumeAllowTintUnderwater;
-    uint32_t _unused2;
+    float coarseLodDistance;
     uint32_t twirlPortalNormal;
     uint32_t lightIndexIgnoreFPVShadows;
     float gradientMultDiffuse;
@@ -331,7 +334,7 @@ struct ShGeometryInstance
     uint32_t firstVertex_Layer1;
     uint32_t firstVertex_Layer2;
     uint32_t firstVertex_Layer3;
-    uint32_t _unused3;
+    float coarseLodMaxDeviation;
     uint32_t _unused4;
     uint32_t _unused5;
     uint32_t _unused6;
@@ -364,6 +367,14 @@ struct ShLightInCell
     uint32_t __pad0;
 };
 
+struct ShLightTreeNode
+{
+    float boundsMin[3];
+    uint32_t childOrLightIndex;
+    float boundsMax[3];
+    float power;
+};
+
 struct ShVertPreprocessing
 {
     uint32_t tlasInstanceCount;
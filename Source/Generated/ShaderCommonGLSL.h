@@ -8,7 +8,7 @@
 #define MAX_GEOMETRY_PRIMITIVE_COUNT (1048576)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT_POW (20)
 #define LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT (256)
-#define MAX_TOP_LEVEL_INSTANCE_COUNT (45)
+#define MAX_TOP_LEVEL_INSTANCE_COUNT (47)
 #define BINDING_VERTEX_BUFFER_STATIC (0)
 #define BINDING_VERTEX_BUFFER_DYNAMIC (1)
 #define BINDING_INDEX_BUFFER_STATIC (2)
@@ -36,6 +36,7 @@
 #define BINDING_LIGHT_SOURCES_INDEX_CUR_TO_PREV (3)
 #define BINDING_INITIAL_LIGHTS_GRID (4)
 #define BINDING_INITIAL_LIGHTS_GRID_PREV (5)
+#define BINDING_LIGHT_TREE (6)
 #define BINDING_LENS_FLARES_CULLING_INPUT (0)
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
@@ -57,8 +58,8 @@
 #define INSTANCE_MASK_WORLD_0 (1 << 0)
 #define INSTANCE_MASK_WORLD_1 (1 << 1)
 #define INSTANCE_MASK_WORLD_2 (1 << 2)
-#define INSTANCE_MASK_RESERVED_0 (1 << 3)
-#define INSTANCE_MASK_RESERVED_1 (1 << 4)
+#define INSTANCE_MASK_WORLD_0_DETAIL (1 << 3)
+#define INSTANCE_MASK_WORLD_0_COARSE (1 << 4)
 #define INSTANCE_MASK_REFRACT (1 << 5)
 #define INSTANCE_MASK_FIRST_PERSON (1 << 6)
 #define INSTANCE_MASK_FIRST_PERSON_VIEWER (1 << 7)
@@ -76,6 +77,7 @@
 #define SBT_INDEX_MISS_SHADOW (1)
 #define SBT_INDEX_HITGROUP_FULLY_OPAQUE (0)
 #define SBT_INDEX_HITGROUP_ALPHA_TESTED (1)
+#define SBT_INDEX_HITGROUP_COARSE_LOD (2)
 #define MATERIAL_NO_TEXTURE (0)
 #define MATERIAL_BLENDING_TYPE_OPAQUE (0)
 #define MATERIAL_BLENDING_TYPE_ALPHA (1)
@@ -170,6 +172,7 @@
 #define LIGHT_ARRAY_DIRECTIONAL_LIGHT_OFFSET (0)
 #define LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET (1)
 #define LIGHT_INDEX_NONE (32767)
+#define LIGHT_TREE_NODE_LEAF_BIT (1 << 31)
 #define LIGHT_GRID_SIZE_X (16)
 #define LIGHT_GRID_SIZE_Y (16)
 #define LIGHT_GRID_SIZE_Z (16)
@@ -273,7 +276,7 @@ struct ShGlobalUniform
     float primaryRayMinDist;
     uint rayCullMaskWorld_Shadow;
     uint volumeAllowTintUnderwater;
-    uint _unused2;
+    float coarseLodDistance;
     uint twirlPortalNormal;
     uint lightIndexIgnoreFPVShadows;
     float gradientMultDiffuse;
@@ -326,7 +329,7 @@ struct ShGeometryInstance
     uint firstVertex_Layer1;
     uint firstVertex_Layer2;
     uint firstVertex_Layer3;
-    uint _unused3;
+    float coarseLodMaxDeviation;
     uint _unused4;
     uint _unused5;
     uint _unused6;
@@ -359,6 +362,14 @@ struct ShLightInCell
     uint __pad0;
 };
 
+struct ShLightTreeNode
+{
+    vec3 boundsMin;
+    uint childOrLightIndex;
+    vec3 boundsMax;
+    float power;
+};
+
 struct ShVertPreprocessing
 {
     uint tlasInstanceCount;
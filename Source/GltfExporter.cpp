@@ -21,8 +21,11 @@
 #include "GltfExporter.h"
 
 #include "Const.h"
+#include "JsonParser.h"
+#include "MeshOptimization.h"
 #include "SpanCounted.h"
 #include "TextureExporter.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 
 #include "Generated/ShaderCommonC.h"
@@ -36,18 +39,12 @@
 #include <array>
 #include <cassert>
 #include <fstream>
-#include <queue>
+#include <map>
 #include <span>
 #include <type_traits>
 
 namespace
 {
-template< class T >
-void HashCombine( std::size_t& seed, const T& v )
-{
-    seed ^= std::hash< T >{}( v ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
-}
-
 bool TransformIsLess( const RgTransform& a, const RgTransform& b )
 {
     for( size_t i = 0; i < std::size( a.matrix ); i++ )
@@ -86,7 +83,7 @@ uint64_t TransformHash( const RgTransform& a )
     {
         for( size_t j = 0; j < std::size( a.matrix[ 0 ] ); j++ )
         {
-            HashCombine( h, a.matrix[ i ][ j ] );
+            RTGL1::Utils::HashCombine( h, a.matrix[ i ][ j ] );
         }
     }
     return h;
@@ -128,10 +125,38 @@ std::filesystem::path GetGltfBinPath( std::filesystem::path gltfPath )
     return gltfPath.replace_extension( ".bin" );
 }
 
+std::filesystem::path GetExportManifestPath( std::filesystem::path gltfPath )
+{
+    return gltfPath.replace_extension( ".export.json" );
+}
+
 std::string GetGltfBinURI( const std::filesystem::path& gltfPath )
 {
     return GetGltfBinPath( gltfPath ).filename().string();
 }
+
+bool IsGlb( const std::filesystem::path& gltfPath )
+{
+    return gltfPath.extension() == ".glb";
+}
+
+std::optional< uint64_t > HashFileContents( const std::filesystem::path& path )
+{
+    std::ifstream file( path, std::ios::binary );
+    if( !file.is_open() )
+    {
+        return std::nullopt;
+    }
+
+    uint64_t hash = RTGL1::Utils::FNV1A_64_OFFSET_BASIS;
+    char     chunk[ 64 * 1024 ];
+
+    while( file.read( chunk, sizeof( chunk ) ) || file.gcount() > 0 )
+    {
+        hash = RTGL1::Utils::HashFnv1a( chunk, size_t( file.gcount() ), hash );
+    }
+    return hash;
+}
 }
 
 
@@ -224,6 +249,58 @@ struct DeepCopyOfPrimitive
         return editor.pbrInfoExists ? Utils::Saturate( editor.pbrInfo.metallicDefault ) : 0.0f;
     }
 
+    // Vertices, indices and the material properties; names are not a part of the payload
+    static uint64_t HashPayload( const RgMeshPrimitiveInfo& c )
+    {
+        const auto textureName = std::string_view( Utils::SafeCstr( c.pTextureName ) );
+
+        uint64_t h = Utils::HashFnv1a( c.pVertices, c.vertexCount * sizeof( RgPrimitiveVertex ) );
+        h          = Utils::HashFnv1a( c.pIndices, c.indexCount * sizeof( uint32_t ), h );
+        h          = Utils::HashFnv1a( textureName.data(), textureName.size(), h );
+        h          = Utils::HashFnv1a( &c.flags, sizeof( c.flags ), h );
+        h          = Utils::HashFnv1a( &c.color, sizeof( c.color ), h );
+        return h;
+    }
+
+    // Only the data that is written to .bin; stable between runs, as it's saved to the manifest
+    uint64_t HashGeometry() const
+    {
+        uint64_t h = Utils::HashFnv1a( Vertices().data(), Vertices().size_bytes() );
+        h          = Utils::HashFnv1a( Indices().data(), Indices().size_bytes(), h );
+        return h;
+    }
+
+    bool IsSamePayload( const RgMeshPrimitiveInfo& c ) const
+    {
+        const RgEditorInfo& otherEditor = c.pEditorInfo ? *c.pEditorInfo : RgEditorInfo{};
+
+        if( info.flags != c.flags || info.color != c.color || info.emissive != c.emissive ||
+            pTextureName != Utils::SafeCstr( c.pTextureName ) )
+        {
+            return false;
+        }
+
+        if( editor.pbrInfoExists != otherEditor.pbrInfoExists ||
+            ( editor.pbrInfoExists &&
+              ( editor.pbrInfo.metallicDefault != otherEditor.pbrInfo.metallicDefault ||
+                editor.pbrInfo.roughnessDefault != otherEditor.pbrInfo.roughnessDefault ) ) )
+        {
+            return false;
+        }
+
+        return std::ranges::equal( Indices(), std::span( c.pIndices, c.indexCount ) ) &&
+               pVertices.size() == c.vertexCount &&
+               std::memcmp( pVertices.data(),
+                            c.pVertices,
+                            pVertices.size() * sizeof( RgPrimitiveVertex ) ) == 0;
+    }
+
+    void OptimizeMesh()
+    {
+        MeshOptimization::Optimize( pVertices, pIndices );
+        FixupPointers( *this );
+    }
+
     cgltf_alpha_mode AlphaMode() const
     {
         if( info.flags & RG_MESH_PRIMITIVE_ALPHA_TESTED )
@@ -266,23 +343,52 @@ private:
 
 
 
-RTGL1::GltfExporter::GltfExporter( const RgTransform& _worldTransform, float _oneGameUnitInMeters )
-    : worldTransform( _worldTransform ), oneGameUnitInMeters( _oneGameUnitInMeters )
+RTGL1::GltfExporter::GltfExporter( const RgTransform&            _worldTransform,
+                                   float                         _oneGameUnitInMeters,
+                                   bool                          _optimizeMeshes,
+                                   std::shared_ptr< ThreadPool > _threadPool )
+    : worldTransform( _worldTransform )
+    , oneGameUnitInMeters( _oneGameUnitInMeters )
+    , optimizeMeshes( _optimizeMeshes )
+    , threadPool( std::move( _threadPool ) )
 {
 }
 
 namespace
 {
 
+// Vertex data of all primitives. For .gltf, it's written to a separate .bin file right away.
+// For .glb, the chunk is accumulated, as it must be placed after the JSON chunk.
+// If 'appendTo' is not 0, the existing .bin of that size is kept, and new data is appended
 struct GltfBin
 {
-    explicit GltfBin( const std::filesystem::path& gltfPath )
-        : uri( GetGltfBinURI( gltfPath ) )
-        , file( GetGltfBinPath( gltfPath ), std::ios::out | std::ios::trunc | std::ios::binary )
+    // 'prevHash' is the hash of the first 'appendTo' bytes of the existing file
+    explicit GltfBin( const std::filesystem::path& gltfPath, size_t appendTo, uint64_t prevHash )
+        : isGlb( IsGlb( gltfPath ) )
+        , uri( isGlb ? std::string() : GetGltfBinURI( gltfPath ) )
+        , file()
         , fileOffset( 0 )
+        , hash( appendTo > 0 ? prevHash : RTGL1::Utils::FNV1A_64_OFFSET_BASIS )
         , storage{}
     {
-        assert( file );
+        assert( !isGlb || appendTo == 0 );
+
+        if( !isGlb )
+        {
+            if( appendTo > 0 )
+            {
+                file.open( GetGltfBinPath( gltfPath ),
+                           std::ios::in | std::ios::out | std::ios::binary );
+                file.seekp( std::streamoff( appendTo ) );
+                fileOffset = appendTo;
+            }
+            else
+            {
+                file.open( GetGltfBinPath( gltfPath ),
+                           std::ios::out | std::ios::trunc | std::ios::binary );
+            }
+            assert( file );
+        }
     }
 
     cgltf_buffer* Get()
@@ -290,7 +396,8 @@ struct GltfBin
         storage = cgltf_buffer{
             .name = nullptr,
             .size = fileOffset,
-            .uri  = const_cast< char* >( uri.c_str() ),
+            // GLB-stored buffer must have no URI
+            .uri  = isGlb ? nullptr : const_cast< char* >( uri.c_str() ),
         };
         return &storage;
     }
@@ -301,29 +408,103 @@ struct GltfBin
     {
         size_t begin = fileOffset;
 
-        file.write( reinterpret_cast< const char* >( bytes.data() ),
-                    std::streamsize( bytes.size_bytes() ) );
+        if( isGlb )
+        {
+            auto src = reinterpret_cast< const uint8_t* >( bytes.data() );
+            glbChunk.insert( glbChunk.end(), src, src + bytes.size_bytes() );
+        }
+        else
+        {
+            file.write( reinterpret_cast< const char* >( bytes.data() ),
+                        std::streamsize( bytes.size_bytes() ) );
+            hash = RTGL1::Utils::HashFnv1a( bytes.data(), bytes.size_bytes(), hash );
+        }
         fileOffset += bytes.size_bytes();
 
         return begin;
     }
 
+    std::span< const uint8_t > GlbChunk() const { return glbChunk; }
+    // Of the whole .bin file, including the data that was there before appending
+    uint64_t                   Hash() const { return hash; }
+
 private:
-    std::string   uri;
-    std::ofstream file;
-    size_t        fileOffset;
-    cgltf_buffer  storage;
+    bool                   isGlb;
+    std::string            uri;
+    std::fstream           file;
+    size_t                 fileOffset;
+    uint64_t               hash;
+    cgltf_buffer           storage;
+    std::vector< uint8_t > glbChunk;
 };
 
+// Binary glTF: 12-byte header, JSON chunk, BIN chunk; chunks are 4-byte aligned
+bool WriteGlb( const std::filesystem::path& path,
+               std::string_view             json,
+               std::span< const uint8_t >   bin )
+{
+    constexpr uint32_t GlbMagic        = 0x46546C67; // glTF
+    constexpr uint32_t GlbVersion      = 2;
+    constexpr uint32_t ChunkHeaderSize = 8;
+    constexpr uint32_t ChunkTypeJson   = 0x4E4F534A; // JSON
+    constexpr uint32_t ChunkTypeBin    = 0x004E4942; // BIN
+
+    constexpr auto align4 = []( size_t v ) { return uint32_t( ( v + 3 ) & ~size_t( 3 ) ); };
+
+    const uint32_t jsonSize = align4( json.size() );
+    const uint32_t binSize  = align4( bin.size() );
+
+    const uint32_t totalSize = 12 + ChunkHeaderSize + jsonSize +
+                               ( bin.empty() ? 0 : ChunkHeaderSize + binSize );
+
+    std::ofstream file( path, std::ios::out | std::ios::trunc | std::ios::binary );
+    if( !file )
+    {
+        return false;
+    }
+
+    auto writeU32 = [ &file ]( uint32_t v ) {
+        file.write( reinterpret_cast< const char* >( &v ), sizeof( v ) );
+    };
+    auto pad = [ &file ]( size_t count, char c ) {
+        for( size_t i = 0; i < count; i++ )
+        {
+            file.put( c );
+        }
+    };
+
+    writeU32( GlbMagic );
+    writeU32( GlbVersion );
+    writeU32( totalSize );
+
+    writeU32( jsonSize );
+    writeU32( ChunkTypeJson );
+    file.write( json.data(), std::streamsize( json.size() ) );
+    pad( jsonSize - json.size(), ' ' );
+
+    if( !bin.empty() )
+    {
+        writeU32( binSize );
+        writeU32( ChunkTypeBin );
+        file.write( reinterpret_cast< const char* >( bin.data() ), std::streamsize( bin.size() ) );
+        pad( binSize - bin.size(), '\0' );
+    }
+
+    return bool( file );
+}
 
-auto MakeBufferViews( GltfBin& fbin, const RTGL1::DeepCopyOfPrimitive& prim )
+
+// If 'existing' is not null, the data is already in the .bin
+auto MakeBufferViews( GltfBin&                          fbin,
+                      const RTGL1::DeepCopyOfPrimitive& prim,
+                      const RTGL1::ExportedPrimitive*   existing )
 {
     return std::to_array( {
 #define BUFFER_VIEW_VERTICES 0
         cgltf_buffer_view{
             .name   = nullptr,
             .buffer = fbin.Get(),
-            .offset = fbin.Write( prim.Vertices() ),
+            .offset = existing ? existing->verticesOffset : fbin.Write( prim.Vertices() ),
             .size   = prim.Vertices().size_bytes(),
             .stride = sizeof( decltype( prim.Vertices() )::element_type ),
             .type   = cgltf_buffer_view_type_vertices,
@@ -332,7 +513,7 @@ auto MakeBufferViews( GltfBin& fbin, const RTGL1::DeepCopyOfPrimitive& prim )
         cgltf_buffer_view{
             .name   = nullptr,
             .buffer = fbin.Get(),
-            .offset = fbin.Write( prim.Indices() ),
+            .offset = existing ? existing->indicesOffset : fbin.Write( prim.Indices() ),
             .size   = prim.Indices().size_bytes(),
             .stride = sizeof( decltype( prim.Indices() )::element_type ),
             .type   = cgltf_buffer_view_type_indices,
@@ -342,7 +523,8 @@ auto MakeBufferViews( GltfBin& fbin, const RTGL1::DeepCopyOfPrimitive& prim )
 constexpr size_t BufferViewsPerPrim =
     std::size( std::invoke_result_t< decltype( MakeBufferViews ),
                                      GltfBin&,
-                                     const RTGL1::DeepCopyOfPrimitive& >{} );
+                                     const RTGL1::DeepCopyOfPrimitive&,
+                                     const RTGL1::ExportedPrimitive* >{} );
 
 auto MakeAccessors( size_t                         vertexCount,
                     size_t                         indexCount,
@@ -532,6 +714,33 @@ auto append_n( std::vector< T >& v, size_t toadd )
 }
 
 
+// Corresponds to a unique payload of RgMeshPrimitiveInfo, its data is written once
+struct GltfPrimitiveData
+{
+    std::span< cgltf_buffer_view > bufferViews;
+    std::span< cgltf_accessor >    accessors;
+    std::span< cgltf_attribute >   attributes;
+    cgltf_material*                material;
+
+    std::shared_ptr< RTGL1::DeepCopyOfPrimitive > source;
+
+    // hash of the source geometry, before optimization
+    uint64_t                        geometryHash{ 0 };
+    const RTGL1::ExportedPrimitive* existing{ nullptr };
+};
+
+// Corresponds to a unique list of primitives, shared by all nodes that have such list
+struct GltfMesh
+{
+    std::string name;
+
+    std::span< cgltf_primitive > primitives;
+    cgltf_mesh*                  mesh;
+
+    // indices in GltfStorage::uniquePrimitives
+    std::vector< size_t > source;
+};
+
 // Corresponds to RgMeshInfo
 struct GltfRoot
 {
@@ -539,73 +748,95 @@ struct GltfRoot
     RgTransform transform;
 
     cgltf_node* thisNode;
-
-    std::span< cgltf_buffer_view > bufferViews;
-    std::span< cgltf_accessor >    accessors;
-    std::span< cgltf_attribute >   attributes;
-    std::span< cgltf_primitive >   primitives;
-    std::span< cgltf_material >    materials;
-    cgltf_mesh*                    mesh;
-
-    std::vector< std::shared_ptr< RTGL1::DeepCopyOfPrimitive > > source;
+    cgltf_mesh* mesh;
 };
 
 struct GltfStorage
 {
     explicit GltfStorage( const RTGL1::MeshesToTheirPrimitives& scene, size_t lightCount )
     {
-        struct Ranges
-        {
-            BeginCount bufferViews;
-            BeginCount accessors;
-            BeginCount attributes;
-            BeginCount primitives;
-            BeginCount materials;
-            BeginCount mesh;
-            BeginCount thisNode;
-        };
-        std::queue< Ranges > ranges;
+        rgl::unordered_map< const RTGL1::DeepCopyOfPrimitive*, size_t > primitiveIndices;
+        std::map< std::vector< size_t >, size_t >                       meshIndices;
+        std::vector< size_t >                                           rootMeshIndices;
 
-        // alloc
+        // find unique
         for( const auto& [ meshNode, prims ] : scene )
         {
-            size_t primsPerMesh = prims.size();
-
-            ranges.push( Ranges{
-                .bufferViews = append_n( allBufferViews, primsPerMesh * BufferViewsPerPrim ),
-                .accessors   = append_n( allAccessors, primsPerMesh * AccessorsPerPrim ),
-                .attributes  = append_n( allAttributes, primsPerMesh * AttributesPerPrim ),
-                .primitives  = append_n( allPrimitives, primsPerMesh ),
-                .materials   = append_n( allMaterials, primsPerMesh ),
-                .mesh        = append_n( allMeshes, 1 ),
-                .thisNode    = append_n( allNodes, 1 ),
+            std::vector< size_t > list;
+            list.reserve( prims.size() );
+
+            for( const auto& p : prims )
+            {
+                auto [ iter, isNew ] =
+                    primitiveIndices.try_emplace( p.get(), uniquePrimitives.size() );
+                if( isNew )
+                {
+                    uniquePrimitives.push_back( GltfPrimitiveData{ .source = p } );
+                }
+                list.push_back( iter->second );
+            }
+
+            auto [ iter, isNew ] = meshIndices.try_emplace( list, meshes.size() );
+            if( isNew )
+            {
+                meshes.push_back( GltfMesh{ .name = meshNode.name, .source = std::move( list ) } );
+            }
+            rootMeshIndices.push_back( iter->second );
+
+            roots.push_back( GltfRoot{
+                .name      = meshNode.name,
+                .transform = meshNode.transform,
             } );
         }
+
+        // alloc
+        const size_t primCount = uniquePrimitives.size();
+
+        BeginCount bufferViewsbc = append_n( allBufferViews, primCount * BufferViewsPerPrim );
+        BeginCount accessorsbc   = append_n( allAccessors, primCount * AccessorsPerPrim );
+        BeginCount attributesbc  = append_n( allAttributes, primCount * AttributesPerPrim );
+        BeginCount materialsbc   = append_n( allMaterials, primCount );
+
+        std::vector< BeginCount > meshPrimitivesbc;
+        for( const GltfMesh& m : meshes )
+        {
+            meshPrimitivesbc.push_back( append_n( allPrimitives, m.source.size() ) );
+        }
+        BeginCount meshesbc = append_n( allMeshes, meshes.size() );
+        BeginCount rootsbc  = append_n( allNodes, roots.size() );
         BeginCount lightsbc = append_n( allNodes, lightCount );
         BeginCount worldbc  = append_n( allNodes, 1 );
 
         // resolve pointers
-        for( const auto& [ meshNode, prims ] : scene )
         {
-            const Ranges r = ranges.front();
-            ranges.pop();
-
-            GltfRoot root = {
-                .name        = meshNode.name,
-                .transform   = meshNode.transform,
-                .thisNode    = r.thisNode.ToPointer( allNodes ),
-                .bufferViews = r.bufferViews.ToSpan( allBufferViews ),
-                .accessors   = r.accessors.ToSpan( allAccessors ),
-                .attributes  = r.attributes.ToSpan( allAttributes ),
-                .primitives  = r.primitives.ToSpan( allPrimitives ),
-                .materials   = r.primitives.ToSpan( allMaterials ),
-                .mesh        = r.mesh.ToPointer( allMeshes ),
-                .source      = prims,
-            };
-            assert( root.source.size() == root.primitives.size() );
+            auto views      = bufferViewsbc.ToSpan( allBufferViews );
+            auto accessors  = accessorsbc.ToSpan( allAccessors );
+            auto attributes = attributesbc.ToSpan( allAttributes );
+            auto materials  = materialsbc.ToSpan( allMaterials );
+
+            for( size_t i = 0; i < primCount; i++ )
+            {
+                GltfPrimitiveData& p = uniquePrimitives[ i ];
 
-            worldChildren.push_back( root.thisNode );
-            roots.push_back( std::move( root ) );
+                p.bufferViews = views.subspan( i * BufferViewsPerPrim, BufferViewsPerPrim );
+                p.accessors   = accessors.subspan( i * AccessorsPerPrim, AccessorsPerPrim );
+                p.attributes  = attributes.subspan( i * AttributesPerPrim, AttributesPerPrim );
+                p.material    = &materials[ i ];
+            }
+        }
+
+        for( size_t i = 0; i < meshes.size(); i++ )
+        {
+            meshes[ i ].primitives = meshPrimitivesbc[ i ].ToSpan( allPrimitives );
+            meshes[ i ].mesh       = &meshesbc.ToSpan( allMeshes )[ i ];
+        }
+
+        for( size_t i = 0; i < roots.size(); i++ )
+        {
+            roots[ i ].thisNode = &rootsbc.ToSpan( allNodes )[ i ];
+            roots[ i ].mesh     = meshes[ rootMeshIndices[ i ] ].mesh;
+
+            worldChildren.push_back( roots[ i ].thisNode );
         }
 
         lightNodes = lightsbc.ToSpan( allNodes );
@@ -616,7 +847,6 @@ struct GltfStorage
 
         world = worldbc.ToPointer( allNodes );
 
-        assert( ranges.empty() );
         assert( worldChildren.size() == roots.size() + lightCount );
     }
 
@@ -628,7 +858,9 @@ struct GltfStorage
     std::vector< cgltf_mesh >        allMeshes;
     std::vector< cgltf_node >        allNodes;
 
-    std::vector< GltfRoot > roots; // each corresponds to RgMeshInfo
+    std::vector< GltfPrimitiveData > uniquePrimitives;
+    std::vector< GltfMesh >          meshes;
+    std::vector< GltfRoot >          roots; // each corresponds to RgMeshInfo
 
     cgltf_node*                world{ nullptr };
     std::vector< cgltf_node* > worldChildren;
@@ -639,9 +871,10 @@ struct GltfStorage
 
 struct GltfTextures
 {
-    explicit GltfTextures( const std::set< std::string >& sceneMaterials,
-                           const std::filesystem::path&   texturesFolder,
-                           const RTGL1::TextureManager&   textureManager )
+    explicit GltfTextures( const std::set< std::string >&     sceneMaterials,
+                           const std::filesystem::path&       texturesFolder,
+                           const RTGL1::TextureManager&       textureManager,
+                           const rgl::string_map< uint64_t >& previousHashes )
     {
         RTGL1::debug::Info( "Exporting textures..." );
 
@@ -698,13 +931,21 @@ struct GltfTextures
             static_assert( RTGL1::TEXTURE_NORMAL_INDEX == 2 );
             static_assert( RTGL1::TEXTURE_EMISSIVE_INDEX == 3 );
             auto [ albedo, orm, normal, emissive ] = textureManager.ExportMaterialTextures(
-                materialName.c_str(), texturesFolder, false );
+                materialName.c_str(), texturesFolder, false, &previousHashes );
 
             auto tryMakeCgltfTexture =
                 [ this, &findSampler, &materialName ](
                     RTGL1::TextureManager::ExportResult&& r ) -> cgltf_texture* {
                 if( !r.relativePath.empty() )
                 {
+                    if( r.contentHash != 0 )
+                    {
+                        exported.push_back( RTGL1::ExportedTexture{
+                            .file = std::filesystem::path( r.relativePath ).generic_string(),
+                            .hash = r.contentHash,
+                        } );
+                    }
+
                     std::string&   str = strings.increment_and_get();
                     cgltf_image&   img = images.increment_and_get();
                     cgltf_texture& txd = textures.increment_and_get();
@@ -755,6 +996,9 @@ struct GltfTextures
     auto Images() { return images.get_counted_subspan(); }
     auto Textures() { return textures.get_counted_subspan(); }
 
+    // for the export manifest
+    std::vector< RTGL1::ExportedTexture > exported;
+
 private:
     std::vector< std::string >   allocStrings;
     std::vector< cgltf_sampler > allocSamplers;
@@ -1087,36 +1331,46 @@ private:
 };
 
 
-void MakeLightsForPrimitive( const RgMeshInfo&                     mesh,
-                             const RgMeshPrimitiveInfo&            prim,
-                             const RgEditorAttachedLightInfo&      lightInfo,
-                             float                                 oneGameUnitInMeters,
-                             std::vector< RTGL1::PositionNormal >& initial,
-                             std::vector< RgSpotLightUploadInfo >& result )
+// Column lengths of the transform. Light clusters are made in the local space scaled by them,
+// so the thresholds are the same as in the world space, if there's no shear
+std::optional< RgFloat3D > GetTransformScale( const RgTransform& tr )
 {
-    assert( initial.empty() );
-    assert( result.empty() );
+    RgFloat3D scale = {};
+    for( int j = 0; j < 3; j++ )
+    {
+        float column[] = { tr.matrix[ 0 ][ j ], tr.matrix[ 1 ][ j ], tr.matrix[ 2 ][ j ] };
 
-    constexpr auto toFloat3 = []( const float( &ptr )[ 3 ] ) {
-        return RgFloat3D{ RG_ACCESS_VEC3( ptr ) };
-    };
-    using RTGL1::Utils::ApplyTransform;
+        scale.data[ j ] = RTGL1::Utils::Length( column );
+        if( !( scale.data[ j ] > 0.0f ) )
+        {
+            return std::nullopt;
+        }
+    }
+    return scale;
+}
+
+// Triangles that are connected by edges are merged into one light
+std::vector< RTGL1::PositionNormal > MakeLightClusters( const RgMeshInfo&          mesh,
+                                                        const RgMeshPrimitiveInfo& prim,
+                                                        const RgFloat3D&           scale )
+{
+    using PositionNormal = RTGL1::PositionNormal;
 
     assert( prim.indexCount % 3 == 0 );
     if( prim.indexCount / 3 > 1024 )
     {
         RTGL1::debug::Warning(
             "The amount of triangles on a primitive (ID {}-{}, material name: {}) "
-            "with attached light is too high ()",
-            prim.indexCount / 3,
+            "with attached light is too high ({})",
             mesh.uniqueObjectID,
             prim.primitiveIndexInMesh,
-            RTGL1::Utils::SafeCstr( prim.pTextureName ) );
+            RTGL1::Utils::SafeCstr( prim.pTextureName ),
+            prim.indexCount / 3 );
     }
 
-#if POLYLIGHT_AS_SPHERE
-    using PositionNormal = RTGL1::PositionNormal;
+    std::vector< PositionNormal > clusters;
 
+#if POLYLIGHT_AS_SPHERE
     auto merge = []( const std::optional< PositionNormal >& a,
                      const std::optional< PositionNormal >& b ) -> std::optional< PositionNormal > {
         if( a && b )
@@ -1137,84 +1391,154 @@ void MakeLightsForPrimitive( const RgMeshInfo&                     mesh,
         return std::nullopt;
     };
 
-    struct Tri
-    {
-        RgFloat3D v[ 3 ];
-    };
-    auto haveCommonEdge = []( const Tri& a, const Tri& b ) {
-        auto isSameEdge = []( const RgFloat3D& v0,
-                              const RgFloat3D& v1,
-                              const RgFloat3D& u0,
-                              const RgFloat3D& u1 ) {
-            return ( RTGL1::Utils::AreAlmostSame( v0, u0 ) &&
-                     RTGL1::Utils::AreAlmostSame( v1, u1 ) ) ||
-                   ( RTGL1::Utils::AreAlmostSame( v0, u1 ) &&
-                     RTGL1::Utils::AreAlmostSame( v1, u0 ) );
-        };
-        constexpr int edges[][ 2 ] = {
-            { 0, 1 },
-            { 1, 2 },
-            { 2, 0 },
+    auto toScaled = [ &scale ]( const float( &p )[ 3 ] ) {
+        return RgFloat3D{
+            p[ 0 ] * scale.data[ 0 ],
+            p[ 1 ] * scale.data[ 1 ],
+            p[ 2 ] * scale.data[ 2 ],
         };
-        for( const auto& [ av0, av1 ] : edges )
+    };
+
+    // vertices with almost the same position are welded, so split vertices share edges
+    rgl::unordered_map< uint64_t, uint32_t > weldedIds;
+    auto getWeldedId = [ &weldedIds ]( const RgFloat3D& p ) {
+        constexpr float weldThreshold = 0.001f;
+
+        uint64_t key = 0;
+        for( float c : p.data )
         {
-            for( const auto& [ bv0, bv1 ] : edges )
-            {
-                if( isSameEdge( a.v[ av0 ], a.v[ av1 ], b.v[ bv0 ], b.v[ bv1 ] ) )
-                {
-                    return true;
-                }
-            }
+            RTGL1::Utils::HashCombine( key, std::llround( c / weldThreshold ) );
         }
-        return false;
+        auto [ iter, isNew ] = weldedIds.emplace( key, uint32_t( weldedIds.size() ) );
+        return iter->second;
     };
-    std::optional< Tri >            prev;
-    std::optional< PositionNormal > accum;
 
-    auto flushAccum = [ &initial, &accum ]() {
-        if( accum )
+    // union-find over triangles
+    const uint32_t          triCount = prim.indexCount / 3;
+    std::vector< uint32_t > parent( triCount );
+    for( uint32_t tri = 0; tri < triCount; tri++ )
+    {
+        parent[ tri ] = tri;
+    }
+    auto findRoot = [ &parent ]( uint32_t tri ) {
+        while( parent[ tri ] != tri )
         {
-            initial.push_back( *accum );
-            accum = std::nullopt;
+            parent[ tri ] = parent[ parent[ tri ] ];
+            tri           = parent[ tri ];
         }
+        return tri;
     };
 
-    for( uint32_t tri = 0; tri < prim.indexCount / 3; tri++ )
+    // edge (as a pair of welded ids) to the first triangle that has it
+    rgl::unordered_map< uint64_t, uint32_t > edgeToTri;
+
+    std::vector< std::optional< PositionNormal > > triLights( triCount );
+
+    for( uint32_t tri = 0; tri < triCount; tri++ )
     {
-        Tri local = {
-            toFloat3( prim.pVertices[ prim.pIndices[ tri * 3 + 0 ] ].position ),
-            toFloat3( prim.pVertices[ prim.pIndices[ tri * 3 + 1 ] ].position ),
-            toFloat3( prim.pVertices[ prim.pIndices[ tri * 3 + 2 ] ].position ),
+        RgFloat3D scaled[] = {
+            toScaled( prim.pVertices[ prim.pIndices[ tri * 3 + 0 ] ].position ),
+            toScaled( prim.pVertices[ prim.pIndices[ tri * 3 + 1 ] ].position ),
+            toScaled( prim.pVertices[ prim.pIndices[ tri * 3 + 2 ] ].position ),
         };
 
-        Tri global = {
-            ApplyTransform( mesh.transform, local.v[ 0 ] ),
-            ApplyTransform( mesh.transform, local.v[ 1 ] ),
-            ApplyTransform( mesh.transform, local.v[ 2 ] ),
+        auto n = TryGetNormal( scaled );
+        if( !n )
+        {
+            continue;
+        }
+        triLights[ tri ] = PositionNormal{
+            .position = GetCenter( scaled ),
+            .normal   = *n,
         };
 
-        if( auto n = TryGetNormal( global.v ) )
+        uint32_t ids[] = {
+            getWeldedId( scaled[ 0 ] ),
+            getWeldedId( scaled[ 1 ] ),
+            getWeldedId( scaled[ 2 ] ),
+        };
+
+        for( int e = 0; e < 3; e++ )
         {
-            if( prev )
+            uint32_t a = ids[ e ];
+            uint32_t b = ids[ ( e + 1 ) % 3 ];
+            if( a == b )
             {
-                if( !haveCommonEdge( global, *prev ) )
-                {
-                    flushAccum();
-                }
+                continue;
             }
-            prev = global;
 
-            accum = merge( accum,
-                           PositionNormal{
-                               .position = GetCenter( global.v ),
-                               .normal   = *n,
-                           } );
+            uint64_t edge = ( uint64_t( std::min( a, b ) ) << 32 ) | std::max( a, b );
+
+            auto [ iter, isNew ] = edgeToTri.emplace( edge, tri );
+            if( !isNew )
+            {
+                parent[ findRoot( tri ) ] = findRoot( iter->second );
+            }
+        }
+    }
+
+    // clusters are ordered by their first triangle
+    rgl::unordered_map< uint32_t, uint32_t >       rootToCluster;
+    std::vector< std::optional< PositionNormal > > accum;
+
+    for( uint32_t tri = 0; tri < triCount; tri++ )
+    {
+        if( !triLights[ tri ] )
+        {
+            continue;
+        }
+
+        auto [ iter, isNew ] = rootToCluster.emplace( findRoot( tri ), uint32_t( accum.size() ) );
+        if( isNew )
+        {
+            accum.emplace_back();
         }
+        accum[ iter->second ] = merge( accum[ iter->second ], triLights[ tri ] );
+    }
+
+    for( const auto& a : accum )
+    {
+        assert( a );
+        clusters.push_back( *a );
     }
-    flushAccum();
+#endif
+
+    return clusters;
+}
+
+void ResolveAttachedLights( const RgMeshInfo&                       mesh,
+                            std::span< const RTGL1::PositionNormal > clusters,
+                            const RgFloat3D&                        scale,
+                            const RgEditorAttachedLightInfo&        lightInfo,
+                            float                                   oneGameUnitInMeters,
+                            std::vector< RgSpotLightUploadInfo >&   result )
+{
+    auto toLocal = [ &scale ]( const RgFloat3D& scaled ) {
+        return RgFloat3D{
+            scaled.data[ 0 ] / scale.data[ 0 ],
+            scaled.data[ 1 ] / scale.data[ 1 ],
+            scaled.data[ 2 ] / scale.data[ 2 ],
+        };
+    };
+
+    auto applyToDirection = [ &mesh ]( const RgFloat3D& d ) {
+        RgFloat3D r = {};
+        for( int i = 0; i < 3; i++ )
+        {
+            r.data[ i ] = mesh.transform.matrix[ i ][ 0 ] * d.data[ 0 ] +
+                          mesh.transform.matrix[ i ][ 1 ] * d.data[ 1 ] +
+                          mesh.transform.matrix[ i ][ 2 ] * d.data[ 2 ];
+        }
+        return r;
+    };
 
-    for( const auto& [ position, normal ] : initial )
+    for( const auto& [ scaledPosition, scaledNormal ] : clusters )
     {
+        // transform without scale is a rotation, so it can be applied to normals
+        RgFloat3D position =
+            RTGL1::Utils::ApplyTransform( mesh.transform, toLocal( scaledPosition ) );
+        RgFloat3D normal = RTGL1::Utils::Normalize( applyToDirection( toLocal( scaledNormal ) ) );
+
         float offset = 0.1f / oneGameUnitInMeters;
 
         result.emplace_back( RgSpotLightUploadInfo{
@@ -1230,22 +1554,77 @@ void MakeLightsForPrimitive( const RgMeshInfo&                     mesh,
             .angleInner   = RTGL1::Utils::DegToRad( 75 ),
         } );
     }
-#endif
 }
 
 
-auto MakeLightsForPrimitive( const RgMeshInfo&                     mesh,
-                             const RgMeshPrimitiveInfo&            prim,
-                             const RgEditorAttachedLightInfo&      lightInfo,
-                             float                                 oneGameUnitInMeters )
+auto MakeLightsForPrimitive( const RgMeshInfo&                mesh,
+                             const RgMeshPrimitiveInfo&       prim,
+                             const RgEditorAttachedLightInfo& lightInfo,
+                             float                            oneGameUnitInMeters )
 {
-    std::vector< RTGL1::PositionNormal > initial;
     std::vector< RgSpotLightUploadInfo > resolved;
-    MakeLightsForPrimitive( mesh, prim, lightInfo, oneGameUnitInMeters, initial, resolved );
+
+    if( auto scale = GetTransformScale( mesh.transform ) )
+    {
+        ResolveAttachedLights( mesh,
+                               MakeLightClusters( mesh, prim, *scale ),
+                               *scale,
+                               lightInfo,
+                               oneGameUnitInMeters,
+                               resolved );
+    }
 
     return resolved;
 }
 
+uint64_t HashAttachedLightsKey( const RgMeshInfo&          mesh,
+                                const RgMeshPrimitiveInfo& prim,
+                                const RgFloat3D&           scale )
+{
+    auto asBytes = []( const void* p, size_t size ) {
+        return std::string_view( static_cast< const char* >( p ), size );
+    };
+
+    uint64_t h = 0;
+    RTGL1::Utils::HashCombine( h, std::string_view( RTGL1::Utils::SafeCstr( mesh.pMeshName ) ) );
+    RTGL1::Utils::HashCombine( h, prim.primitiveIndexInMesh );
+    RTGL1::Utils::HashCombine( h,
+                               std::string_view( RTGL1::Utils::SafeCstr( prim.pTextureName ) ) );
+    RTGL1::Utils::HashCombine(
+        h, asBytes( prim.pVertices, prim.vertexCount * sizeof( RgPrimitiveVertex ) ) );
+    RTGL1::Utils::HashCombine( h, asBytes( prim.pIndices, prim.indexCount * sizeof( uint32_t ) ) );
+    for( float s : scale.data )
+    {
+        // clusters depend on scale, as thresholds are absolute
+        RTGL1::Utils::HashCombine( h, std::lround( s * 1000.0f ) );
+    }
+    return h;
+}
+
+
+// Manifest of the last export; its primitives are dropped, if .bin was changed since then
+std::optional< RTGL1::ExportManifest > ReadPreviousExport( const std::filesystem::path& gltfPath )
+{
+    auto manifest = RTGL1::json_parser::ReadFileAs< RTGL1::ExportManifest >(
+        GetExportManifestPath( gltfPath ) );
+    if( !manifest )
+    {
+        return std::nullopt;
+    }
+
+    // the size check is cheap, but edits can keep the size, so compare the contents too
+    std::error_code ec;
+    if( IsGlb( gltfPath ) || !std::filesystem::exists( gltfPath ) ||
+        std::filesystem::file_size( GetGltfBinPath( gltfPath ), ec ) != manifest->binSize || ec ||
+        HashFileContents( GetGltfBinPath( gltfPath ) ) != manifest->binHash )
+    {
+        manifest->binSize = 0;
+        manifest->binHash = 0;
+        manifest->primitives.clear();
+    }
+
+    return manifest;
+}
 
 bool PrepareFolder( const std::filesystem::path& gltfPath )
 {
@@ -1348,11 +1727,29 @@ void RTGL1::GltfExporter::AddPrimitive( const RgMeshInfo&          mesh,
         return;
     }
 
+    std::shared_ptr< DeepCopyOfPrimitive > copy;
+    {
+        auto& sameHash = uniquePrimitives[ DeepCopyOfPrimitive::HashPayload( primitive ) ];
+
+        auto found = std::ranges::find_if(
+            sameHash, [ &primitive ]( const auto& p ) { return p->IsSamePayload( primitive ); } );
+
+        if( found != sameHash.end() )
+        {
+            copy = *found;
+        }
+        else
+        {
+            copy = std::make_shared< DeepCopyOfPrimitive >( primitive );
+            sameHash.push_back( copy );
+        }
+    }
+
     scene[ GltfMeshNode{
                mesh.pMeshName,
                mesh.transform,
            } ]
-        .emplace_back( std::make_shared< DeepCopyOfPrimitive >( primitive ) );
+        .push_back( std::move( copy ) );
 
     if( !Utils::IsCstrEmpty( primitive.pTextureName ) )
     {
@@ -1372,24 +1769,85 @@ void RTGL1::GltfExporter::AddPrimitiveLights( const RgMeshInfo&          mesh,
     }
 }
 
-void RTGL1::GltfExporter::MakeLightsForPrimitiveDynamic(
-    const RgMeshInfo&                     mesh,
-    const RgMeshPrimitiveInfo&            primitive,
-    float                                 oneGameUnitInMeters,
-    std::vector< PositionNormal >&        tempStorage,
-    std::vector< RgSpotLightUploadInfo >& resultStorage )
+std::span< RgSpotLightUploadInfo > RTGL1::AttachedLightsCache::MakeLights(
+    const RgMeshInfo& mesh, const RgMeshPrimitiveInfo& primitive, float oneGameUnitInMeters )
 {
-    assert( tempStorage.empty() );
-    assert( resultStorage.empty() );
+    result.clear();
 
-    if( primitive.pEditorInfo && primitive.pEditorInfo->attachedLightExists )
+    if( !primitive.pEditorInfo || !primitive.pEditorInfo->attachedLightExists )
+    {
+        return {};
+    }
+
+    auto scale = GetTransformScale( mesh.transform );
+    if( !scale )
+    {
+        return {};
+    }
+
+    auto [ iter, isNew ] = entries.try_emplace( HashAttachedLightsKey( mesh, primitive, *scale ) );
+    Entry& entry         = iter->second;
+
+    if( isNew )
+    {
+        entry.clusters = MakeLightClusters( mesh, primitive, *scale );
+
+        uint64_t hashBase = 0;
+
+        Utils::HashCombine( hashBase,
+                            std::string_view( Utils::SafeCstr( primitive.pTextureName ) ) );
+        Utils::HashCombine( hashBase, std::string_view( Utils::SafeCstr( mesh.pMeshName ) ) );
+        Utils::HashCombine( hashBase, primitive.primitiveIndexInMesh );
+
+        for( uint64_t counter = 0; counter < entry.clusters.size(); counter++ )
+        {
+            uint64_t h = hashBase;
+            Utils::HashCombine( h, counter );
+
+            // TODO: change ID; hope that there's no collision
+            uint64_t h32 = h % UINT32_MAX;
+
+            entry.uniqueIDs.push_back( h32 << 16ull );
+        }
+    }
+    entry.lastUsedFrame = frameCounter;
+
+    ResolveAttachedLights( mesh,
+                           entry.clusters,
+                           *scale,
+                           primitive.pEditorInfo->attachedLight,
+                           oneGameUnitInMeters,
+                           result );
+
+    assert( result.size() == entry.uniqueIDs.size() );
+    for( size_t i = 0; i < result.size(); i++ )
+    {
+        result[ i ].uniqueID     = entry.uniqueIDs[ i ];
+        result[ i ].isExportable = false;
+    }
+
+    return result;
+}
+
+void RTGL1::AttachedLightsCache::PrepareForFrame()
+{
+    constexpr uint32_t maxUnusedFrames = 120;
+
+    frameCounter++;
+
+    if( frameCounter % maxUnusedFrames == 0 )
     {
-        MakeLightsForPrimitive( mesh,
-                                primitive,
-                                primitive.pEditorInfo->attachedLight,
-                                oneGameUnitInMeters,
-                                tempStorage,
-                                resultStorage );
+        for( auto iter = entries.begin(); iter != entries.end(); )
+        {
+            if( frameCounter - iter->second.lastUsedFrame > maxUnusedFrames )
+            {
+                iter = entries.erase( iter );
+            }
+            else
+            {
+                ++iter;
+            }
+        }
     }
 }
 
@@ -1432,61 +1890,143 @@ void RTGL1::GltfExporter::ExportToFiles( const std::filesystem::path& gltfPath,
     debug::Info( "Export start..." );
 
 
-    // lock pointers
-    GltfBin      fbin( gltfPath );
-    GltfStorage  storage( scene, sceneLights.size() );
-    GltfTextures textureStorage(
-        sceneMaterials, GetOriginalTexturesFolder( gltfPath ), textureManager );
-    GltfLights lightStorage( sceneLights, storage.lightNodes );
+    std::optional< ExportManifest > previous = ReadPreviousExport( gltfPath );
 
+    rgl::string_map< uint64_t > previousTextures;
+    if( previous )
+    {
+        for( const ExportedTexture& t : previous->textures )
+        {
+            previousTextures[ t.file ] = t.hash;
+        }
+    }
 
-    // for each RgMesh
-    for( GltfRoot& root : storage.roots )
+    GltfStorage storage( scene, sceneLights.size() );
+
+    for( GltfPrimitiveData& prim : storage.uniquePrimitives )
+    {
+        // optimized and non-optimized data of the same primitive differ in .bin
+        const uint8_t optimized = optimizeMeshes ? 1 : 0;
+
+        prim.geometryHash =
+            Utils::HashFnv1a( &optimized, sizeof( optimized ), prim.source->HashGeometry() );
+    }
+
+    // primitives that are already in the .bin from the last export are only referenced
+    size_t appendTo = 0;
+    if( previous && !previous->primitives.empty() )
     {
-        // for each RgMeshPrimitive
-        for( size_t i = 0; i < root.source.size(); i++ )
+        rgl::unordered_map< uint64_t, const ExportedPrimitive* > previousPrimitives;
+        for( const ExportedPrimitive& p : previous->primitives )
         {
-            const DeepCopyOfPrimitive& rgprim = *root.source[ i ];
+            previousPrimitives[ p.hash ] = &p;
+        }
 
-            std::span viewsDst( root.bufferViews.begin() + ptrdiff_t( BufferViewsPerPrim * i ),
-                                BufferViewsPerPrim );
+        uint64_t reusedBytes = 0;
+        for( GltfPrimitiveData& prim : storage.uniquePrimitives )
+        {
+            auto f = previousPrimitives.find( prim.geometryHash );
+            if( f != previousPrimitives.end() &&
+                f->second->verticesOffset + prim.source->Vertices().size_bytes() <=
+                    previous->binSize &&
+                f->second->indicesOffset + prim.source->Indices().size_bytes() <=
+                    previous->binSize )
             {
-                std::ranges::move( MakeBufferViews( fbin, rgprim ), viewsDst.begin() );
+                prim.existing = f->second;
+                reusedBytes += prim.source->Vertices().size_bytes();
+                reusedBytes += prim.source->Indices().size_bytes();
             }
+        }
 
-            std::span accessorsDst( root.accessors.begin() + ptrdiff_t( AccessorsPerPrim * i ),
-                                    AccessorsPerPrim );
+        // if most of the old data is unreferenced, rewrite from scratch
+        if( reusedBytes * 2 < previous->binSize )
+        {
+            for( GltfPrimitiveData& prim : storage.uniquePrimitives )
             {
-                std::ranges::move(
-                    MakeAccessors( rgprim.Vertices().size(), rgprim.Indices().size(), viewsDst ),
-                    accessorsDst.begin() );
+                prim.existing = nullptr;
             }
+        }
+        else
+        {
+            appendTo = previous->binSize;
+        }
+    }
+
+    // lock pointers
+    GltfBin      fbin( gltfPath, appendTo, previous ? previous->binHash : 0 );
+    GltfTextures textureStorage( sceneMaterials,
+                                 GetOriginalTexturesFolder( gltfPath ),
+                                 textureManager,
+                                 previousTextures );
+    GltfLights   lightStorage( sceneLights, storage.lightNodes );
 
-            std::span vertAttrsDst( root.attributes.begin() + ptrdiff_t( AttributesPerPrim * i ),
-                                    AttributesPerPrim );
+
+    if( optimizeMeshes )
+    {
+        auto optimize = [ &storage ]( size_t begin, size_t end ) {
+            for( size_t i = begin; i < end; i++ )
             {
-                std::ranges::move( MakeVertexAttributes( accessorsDst ), vertAttrsDst.begin() );
+                // already optimized in the .bin
+                if( !storage.uniquePrimitives[ i ].existing )
+                {
+                    storage.uniquePrimitives[ i ].source->OptimizeMesh();
+                }
             }
+        };
 
-            root.materials[ i ] = MakeMaterial( rgprim, textureStorage );
+        if( threadPool )
+        {
+            threadPool->ParallelFor( storage.uniquePrimitives.size(), 16, optimize );
+        }
+        else
+        {
+            optimize( 0, storage.uniquePrimitives.size() );
+        }
+    }
+
+    // vertex data of identical primitives is written only once
+    for( GltfPrimitiveData& prim : storage.uniquePrimitives )
+    {
+        const DeepCopyOfPrimitive& rgprim = *prim.source;
+
+        std::ranges::move( MakeBufferViews( fbin, rgprim, prim.existing ),
+                           prim.bufferViews.begin() );
+        std::ranges::move(
+            MakeAccessors( rgprim.Vertices().size(), rgprim.Indices().size(), prim.bufferViews ),
+            prim.accessors.begin() );
+        std::ranges::move( MakeVertexAttributes( prim.accessors ), prim.attributes.begin() );
+
+        *prim.material = MakeMaterial( rgprim, textureStorage );
+    }
 
-            root.primitives[ i ] = cgltf_primitive{
+    // each unique list of primitives is a mesh that is instanced by nodes
+    for( GltfMesh& m : storage.meshes )
+    {
+        for( size_t i = 0; i < m.source.size(); i++ )
+        {
+            const GltfPrimitiveData& prim = storage.uniquePrimitives[ m.source[ i ] ];
+
+            m.primitives[ i ] = cgltf_primitive{
                 .type             = cgltf_primitive_type_triangles,
-                .indices          = GetIndicesAccessor( accessorsDst ),
-                .material         = &root.materials[ i ],
-                .attributes       = std::data( vertAttrsDst ),
-                .attributes_count = std::size( vertAttrsDst ),
+                .indices          = GetIndicesAccessor( prim.accessors ),
+                .material         = prim.material,
+                .attributes       = std::data( prim.attributes ),
+                .attributes_count = std::size( prim.attributes ),
                 .extras           = {},
             };
         }
 
-        *root.mesh = cgltf_mesh{
-            .name             = const_cast< char* >( root.name.c_str() ),
-            .primitives       = std::data( root.primitives ),
-            .primitives_count = std::size( root.primitives ),
+        *m.mesh = cgltf_mesh{
+            .name             = const_cast< char* >( m.name.c_str() ),
+            .primitives       = std::data( m.primitives ),
+            .primitives_count = std::size( m.primitives ),
             .extras           = {},
         };
+    }
 
+    // for each RgMesh
+    for( GltfRoot& root : storage.roots )
+    {
         *root.thisNode = cgltf_node{
             .name                    = const_cast< char* >( root.name.c_str() ),
             .parent                  = nullptr, /* later */
@@ -1571,11 +2111,54 @@ void RTGL1::GltfExporter::ExportToFiles( const std::filesystem::path& gltfPath,
         return;
     }
 
-    r = cgltf_write_file( &options, gltfPath.string().c_str(), &data );
-    if( r != cgltf_result_success )
+    if( IsGlb( gltfPath ) )
     {
-        debug::Warning( "cgltf_write_file fail" );
-        return;
+        // the container is written manually, so the BIN chunk goes straight from memory
+        auto json = std::string( cgltf_write( &options, nullptr, 0, &data ), '\0' );
+        json.resize( cgltf_write( &options, json.data(), json.size(), &data ) );
+
+        // without null-terminator
+        if( !json.empty() && json.back() == '\0' )
+        {
+            json.pop_back();
+        }
+
+        if( !WriteGlb( gltfPath, json, fbin.GlbChunk() ) )
+        {
+            debug::Warning( "{}: Failed to write GLB", gltfPath.string() );
+            return;
+        }
+    }
+    else
+    {
+        r = cgltf_write_file( &options, gltfPath.string().c_str(), &data );
+        if( r != cgltf_result_success )
+        {
+            debug::Warning( "cgltf_write_file fail" );
+            return;
+        }
+    }
+
+    {
+        ExportManifest manifest = {
+            .binSize  = IsGlb( gltfPath ) ? 0 : fbin.Get()->size,
+            .binHash  = IsGlb( gltfPath ) ? 0 : fbin.Hash(),
+            .textures = std::move( textureStorage.exported ),
+        };
+
+        if( !IsGlb( gltfPath ) )
+        {
+            for( const GltfPrimitiveData& prim : storage.uniquePrimitives )
+            {
+                manifest.primitives.push_back( ExportedPrimitive{
+                    .hash           = prim.geometryHash,
+                    .verticesOffset = prim.bufferViews[ BUFFER_VIEW_VERTICES ].offset,
+                    .indicesOffset  = prim.bufferViews[ BUFFER_VIEW_INDICES ].offset,
+                } );
+            }
+        }
+
+        json_parser::WriteFile( GetExportManifestPath( gltfPath ), manifest );
     }
 
     debug::Info( "Export successful: {}",
@@ -1595,8 +2178,8 @@ bool RTGL1::GltfMeshNode::operator<( const GltfMeshNode& other ) const
 uint64_t RTGL1::GltfMeshNode::Hash() const
 {
     uint64_t h = 0;
-    HashCombine( h, name );
-    HashCombine( h, transform );
+    Utils::HashCombine( h, name );
+    Utils::HashCombine( h, transform );
 
     return h;
 }
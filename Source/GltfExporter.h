@@ -27,9 +27,11 @@
 #include <filesystem>
 #include <functional>
 #include <set>
+#include <span>
 
 namespace RTGL1
 {
+class ThreadPool;
 struct DeepCopyOfPrimitive;
 
 struct GltfMeshNode
@@ -61,10 +63,17 @@ namespace RTGL1
 using MeshesToTheirPrimitives =
     rgl::unordered_map< GltfMeshNode, std::vector< std::shared_ptr< DeepCopyOfPrimitive > > >;
 
+// Payload hash to primitives with that hash, so identical primitives are stored only once
+using PrimitivesByPayload =
+    rgl::unordered_map< uint64_t, std::vector< std::shared_ptr< DeepCopyOfPrimitive > > >;
+
 class GltfExporter
 {
 public:
-    explicit GltfExporter( const RgTransform& worldTransform, float oneGameUnitInMeters );
+    GltfExporter( const RgTransform&            worldTransform,
+                  float                         oneGameUnitInMeters,
+                  bool                          optimizeMeshes,
+                  std::shared_ptr< ThreadPool > threadPool );
     ~GltfExporter() = default;
 
     GltfExporter( const GltfExporter& other )                = delete;
@@ -79,20 +88,42 @@ public:
     void ExportToFiles( const std::filesystem::path& gltfPath,
                         const TextureManager&        textureManager );
 
-    // TODO: allocators, to not pass references
-    static void MakeLightsForPrimitiveDynamic(
-        const RgMeshInfo&                     mesh,
-        const RgMeshPrimitiveInfo&            primitive,
-        float                                 oneGameUnitInMeters,
-        std::vector< PositionNormal >&        tempStorage,
-        std::vector< RgSpotLightUploadInfo >& resultStorage );
-
 private:
     MeshesToTheirPrimitives     scene;
+    PrimitivesByPayload         uniquePrimitives;
     std::set< std::string >     sceneMaterials;
     std::vector< GenericLight > sceneLights;
 
-    RgTransform worldTransform;
-    float       oneGameUnitInMeters;
+    RgTransform                   worldTransform;
+    float                         oneGameUnitInMeters;
+    bool                          optimizeMeshes;
+    std::shared_ptr< ThreadPool > threadPool;
+};
+
+// Lights of primitives with RgEditorInfo::attachedLightEvenOnDynamic are generated once per
+// primitive geometry, and then only transformed by RgMeshInfo::transform
+class AttachedLightsCache
+{
+public:
+    // Lights with uniqueID set, valid until the next call
+    std::span< RgSpotLightUploadInfo > MakeLights( const RgMeshInfo&          mesh,
+                                                   const RgMeshPrimitiveInfo& primitive,
+                                                   float                      oneGameUnitInMeters );
+
+    // Forget the primitives that were not drawn for some time
+    void PrepareForFrame();
+
+private:
+    struct Entry
+    {
+        // in the local space, scaled by the transform's scale
+        std::vector< PositionNormal > clusters;
+        std::vector< uint64_t >       uniqueIDs;
+        uint32_t                      lastUsedFrame{ 0 };
+    };
+
+    rgl::unordered_map< uint64_t, Entry > entries;
+    std::vector< RgSpotLightUploadInfo >  result;
+    uint32_t                              frameCounter{ 0 };
 };
 }
@@ -22,7 +22,10 @@
 
 #include "Const.h"
 #include "Matrix.h"
+#include "MeshOptimization.h"
+#include "MeshSimplification.h"
 #include "Scene.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 
 #include "Generated/ShaderCommonC.h"
@@ -152,20 +155,143 @@ namespace
         return cgltf_accessor_read_float( accessor, index, out, N );
     }
 
+    // Primitives are gathered on worker threads,
+    // so messages are collected and printed by the caller in the original order
+    struct GatherLog
+    {
+        template< typename... Args >
+        void Warning( std::string_view fmt, Args&&... args )
+        {
+            messages.push_back( std::vformat( fmt, std::make_format_args( args... ) ) );
+        }
+
+        void Flush()
+        {
+            for( const auto& m : messages )
+            {
+                debug::Warning( m );
+            }
+            messages.clear();
+        }
+
+        std::vector< std::string > messages;
+    };
+
+    // Pointer to the first element, if the accessor data can be read without conversions
+    const uint8_t* DirectAccessorData( const cgltf_accessor* accessor )
+    {
+        const cgltf_buffer_view* view = accessor->buffer_view;
+
+        // 'view->data' is set by compression extensions
+        if( accessor->is_sparse || !view || view->data || !view->buffer->data )
+        {
+            return nullptr;
+        }
+
+        return static_cast< const uint8_t* >( view->buffer->data ) + view->offset +
+               accessor->offset;
+    }
+
+    template< size_t N >
+    bool ReadFloats( const cgltf_accessor*          accessor,
+                     std::span< RgPrimitiveVertex > dst,
+                     float ( RgPrimitiveVertex::*member )[ N ] )
+    {
+        if( accessor->component_type == cgltf_component_type_r_32f && !accessor->normalized &&
+            cgltf_num_components( accessor->type ) == N )
+        {
+            if( const uint8_t* src = DirectAccessorData( accessor ) )
+            {
+                // strided copy of float2/3/4, compilers turn it into plain vector moves
+                for( size_t i = 0; i < dst.size(); i++ )
+                {
+                    memcpy( dst[ i ].*member, src + i * accessor->stride, sizeof( float ) * N );
+                }
+                return true;
+            }
+        }
+
+        cgltf_bool ok = true;
+        for( size_t i = 0; i < dst.size(); i++ )
+        {
+            ok &= cgltf_accessor_read_float_h( accessor, i, dst[ i ].*member );
+        }
+        return ok;
+    }
+
+    template< typename T >
+    void ConvertIndices( const uint8_t* src, size_t stride, std::span< uint32_t > dst )
+    {
+        if( stride == sizeof( T ) )
+        {
+            const T* typed = reinterpret_cast< const T* >( src );
+            for( size_t k = 0; k < dst.size(); k++ )
+            {
+                dst[ k ] = typed[ k ];
+            }
+        }
+        else
+        {
+            for( size_t k = 0; k < dst.size(); k++ )
+            {
+                T v;
+                memcpy( &v, src + k * stride, sizeof( T ) );
+                dst[ k ] = v;
+            }
+        }
+    }
+
+    bool ReadIndices( const cgltf_accessor* accessor, std::span< uint32_t > dst )
+    {
+        if( const uint8_t* src = DirectAccessorData( accessor ) )
+        {
+            switch( accessor->component_type )
+            {
+                case cgltf_component_type_r_8u:
+                    ConvertIndices< uint8_t >( src, accessor->stride, dst );
+                    return true;
+                case cgltf_component_type_r_16u:
+                    ConvertIndices< uint16_t >( src, accessor->stride, dst );
+                    return true;
+                case cgltf_component_type_r_32u:
+                    if( accessor->stride == sizeof( uint32_t ) )
+                    {
+                        memcpy( dst.data(), src, dst.size_bytes() );
+                    }
+                    else
+                    {
+                        ConvertIndices< uint32_t >( src, accessor->stride, dst );
+                    }
+                    return true;
+                default: break;
+            }
+        }
+
+        for( size_t k = 0; k < dst.size(); k++ )
+        {
+            if( !cgltf_accessor_read_uint( accessor, k, &dst[ k ], 1 ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     std::vector< RgPrimitiveVertex > GatherVertices( const cgltf_primitive& prim,
                                                      const cgltf_node&      node,
-                                                     std::string_view       gltfPath )
+                                                     std::string_view       gltfPath,
+                                                     GatherLog&             log )
     {
         std::span attrSpan( prim.attributes, prim.attributes_count );
 
-        auto debugprintAttr = [ &node, &gltfPath ]( const cgltf_attribute& attr,
-                                                    std::string_view       msg ) {
-            debug::Warning( "{}: Ignoring primitive of ...->{}->{}: Attribute {}: {}",
-                            gltfPath,
-                            NodeName( node.parent ),
-                            NodeName( node ),
-                            Utils::SafeCstr( attr.name ),
-                            msg );
+        auto debugprintAttr = [ &node, &gltfPath, &log ]( const cgltf_attribute& attr,
+                                                          std::string_view       msg ) {
+            log.Warning( "{}: Ignoring primitive of ...->{}->{}: Attribute {}: {}",
+                         gltfPath,
+                         NodeName( node.parent ),
+                         NodeName( node ),
+                         Utils::SafeCstr( attr.name ),
+                         msg );
         };
 
         // check if compatible and find common attribute count
@@ -265,26 +391,26 @@ namespace
 
             if( !position || !normal || !tangent || !texcoord )
             {
-                debug::Warning( "{}: Ignoring primitive of ...->{}->{}: Not all required "
-                                "attributes are present. "
-                                "POSITION - {}. "
-                                "NORMAL - {}. "
-                                "TANGENT - {}. "
-                                "TEXCOORD_0 - {}",
-                                gltfPath,
-                                NodeName( node.parent ),
-                                NodeName( node ),
-                                position,
-                                normal,
-                                tangent,
-                                texcoord );
+                log.Warning( "{}: Ignoring primitive of ...->{}->{}: Not all required "
+                             "attributes are present. "
+                             "POSITION - {}. "
+                             "NORMAL - {}. "
+                             "TANGENT - {}. "
+                             "TEXCOORD_0 - {}",
+                             gltfPath,
+                             NodeName( node.parent ),
+                             NodeName( node ),
+                             position,
+                             normal,
+                             tangent,
+                             texcoord );
                 return {};
             }
         }
 
         if( !vertexCount )
         {
-            debug::Warning(
+            log.Warning(
                 "{}: Ignoring ...->{}->{}: ", gltfPath, NodeName( node.parent ), NodeName( node ) );
             return {};
         }
@@ -300,37 +426,20 @@ namespace
             switch( attr.type )
             {
                 case cgltf_attribute_type_position:
-                    for( size_t i = 0; i < primVertices.size(); i++ )
-                    {
-                        ok &=
-                            cgltf_accessor_read_float_h( attr.data, i, primVertices[ i ].position );
-                    }
+                    ok = ReadFloats( attr.data, primVertices, &RgPrimitiveVertex::position );
                     break;
 
                 case cgltf_attribute_type_normal:
-                    for( size_t i = 0; i < primVertices.size(); i++ )
-                    {
-                        ok &= cgltf_accessor_read_float_h( attr.data, i, primVertices[ i ].normal );
-                    }
+                    ok = ReadFloats( attr.data, primVertices, &RgPrimitiveVertex::normal );
                     break;
 
                 case cgltf_attribute_type_tangent:
-                    for( size_t i = 0; i < primVertices.size(); i++ )
-                    {
-                        ok &=
-                            cgltf_accessor_read_float_h( attr.data, i, primVertices[ i ].tangent );
-                    }
+                    ok = ReadFloats( attr.data, primVertices, &RgPrimitiveVertex::tangent );
                     break;
 
-                case cgltf_attribute_type_texcoord: {
-                    int texcoordIndex = attr.index;
-                    for( size_t i = 0; i < primVertices.size(); i++ )
-                    {
-                        ok &=
-                            cgltf_accessor_read_float_h( attr.data, i, primVertices[ i ].texCoord );
-                    }
+                case cgltf_attribute_type_texcoord:
+                    ok = ReadFloats( attr.data, primVertices, &RgPrimitiveVertex::texCoord );
                     break;
-                }
 
                 case cgltf_attribute_type_color:
                     defaultColor = std::nullopt;
@@ -366,49 +475,41 @@ namespace
 
     std::vector< uint32_t > GatherIndices( const cgltf_primitive& prim,
                                            const cgltf_node&      node,
-                                           std::string_view       gltfPath )
+                                           std::string_view       gltfPath,
+                                           GatherLog&             log )
     {
         if( prim.indices->is_sparse )
         {
-            debug::Warning( "{}: Ignoring primitive of ...->{}->{}: Indices: Sparse accessors are "
-                            "not supported",
-                            gltfPath,
-                            NodeName( node.parent ),
-                            NodeName( node ) );
+            log.Warning( "{}: Ignoring primitive of ...->{}->{}: Indices: Sparse accessors are "
+                         "not supported",
+                         gltfPath,
+                         NodeName( node.parent ),
+                         NodeName( node ) );
             return {};
         }
 
         std::vector< uint32_t > primIndices( prim.indices->count );
 
-        for( size_t k = 0; k < prim.indices->count; k++ )
+        if( !ReadIndices( prim.indices, primIndices ) )
         {
-            uint32_t resolved;
-
-            if( !cgltf_accessor_read_uint( prim.indices, k, &resolved, 1 ) )
-            {
-                debug::Warning(
-                    "{}: Ignoring primitive of ...->{}->{}: Indices: cgltf_accessor_read_uint fail",
-                    gltfPath,
-                    NodeName( node.parent ),
-                    NodeName( node ) );
-                return {};
-            }
-
-            primIndices[ k ] = resolved;
+            log.Warning(
+                "{}: Ignoring primitive of ...->{}->{}: Indices: cgltf_accessor_read_uint fail",
+                gltfPath,
+                NodeName( node.parent ),
+                NodeName( node ) );
+            return {};
         }
 
         return primIndices;
     }
 
-    std::string MakePTextureName( const cgltf_material&              mat,
-                                  std::span< std::filesystem::path > fallbacks )
+    // Name of the original game texture, if the glTF was exported by RTGL1
+    std::string_view ExplicitTextureName( const cgltf_material& mat )
     {
         const cgltf_texture* t = mat.pbr_metallic_roughness.base_color_texture.texture;
 
         if( t && t->image && t->image->name )
         {
-            std::string name = t->image->name;
-
             if( t->image->uri )
             {
                 if( !std::string_view( t->image->uri )
@@ -425,7 +526,18 @@ namespace
                 }
             }
 
-            return name;
+            return t->image->name;
+        }
+
+        return {};
+    }
+
+    std::string MakePTextureName( std::string_view                   explicitName,
+                                  std::span< std::filesystem::path > fallbacks )
+    {
+        if( !explicitName.empty() )
+        {
+            return std::string( explicitName );
         }
 
         for( const auto& f : fallbacks )
@@ -439,21 +551,26 @@ namespace
         return "";
     }
 
-    struct UploadTexturesResult
+    template< typename T >
+    void HashBytes( uint64_t& seed, std::span< const T > data )
+    {
+        Utils::HashCombine( seed,
+                            std::string_view( reinterpret_cast< const char* >( data.data() ),
+                                              data.size_bytes() ) );
+    }
+
+    struct CompiledMaterial
     {
-        RgColor4DPacked32 color        = Utils::PackColor( 255, 255, 255, 255 );
-        float             emissiveMult = 0.0f;
-        std::string       pTextureName;
+        uint32_t          index           = SceneCache::NoMaterial;
+        RgColor4DPacked32 color           = Utils::PackColor( 255, 255, 255, 255 );
+        float             emissiveMult    = 0.0f;
         float             metallicFactor  = 0.0f;
         float             roughnessFactor = 1.0f;
     };
 
-    UploadTexturesResult UploadTextures( VkCommandBuffer              cmd,
-                                         uint32_t                     frameIndex,
-                                         const cgltf_material*        mat,
-                                         TextureManager&              textureManager,
-                                         const std::filesystem::path& gltfFolder,
-                                         std::string_view             gltfPath )
+    CompiledMaterial CompileMaterial( const cgltf_material* mat,
+                                      SceneCache::Writer&   writer,
+                                      std::string_view      gltfPath )
     {
         if( mat == nullptr )
         {
@@ -469,22 +586,15 @@ namespace
             return {};
         }
 
-        // clang-format off
-        std::filesystem::path fullPaths[] = {
-            std::filesystem::path(),
-            std::filesystem::path(),
-            std::filesystem::path(),
-            std::filesystem::path(),
-        };
-        SamplerManager::Handle samplers[] = {
-            SamplerManager::Handle( RG_SAMPLER_FILTER_AUTO, RG_SAMPLER_ADDRESS_MODE_REPEAT, RG_SAMPLER_ADDRESS_MODE_REPEAT ),
-            SamplerManager::Handle( RG_SAMPLER_FILTER_AUTO, RG_SAMPLER_ADDRESS_MODE_REPEAT, RG_SAMPLER_ADDRESS_MODE_REPEAT ),
-            SamplerManager::Handle( RG_SAMPLER_FILTER_AUTO, RG_SAMPLER_ADDRESS_MODE_REPEAT, RG_SAMPLER_ADDRESS_MODE_REPEAT ),
-            SamplerManager::Handle( RG_SAMPLER_FILTER_AUTO, RG_SAMPLER_ADDRESS_MODE_REPEAT, RG_SAMPLER_ADDRESS_MODE_REPEAT ),
+        SceneCache::Material dst = {
+            .pbrSwizzling = RG_TEXTURE_SWIZZLING_NULL_ROUGHNESS_METALLIC,
         };
-        static_assert( std::size( fullPaths ) == TEXTURES_PER_MATERIAL_COUNT );
-        static_assert( std::size( samplers ) == TEXTURES_PER_MATERIAL_COUNT );
-        // clang-format on
+        for( uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++ )
+        {
+            dst.filters[ i ]       = RG_SAMPLER_FILTER_AUTO;
+            dst.addressModesU[ i ] = RG_SAMPLER_ADDRESS_MODE_REPEAT;
+            dst.addressModesV[ i ] = RG_SAMPLER_ADDRESS_MODE_REPEAT;
+        }
 
 
         const std::pair< int, const cgltf_texture_view& > txds[] = {
@@ -507,7 +617,6 @@ namespace
         };
         static_assert( std::size( txds ) == TEXTURES_PER_MATERIAL_COUNT );
 
-        RgTextureSwizzling pbrSwizzling = RG_TEXTURE_SWIZZLING_NULL_ROUGHNESS_METALLIC;
         {
             cgltf_texture* texRM = mat->pbr_metallic_roughness.metallic_roughness_texture.texture;
             cgltf_texture* texO  = mat->occlusion_texture.texture;
@@ -518,7 +627,7 @@ namespace
                 {
                     if( texRM->image == texO->image )
                     {
-                        pbrSwizzling = RG_TEXTURE_SWIZZLING_OCCLUSION_ROUGHNESS_METALLIC;
+                        dst.pbrSwizzling = RG_TEXTURE_SWIZZLING_OCCLUSION_ROUGHNESS_METALLIC;
                     }
                     else
                     {
@@ -557,6 +666,8 @@ namespace
             return wrap == 33071 ? RG_SAMPLER_ADDRESS_MODE_CLAMP : RG_SAMPLER_ADDRESS_MODE_REPEAT;
         };
 
+        bool anyPath = false;
+
         for( const auto& [ index, txview ] : txds )
         {
             if( !txview.texture || !txview.texture->image )
@@ -586,26 +697,20 @@ namespace
                 continue;
             }
 
-            fullPaths[ index ] = gltfFolder / Utils::SafeCstr( txview.texture->image->uri );
+            dst.paths[ index ] = writer.AddString( txview.texture->image->uri );
+            anyPath            = true;
 
             if( txview.texture->sampler )
             {
-                samplers[ index ] = SamplerManager::Handle(
-                    makeRgSamplerFilter( txview.texture->sampler->mag_filter ),
-                    makeRgSamplerAddrMode( txview.texture->sampler->wrap_s ),
-                    makeRgSamplerAddrMode( txview.texture->sampler->wrap_t ) );
+                dst.filters[ index ] = makeRgSamplerFilter( txview.texture->sampler->mag_filter );
+                dst.addressModesU[ index ] =
+                    makeRgSamplerAddrMode( txview.texture->sampler->wrap_s );
+                dst.addressModesV[ index ] =
+                    makeRgSamplerAddrMode( txview.texture->sampler->wrap_t );
             }
         }
 
-
-        std::string materialName = MakePTextureName( *mat, fullPaths );
-
-        // if fullPaths are empty
-        if( !materialName.empty() )
-        {
-            textureManager.TryCreateImportedMaterial(
-                cmd, frameIndex, materialName, fullPaths, samplers, pbrSwizzling );
-        }
+        std::string_view explicitName = ExplicitTextureName( *mat );
 
         if( auto t = mat->pbr_metallic_roughness.metallic_roughness_texture.texture )
         {
@@ -625,116 +730,176 @@ namespace
             }
         }
 
-        return UploadTexturesResult{
+        uint32_t index = SceneCache::NoMaterial;
+
+        // if paths are empty, the explicit name is not used, as the material is not created
+        if( anyPath )
+        {
+            dst.name = writer.AddString( explicitName );
+            index    = writer.AddMaterial( dst );
+        }
+
+        return CompiledMaterial{
+            .index = index,
             .color = Utils::PackColorFromFloat( mat->pbr_metallic_roughness.base_color_factor ),
             .emissiveMult    = Utils::Luminance( mat->emissive_factor ),
-            .pTextureName    = std::move( materialName ),
             .metallicFactor  = mat->pbr_metallic_roughness.metallic_factor,
             .roughnessFactor = mat->pbr_metallic_roughness.roughness_factor,
         };
     }
 
+    // Null if failed
+    cgltf_data* ParseGltf( const std::string& gltfPath, const RgTransform& worldTransform )
+    {
+        cgltf_result  r{ cgltf_result_success };
+        cgltf_options options{};
+        cgltf_data*   parsedData{ nullptr };
+
+        struct FreeIfFail
+        {
+            cgltf_data** parsedData;
+            bool         success;
+            ~FreeIfFail()
+            {
+                if( !success )
+                {
+                    cgltf_free( *parsedData );
+                }
+            }
+        } tmp = { &parsedData, false };
+
+        r = cgltf_parse_file( &options, gltfPath.c_str(), &parsedData );
+        if( r == cgltf_result_file_not_found )
+        {
+            debug::Warning( "{}: Can't find a file, no static scene will be present", gltfPath );
+            return nullptr;
+        }
+        else if( r != cgltf_result_success )
+        {
+            debug::Warning( "{}: cgltf_parse_file. Error code: {} {}",
+                            gltfPath,
+                            int( r ),
+                            CgltfErrorName( r ) );
+            return nullptr;
+        }
+
+        r = cgltf_load_buffers( &options, parsedData, gltfPath.c_str() );
+        if( r != cgltf_result_success )
+        {
+            debug::Warning( "{}: cgltf_load_buffers. Error code: {} {}. URI-s for .bin buffers "
+                            "might be incorrect",
+                            gltfPath,
+                            int( r ),
+                            CgltfErrorName( r ) );
+            return nullptr;
+        }
+
+        r = cgltf_validate( parsedData );
+        if( r != cgltf_result_success )
+        {
+            debug::Warning(
+                "{}: cgltf_validate. Error code: {} {}", gltfPath, int( r ), CgltfErrorName( r ) );
+            return nullptr;
+        }
+
+        if( parsedData->scenes_count == 0 )
+        {
+            debug::Warning( "{}: {}", gltfPath, "No scenes found" );
+            return nullptr;
+        }
+
+        if( parsedData->scene == nullptr )
+        {
+            debug::Warning( "{}: {}", gltfPath, "No default scene, using first" );
+            parsedData->scene = &parsedData->scenes[ 0 ];
+        }
+
+        cgltf_node* mainNode = FindMainRootNode( parsedData );
+
+        if( !mainNode )
+        {
+            debug::Warning(
+                "{}: {}", gltfPath, "No \"" RTGL1_MAIN_ROOT_NODE "\" node in the default scene" );
+            return nullptr;
+        }
+
+        ApplyInverseWorldTransform( *mainNode, worldTransform );
+
+        tmp.success = true;
+        return parsedData;
+    }
+
 }
 }
 
-RTGL1::GltfImporter::GltfImporter( const std::filesystem::path& _gltfPath,
-                                   const RgTransform&           _worldTransform,
-                                   float                        _oneGameUnitInMeters )
-    : data( nullptr )
+RTGL1::GltfImporter::GltfImporter( const std::filesystem::path&  _gltfPath,
+                                   const RgTransform&            _worldTransform,
+                                   float                         _oneGameUnitInMeters,
+                                   bool                          _optimizeMeshes,
+                                   std::shared_ptr< ThreadPool > _threadPool )
+    : cache( std::nullopt )
     , gltfPath( _gltfPath.string() )
     , gltfFolder( _gltfPath.parent_path() )
     , oneGameUnitInMeters( _oneGameUnitInMeters )
+    , optimizeMeshes( _optimizeMeshes )
+    , threadPool( std::move( _threadPool ) )
 {
-    cgltf_result  r{ cgltf_result_success };
-    cgltf_options options{};
-    cgltf_data*   parsedData{ nullptr };
-
-    struct FreeIfFail
-    {
-        cgltf_data** data;
-        cgltf_data** parsedData;
-        ~FreeIfFail()
-        {
-            if( *data == nullptr )
-            {
-                cgltf_free( *parsedData );
-            }
-        }
-    } tmp = { &data, &parsedData };
-
-    r = cgltf_parse_file( &options, gltfPath.c_str(), &parsedData );
-    if( r == cgltf_result_file_not_found )
+    auto key =
+        SceneCache::MakeKey( _gltfPath, _worldTransform, _oneGameUnitInMeters, _optimizeMeshes );
+    if( !key )
     {
         debug::Warning( "{}: Can't find a file, no static scene will be present", gltfPath );
         return;
     }
-    else if( r != cgltf_result_success )
-    {
-        debug::Warning(
-            "{}: cgltf_parse_file. Error code: {} {}", gltfPath, int( r ), CgltfErrorName( r ) );
-        return;
-    }
 
-    r = cgltf_load_buffers( &options, parsedData, gltfPath.c_str() );
-    if( r != cgltf_result_success )
+    auto cachePath = std::filesystem::path( _gltfPath ).replace_extension( ".rtglscene" );
+
+    cache = SceneCache::Load( cachePath, gltfFolder, *key );
+    if( cache )
     {
-        debug::Warning(
-            "{}: cgltf_load_buffers. Error code: {} {}. URI-s for .bin buffers might be incorrect",
-            gltfPath,
-            int( r ),
-            CgltfErrorName( r ) );
+        debug::Verbose( "{}: Using compiled scene {}", gltfPath, cachePath.string() );
         return;
     }
 
-    r = cgltf_validate( parsedData );
-    if( r != cgltf_result_success )
+    cgltf_data* data = ParseGltf( gltfPath, _worldTransform );
+    if( !data )
     {
-        debug::Warning(
-            "{}: cgltf_validate. Error code: {} {}", gltfPath, int( r ), CgltfErrorName( r ) );
         return;
     }
 
-    if( parsedData->scenes_count == 0 )
+    bool canBeSaved = false;
+    auto compiled   = Compile( data, *key, canBeSaved );
+    cgltf_free( data );
+
+    if( compiled.empty() )
     {
-        debug::Warning( "{}: {}", gltfPath, "No scenes found" );
         return;
     }
 
-    if( parsedData->scene == nullptr )
+    if( !canBeSaved )
     {
-        debug::Warning( "{}: {}", gltfPath, "No default scene, using first" );
-        parsedData->scene = &parsedData->scenes[ 0 ];
+        debug::Warning( "{}: Can't read .bin buffers to track changes, scene is not cached",
+                        gltfPath );
     }
-
-    cgltf_node* mainNode = FindMainRootNode( parsedData );
-
-    if( !mainNode )
+    else if( !SceneCache::Save( cachePath, compiled ) )
     {
-        debug::Warning(
-            "{}: {}", gltfPath, "No \"" RTGL1_MAIN_ROOT_NODE "\" node in the default scene" );
-        return;
+        debug::Warning( "{}: Failed to write compiled scene", cachePath.string() );
     }
 
-    ApplyInverseWorldTransform( *mainNode, _worldTransform );
-
-    data = parsedData;
+    cache = SceneCache::FromBytes( std::move( compiled ), *key );
+    assert( cache );
 }
 
-RTGL1::GltfImporter::~GltfImporter()
-{
-    cgltf_free( data );
-}
+RTGL1::GltfImporter::~GltfImporter() = default;
 
-void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
-                                         uint32_t                  frameIndex,
-                                         Scene&                    scene,
-                                         TextureManager&           textureManager,
-                                         const TextureMetaManager& textureMeta ) const
+std::vector< uint8_t > RTGL1::GltfImporter::Compile( cgltf_data* data,
+                                                     uint64_t    key,
+                                                     bool&       canBeSaved ) const
 {
     cgltf_node* mainNode = FindMainRootNode( data );
     if( !mainNode )
     {
-        return;
+        return {};
     }
 
     if( mainNode->mesh || mainNode->light )
@@ -744,7 +909,41 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                         mainNode->name );
     }
 
-    // meshes
+    SceneCache::Writer writer;
+
+    // if a dependency is not tracked, a stale cache could be loaded, so don't save it at all
+    canBeSaved = true;
+
+    for( const cgltf_buffer& buffer : std::span( data->buffers, data->buffers_count ) )
+    {
+        // embedded buffers and the BIN chunk of .glb are a part of the file itself
+        if( Utils::IsCstrEmpty( buffer.uri ) || std::strncmp( buffer.uri, "data:", 5 ) == 0 )
+        {
+            continue;
+        }
+
+        std::string uri = buffer.uri;
+        uri.resize( cgltf_decode_uri( uri.data() ) );
+
+        canBeSaved &= writer.AddDependency( gltfFolder / uri, uri );
+    }
+
+    struct PrimitiveJob
+    {
+        const cgltf_node*                node;
+        uint32_t                         primitiveIndex;
+        std::vector< RgPrimitiveVertex > vertices;
+        std::vector< uint32_t >          indices;
+        std::vector< RgPrimitiveVertex > lodVertices;
+        std::vector< uint32_t >          lodIndices;
+        float                            lodMaxDeviation = 0.0f;
+        uint64_t                         dataHash        = 0;
+        GatherLog                        log;
+    };
+
+    // collect all primitives, so their data can be gathered in parallel
+    std::vector< PrimitiveJob > jobs;
+
     for( cgltf_node* srcNode : std::span( mainNode->children, mainNode->children_count ) )
     {
         if( !srcNode || !srcNode->mesh )
@@ -767,35 +966,117 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                             mainNode->name,
                             srcNode->name );
         }
-        
-        auto primitiveExtra = json_parser::ReadStringAs< PrimitiveExtraInfo >(
-            Utils::SafeCstr( srcNode->extras.data ) );
-
-        // TODO: really bad way to reduce hash64 to 32 bits
-        RgMeshInfo dstMesh = {
-            .uniqueObjectID =
-                uint32_t( std::hash< std::string_view >{}( srcNode->name ) % UINT32_MAX ),
-            .pMeshName    = srcNode->name,
-            .transform    = MakeRgTransformFromGltfNode( *srcNode ),
-            .isExportable = true,
-        };
 
         for( uint32_t i = 0; i < srcNode->mesh->primitives_count; i++ )
         {
-            const cgltf_primitive& srcPrim = srcNode->mesh->primitives[ i ];
+            jobs.push_back( PrimitiveJob{ .node = srcNode, .primitiveIndex = i } );
+        }
+    }
+
+    rgl::unordered_map< const cgltf_material*, CompiledMaterial > materials;
+
+    // bound the memory of gathered, but not yet written data
+    constexpr size_t JobBatchSize = 512;
 
-            auto vertices = GatherVertices( srcPrim, *srcNode, gltfPath );
-            if( vertices.empty() )
+    // only dense meshes are worth a separate coarse version for distant rays
+    constexpr size_t LodMinTriangleCount = 1024;
+    constexpr float  LodTargetRatio      = 0.25f;
+
+    for( size_t batchStart = 0; batchStart < jobs.size(); batchStart += JobBatchSize )
+    {
+        size_t batchSize = std::min( JobBatchSize, jobs.size() - batchStart );
+        auto   batch     = std::span( jobs ).subspan( batchStart, batchSize );
+
+        auto gather = [ this, &batch ]( size_t begin, size_t end ) {
+            for( size_t j = begin; j < end; j++ )
             {
-                continue;
+                PrimitiveJob&          job     = batch[ j ];
+                const cgltf_primitive& srcPrim = job.node->mesh->primitives[ job.primitiveIndex ];
+
+                job.vertices = GatherVertices( srcPrim, *job.node, gltfPath, job.log );
+                if( job.vertices.empty() )
+                {
+                    continue;
+                }
+
+                job.indices = GatherIndices( srcPrim, *job.node, gltfPath, job.log );
+
+                if( optimizeMeshes && !job.indices.empty() )
+                {
+                    MeshOptimization::Optimize( job.vertices, job.indices );
+                }
+
+                // alpha tested geometry can't be simplified without changing its silhouette
+                bool isOpaque =
+                    !srcPrim.material || srcPrim.material->alpha_mode == cgltf_alpha_mode_opaque;
+
+                if( isOpaque && job.indices.size() / 3 >= LodMinTriangleCount )
+                {
+                    auto lod = MeshSimplification::Simplify(
+                        job.vertices, job.indices, LodTargetRatio, COARSE_LOD_MAX_ERROR );
+
+                    // not worth an additional geometry, if only a few triangles were removed
+                    if( !lod.indices.empty() && lod.indices.size() * 2 <= job.indices.size() )
+                    {
+                        if( optimizeMeshes )
+                        {
+                            MeshOptimization::Optimize( lod.vertices, lod.indices );
+                        }
+
+                        job.lodVertices     = std::move( lod.vertices );
+                        job.lodIndices      = std::move( lod.indices );
+                        job.lodMaxDeviation = lod.maxDeviation;
+                    }
+                }
+
+                // on reimport, the vertex data of unchanged primitives is not copied again
+                auto hashData = []( const auto& v, uint64_t h ) {
+                    return Utils::HashFnv1a( v.data(), std::span( v ).size_bytes(), h );
+                };
+                const uint64_t counts[] = {
+                    job.vertices.size(),
+                    job.indices.size(),
+                    job.lodVertices.size(),
+                    job.lodIndices.size(),
+                };
+                job.dataHash = hashData( counts, Utils::FNV1A_64_OFFSET_BASIS );
+                job.dataHash = hashData( job.vertices, job.dataHash );
+                job.dataHash = hashData( job.indices, job.dataHash );
+                job.dataHash = hashData( job.lodVertices, job.dataHash );
+                job.dataHash = hashData( job.lodIndices, job.dataHash );
             }
+        };
+
+        if( threadPool )
+        {
+            threadPool->ParallelFor( batch.size(), 1, gather );
+        }
+        else
+        {
+            gather( 0, batch.size() );
+        }
+
+        // writing is in the original order, so the upload order is the same as in glTF
+        for( PrimitiveJob& job : batch )
+        {
+            job.log.Flush();
 
-            auto indices = GatherIndices( srcPrim, *srcNode, gltfPath );
-            if( indices.empty() )
+            const cgltf_node*      srcNode = job.node;
+            const uint32_t         i       = job.primitiveIndex;
+            const cgltf_primitive& srcPrim = srcNode->mesh->primitives[ i ];
+
+            auto vertices    = std::move( job.vertices );
+            auto indices     = std::move( job.indices );
+            auto lodVertices = std::move( job.lodVertices );
+            auto lodIndices  = std::move( job.lodIndices );
+            if( vertices.empty() || indices.empty() )
             {
                 continue;
             }
 
+            auto primitiveExtra = json_parser::ReadStringAs< PrimitiveExtraInfo >(
+                Utils::SafeCstr( srcNode->extras.data ) );
+
 
             RgMeshPrimitiveFlags dstFlags = 0;
 
@@ -818,79 +1099,73 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                 }
             }
 
-
-            auto matinfo = UploadTextures(
-                cmd, frameIndex, srcPrim.material, textureManager, gltfFolder, gltfPath );
-
-            auto primname = std::to_string( i );
-
-            RgEditorInfo editorInfo = {};
-
-            RgMeshPrimitiveInfo dstPrim = {
-                .pPrimitiveNameInMesh = primname.c_str(),
-                .primitiveIndexInMesh = uint32_t( i ),
-                .flags                = dstFlags,
-                .pVertices            = vertices.data(),
-                .vertexCount          = uint32_t( vertices.size() ),
-                .pIndices             = indices.empty() ? nullptr : indices.data(),
-                .indexCount           = uint32_t( indices.size() ),
-                .pTextureName         = matinfo.pTextureName.c_str(),
-                .textureFrame         = 0,
-                .color                = matinfo.color,
-                .emissive             = matinfo.emissiveMult,
-                .pEditorInfo          = &editorInfo,
-            };
-
-            textureMeta.Modify( dstPrim, editorInfo, true );
+            RgMeshPrimitiveFlags extraFlags = 0;
             {
-                // pbr info from gltf has higher priority
-                editorInfo.pbrInfoExists = true;
-                editorInfo.pbrInfo       = { .metallicDefault  = matinfo.metallicFactor,
-                                             .roughnessDefault = matinfo.roughnessFactor };
-            }
+                if( primitiveExtra.isGlass )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_GLASS;
+                }
 
-            if( primitiveExtra.isGlass )
-            {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_GLASS;
-            }
+                if( primitiveExtra.isMirror )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_MIRROR;
+                }
 
-            if( primitiveExtra.isMirror )
-            {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_MIRROR;
-            }
+                if( primitiveExtra.isWater )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_WATER;
+                }
 
-            if( primitiveExtra.isWater )
-            {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_WATER;
-            }
+                if( primitiveExtra.isSkyVisibility )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_SKY_VISIBILITY;
+                }
 
-            if( primitiveExtra.isSkyVisibility )
-            {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_SKY_VISIBILITY;
-            }
+                if( primitiveExtra.isAcid )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_ACID;
+                }
 
-            if( primitiveExtra.isAcid )
-            {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_ACID;
+                if( primitiveExtra.isThinMedia )
+                {
+                    extraFlags |= RG_MESH_PRIMITIVE_THIN_MEDIA;
+                }
             }
 
-            if( primitiveExtra.isThinMedia )
+            auto matIter = materials.find( srcPrim.material );
+            if( matIter == materials.end() )
             {
-                dstPrim.flags |= RG_MESH_PRIMITIVE_THIN_MEDIA;
+                matIter =
+                    materials
+                        .emplace( srcPrim.material,
+                                  CompileMaterial( srcPrim.material, writer, gltfPath ) )
+                        .first;
             }
+            const CompiledMaterial& matinfo = matIter->second;
+
+            // TODO: really bad way to reduce hash64 to 32 bits
+            auto dst = SceneCache::Primitive{
+                .meshName = writer.AddString( srcNode->name ),
+                .uniqueObjectID =
+                    uint32_t( std::hash< std::string_view >{}( srcNode->name ) % UINT32_MAX ),
+                .primitiveIndex  = i,
+                .transform       = MakeRgTransformFromGltfNode( *srcNode ),
+                .flags           = dstFlags,
+                .extraFlags      = extraFlags,
+                .material        = matinfo.index,
+                .color           = matinfo.color,
+                .emissive        = matinfo.emissiveMult,
+                .metallicFactor  = matinfo.metallicFactor,
+                .roughnessFactor = matinfo.roughnessFactor,
+                .lodMaxDeviation = job.lodMaxDeviation,
+                .dataHash        = job.dataHash,
+            };
 
-            auto r = scene.UploadPrimitive( frameIndex, dstMesh, dstPrim, textureManager, true );
-
-
-            if( !( r == UploadResult::Static || r == UploadResult::ExportableStatic ) )
-            {
-                assert( 0 );
-            }
+            writer.AddPrimitive( dst, vertices, indices, lodVertices, lodIndices );
         }
     }
 
-    bool     foundLight = false;
-    uint64_t counter    = 0;
+    uint64_t counter = 0;
 
     // lights
     for( cgltf_node* srcNode : std::span( mainNode->children, mainNode->children_count ) )
@@ -950,8 +1225,9 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                     .direction              = direction,
                     .angularDiameterDegrees = 0.5f,
                 };
-                scene.UploadLight( frameIndex, &info, nullptr, true );
-                foundLight = true;
+                SceneCache::Light light = { .type = SceneCache::Light::Directional };
+                light.directional       = info;
+                writer.AddLight( light );
                 break;
             }
             case cgltf_light_type_point: {
@@ -965,8 +1241,9 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                     .position = position,
                     .radius   = 0.05f / oneGameUnitInMeters,
                 };
-                scene.UploadLight( frameIndex, &info, nullptr, true );
-                foundLight = true;
+                SceneCache::Light light = { .type = SceneCache::Light::Spherical };
+                light.spherical         = info;
+                writer.AddLight( light );
                 break;
             }
             case cgltf_light_type_spot: {
@@ -983,8 +1260,9 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
                     .angleOuter = srcNode->light->spot_outer_cone_angle,
                     .angleInner = srcNode->light->spot_inner_cone_angle,
                 };
-                scene.UploadLight( frameIndex, &info, nullptr, true );
-                foundLight = true;
+                SceneCache::Light light = { .type = SceneCache::Light::Spot };
+                light.spot              = info;
+                writer.AddLight( light );
                 break;
             }
             case cgltf_light_type_invalid:
@@ -993,7 +1271,249 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
         }
     }
 
-    if( !foundLight )
+    return writer.Finish( key );
+}
+
+std::string RTGL1::GltfImporter::MakeMaterialPaths(
+    const SceneCache::Material& m, std::span< std::filesystem::path > fullPaths ) const
+{
+    assert( fullPaths.size() == TEXTURES_PER_MATERIAL_COUNT );
+
+    for( uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++ )
+    {
+        if( m.paths[ i ].size > 0 )
+        {
+            fullPaths[ i ] = gltfFolder / cache->GetString( m.paths[ i ] );
+        }
+    }
+
+    return MakePTextureName( cache->GetString( m.name ), fullPaths );
+}
+
+void RTGL1::GltfImporter::ForEachPrimitive( const TextureMetaManager&      textureMeta,
+                                            std::span< const std::string > materialNames,
+                                            const PrimitiveFunc&           f ) const
+{
+    for( const SceneCache::Primitive& p : cache->GetPrimitives() )
+    {
+        // vertices and indices are used right from the cache memory
+        auto vertices = cache->GetVertices( p );
+        auto indices  = cache->GetIndices( p );
+
+        RgMeshInfo dstMesh = {
+            .uniqueObjectID = p.uniqueObjectID,
+            .pMeshName      = cache->GetString( p.meshName ),
+            .transform      = p.transform,
+            .isExportable   = true,
+        };
+
+        auto primname = std::to_string( p.primitiveIndex );
+
+        RgEditorInfo editorInfo = {};
+
+        RgMeshPrimitiveInfo dstPrim = {
+            .pPrimitiveNameInMesh = primname.c_str(),
+            .primitiveIndexInMesh = p.primitiveIndex,
+            .flags                = p.flags,
+            .pVertices            = vertices.data(),
+            .vertexCount          = uint32_t( vertices.size() ),
+            .pIndices             = indices.empty() ? nullptr : indices.data(),
+            .indexCount           = uint32_t( indices.size() ),
+            .pTextureName =
+                p.material != SceneCache::NoMaterial ? materialNames[ p.material ].c_str() : "",
+            .textureFrame = 0,
+            .color        = p.color,
+            .emissive     = p.emissive,
+            .pEditorInfo  = &editorInfo,
+        };
+
+        textureMeta.Modify( dstPrim, editorInfo, true );
+        {
+            // pbr info from gltf has higher priority
+            editorInfo.pbrInfoExists = true;
+            editorInfo.pbrInfo       = { .metallicDefault  = p.metallicFactor,
+                                         .roughnessDefault = p.roughnessFactor };
+        }
+
+        dstPrim.flags |= p.extraFlags;
+
+        auto lodVertices = cache->GetLodVertices( p );
+        auto lodIndices  = cache->GetLodIndices( p );
+
+        RgMeshPrimitiveInfo lodPrim = dstPrim;
+        {
+            lodPrim.pVertices   = lodVertices.data();
+            lodPrim.vertexCount = uint32_t( lodVertices.size() );
+            lodPrim.pIndices    = lodIndices.data();
+            lodPrim.indexCount  = uint32_t( lodIndices.size() );
+        }
+
+        f( dstMesh,
+           dstPrim,
+           lodIndices.empty() ? nullptr : &lodPrim,
+           p.lodMaxDeviation,
+           p.dataHash );
+    }
+}
+
+auto RTGL1::GltfImporter::DescribeStaticGeometry( const TextureMetaManager& textureMeta ) const
+    -> StaticGeometryInfo
+{
+    if( !cache )
+    {
+        return {};
+    }
+
+    uint64_t h           = 0;
+    uint64_t vertexCount = 0;
+    uint64_t indexCount  = 0;
+
+    // texture indices are baked into the geometry instances
+    std::vector< std::string > materialNames;
+    materialNames.reserve( cache->GetMaterials().size() );
+
+    for( const SceneCache::Material& m : cache->GetMaterials() )
+    {
+        std::filesystem::path fullPaths[ TEXTURES_PER_MATERIAL_COUNT ];
+        materialNames.push_back( MakeMaterialPaths( m, fullPaths ) );
+
+        Utils::HashCombine( h, materialNames.back() );
+        for( uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++ )
+        {
+            Utils::HashCombine( h, fullPaths[ i ].native() );
+            Utils::HashCombine( h, m.filters[ i ] );
+            Utils::HashCombine( h, m.addressModesU[ i ] );
+            Utils::HashCombine( h, m.addressModesV[ i ] );
+        }
+        Utils::HashCombine( h, m.pbrSwizzling );
+    }
+
+    auto hashPrimitive = [ & ]( const RgMeshInfo&          mesh,
+                                const RgMeshPrimitiveInfo& prim,
+                                const RgMeshPrimitiveInfo* coarseLod,
+                                float                      coarseLodMaxDeviation,
+                                uint64_t                   dataHash ) {
+        const RgEditorInfo& editor = *prim.pEditorInfo;
+
+        Utils::HashCombine( h, std::string_view( mesh.pMeshName ) );
+        Utils::HashCombine( h, mesh.uniqueObjectID );
+        HashBytes( h, std::span< const RgTransform >( &mesh.transform, 1 ) );
+        Utils::HashCombine( h, prim.primitiveIndexInMesh );
+        Utils::HashCombine( h, prim.flags );
+        Utils::HashCombine( h, std::string_view( prim.pTextureName ) );
+        Utils::HashCombine( h, prim.color );
+        Utils::HashCombine( h, prim.emissive );
+        Utils::HashCombine( h, editor.attachedLightExists );
+        Utils::HashCombine( h, editor.attachedLightEvenOnDynamic );
+        Utils::HashCombine( h, editor.attachedLight.intensity );
+        Utils::HashCombine( h, editor.attachedLight.color );
+        Utils::HashCombine( h, editor.pbrInfo.metallicDefault );
+        Utils::HashCombine( h, editor.pbrInfo.roughnessDefault );
+        Utils::HashCombine( h, dataHash );
+        Utils::HashCombine( h, coarseLodMaxDeviation );
+
+        // +2 for the alignment of each range
+        vertexCount += prim.vertexCount + 2;
+        indexCount  += prim.indexCount + 2;
+        if( coarseLod )
+        {
+            vertexCount += coarseLod->vertexCount + 2;
+            indexCount  += coarseLod->indexCount + 2;
+        }
+    };
+    ForEachPrimitive( textureMeta, materialNames, hashPrimitive );
+
+    return StaticGeometryInfo{
+        .hash        = h,
+        .vertexCount = uint32_t( std::min< uint64_t >( vertexCount, UINT32_MAX ) ),
+        .indexCount  = uint32_t( std::min< uint64_t >( indexCount, UINT32_MAX ) ),
+    };
+}
+
+void RTGL1::GltfImporter::UploadToScene( uint32_t                  frameIndex,
+                                         Scene&                    scene,
+                                         TextureManager&           textureManager,
+                                         const TextureMetaManager& textureMeta,
+                                         bool                      uploadGeometry ) const
+{
+    if( !cache )
+    {
+        return;
+    }
+
+    // materials are created once, primitives only reference them by name
+    std::vector< std::string > materialNames;
+    materialNames.reserve( cache->GetMaterials().size() );
+
+    for( const SceneCache::Material& m : cache->GetMaterials() )
+    {
+        std::filesystem::path  fullPaths[ TEXTURES_PER_MATERIAL_COUNT ];
+        SamplerManager::Handle samplers[ TEXTURES_PER_MATERIAL_COUNT ];
+
+        std::string materialName = MakeMaterialPaths( m, fullPaths );
+
+        for( uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++ )
+        {
+            samplers[ i ] = SamplerManager::Handle( RgSamplerFilter( m.filters[ i ] ),
+                                                    RgSamplerAddressMode( m.addressModesU[ i ] ),
+                                                    RgSamplerAddressMode( m.addressModesV[ i ] ) );
+        }
+
+        // if fullPaths are empty
+        if( !materialName.empty() )
+        {
+            textureManager.TryCreateImportedMaterial( frameIndex,
+                                                      materialName,
+                                                      fullPaths,
+                                                      samplers,
+                                                      RgTextureSwizzling( m.pbrSwizzling ) );
+        }
+
+        materialNames.push_back( std::move( materialName ) );
+    }
+
+    if( uploadGeometry )
+    {
+        auto upload = [ & ]( const RgMeshInfo&          mesh,
+                             const RgMeshPrimitiveInfo& prim,
+                             const RgMeshPrimitiveInfo* coarseLod,
+                             float                      coarseLodMaxDeviation,
+                             uint64_t                   dataHash ) {
+            auto r = scene.UploadPrimitive( frameIndex,
+                                            mesh,
+                                            prim,
+                                            textureManager,
+                                            true,
+                                            coarseLod,
+                                            coarseLodMaxDeviation,
+                                            dataHash );
+
+            if( !( r == UploadResult::Static || r == UploadResult::ExportableStatic ) )
+            {
+                assert( 0 );
+            }
+        };
+        ForEachPrimitive( textureMeta, materialNames, upload );
+    }
+
+    for( const SceneCache::Light& l : cache->GetLights() )
+    {
+        switch( l.type )
+        {
+            case SceneCache::Light::Directional:
+                scene.UploadLight( frameIndex, &l.directional, nullptr, true );
+                break;
+            case SceneCache::Light::Spherical:
+                scene.UploadLight( frameIndex, &l.spherical, nullptr, true );
+                break;
+            case SceneCache::Light::Spot:
+                scene.UploadLight( frameIndex, &l.spot, nullptr, true );
+                break;
+            default: assert( 0 ); break;
+        }
+    }
+
+    if( cache->GetLights().empty() )
     {
         debug::Warning( "Haven't found any lights in {}: "
                         "Original exportable lights will be used",
@@ -1003,5 +1523,5 @@ void RTGL1::GltfImporter::UploadToScene( VkCommandBuffer           cmd,
 
 RTGL1::GltfImporter::operator bool() const
 {
-    return data != nullptr;
+    return cache.has_value();
 }
@@ -21,8 +21,10 @@
 #pragma once
 
 #include "Common.h"
+#include "SceneCache.h"
 
 #include <filesystem>
+#include <functional>
 
 struct cgltf_node;
 struct cgltf_data;
@@ -32,6 +34,7 @@ namespace RTGL1
 {
 
 class Scene;
+class ThreadPool;
 class TextureManager;
 class TextureMetaManager;
 class LightManager;
@@ -39,9 +42,11 @@ class LightManager;
 class GltfImporter
 {
 public:
-    GltfImporter( const std::filesystem::path& gltfPath,
-                  const RgTransform&           worldTransform,
-                  float                        oneGameUnitInMeters );
+    GltfImporter( const std::filesystem::path&  gltfPath,
+                  const RgTransform&            worldTransform,
+                  float                         oneGameUnitInMeters,
+                  bool                          optimizeMeshes,
+                  std::shared_ptr< ThreadPool > threadPool = nullptr );
     ~GltfImporter();
 
     GltfImporter( const GltfImporter& other )                = delete;
@@ -49,19 +54,55 @@ public:
     GltfImporter& operator=( const GltfImporter& other )     = delete;
     GltfImporter& operator=( GltfImporter&& other ) noexcept = delete;
 
-    void UploadToScene( VkCommandBuffer           cmd,
-                        uint32_t                  frameIndex,
+    struct StaticGeometryInfo
+    {
+        // hash of everything that is baked into the static geometry,
+        // if it's the same after a reimport, the static acceleration structure can be kept
+        uint64_t hash        = 0;
+        // how much vertex buffer space all primitives take, at most
+        uint32_t vertexCount = 0;
+        uint32_t indexCount  = 0;
+    };
+    StaticGeometryInfo DescribeStaticGeometry( const TextureMetaManager& textureMeta ) const;
+
+    // If 'uploadGeometry' is false, only materials and lights are uploaded
+    void UploadToScene( uint32_t                  frameIndex,
                         Scene&                    scene,
                         TextureManager&           textureManager,
-                        const TextureMetaManager& textureMeta ) const;
+                        const TextureMetaManager& textureMeta,
+                        bool                      uploadGeometry ) const;
 
     explicit operator bool() const;
 
 private:
-    cgltf_data*           data;
-    std::string           gltfPath;
-    std::filesystem::path gltfFolder;
-    float                 oneGameUnitInMeters;
+    // Convert glTF into the flat tables of a scene cache.
+    // 'canBeSaved' is false, if the referenced files couldn't be hashed
+    std::vector< uint8_t > Compile( cgltf_data* data, uint64_t key, bool& canBeSaved ) const;
+
+    // Returns material name, 'fullPaths' are filled with absolute texture paths
+    std::string MakeMaterialPaths( const SceneCache::Material&        m,
+                                   std::span< std::filesystem::path > fullPaths ) const;
+
+    // Call 'f' with each primitive as it should be uploaded, i.e. with texture meta applied.
+    // 'coarseLod' is the same primitive with simplified geometry, or null;
+    // 'coarseLodMaxDeviation' is how far it is from the original, in the mesh's local units;
+    // 'dataHash' is the same, if the vertex data of both is the same
+    using PrimitiveFunc = std::function< void( const RgMeshInfo&          mesh,
+                                               const RgMeshPrimitiveInfo& primitive,
+                                               const RgMeshPrimitiveInfo* coarseLod,
+                                               float                      coarseLodMaxDeviation,
+                                               uint64_t                   dataHash ) >;
+    void ForEachPrimitive( const TextureMetaManager&      textureMeta,
+                           std::span< const std::string > materialNames,
+                           const PrimitiveFunc&           f ) const;
+
+private:
+    std::optional< SceneCache >   cache;
+    std::string                   gltfPath;
+    std::filesystem::path         gltfFolder;
+    float                         oneGameUnitInMeters;
+    bool                          optimizeMeshes;
+    std::shared_ptr< ThreadPool > threadPool;
 };
 
 }
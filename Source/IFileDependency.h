@@ -43,7 +43,7 @@ inline FileType MakeFileType( const std::filesystem::path& p )
 
     std::ranges::transform( ext, ext.begin(), []( unsigned char c ) { return std::tolower( c ); } );
 
-    if( ext == ".gltf" )
+    if( ext == ".gltf" || ext == ".glb" )
     {
         return FileType::GLTF;
     }
@@ -20,15 +20,24 @@
 
 #include "ImageLoader.h"
 
+#include "TexturePrefetcher.h"
+
 #include <ktx.h>
 #include <ktxvulkan.h>
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+
+RTGL1::ImageLoader::ImageLoader( std::shared_ptr< TexturePrefetcher > _prefetcher )
+    : prefetcher( std::move( _prefetcher ) )
+{
+}
 
 RTGL1::ImageLoader::~ImageLoader()
 {
     assert( loadedImages.empty() );
+    assert( prefetchedImages.empty() );
 }
 
 bool RTGL1::ImageLoader::LoadTextureFile( const std::filesystem::path& path,
@@ -48,6 +57,15 @@ std::optional< RTGL1::ImageLoader::ResultInfo > RTGL1::ImageLoader::Load(
         return std::nullopt;
     }
 
+    if( prefetcher )
+    {
+        if( auto p = prefetcher->TryTake( path ) )
+        {
+            prefetchedImages.push_back( std::move( p->owner ) );
+            return p->result;
+        }
+    }
+
     ktxTexture* pTexture = nullptr;
     bool        loaded   = LoadTextureFile( path, &pTexture );
 
@@ -143,6 +161,77 @@ std::optional< RTGL1::ImageLoader::LayeredResultInfo > RTGL1::ImageLoader::LoadL
     return result;
 }
 
+std::optional< RTGL1::ImageLoader::CubemapResult > RTGL1::ImageLoader::LoadCubemap(
+    const std::filesystem::path& path )
+{
+    if( path.empty() )
+    {
+        return std::nullopt;
+    }
+
+    ktxTexture* pTexture = nullptr;
+    bool        loaded   = LoadTextureFile( path, &pTexture );
+
+    if( !loaded )
+    {
+        return std::nullopt;
+    }
+
+    if( pTexture->numDimensions != 2 || pTexture->numFaces != 6 || pTexture->numLayers != 1 ||
+        pTexture->numLevels == 0 || pTexture->baseWidth != pTexture->baseHeight ||
+        ktxTexture_GetVkFormat( pTexture ) == VK_FORMAT_UNDEFINED )
+    {
+        debug::Warning( "{}: Expected a KTX2 cubemap with 6 square faces", path.string() );
+        ktxTexture_Destroy( pTexture );
+        return std::nullopt;
+    }
+
+    CubemapResult result = {
+        .data         = {},
+        .faceSize     = 0,
+        .levelOffsets = {},
+        .levelSizes   = {},
+        .levelCount   = std::min( pTexture->numLevels, MAX_PREGENERATED_MIPMAP_LEVELS ),
+        .baseSize     = { pTexture->baseWidth, pTexture->baseHeight },
+        .format       = ktxTexture_GetVkFormat( pTexture ),
+    };
+
+    // KTX stores faces inside of each level, but uploader expects a mip chain per face
+    for( uint32_t level = 0; level < result.levelCount; level++ )
+    {
+        auto size = static_cast< uint32_t >( ktxTexture_GetImageSize( pTexture, level ) );
+
+        result.levelOffsets[ level ] = result.faceSize;
+        result.levelSizes[ level ]   = size;
+        result.faceSize += size;
+    }
+
+    result.data.resize( size_t( 6 ) * result.faceSize );
+
+    const uint8_t* pSrc = ktxTexture_GetData( pTexture );
+
+    for( uint32_t face = 0; face < 6; face++ )
+    {
+        for( uint32_t level = 0; level < result.levelCount; level++ )
+        {
+            ktx_size_t offset = 0;
+            if( ktxTexture_GetImageOffset( pTexture, level, 0, face, &offset ) != KTX_SUCCESS )
+            {
+                debug::Warning(
+                    "{}: Failed to get face {} of level {}", path.string(), face, level );
+                ktxTexture_Destroy( pTexture );
+                return std::nullopt;
+            }
+
+            size_t dst = size_t( face ) * result.faceSize + result.levelOffsets[ level ];
+            memcpy( &result.data[ dst ], pSrc + offset, result.levelSizes[ level ] );
+        }
+    }
+
+    ktxTexture_Destroy( pTexture );
+    return result;
+}
+
 void RTGL1::ImageLoader::FreeLoaded()
 {
     for( ktxTexture* p : loadedImages )
@@ -151,4 +240,5 @@ void RTGL1::ImageLoader::FreeLoaded()
     }
 
     loadedImages.clear();
+    prefetchedImages.clear();
 }
@@ -34,6 +34,8 @@ struct ktxTexture;
 namespace RTGL1
 {
 
+class TexturePrefetcher;
+
 // Loading images from files.
 class ImageLoader final
 {
@@ -58,8 +60,22 @@ public:
         VkFormat                      format;
     };
 
+    // Owns its data, faces are laid out one after another,
+    // each with its full mip chain, so level offsets are relative to a face
+    struct CubemapResult
+    {
+        std::vector< uint8_t > data;
+        uint32_t               faceSize;
+        uint32_t               levelOffsets[ MAX_PREGENERATED_MIPMAP_LEVELS ];
+        uint32_t               levelSizes[ MAX_PREGENERATED_MIPMAP_LEVELS ];
+        uint32_t               levelCount;
+        RgExtent2D             baseSize;
+        VkFormat               format;
+    };
+
 public:
-    ImageLoader() = default;
+    // If prefetcher is set, files that were decoded ahead are taken from it
+    explicit ImageLoader( std::shared_ptr< TexturePrefetcher > prefetcher = nullptr );
     ~ImageLoader();
 
     ImageLoader( const ImageLoader& other )                = delete;
@@ -70,6 +86,10 @@ public:
     std::optional< ResultInfo >        Load( const std::filesystem::path& path );
     std::optional< LayeredResultInfo > LoadLayered( const std::filesystem::path& path );
 
+    // Load a KTX2 file with 6 faces. Doesn't touch the instance state, so can be called
+    // from any thread
+    static std::optional< CubemapResult > LoadCubemap( const std::filesystem::path& path );
+
     // Must be called after using the loaded data to free the allocated memory
     void FreeLoaded();
 
@@ -81,10 +101,13 @@ public:
     static auto GetFolder() { return TEXTURES_FOLDER; }
 
 private:
-    bool LoadTextureFile( const std::filesystem::path& path, ktxTexture** ppTexture );
+    static bool LoadTextureFile( const std::filesystem::path& path, ktxTexture** ppTexture );
 
 private:
-    std::vector< ktxTexture* > loadedImages;
+    std::vector< ktxTexture* >             loadedImages;
+    std::vector< std::shared_ptr< void > > prefetchedImages;
+
+    std::shared_ptr< TexturePrefetcher > prefetcher;
 };
 
 }
\ No newline at end of file
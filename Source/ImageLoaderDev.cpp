@@ -20,22 +20,113 @@
 
 #include "ImageLoaderDev.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <fstream>
+#include <thread>
+
+#include "BlockCompression.h"
+#include "TexturePrefetcher.h"
+#include "ThreadPool.h"
+#include "Utils.h"
 
 #include "Stb/stb_image.h"
 
+namespace
+{
+
+constexpr uint32_t CacheMagic   = 0x43425452; // RTBC
+constexpr uint32_t CacheVersion = 3;
+
+struct CacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t levelOffsets[ RTGL1::MAX_PREGENERATED_MIPMAP_LEVELS ];
+    uint32_t levelSizes[ RTGL1::MAX_PREGENERATED_MIPMAP_LEVELS ];
+    uint32_t dataSize;
+    uint32_t isSRGB;
+};
+
+std::optional< std::vector< uint8_t > > ReadWholeFile( const std::filesystem::path& path )
+{
+    std::ifstream file( path, std::ios::binary | std::ios::ate );
+    if( !file.is_open() )
+    {
+        return std::nullopt;
+    }
+
+    auto size = file.tellg();
+    if( size <= 0 )
+    {
+        return std::nullopt;
+    }
+
+    auto bytes = std::vector< uint8_t >( size_t( size ) );
+
+    file.seekg( 0 );
+    if( !file.read( reinterpret_cast< char* >( bytes.data() ), size ) )
+    {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+// the hash is a part of the cache file name, so it must be the same on all platforms
+uint64_t HashBytes( const std::vector< uint8_t >& bytes )
+{
+    return RTGL1::Utils::HashFnv1a( bytes.data(), bytes.size() );
+}
+
+}
+
+RTGL1::ImageLoaderDev::ImageLoaderDev( std::filesystem::path                _compressedCacheFolder,
+                                       std::shared_ptr< ThreadPool >        _threadPool,
+                                       std::shared_ptr< TexturePrefetcher > _prefetcher )
+    : cacheFolder( std::move( _compressedCacheFolder ) )
+    , threadPool( std::move( _threadPool ) )
+    , prefetcher( std::move( _prefetcher ) )
+{
+}
+
 RTGL1::ImageLoaderDev::~ImageLoaderDev()
 {
     assert( loadedImages.empty() );
+    assert( loadedCompressed.empty() );
+    assert( prefetchedImages.empty() );
 }
 
-std::optional< RTGL1::ImageLoader::ResultInfo > RTGL1::ImageLoaderDev::Load( const std::filesystem::path& path )
+std::optional< RTGL1::ImageLoader::ResultInfo > RTGL1::ImageLoaderDev::Load(
+    const std::filesystem::path& path, bool isSRGB )
 {
     if( path.empty() )
     {
         return std::nullopt;
     }
 
+    if( prefetcher )
+    {
+        if( auto p = prefetcher->TryTake( path, isSRGB ) )
+        {
+            prefetchedImages.push_back( std::move( p->owner ) );
+            return p->result;
+        }
+    }
+
+    if( !cacheFolder.empty() )
+    {
+        if( auto r = LoadCompressed( path, isSRGB ) )
+        {
+            return r;
+        }
+    }
+
     int                x = 0, y = 0;
     constexpr uint32_t Channels = 4;
 
@@ -66,6 +157,153 @@ std::optional< RTGL1::ImageLoader::ResultInfo > RTGL1::ImageLoaderDev::Load( con
     return result;
 }
 
+std::optional< RTGL1::ImageLoader::ResultInfo > RTGL1::ImageLoaderDev::LoadCompressed(
+    const std::filesystem::path& path, bool isSRGB )
+{
+    auto source = ReadWholeFile( path );
+    if( !source )
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t sourceHash = HashBytes( *source );
+
+    // mips of the same file differ, if it's used both as sRGB and linear
+    const auto cachePath =
+        cacheFolder / std::format( "{:016x}{}.bc", sourceHash, isSRGB ? "_srgb" : "" );
+
+    auto makeResult = [ this ]( const CacheFileHeader& header, std::vector< uint8_t >&& data ) {
+        ImageLoader::ResultInfo result = {
+            .levelOffsets   = {},
+            .levelSizes     = {},
+            .levelCount     = header.levelCount,
+            .isPregenerated = true,
+            .pData          = data.data(),
+            .dataSize       = header.dataSize,
+            .baseSize       = { header.width, header.height },
+            .format         = VkFormat( header.format ),
+        };
+        std::ranges::copy( header.levelOffsets, result.levelOffsets );
+        std::ranges::copy( header.levelSizes, result.levelSizes );
+
+        // vector's buffer is not reallocated on move
+        loadedCompressed.push_back( std::move( data ) );
+        return result;
+    };
+
+
+    // try the cached file
+    if( auto cached = ReadWholeFile( cachePath ) )
+    {
+        CacheFileHeader header = {};
+
+        if( cached->size() >= sizeof( header ) )
+        {
+            memcpy( &header, cached->data(), sizeof( header ) );
+
+            if( header.magic == CacheMagic && header.version == CacheVersion &&
+                header.sourceHash == sourceHash && header.isSRGB == uint32_t( isSRGB ) &&
+                header.levelCount <= MAX_PREGENERATED_MIPMAP_LEVELS &&
+                cached->size() == sizeof( header ) + header.dataSize )
+            {
+                cached->erase( cached->begin(), cached->begin() + sizeof( header ) );
+                return makeResult( header, std::move( *cached ) );
+            }
+        }
+
+        debug::Warning( "Ignoring invalid compressed texture cache file: {}", cachePath.string() );
+    }
+
+
+    // decode and compress
+    int                x = 0, y = 0;
+    constexpr uint32_t Channels = 4;
+
+    stbi_uc* pPixels =
+        stbi_load_from_memory( source->data(), int( source->size() ), &x, &y, nullptr, Channels );
+    if( pPixels == nullptr )
+    {
+        return std::nullopt;
+    }
+
+    // blocks are 4x4, not worth it for tiny images
+    if( x < 4 || y < 4 )
+    {
+        stbi_image_free( pPixels );
+        return std::nullopt;
+    }
+
+    BlockCompression::Result compressed = BlockCompression::CompressWithMipmaps(
+        pPixels, RgExtent2D{ uint32_t( x ), uint32_t( y ) }, isSRGB, threadPool.get() );
+
+    stbi_image_free( pPixels );
+
+
+    CacheFileHeader header = {
+        .magic        = CacheMagic,
+        .version      = CacheVersion,
+        .sourceHash   = sourceHash,
+        .format       = uint32_t( compressed.format ),
+        .width        = compressed.baseSize.width,
+        .height       = compressed.baseSize.height,
+        .levelCount   = compressed.levelCount,
+        .levelOffsets = {},
+        .levelSizes   = {},
+        .dataSize     = uint32_t( compressed.data.size() ),
+        .isSRGB       = uint32_t( isSRGB ),
+    };
+    std::ranges::copy( compressed.levelOffsets, header.levelOffsets );
+    std::ranges::copy( compressed.levelSizes, header.levelSizes );
+
+    // write to a temporary file first, so a partially written file is never read
+    {
+        std::error_code ec;
+        std::filesystem::create_directories( cacheFolder, ec );
+
+        // the same texture can be compressed by a prefetch worker and the main thread
+        // at the same time, so each writer has its own temporary file
+        static std::atomic_uint64_t tempCounter{ 0 };
+
+        auto tempPath = std::filesystem::path( cachePath )
+                            .concat( std::format( ".{:x}.{}.tmp",
+                                                  std::hash< std::thread::id >{}(
+                                                      std::this_thread::get_id() ),
+                                                  tempCounter.fetch_add( 1 ) ) );
+        bool written;
+        {
+            std::ofstream file( tempPath, std::ios::binary | std::ios::trunc );
+            file.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+            file.write( reinterpret_cast< const char* >( compressed.data.data() ),
+                        std::streamsize( compressed.data.size() ) );
+            written = bool( file );
+        }
+
+        // rename replaces the target atomically, so a reader gets either the old or the new
+        if( written )
+        {
+            std::filesystem::rename( tempPath, cachePath, ec );
+        }
+
+        if( !written || ec )
+        {
+            std::error_code ignored;
+            std::filesystem::remove( tempPath, ignored );
+
+            debug::Warning( "Failed to save compressed texture cache {}: {}",
+                            cachePath.string(),
+                            written ? ec.message() : "write error" );
+        }
+        else
+        {
+            debug::Verbose( "Compressed texture cache was created for {}: {}",
+                            path.string(),
+                            cachePath.string() );
+        }
+    }
+
+    return makeResult( header, std::move( compressed.data ) );
+}
+
 void RTGL1::ImageLoaderDev::FreeLoaded()
 {
     for( void* pData : loadedImages )
@@ -73,4 +311,6 @@ void RTGL1::ImageLoaderDev::FreeLoaded()
         stbi_image_free( pData );
     }
     loadedImages.clear();
+    loadedCompressed.clear();
+    prefetchedImages.clear();
 }
@@ -27,11 +27,19 @@
 namespace RTGL1
 {
 
+class ThreadPool;
+class TexturePrefetcher;
+
 // Loading images from files in a development mode, e.g. using raw .png  files
 class ImageLoaderDev final
 {
 public:
-    explicit ImageLoaderDev() = default;
+    // If compressedCacheFolder is not empty, images are block-compressed on the first load,
+    // and the result is saved to that folder with the source file's content hash as a key.
+    // If prefetcher is set, files that were decoded ahead are taken from it
+    explicit ImageLoaderDev( std::filesystem::path                compressedCacheFolder = {},
+                             std::shared_ptr< ThreadPool >        threadPool            = nullptr,
+                             std::shared_ptr< TexturePrefetcher > prefetcher            = nullptr );
     ~ImageLoaderDev();
 
     ImageLoaderDev( const ImageLoaderDev& other )                = delete;
@@ -39,7 +47,8 @@ public:
     ImageLoaderDev& operator=( const ImageLoaderDev& other )     = delete;
     ImageLoaderDev& operator=( ImageLoaderDev&& other ) noexcept = delete;
 
-    std::optional< ImageLoader::ResultInfo > Load( const std::filesystem::path& path );
+    // isSRGB defines how the mip chain of a compressed image is filtered
+    std::optional< ImageLoader::ResultInfo > Load( const std::filesystem::path& path, bool isSRGB );
     // Must be called after using the loaded data to free the allocated memory
     void                                     FreeLoaded();
 
@@ -51,7 +60,17 @@ public:
     static auto GetFolder() { return TEXTURES_FOLDER_DEV; }
 
 private:
-    std::vector< void* > loadedImages;
+    std::optional< ImageLoader::ResultInfo > LoadCompressed( const std::filesystem::path& path,
+                                                             bool                         isSRGB );
+
+private:
+    std::vector< void* >                   loadedImages;
+    std::vector< std::vector< uint8_t > >  loadedCompressed;
+    std::vector< std::shared_ptr< void > > prefetchedImages;
+
+    std::filesystem::path                cacheFolder;
+    std::shared_ptr< ThreadPool >        threadPool;
+    std::shared_ptr< TexturePrefetcher > prefetcher;
 };
 
 }
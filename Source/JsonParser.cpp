@@ -210,6 +210,9 @@ JSON_TYPE( RTGL1::LibraryConfig )
     , "vulkanValidation", &T::vulkanValidation
     , "dlssValidation", &T::dlssValidation
     , "fpsMonitor", &T::fpsMonitor
+    , "compressDevTextures", &T::compressDevTextures
+    , "optimizeSceneMeshes", &T::optimizeSceneMeshes
+    , "cullLights", &T::cullLights
 JSON_TYPE_END;
 // clang-format on
 
@@ -221,6 +224,56 @@ auto RTGL1::json_parser::detail::ReadLibraryConfig( const std::filesystem::path&
 
 
 
+// clang-format off
+JSON_TYPE( RTGL1::TexturePrefetchFile )
+      "path", &T::path
+    , "isSRGB", &T::isSRGB
+JSON_TYPE_END;
+JSON_TYPE( RTGL1::TexturePrefetchEntry )
+      "materialName", &T::materialName
+    , "files", &T::files
+JSON_TYPE_END;
+JSON_TYPE( RTGL1::TexturePrefetchManifest )
+      "version", &T::version
+    , "array", &T::array
+JSON_TYPE_END;
+// clang-format on
+
+auto RTGL1::json_parser::detail::ReadTexturePrefetchManifest( const std::filesystem::path& path )
+    -> std::optional< TexturePrefetchManifest >
+{
+    return LoadFileAs< TexturePrefetchManifest >( path );
+}
+
+
+
+// clang-format off
+JSON_TYPE( RTGL1::ExportedPrimitive )
+      "hash", &T::hash
+    , "verticesOffset", &T::verticesOffset
+    , "indicesOffset", &T::indicesOffset
+JSON_TYPE_END;
+JSON_TYPE( RTGL1::ExportedTexture )
+      "file", &T::file
+    , "hash", &T::hash
+JSON_TYPE_END;
+JSON_TYPE( RTGL1::ExportManifest )
+      "version", &T::version
+    , "binSize", &T::binSize
+    , "binHash", &T::binHash
+    , "primitives", &T::primitives
+    , "textures", &T::textures
+JSON_TYPE_END;
+// clang-format on
+
+auto RTGL1::json_parser::detail::ReadExportManifest( const std::filesystem::path& path )
+    -> std::optional< ExportManifest >
+{
+    return LoadFileAs< ExportManifest >( path );
+}
+
+
+
 // clang-format off
 JSON_TYPE( RgLightExtraInfo )
       "lightstyle",   &T::lightstyle
@@ -322,3 +375,54 @@ std::string RTGL1::json_parser::MakeJsonString( const RgLightExtraInfo& info )
 
     return {};
 }
+
+namespace
+{
+template< typename T >
+bool SaveFileAs( const std::filesystem::path& path, const T& value )
+{
+    using namespace RTGL1;
+
+    try
+    {
+        std::string str;
+
+        glz::write< glz::opts{
+            .error_on_unknown_keys = false,
+            .no_except             = false,
+            .prettify              = true,
+            .indentation_width     = 4,
+        } >( value, str );
+
+        std::error_code ec;
+        std::filesystem::create_directories( path.parent_path(), ec );
+
+        std::ofstream file( path, std::ios::trunc );
+        if( !file.is_open() )
+        {
+            debug::Warning( "Json write fail on {}: Can't open the file", path.string() );
+            return false;
+        }
+
+        file << str;
+        return true;
+    }
+    catch( std::exception& e )
+    {
+        debug::Warning( "Json write fail on {}:\n{}", path.string(), e.what() );
+    }
+
+    return false;
+}
+}
+
+bool RTGL1::json_parser::WriteFile( const std::filesystem::path&   path,
+                                    const TexturePrefetchManifest& value )
+{
+    return SaveFileAs( path, value );
+}
+
+bool RTGL1::json_parser::WriteFile( const std::filesystem::path& path, const ExportManifest& value )
+{
+    return SaveFileAs( path, value );
+}
@@ -40,6 +40,15 @@ struct LibraryConfig
     bool vulkanValidation = false;
     bool dlssValidation   = false;
     bool fpsMonitor       = false;
+
+    // block-compress raw developer textures, and cache the result
+    bool compressDevTextures = true;
+
+    // reorder triangles and vertices of imported and exported scenes for GPU locality
+    bool optimizeSceneMeshes = true;
+
+    // don't upload non-static lights that are too dim or far from the view volume
+    bool cullLights = false;
 };
 
 
@@ -121,6 +130,59 @@ struct SceneMetaArray
 
 
 
+struct TexturePrefetchFile
+{
+    std::string path   = {};
+    bool        isSRGB = false;
+};
+
+struct TexturePrefetchEntry
+{
+    std::string                        materialName = {};
+    std::vector< TexturePrefetchFile > files        = {};
+};
+
+// Override files that were loaded on a map, to decode them ahead on the next load of that map
+struct TexturePrefetchManifest
+{
+    constexpr static int Version{ 1 };
+    constexpr static int RequiredVersion{ 1 };
+
+    int                                 version = Version;
+    std::vector< TexturePrefetchEntry > array;
+};
+
+
+
+struct ExportedPrimitive
+{
+    uint64_t hash           = 0;
+    uint64_t verticesOffset = 0;
+    uint64_t indicesOffset  = 0;
+};
+
+struct ExportedTexture
+{
+    std::string file = {};
+    uint64_t    hash = 0;
+};
+
+// What the last glTF export has written, so the next one appends only new data
+struct ExportManifest
+{
+    constexpr static int Version{ 1 };
+    constexpr static int RequiredVersion{ 1 };
+
+    int                              version = Version;
+    uint64_t                         binSize = 0;
+    // FNV-1a of the .bin contents, to detect edits that keep the size
+    uint64_t                         binHash = 0;
+    std::vector< ExportedPrimitive > primitives;
+    std::vector< ExportedTexture >   textures;
+};
+
+
+
 struct PrimitiveExtraInfo
 {
     int isGlass         = 0;
@@ -146,6 +208,12 @@ namespace json_parser
         auto ReadLibraryConfig( const std::filesystem::path& path )
             -> std::optional< LibraryConfig >;
 
+        auto ReadTexturePrefetchManifest( const std::filesystem::path& path )
+            -> std::optional< TexturePrefetchManifest >;
+
+        auto ReadExportManifest( const std::filesystem::path& path )
+            -> std::optional< ExportManifest >;
+
         auto ReadLightExtraInfo( const std::string_view& data ) -> RgLightExtraInfo;
 
         auto ReadPrimitiveExtraInfo( const std::string_view& data ) -> PrimitiveExtraInfo;
@@ -174,6 +242,18 @@ namespace json_parser
         return detail::ReadLibraryConfig( path );
     }
 
+    template<>
+    inline auto ReadFileAs< TexturePrefetchManifest >( const std::filesystem::path& path )
+    {
+        return detail::ReadTexturePrefetchManifest( path );
+    }
+
+    template<>
+    inline auto ReadFileAs< ExportManifest >( const std::filesystem::path& path )
+    {
+        return detail::ReadExportManifest( path );
+    }
+
 
 
     template< typename T >
@@ -194,6 +274,9 @@ namespace json_parser
 
 
     std::string MakeJsonString( const RgLightExtraInfo& info );
+
+    bool WriteFile( const std::filesystem::path& path, const TexturePrefetchManifest& value );
+    bool WriteFile( const std::filesystem::path& path, const ExportManifest& value );
 }
 
 }
@@ -25,6 +25,7 @@
 
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
+#include "Matrix.h"
 #include "RgException.h"
 #include "Utils.h"
 
@@ -36,14 +37,22 @@ constexpr float MIN_COLOR_SUM     = 0.0001f;
 constexpr float MIN_SPHERE_RADIUS = 0.005f;
 
 constexpr uint32_t LIGHT_ARRAY_MAX_SIZE = 4096;
+// each light is a leaf in a binary tree, plus 3 roots
+constexpr uint32_t LIGHT_TREE_MAX_SIZE = 2 * LIGHT_ARRAY_MAX_SIZE + 1;
 
 constexpr VkDeviceSize GRID_LIGHTS_COUNT =
     LIGHT_GRID_CELL_SIZE * ( LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y * LIGHT_GRID_SIZE_Z );
 
+// illuminance (in lux) below which a light is considered to not affect a point
+constexpr float    LIGHT_CULL_MIN_ILLUMINANCE = 0.01f;
+// how many frames a light is kept after it left the view volume
+constexpr uint32_t LIGHT_CULL_GRACE_FRAMES = 30;
+
 }
 
 RTGL1::LightManager::LightManager( VkDevice                            _device,
-                                   std::shared_ptr< MemoryAllocator >& _allocator )
+                                   std::shared_ptr< MemoryAllocator >& _allocator,
+                                   bool                                _enableCulling )
     : device( _device )
     , regLightCount( 0 )
     , regLightCount_Prev( 0 )
@@ -54,6 +63,8 @@ RTGL1::LightManager::LightManager( VkDevice                            _device,
     , descSets{}
     , needDescSetUpdate{}
 {
+    culling.enabled = _enableCulling;
+
     lightsBuffer = std::make_shared< AutoBuffer >( _allocator );
     lightsBuffer->Create( sizeof( ShLightEncoded ) * LIGHT_ARRAY_MAX_SIZE,
                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -74,6 +85,11 @@ RTGL1::LightManager::LightManager( VkDevice                            _device,
                   "Lights grid" );
     }
 
+    lightTreeBuffer = std::make_shared< AutoBuffer >( _allocator );
+    lightTreeBuffer->Create( sizeof( ShLightTreeNode ) * LIGHT_TREE_MAX_SIZE,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             "Lights tree" );
+
     prevToCurIndex = std::make_shared< AutoBuffer >( _allocator );
     prevToCurIndex->Create( sizeof( uint32_t ) * LIGHT_ARRAY_MAX_SIZE,
                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
@@ -269,6 +285,17 @@ void RTGL1::LightManager::PrepareForFrame( VkCommandBuffer cmd, uint32_t frameIn
     // no need to clear curToPrevIndex, as it'll be filled in the cur frame
 
     uniqueIDToArrayIndex[ frameIndex ].clear();
+
+    dynamicEncoded.clear();
+    dynamicUniqueIDs.clear();
+
+    culling.frameCounter++;
+    if( culling.frameCounter % LIGHT_CULL_GRACE_FRAMES == 0 )
+    {
+        std::erase_if( culling.lastVisibleFrame, [ this ]( const auto& kv ) {
+            return culling.frameCounter - kv.second > LIGHT_CULL_GRACE_FRAMES;
+        } );
+    }
 }
 
 void RTGL1::LightManager::Reset()
@@ -291,6 +318,15 @@ void RTGL1::LightManager::Reset()
 
     regLightCount_Prev = regLightCount = 0;
     dirLightCount_Prev = dirLightCount = 0;
+
+    // encode static lights again on the next submit
+    staticLights.version.reset();
+    staticLights.uniqueIDToArrayIndex.clear();
+
+    dynamicEncoded.clear();
+    dynamicUniqueIDs.clear();
+
+    culling.lastVisibleFrame.clear();
 }
 
 RTGL1::LightArrayIndex RTGL1::LightManager::GetIndex( const ShLightEncoded& encodedLight ) const
@@ -335,6 +371,13 @@ void RTGL1::LightManager::AddInternal( uint32_t              frameIndex,
     auto* dst = lightsBuffer->GetMappedAs< ShLightEncoded* >( frameIndex );
     memcpy( &dst[ index.GetArrayIndex() ], &encodedLight, sizeof( ShLightEncoded ) );
 
+    if( encodedLight.lightType != LIGHT_TYPE_DIRECTIONAL )
+    {
+        // keep a copy, as staging memory is slow to read from
+        dynamicEncoded.push_back( encodedLight );
+        dynamicUniqueIDs.push_back( uniqueId );
+    }
+
 
     FillMatchPrev( frameIndex, index, uniqueId );
     // must be unique
@@ -384,47 +427,248 @@ float CalculateLightStyle( const T& l, std::span< const float > lightstyles )
 
 }
 
-void RTGL1::LightManager::Add( uint32_t frameIndex, const RgSphericalLightUploadInfo& info )
+namespace
+{
+
+// Returns nullopt, if the light must not be added
+std::optional< RTGL1::ShLightEncoded > TryEncode( const RgSphericalLightUploadInfo& info,
+                                                  float                             mult )
 {
     if( IsLightColorTooDim( info ) )
     {
-        return;
+        return std::nullopt;
     }
 
-    AddInternal( frameIndex,
-                 info.uniqueID,
-                 EncodeAsSphereLight( info, CalculateLightStyle( info, lightstyles ) ) );
+    return EncodeAsSphereLight( info, mult );
 }
 
-void RTGL1::LightManager::Add( uint32_t frameIndex, const RgPolygonalLightUploadInfo& info )
+std::optional< RTGL1::ShLightEncoded > TryEncode( const RgPolygonalLightUploadInfo& info,
+                                                  float                             mult )
 {
     if( IsLightColorTooDim( info ) )
+    {
+        return std::nullopt;
+    }
+
+    RgFloat3D unnormalizedNormal = RTGL1::Utils::GetUnnormalizedNormal( info.positions );
+    if( RTGL1::Utils::Dot( unnormalizedNormal.data, unnormalizedNormal.data ) <= 0.0f )
+    {
+        return std::nullopt;
+    }
+
+    return EncodeAsTriangleLight( info, unnormalizedNormal, mult );
+}
+
+std::optional< RTGL1::ShLightEncoded > TryEncode( const RgSpotLightUploadInfo& info, float mult )
+{
+    if( IsLightColorTooDim( info ) || info.radius < 0.0f || info.angleOuter <= 0.0f )
+    {
+        return std::nullopt;
+    }
+
+    return EncodeAsSpotLight( info, mult );
+}
+
+std::optional< RTGL1::ShLightEncoded > TryEncode( const RgDirectionalLightUploadInfo& info,
+                                                  float                               mult )
+{
+    if( IsLightColorTooDim( info ) || info.angularDiameterDegrees < 0.0f )
+    {
+        return std::nullopt;
+    }
+
+    return EncodeAsDirectionalLight( info, mult );
+}
+
+}
+
+namespace
+{
+
+// Distance at which the light's illuminance drops below LIGHT_CULL_MIN_ILLUMINANCE;
+// conservative, as if all flux was emitted into a hemisphere
+float GetInfluenceRange( RgColor4DPacked32 color, float intensity )
+{
+    auto  fcolor   = RTGL1::Utils::UnpackColor4DPacked32< RgFloat3D >( color );
+    float maxColor = std::max( { fcolor.data[ 0 ], fcolor.data[ 1 ], fcolor.data[ 2 ] } );
+
+    return std::sqrt( std::max( 0.0f, intensity * maxColor ) /
+                      ( float( RTGL1::RG_PI ) * RTGL1::LIGHT_CULL_MIN_ILLUMINANCE ) );
+}
+
+struct InfluenceSphere
+{
+    RgFloat3D center;
+    float     radius;
+};
+
+InfluenceSphere GetInfluenceSphere( const RgSphericalLightUploadInfo& info )
+{
+    return InfluenceSphere{
+        .center = info.position,
+        .radius = std::max( 0.0f, info.radius ) + GetInfluenceRange( info.color, info.intensity ),
+    };
+}
+
+InfluenceSphere GetInfluenceSphere( const RgSpotLightUploadInfo& info )
+{
+    // cone is ignored
+    return InfluenceSphere{
+        .center = info.position,
+        .radius = std::max( 0.0f, info.radius ) + GetInfluenceRange( info.color, info.intensity ),
+    };
+}
+
+InfluenceSphere GetInfluenceSphere( const RgPolygonalLightUploadInfo& info )
+{
+    RgFloat3D center = {};
+    for( const RgFloat3D& p : info.positions )
+    {
+        center.data[ 0 ] += p.data[ 0 ] / 3.0f;
+        center.data[ 1 ] += p.data[ 1 ] / 3.0f;
+        center.data[ 2 ] += p.data[ 2 ] / 3.0f;
+    }
+
+    float extent = 0.0f;
+    for( const RgFloat3D& p : info.positions )
+    {
+        float d[] = {
+            p.data[ 0 ] - center.data[ 0 ],
+            p.data[ 1 ] - center.data[ 1 ],
+            p.data[ 2 ] - center.data[ 2 ],
+        };
+        extent = std::max( extent, RTGL1::Utils::Length( d ) );
+    }
+
+    return InfluenceSphere{
+        .center = center,
+        .radius = extent + GetInfluenceRange( info.color, info.intensity ),
+    };
+}
+
+}
+
+void RTGL1::LightManager::SetCullingView( const float* view, const float* projection, float margin )
+{
+    if( !culling.enabled )
     {
         return;
     }
 
-    RgFloat3D unnormalizedNormal = Utils::GetUnnormalizedNormal( info.positions );
-    if( Utils::Dot( unnormalizedNormal.data, unnormalizedNormal.data ) <= 0.0f )
+    // column-major
+    float viewProj[ 16 ];
+    Matrix::Multiply( viewProj, view, projection );
+
+    const auto row = [ &viewProj ]( int r ) {
+        return std::array{ viewProj[ 0 * 4 + r ],
+                           viewProj[ 1 * 4 + r ],
+                           viewProj[ 2 * 4 + r ],
+                           viewProj[ 3 * 4 + r ] };
+    };
+    const auto r0 = row( 0 ), r1 = row( 1 ), r2 = row( 2 ), r3 = row( 3 );
+
+    for( int i = 0; i < 4; i++ )
+    {
+        // left, right, bottom, top, far
+        culling.planes[ 0 ][ i ] = r3[ i ] + r0[ i ];
+        culling.planes[ 1 ][ i ] = r3[ i ] - r0[ i ];
+        culling.planes[ 2 ][ i ] = r3[ i ] + r1[ i ];
+        culling.planes[ 3 ][ i ] = r3[ i ] - r1[ i ];
+        culling.planes[ 4 ][ i ] = r3[ i ] - r2[ i ];
+    }
+
+    for( auto& plane : culling.planes )
+    {
+        float len = Utils::Length( plane );
+        if( len > 0.0f )
+        {
+            for( float& c : plane )
+            {
+                c /= len;
+            }
+        }
+        else
+        {
+            // degenerate, e.g. no camera yet: nothing is culled by this plane
+            plane[ 0 ] = plane[ 1 ] = plane[ 2 ] = 0.0f;
+            plane[ 3 ] = 1.0f;
+        }
+    }
+
+    culling.margin = std::max( 0.0f, margin );
+}
+
+bool RTGL1::LightManager::IsCulled( UniqueLightID    uniqueID,
+                                    const RgFloat3D& center,
+                                    float            radius )
+{
+    if( !culling.enabled )
+    {
+        return false;
+    }
+
+    bool isVisible = true;
+    for( const auto& plane : culling.planes )
+    {
+        float dist = Utils::Dot( plane, center.data ) + plane[ 3 ];
+        if( dist < -( radius + culling.margin ) )
+        {
+            isVisible = false;
+            break;
+        }
+    }
+
+    if( isVisible )
+    {
+        culling.lastVisibleFrame[ uniqueID ] = culling.frameCounter;
+        return false;
+    }
+
+    auto found = culling.lastVisibleFrame.find( uniqueID );
+    return found == culling.lastVisibleFrame.end() ||
+           culling.frameCounter - found->second > LIGHT_CULL_GRACE_FRAMES;
+}
+
+void RTGL1::LightManager::Add( uint32_t frameIndex, const RgSphericalLightUploadInfo& info )
+{
+    if( auto [ center, radius ] = GetInfluenceSphere( info );
+        IsCulled( info.uniqueID, center, radius ) )
     {
         return;
     }
 
-    AddInternal( frameIndex,
-                 info.uniqueID,
-                 EncodeAsTriangleLight(
-                     info, unnormalizedNormal, CalculateLightStyle( info, lightstyles ) ) );
+    if( auto encoded = TryEncode( info, CalculateLightStyle( info, lightstyles ) ) )
+    {
+        AddInternal( frameIndex, info.uniqueID, *encoded );
+    }
+}
+
+void RTGL1::LightManager::Add( uint32_t frameIndex, const RgPolygonalLightUploadInfo& info )
+{
+    if( auto [ center, radius ] = GetInfluenceSphere( info );
+        IsCulled( info.uniqueID, center, radius ) )
+    {
+        return;
+    }
+
+    if( auto encoded = TryEncode( info, CalculateLightStyle( info, lightstyles ) ) )
+    {
+        AddInternal( frameIndex, info.uniqueID, *encoded );
+    }
 }
 
 void RTGL1::LightManager::Add( uint32_t frameIndex, const RgSpotLightUploadInfo& info )
 {
-    if( IsLightColorTooDim( info ) || info.radius < 0.0f || info.angleOuter <= 0.0f )
+    if( auto [ center, radius ] = GetInfluenceSphere( info );
+        IsCulled( info.uniqueID, center, radius ) )
     {
         return;
     }
 
-    AddInternal( frameIndex,
-                 info.uniqueID,
-                 EncodeAsSpotLight( info, CalculateLightStyle( info, lightstyles ) ) );
+    if( auto encoded = TryEncode( info, CalculateLightStyle( info, lightstyles ) ) )
+    {
+        AddInternal( frameIndex, info.uniqueID, *encoded );
+    }
 }
 
 void RTGL1::LightManager::Add( uint32_t frameIndex, const RgDirectionalLightUploadInfo& info )
@@ -435,24 +679,258 @@ void RTGL1::LightManager::Add( uint32_t frameIndex, const RgDirectionalLightUplo
         return;
     }
 
-    if( IsLightColorTooDim( info ) || info.angularDiameterDegrees < 0.0f )
+    if( auto encoded = TryEncode( info, CalculateLightStyle( info, lightstyles ) ) )
     {
+        AddInternal( frameIndex, info.uniqueID, *encoded );
+    }
+}
+
+void RTGL1::LightManager::SubmitStaticLights( uint32_t                           frameIndex,
+                                              std::span< const GenericLight >    lights,
+                                              uint64_t                           version,
+                                              std::optional< RgColor4DPacked32 > directionalTint )
+{
+    assert( regLightCount == 0 && dirLightCount == 0 );
+
+    auto oldStaticIndices = rgl::unordered_map< UniqueLightID, LightArrayIndex >{};
+
+    const bool isNewList = staticLights.version != version;
+    if( isNewList )
+    {
+        oldStaticIndices = std::move( staticLights.uniqueIDToArrayIndex );
+        RebuildStaticLights( lights, version );
+    }
+    else
+    {
+        UpdateStaticLightstyles( lights );
+    }
+
+    // only one directional light can exist, so it's added as usual,
+    // it's also the one that can be tinted
+    if( staticLights.directional )
+    {
+        auto sun = std::get< RgDirectionalLightUploadInfo >( lights[ *staticLights.directional ] );
+        if( directionalTint )
+        {
+            sun.color = *directionalTint;
+        }
+        Add( frameIndex, sun );
+    }
+
+    // regular static lights occupy the beginning of the regular region,
+    // dynamic ones are appended after them
+    regLightCount = uint32_t( staticLights.encoded.size() );
+
+    auto* prev2cur = prevToCurIndex->GetMappedAs< uint32_t* >( frameIndex );
+    auto* cur2prev = curToPrevIndex->GetMappedAs< uint32_t* >( frameIndex );
+
+    if( !isNewList )
+    {
+        // static lights have the same indices as in the previous frame
+        for( uint32_t i = 0; i < regLightCount; i++ )
+        {
+            uint32_t index    = LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET + i;
+            prev2cur[ index ] = index;
+            cur2prev[ index ] = index;
+        }
         return;
     }
 
-    AddInternal( frameIndex,
-                 info.uniqueID,
-                 EncodeAsDirectionalLight( info, CalculateLightStyle( info, lightstyles ) ) );
+    uint32_t prevFrame = ( frameIndex + 1 ) % MAX_FRAMES_IN_FLIGHT;
+
+    for( uint32_t i = 0; i < regLightCount; i++ )
+    {
+        const UniqueLightID uniqueID = staticLights.uniqueIDs[ i ];
+
+        // a light could be static or dynamic in the previous frame
+        auto found = oldStaticIndices.find( uniqueID );
+        if( found == oldStaticIndices.end() )
+        {
+            found = uniqueIDToArrayIndex[ prevFrame ].find( uniqueID );
+            if( found == uniqueIDToArrayIndex[ prevFrame ].end() )
+            {
+                continue;
+            }
+        }
+
+        uint32_t index = LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET + i;
+        prev2cur[ found->second.GetArrayIndex() ] = index;
+        cur2prev[ index ]                        = found->second.GetArrayIndex();
+    }
+}
+
+void RTGL1::LightManager::RebuildStaticLights( std::span< const GenericLight > lights,
+                                               uint64_t                        version )
+{
+    staticLights.version = version;
+    staticLights.encoded.clear();
+    staticLights.uniqueIDs.clear();
+    staticLights.styled.clear();
+    staticLights.directional.reset();
+    staticLights.uniqueIDToArrayIndex.clear();
+    staticLights.isDeviceOutdated = true;
+
+    constexpr uint32_t maxCount = LIGHT_ARRAY_MAX_SIZE - LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET;
+
+    for( uint32_t source = 0; source < lights.size(); source++ )
+    {
+        std::visit(
+            [ & ]< typename T >( const T& specific ) {
+                if constexpr( std::is_same_v< T, RgDirectionalLightUploadInfo > )
+                {
+                    if( staticLights.directional )
+                    {
+                        debug::Error( "Only one directional light is allowed" );
+                        return;
+                    }
+                    staticLights.directional = source;
+                }
+                else
+                {
+                    if( staticLights.encoded.size() >= maxCount )
+                    {
+                        debug::Warning( "Too many static lights, max is {}", maxCount );
+                        return;
+                    }
+
+                    float mult    = CalculateLightStyle( specific, lightstyles );
+                    auto  encoded = TryEncode( specific, mult );
+                    if( !encoded )
+                    {
+                        return;
+                    }
+
+                    auto slot = uint32_t( staticLights.encoded.size() );
+
+                    staticLights.encoded.push_back( *encoded );
+                    staticLights.uniqueIDs.push_back( specific.uniqueID );
+                    staticLights.uniqueIDToArrayIndex[ specific.uniqueID ] =
+                        LightArrayIndex{ LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET + slot };
+
+                    if( specific.extra.exists )
+                    {
+                        staticLights.styled.push_back( StaticLights::Styled{
+                            .slot   = slot,
+                            .source = source,
+                            .mult   = mult,
+                        } );
+                    }
+                }
+            },
+            lights[ source ] );
+    }
+
+    lightTree.BuildStatic( staticLights.encoded, LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET );
+}
+
+void RTGL1::LightManager::UpdateStaticLightstyles( std::span< const GenericLight > lights )
+{
+    bool anyChanged = false;
+
+    for( auto& styled : staticLights.styled )
+    {
+        std::visit(
+            [ & ]< typename T >( const T& specific ) {
+                if constexpr( !std::is_same_v< T, RgDirectionalLightUploadInfo > )
+                {
+                    float mult = CalculateLightStyle( specific, lightstyles );
+                    if( mult == styled.mult )
+                    {
+                        return;
+                    }
+
+                    // the light passed TryEncode on rebuild, and lightstyle doesn't affect that
+                    if( auto encoded = TryEncode( specific, mult ) )
+                    {
+                        staticLights.encoded[ styled.slot ] = *encoded;
+                        anyChanged                          = true;
+                    }
+                    styled.mult = mult;
+                }
+            },
+            lights[ styled.source ] );
+    }
+
+    if( anyChanged )
+    {
+        // powers were changed, but not the positions
+        lightTree.RefitStatic( staticLights.encoded );
+        staticLights.isDeviceOutdated = true;
+    }
 }
 
 void RTGL1::LightManager::SubmitForFrame( VkCommandBuffer cmd, uint32_t frameIndex )
 {
     CmdLabel label( cmd, "Copying lights" );
 
-    lightsBuffer->CopyFromStaging( cmd,
-                                   frameIndex,
-                                   sizeof( ShLightEncoded ) *
-                                       GetLightArrayEnd( regLightCount, dirLightCount ) );
+    const uint32_t staticEnd =
+        LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET + uint32_t( staticLights.encoded.size() );
+    const uint32_t arrayEnd = GetLightArrayEnd( regLightCount, dirLightCount );
+    assert( staticEnd <= arrayEnd );
+
+    const bool isStaticOutdated = staticLights.isDeviceOutdated;
+
+    if( isStaticOutdated )
+    {
+        // static lights are written to the staging only when they were changed
+        auto* dst = lightsBuffer->GetMappedAs< ShLightEncoded* >( frameIndex );
+        memcpy( &dst[ LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET ],
+                staticLights.encoded.data(),
+                staticLights.encoded.size() * sizeof( ShLightEncoded ) );
+
+        lightsBuffer->CopyFromStaging( cmd, frameIndex, sizeof( ShLightEncoded ) * arrayEnd );
+        staticLights.isDeviceOutdated = false;
+    }
+    else
+    {
+        // device-local static region is unchanged, copy only directional and dynamic lights
+        VkBufferCopy copies[] = {
+            {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size      = sizeof( ShLightEncoded ) * LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET,
+            },
+            {
+                .srcOffset = sizeof( ShLightEncoded ) * staticEnd,
+                .dstOffset = sizeof( ShLightEncoded ) * staticEnd,
+                .size      = sizeof( ShLightEncoded ) * ( arrayEnd - staticEnd ),
+            },
+        };
+
+        lightsBuffer->CopyFromStaging( cmd, frameIndex, copies, arrayEnd > staticEnd ? 2 : 1 );
+    }
+
+    {
+        assert( staticEnd + dynamicEncoded.size() == arrayEnd );
+        lightTree.SetDynamic( dynamicEncoded, dynamicUniqueIDs, staticEnd );
+
+        auto* dst = lightTreeBuffer->GetMappedAs< ShLightTreeNode* >( frameIndex );
+        lightTree.Write( dst, isStaticOutdated );
+
+        // same as for the light array, static part is copied only when it was changed
+        const LightTree::Range ranges[] = {
+            lightTree.GetRootsRange(),
+            isStaticOutdated ? lightTree.GetStaticRange() : LightTree::Range{},
+            lightTree.GetDynamicRange(),
+        };
+
+        VkBufferCopy copies[ std::size( ranges ) ];
+        uint32_t     copyCount = 0;
+
+        for( const auto& r : ranges )
+        {
+            if( r.count > 0 )
+            {
+                copies[ copyCount++ ] = VkBufferCopy{
+                    .srcOffset = sizeof( ShLightTreeNode ) * r.offset,
+                    .dstOffset = sizeof( ShLightTreeNode ) * r.offset,
+                    .size      = sizeof( ShLightTreeNode ) * r.count,
+                };
+            }
+        }
+
+        lightTreeBuffer->CopyFromStaging( cmd, frameIndex, copies, copyCount );
+    }
 
     prevToCurIndex->CopyFromStaging(
         cmd,
@@ -535,6 +1013,7 @@ constexpr uint32_t BINDINGS[] = {
     BINDING_LIGHT_SOURCES_INDEX_CUR_TO_PREV,
     BINDING_INITIAL_LIGHTS_GRID,
     BINDING_INITIAL_LIGHTS_GRID_PREV,
+    BINDING_LIGHT_TREE,
 };
 
 void RTGL1::LightManager::CreateDescriptors()
@@ -621,6 +1100,7 @@ void RTGL1::LightManager::UpdateDescriptors( uint32_t frameIndex )
         initialLightsGrid[ frameIndex ].GetBuffer(),
         initialLightsGrid[ Utils::GetPreviousByModulo( frameIndex, MAX_FRAMES_IN_FLIGHT ) ]
             .GetBuffer(),
+        lightTreeBuffer->GetDeviceLocal(),
     };
     static_assert( std::size( BINDINGS ) == std::size( buffers ) );
 
@@ -679,6 +1159,12 @@ uint32_t RTGL1::LightManager::GetLightIndexForShaders( uint32_t  frameIndex,
     }
     UniqueLightID uniqueId = { *pLightUniqueId };
 
+    const auto foundStatic = staticLights.uniqueIDToArrayIndex.find( uniqueId );
+    if( foundStatic != staticLights.uniqueIDToArrayIndex.end() )
+    {
+        return foundStatic->second.GetArrayIndex();
+    }
+
     const auto f = uniqueIDToArrayIndex[ frameIndex ].find( uniqueId );
     if( f == uniqueIDToArrayIndex[ frameIndex ].end() )
     {
@@ -25,6 +25,7 @@
 #include "Containers.h"
 #include "AutoBuffer.h"
 #include "LightDefs.h"
+#include "LightTree.h"
 
 #include <optional>
 #include <span>
@@ -37,7 +38,9 @@ struct ShLightEncoded;
 class LightManager
 {
 public:
-    LightManager( VkDevice device, std::shared_ptr< MemoryAllocator >& allocator );
+    LightManager( VkDevice                            device,
+                  std::shared_ptr< MemoryAllocator >& allocator,
+                  bool                                enableCulling );
     ~LightManager();
 
     LightManager( const LightManager& other )                = delete;
@@ -59,6 +62,20 @@ public:
     void Add( uint32_t frameIndex, const RgDirectionalLightUploadInfo& info );
     void Add( uint32_t frameIndex, const RgSpotLightUploadInfo& info );
 
+    // Must be called before any other light is added in the frame. Regular static lights are
+    // kept at the beginning of the light array and encoded again only if 'version' is changed,
+    // or if their lightstyle values are changed. Directional light is tinted with
+    // 'directionalTint', if it's present.
+    void SubmitStaticLights( uint32_t                           frameIndex,
+                             std::span< const GenericLight >    lights,
+                             uint64_t                           version,
+                             std::optional< RgColor4DPacked32 > directionalTint );
+
+    // Regular non-static lights that can't affect the view volume extended by 'margin'
+    // are not added. Lights are uploaded before the camera of the frame is known,
+    // so the previous frame's matrices are expected.
+    void SetCullingView( const float* view, const float* projection, float margin );
+
     void SubmitForFrame( VkCommandBuffer cmd, uint32_t frameIndex );
     void BarrierLightGrid( VkCommandBuffer cmd, uint32_t frameIndex );
 
@@ -80,6 +97,11 @@ private:
 
     void AddInternal( uint32_t frameIndex, uint64_t uniqueId, const ShLightEncoded& encodedLight );
 
+    bool IsCulled( UniqueLightID uniqueID, const RgFloat3D& center, float radius );
+
+    void RebuildStaticLights( std::span< const GenericLight > lights, uint64_t version );
+    void UpdateStaticLightstyles( std::span< const GenericLight > lights );
+
     void FillMatchPrev( uint32_t        curFrameIndex,
                         LightArrayIndex lightIndexInCurFrame,
                         UniqueLightID   uniqueID );
@@ -94,6 +116,13 @@ private:
     Buffer                        lightsBuffer_Prev;
     Buffer                        initialLightsGrid[ MAX_FRAMES_IN_FLIGHT ];
 
+    // Hierarchy over regular lights for importance sampling
+    LightTree                     lightTree;
+    std::shared_ptr< AutoBuffer > lightTreeBuffer;
+    // Regular lights that were added in the current frame after static ones
+    std::vector< ShLightEncoded > dynamicEncoded;
+    std::vector< UniqueLightID >  dynamicUniqueIDs;
+
     // Match light indices between current and previous frames
     std::shared_ptr< AutoBuffer > prevToCurIndex;
     std::shared_ptr< AutoBuffer > curToPrevIndex;
@@ -106,6 +135,44 @@ private:
     uint32_t dirLightCount;
     uint32_t dirLightCount_Prev;
 
+    struct StaticLights
+    {
+        struct Styled
+        {
+            uint32_t slot;
+            // index in the list that was passed to SubmitStaticLights
+            uint32_t source;
+            // lightstyle value that was used for encoding
+            float    mult;
+        };
+
+        std::optional< uint64_t >     version;
+        // regular lights, starting at LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET
+        std::vector< ShLightEncoded > encoded;
+        std::vector< UniqueLightID >  uniqueIDs;
+        std::vector< Styled >         styled;
+        std::optional< uint32_t >     directional;
+        // indices of static lights are the same between frames, if version is not changed
+        rgl::unordered_map< UniqueLightID, LightArrayIndex > uniqueIDToArrayIndex;
+        // if the device-local buffer doesn't have the actual static lights
+        bool isDeviceOutdated{ false };
+    };
+    StaticLights staticLights;
+
+    struct Culling
+    {
+        bool  enabled{ false };
+        // normalized, pointing inside; near plane is not used,
+        // as lights behind the camera are still limited by the margin
+        float planes[ 5 ][ 4 ]{};
+        float margin{ 0 };
+        // a light that was visible recently is not culled, so it keeps its
+        // index history, and temporal matching works when it re-enters the view
+        rgl::unordered_map< UniqueLightID, uint32_t > lastVisibleFrame;
+        uint32_t                                      frameCounter{ 0 };
+    };
+    Culling culling;
+
     VkDescriptorSetLayout descSetLayout;
     VkDescriptorPool      descPool;
     VkDescriptorSet       descSets[ MAX_FRAMES_IN_FLIGHT ];
@@ -0,0 +1,423 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "LightTree.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+
+constexpr double RG_PI = 3.1415926535897932384626433;
+
+constexpr uint32_t ROOT         = 0;
+constexpr uint32_t STATIC_ROOT  = 1;
+constexpr uint32_t DYNAMIC_ROOT = 2;
+constexpr uint32_t ROOT_COUNT   = 3;
+
+constexpr uint32_t BIN_COUNT = 12;
+// deeper nodes are split in halves, so even with a full light array,
+// the depth is less than LIGHT_TREE_MAX_DEPTH in shaders
+constexpr uint32_t MAX_SAH_DEPTH = 16;
+
+struct Item
+{
+    RTGL1::ShLightTreeNode bounds;
+    float                  centroid[ 3 ];
+};
+
+bool IsLeaf( const RTGL1::ShLightTreeNode& node )
+{
+    return ( node.childOrLightIndex & uint32_t( LIGHT_TREE_NODE_LEAF_BIT ) ) != 0;
+}
+
+RTGL1::ShLightTreeNode MakeEmptyLeaf()
+{
+    return RTGL1::ShLightTreeNode{
+        .boundsMin         = { 0, 0, 0 },
+        .childOrLightIndex = uint32_t( LIGHT_TREE_NODE_LEAF_BIT ) | LIGHT_INDEX_NONE,
+        .boundsMax         = { 0, 0, 0 },
+        .power             = 0,
+    };
+}
+
+RTGL1::ShLightTreeNode MakeLeaf( const RTGL1::ShLightEncoded& l, uint32_t lightIndex )
+{
+    RTGL1::ShLightTreeNode leaf = {
+        .childOrLightIndex = uint32_t( LIGHT_TREE_NODE_LEAF_BIT ) | lightIndex,
+    };
+    float area = 0;
+
+    switch( l.lightType )
+    {
+        case LIGHT_TYPE_SPHERE:
+        case LIGHT_TYPE_SPOT: {
+            // spot cone is ignored, so the bounds are conservative
+            float radius = l.data_0[ 3 ];
+            for( int i = 0; i < 3; i++ )
+            {
+                leaf.boundsMin[ i ] = l.data_0[ i ] - radius;
+                leaf.boundsMax[ i ] = l.data_0[ i ] + radius;
+            }
+            area = float( RG_PI ) * radius * radius;
+            break;
+        }
+        case LIGHT_TYPE_TRIANGLE: {
+            for( int i = 0; i < 3; i++ )
+            {
+                leaf.boundsMin[ i ] = std::min( { l.data_0[ i ], l.data_1[ i ], l.data_2[ i ] } );
+                leaf.boundsMax[ i ] = std::max( { l.data_0[ i ], l.data_1[ i ], l.data_2[ i ] } );
+            }
+            float unnormalizedNormal[] = { l.data_0[ 3 ], l.data_1[ 3 ], l.data_2[ 3 ] };
+            area = 0.5f * RTGL1::Utils::Length( unnormalizedNormal );
+            break;
+        }
+        default: assert( 0 ); break;
+    }
+
+    // encoded color is divided by area, so multiply back to get the emitted power
+    leaf.power = std::max( 0.0f, RTGL1::Utils::Luminance( l.color ) ) * area;
+    return leaf;
+}
+
+// Bounds and power of 'a' and 'b', child index is not set
+RTGL1::ShLightTreeNode Merge( const RTGL1::ShLightTreeNode& a, const RTGL1::ShLightTreeNode& b )
+{
+    RTGL1::ShLightTreeNode r = {
+        .power = a.power + b.power,
+    };
+    for( int i = 0; i < 3; i++ )
+    {
+        r.boundsMin[ i ] = std::min( a.boundsMin[ i ], b.boundsMin[ i ] );
+        r.boundsMax[ i ] = std::max( a.boundsMax[ i ], b.boundsMax[ i ] );
+    }
+    return r;
+}
+
+float SurfaceArea( const RTGL1::ShLightTreeNode& node )
+{
+    float d[ 3 ];
+    for( int i = 0; i < 3; i++ )
+    {
+        d[ i ] = std::max( 0.0f, node.boundsMax[ i ] - node.boundsMin[ i ] );
+    }
+    return 2.0f * ( d[ 0 ] * d[ 1 ] + d[ 1 ] * d[ 2 ] + d[ 2 ] * d[ 0 ] );
+}
+
+// Surface area heuristic weighted by power: a bright light in a large node
+// makes sampling the other lights of that node less precise
+float SplitCost( const RTGL1::ShLightTreeNode& node )
+{
+    return ( node.power + 0.000001f ) * ( SurfaceArea( node ) + 0.000001f );
+}
+
+RTGL1::ShLightTreeNode MakeInvalidBounds()
+{
+    constexpr float inf = std::numeric_limits< float >::infinity();
+    return RTGL1::ShLightTreeNode{
+        .boundsMin = { inf, inf, inf },
+        .boundsMax = { -inf, -inf, -inf },
+        .power     = 0,
+    };
+}
+
+// Reorder items, so [0, result) is the left child, and [result, size) is the right one
+size_t Partition( std::span< Item > items, uint32_t depth )
+{
+    float cmin[ 3 ], cmax[ 3 ];
+    std::ranges::copy( items[ 0 ].centroid, cmin );
+    std::ranges::copy( items[ 0 ].centroid, cmax );
+    for( const Item& item : items )
+    {
+        for( int i = 0; i < 3; i++ )
+        {
+            cmin[ i ] = std::min( cmin[ i ], item.centroid[ i ] );
+            cmax[ i ] = std::max( cmax[ i ], item.centroid[ i ] );
+        }
+    }
+
+    int axis = 0;
+    for( int i = 1; i < 3; i++ )
+    {
+        if( cmax[ i ] - cmin[ i ] > cmax[ axis ] - cmin[ axis ] )
+        {
+            axis = i;
+        }
+    }
+    const float extent = cmax[ axis ] - cmin[ axis ];
+
+    if( extent > 0 && depth < MAX_SAH_DEPTH )
+    {
+        auto toBin = [ & ]( const Item& item ) {
+            auto b = uint32_t( ( item.centroid[ axis ] - cmin[ axis ] ) / extent * BIN_COUNT );
+            return std::min( b, BIN_COUNT - 1 );
+        };
+
+        RTGL1::ShLightTreeNode bins[ BIN_COUNT ];
+        uint32_t               binCounts[ BIN_COUNT ] = {};
+        std::ranges::fill( bins, MakeInvalidBounds() );
+
+        for( const Item& item : items )
+        {
+            uint32_t b = toBin( item );
+            bins[ b ]  = Merge( bins[ b ], item.bounds );
+            binCounts[ b ]++;
+        }
+
+        // cost of the left side, if split is after bin 'i'
+        float    leftCosts[ BIN_COUNT - 1 ];
+        uint32_t leftCounts[ BIN_COUNT - 1 ];
+        {
+            auto     acc      = MakeInvalidBounds();
+            uint32_t accCount = 0;
+            for( uint32_t i = 0; i < BIN_COUNT - 1; i++ )
+            {
+                acc = Merge( acc, bins[ i ] );
+                accCount += binCounts[ i ];
+                leftCosts[ i ]  = SplitCost( acc );
+                leftCounts[ i ] = accCount;
+            }
+        }
+
+        auto     bestCost  = std::numeric_limits< float >::max();
+        uint32_t bestSplit = BIN_COUNT;
+        {
+            auto acc = MakeInvalidBounds();
+            for( uint32_t i = BIN_COUNT - 1; i > 0; i-- )
+            {
+                acc = Merge( acc, bins[ i ] );
+
+                bool bothNonEmpty = leftCounts[ i - 1 ] > 0 && leftCounts[ i - 1 ] < items.size();
+                float cost        = leftCosts[ i - 1 ] + SplitCost( acc );
+
+                if( bothNonEmpty && cost < bestCost )
+                {
+                    bestCost  = cost;
+                    bestSplit = i - 1;
+                }
+            }
+        }
+
+        if( bestSplit < BIN_COUNT )
+        {
+            auto right = std::partition( items.begin(), items.end(), [ & ]( const Item& item ) {
+                return toBin( item ) <= bestSplit;
+            } );
+            return size_t( right - items.begin() );
+        }
+    }
+
+    // fallback to halves
+    size_t mid = items.size() / 2;
+    std::nth_element(
+        items.begin(), items.begin() + mid, items.end(), [ axis ]( const Item& a, const Item& b ) {
+            return a.centroid[ axis ] < b.centroid[ axis ];
+        } );
+    return mid;
+}
+
+void BuildNode( std::vector< RTGL1::ShLightTreeNode >& nodes,
+                uint32_t                               nodeIndex,
+                std::span< Item >                      items,
+                uint32_t                               childOffset,
+                uint32_t                               depth )
+{
+    assert( !items.empty() );
+
+    if( items.size() == 1 )
+    {
+        nodes[ nodeIndex ] = items[ 0 ].bounds;
+        return;
+    }
+
+    auto node = MakeInvalidBounds();
+    for( const Item& item : items )
+    {
+        node = Merge( node, item.bounds );
+    }
+
+    size_t mid = Partition( items, depth );
+    assert( mid > 0 && mid < items.size() );
+
+    // children are always next to each other, and after the parent
+    auto left = uint32_t( nodes.size() );
+    nodes.resize( nodes.size() + 2 );
+
+    node.childOrLightIndex = left + childOffset;
+    nodes[ nodeIndex ]     = node;
+
+    BuildNode( nodes, left, items.first( mid ), childOffset, depth + 1 );
+    BuildNode( nodes, left + 1, items.subspan( mid ), childOffset, depth + 1 );
+}
+
+}
+
+RTGL1::LightTree::LightTree()
+{
+    BuildStatic( {}, LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET );
+    SetDynamic( {}, {}, LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET );
+}
+
+void RTGL1::LightTree::Build( Subtree&                          subtree,
+                              std::span< const ShLightEncoded > lights,
+                              uint32_t                          firstLightIndex,
+                              uint32_t                          childOffset )
+{
+    subtree.nodes.clear();
+    subtree.childOffset     = childOffset;
+    subtree.firstLightIndex = firstLightIndex;
+
+    if( lights.empty() )
+    {
+        subtree.nodes.push_back( MakeEmptyLeaf() );
+        return;
+    }
+
+    std::vector< Item > items;
+    items.reserve( lights.size() );
+
+    for( uint32_t i = 0; i < lights.size(); i++ )
+    {
+        Item item = { .bounds = MakeLeaf( lights[ i ], firstLightIndex + i ) };
+        for( int k = 0; k < 3; k++ )
+        {
+            item.centroid[ k ] = 0.5f * ( item.bounds.boundsMin[ k ] + item.bounds.boundsMax[ k ] );
+        }
+        items.push_back( item );
+    }
+
+    subtree.nodes.reserve( 2 * items.size() - 1 );
+    subtree.nodes.resize( 1 );
+    BuildNode( subtree.nodes, 0, items, childOffset, 0 );
+}
+
+void RTGL1::LightTree::Refit( Subtree& subtree, std::span< const ShLightEncoded > lights )
+{
+    // children are always after their parent, so go backwards
+    for( size_t i = subtree.nodes.size(); i-- > 0; )
+    {
+        ShLightTreeNode& node = subtree.nodes[ i ];
+
+        if( IsLeaf( node ) )
+        {
+            uint32_t lightIndex = node.childOrLightIndex & ~uint32_t( LIGHT_TREE_NODE_LEAF_BIT );
+            if( lightIndex == LIGHT_INDEX_NONE )
+            {
+                continue;
+            }
+
+            assert( lightIndex - subtree.firstLightIndex < lights.size() );
+            node = MakeLeaf( lights[ lightIndex - subtree.firstLightIndex ], lightIndex );
+        }
+        else
+        {
+            uint32_t child = node.childOrLightIndex;
+            uint32_t left  = child - subtree.childOffset;
+
+            node                   = Merge( subtree.nodes[ left ], subtree.nodes[ left + 1 ] );
+            node.childOrLightIndex = child;
+        }
+    }
+}
+
+void RTGL1::LightTree::BuildStatic( std::span< const ShLightEncoded > lights,
+                                    uint32_t                          firstLightIndex )
+{
+    Build( staticTree, lights, firstLightIndex, ROOT_COUNT - 1 );
+}
+
+void RTGL1::LightTree::RefitStatic( std::span< const ShLightEncoded > lights )
+{
+    Refit( staticTree, lights );
+}
+
+void RTGL1::LightTree::SetDynamic( std::span< const ShLightEncoded > lights,
+                                   std::span< const UniqueLightID >  uniqueIDs,
+                                   uint32_t                          firstLightIndex )
+{
+    assert( lights.size() == uniqueIDs.size() );
+
+    // dynamic nodes are right after the static ones
+    const auto childOffset = uint32_t( staticTree.nodes.size() ) + 1;
+
+    bool sameLayout = dynamicTree.childOffset == childOffset &&
+                      dynamicTree.firstLightIndex == firstLightIndex &&
+                      !dynamicTree.nodes.empty() &&
+                      std::ranges::equal( uniqueIDs, dynamicUniqueIDs );
+
+    if( sameLayout )
+    {
+        Refit( dynamicTree, lights );
+    }
+    else
+    {
+        Build( dynamicTree, lights, firstLightIndex, childOffset );
+        dynamicUniqueIDs.assign( uniqueIDs.begin(), uniqueIDs.end() );
+    }
+}
+
+auto RTGL1::LightTree::GetRootsRange() const -> Range
+{
+    return Range{ .offset = ROOT, .count = ROOT_COUNT };
+}
+
+auto RTGL1::LightTree::GetStaticRange() const -> Range
+{
+    return Range{
+        .offset = staticTree.childOffset + 1,
+        .count  = uint32_t( staticTree.nodes.size() ) - 1,
+    };
+}
+
+auto RTGL1::LightTree::GetDynamicRange() const -> Range
+{
+    return Range{
+        .offset = dynamicTree.childOffset + 1,
+        .count  = uint32_t( dynamicTree.nodes.size() ) - 1,
+    };
+}
+
+uint32_t RTGL1::LightTree::GetNodeCount() const
+{
+    return GetDynamicRange().offset + GetDynamicRange().count;
+}
+
+void RTGL1::LightTree::Write( ShLightTreeNode* dst, bool withStatic ) const
+{
+    assert( dynamicTree.childOffset == staticTree.nodes.size() + 1 );
+
+    dst[ ROOT ]                   = Merge( staticTree.nodes[ 0 ], dynamicTree.nodes[ 0 ] );
+    dst[ ROOT ].childOrLightIndex = STATIC_ROOT;
+    dst[ STATIC_ROOT ]            = staticTree.nodes[ 0 ];
+    dst[ DYNAMIC_ROOT ]           = dynamicTree.nodes[ 0 ];
+    static_assert( DYNAMIC_ROOT == STATIC_ROOT + 1 );
+
+    if( withStatic )
+    {
+        std::ranges::copy( std::span( staticTree.nodes ).subspan( 1 ),
+                           &dst[ GetStaticRange().offset ] );
+    }
+    std::ranges::copy( std::span( dynamicTree.nodes ).subspan( 1 ),
+                       &dst[ GetDynamicRange().offset ] );
+}
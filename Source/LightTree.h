@@ -0,0 +1,92 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "LightDefs.h"
+
+#include "Generated/ShaderCommonC.h"
+
+#include <span>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Bounding volume hierarchy over regular lights. Each node has bounds and a summed power
+// of its lights, so shaders can pick a light by its importance for a point.
+// Node array layout: root, static subtree root, dynamic subtree root,
+// then the rest of static nodes, then the rest of dynamic nodes.
+class LightTree
+{
+public:
+    LightTree();
+
+    struct Range
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    // 'firstLightIndex' is an index of lights[0] in the light array
+    void BuildStatic( std::span< const ShLightEncoded > lights, uint32_t firstLightIndex );
+    // Keep the topology, only bounds and powers are recalculated
+    void RefitStatic( std::span< const ShLightEncoded > lights );
+
+    // If 'uniqueIDs' and the static subtree layout are the same as in the previous call,
+    // the dynamic subtree is only refitted
+    void SetDynamic( std::span< const ShLightEncoded > lights,
+                     std::span< const UniqueLightID >  uniqueIDs,
+                     uint32_t                          firstLightIndex );
+
+    Range GetRootsRange() const;
+    Range GetStaticRange() const;
+    Range GetDynamicRange() const;
+    uint32_t GetNodeCount() const;
+
+    // 'dst' must have at least GetNodeCount() elements;
+    // static nodes (except the root) are written only if 'withStatic' is true
+    void Write( ShLightTreeNode* dst, bool withStatic ) const;
+
+private:
+    struct Subtree
+    {
+        // [0] is the root
+        std::vector< ShLightTreeNode > nodes;
+        // local index 'i > 0' is at 'i + childOffset' in the whole node array
+        uint32_t                       childOffset{ 0 };
+        uint32_t                       firstLightIndex{ 0 };
+    };
+
+    static void Build( Subtree&                          subtree,
+                       std::span< const ShLightEncoded > lights,
+                       uint32_t                          firstLightIndex,
+                       uint32_t                          childOffset );
+    static void Refit( Subtree& subtree, std::span< const ShLightEncoded > lights );
+
+private:
+    Subtree staticTree;
+    Subtree dynamicTree;
+
+    std::vector< UniqueLightID > dynamicUniqueIDs;
+};
+
+}
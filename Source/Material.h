@@ -38,6 +38,12 @@ struct Texture
     SamplerManager::Handle              samplerHandle = SamplerManager::Handle();
     std::optional< RgTextureSwizzling > swizzling     = std::nullopt;
     std::filesystem::path               filepath      = {};
+    // Materials that reference this texture
+    uint32_t                            refCount      = 0;
+    // If not 0, the texture is registered for deduplication by its content
+    uint64_t                            contentHash   = 0;
+    // FNV-1a of the pixels, to skip the re-export of unchanged files; 0, if not known
+    uint64_t                            exportHash    = 0;
 };
 
 
@@ -0,0 +1,236 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MeshOptimization.h"
+
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t NoVertex = UINT32_MAX;
+
+struct Adjacency
+{
+    // triangles of vertex 'v' are in [offsets[v], offsets[v+1])
+    std::vector< uint32_t > offsets;
+    std::vector< uint32_t > triangles;
+};
+
+Adjacency MakeAdjacency( std::span< const uint32_t > indices, uint32_t vertexCount )
+{
+    Adjacency adj = {
+        .offsets   = std::vector< uint32_t >( vertexCount + 1, 0 ),
+        .triangles = std::vector< uint32_t >( indices.size() ),
+    };
+
+    for( uint32_t v : indices )
+    {
+        adj.offsets[ v + 1 ]++;
+    }
+    for( uint32_t v = 0; v < vertexCount; v++ )
+    {
+        adj.offsets[ v + 1 ] += adj.offsets[ v ];
+    }
+
+    auto cursor = std::vector< uint32_t >( adj.offsets.begin(), adj.offsets.end() - 1 );
+    for( size_t i = 0; i < indices.size(); i++ )
+    {
+        adj.triangles[ cursor[ indices[ i ] ]++ ] = uint32_t( i / 3 );
+    }
+
+    return adj;
+}
+
+}
+
+bool RTGL1::MeshOptimization::OptimizeTriangleOrder( std::span< uint32_t > indices,
+                                                     uint32_t              vertexCount,
+                                                     uint32_t              cacheSize )
+{
+    if( indices.size() % 3 != 0 || indices.size() < 6 || vertexCount == 0 )
+    {
+        return false;
+    }
+
+    for( uint32_t v : indices )
+    {
+        if( v >= vertexCount )
+        {
+            return false;
+        }
+    }
+
+    const Adjacency adj = MakeAdjacency( indices, vertexCount );
+
+    auto liveTriangles = std::vector< uint32_t >( vertexCount );
+    for( uint32_t v = 0; v < vertexCount; v++ )
+    {
+        liveTriangles[ v ] = adj.offsets[ v + 1 ] - adj.offsets[ v ];
+    }
+
+    auto cacheTime = std::vector< uint32_t >( vertexCount, 0 );
+    auto emitted   = std::vector< bool >( indices.size() / 3, false );
+
+    std::vector< uint32_t > deadEnd;
+    std::vector< uint32_t > candidates;
+    std::vector< uint32_t > result;
+    result.reserve( indices.size() );
+
+    uint32_t time   = cacheSize + 1;
+    uint32_t cursor = 0;
+
+    // next vertex that still has triangles, when there are no good candidates
+    auto skipDeadEnd = [ & ]() -> uint32_t {
+        while( !deadEnd.empty() )
+        {
+            uint32_t d = deadEnd.back();
+            deadEnd.pop_back();
+
+            if( liveTriangles[ d ] > 0 )
+            {
+                return d;
+            }
+        }
+
+        for( ; cursor < vertexCount; cursor++ )
+        {
+            if( liveTriangles[ cursor ] > 0 )
+            {
+                return cursor;
+            }
+        }
+        return NoVertex;
+    };
+
+    for( uint32_t fan = skipDeadEnd(); fan != NoVertex; )
+    {
+        candidates.clear();
+
+        for( uint32_t a = adj.offsets[ fan ]; a < adj.offsets[ fan + 1 ]; a++ )
+        {
+            uint32_t t = adj.triangles[ a ];
+            if( emitted[ t ] )
+            {
+                continue;
+            }
+            emitted[ t ] = true;
+
+            for( uint32_t k = 0; k < 3; k++ )
+            {
+                uint32_t v = indices[ t * 3 + k ];
+
+                result.push_back( v );
+                deadEnd.push_back( v );
+                candidates.push_back( v );
+                liveTriangles[ v ]--;
+
+                // not in the cache
+                if( time - cacheTime[ v ] > cacheSize )
+                {
+                    cacheTime[ v ] = time++;
+                }
+            }
+        }
+
+        // prefer the oldest vertex in the cache, that would still be there after its fan
+        uint32_t best         = NoVertex;
+        int64_t  bestPriority = -1;
+
+        for( uint32_t v : candidates )
+        {
+            if( liveTriangles[ v ] == 0 )
+            {
+                continue;
+            }
+
+            int64_t priority = 0;
+            if( time - cacheTime[ v ] + 2 * liveTriangles[ v ] <= cacheSize )
+            {
+                priority = time - cacheTime[ v ];
+            }
+
+            if( priority > bestPriority )
+            {
+                best         = v;
+                bestPriority = priority;
+            }
+        }
+
+        fan = best != NoVertex ? best : skipDeadEnd();
+    }
+
+    assert( result.size() == indices.size() );
+    std::ranges::copy( result, indices.begin() );
+    return true;
+}
+
+void RTGL1::MeshOptimization::OptimizeVertexOrder( std::span< RgPrimitiveVertex > vertices,
+                                                   std::span< uint32_t >          indices )
+{
+    const auto vertexCount = uint32_t( vertices.size() );
+
+    auto     remap = std::vector< uint32_t >( vertexCount, NoVertex );
+    uint32_t next  = 0;
+
+    for( uint32_t v : indices )
+    {
+        if( v >= vertexCount )
+        {
+            return;
+        }
+
+        if( remap[ v ] == NoVertex )
+        {
+            remap[ v ] = next++;
+        }
+    }
+
+    for( uint32_t& r : remap )
+    {
+        if( r == NoVertex )
+        {
+            r = next++;
+        }
+    }
+    assert( next == vertexCount );
+
+    auto reordered = std::vector< RgPrimitiveVertex >( vertexCount );
+    for( uint32_t v = 0; v < vertexCount; v++ )
+    {
+        reordered[ remap[ v ] ] = vertices[ v ];
+    }
+    std::ranges::copy( reordered, vertices.begin() );
+
+    for( uint32_t& v : indices )
+    {
+        v = remap[ v ];
+    }
+}
+
+void RTGL1::MeshOptimization::Optimize( std::span< RgPrimitiveVertex > vertices,
+                                        std::span< uint32_t >          indices )
+{
+    if( OptimizeTriangleOrder( indices, uint32_t( vertices.size() ) ) )
+    {
+        OptimizeVertexOrder( vertices, indices );
+    }
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Common.h"
+
+#include <span>
+
+namespace RTGL1
+{
+
+// Reordering of triangle lists for a better locality on GPU:
+// post-transform vertex cache for rasterization, and memory access for both raster and BLAS builds
+namespace MeshOptimization
+{
+    // Tipsify: greedy fanning around the vertices that are still in a simulated FIFO cache.
+    // Returns false and keeps the indices as is, if they reference vertices out of range
+    bool OptimizeTriangleOrder( std::span< uint32_t > indices,
+                                uint32_t              vertexCount,
+                                uint32_t              cacheSize = 16 );
+
+    // Place vertices in the order of their first use, and remap the indices.
+    // Unreferenced vertices are moved to the end
+    void OptimizeVertexOrder( std::span< RgPrimitiveVertex > vertices,
+                              std::span< uint32_t >          indices );
+
+    // Both of the above
+    void Optimize( std::span< RgPrimitiveVertex > vertices, std::span< uint32_t > indices );
+}
+
+}
@@ -0,0 +1,580 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MeshSimplification.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+
+constexpr uint32_t NoVertex = UINT32_MAX;
+
+// each pass collapses only the edges that don't share triangles with each other
+constexpr uint32_t MaxPasses = 32;
+
+// cosine of the max angle, by which a triangle's normal can be rotated after a collapse
+constexpr double MinNormalDot = 0.25;
+
+struct Vec3
+{
+    double x, y, z;
+};
+
+Vec3 ToVec3( const float* p )
+{
+    return { p[ 0 ], p[ 1 ], p[ 2 ] };
+}
+
+Vec3 operator+( const Vec3& a, const Vec3& b )
+{
+    return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+Vec3 operator-( const Vec3& a, const Vec3& b )
+{
+    return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+Vec3 operator*( const Vec3& a, double s )
+{
+    return { a.x * s, a.y * s, a.z * s };
+}
+
+Vec3 Cross( const Vec3& a, const Vec3& b )
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+double Dot( const Vec3& a, const Vec3& b )
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Symmetric 4x4 matrix: sum of squared distances to the planes, weighted by triangle areas
+struct Quadric
+{
+    double a00, a01, a02, a03;
+    double a11, a12, a13;
+    double a22, a23;
+    double a33;
+    double weight;
+
+    Quadric& operator+=( const Quadric& o )
+    {
+        a00 += o.a00, a01 += o.a01, a02 += o.a02, a03 += o.a03;
+        a11 += o.a11, a12 += o.a12, a13 += o.a13;
+        a22 += o.a22, a23 += o.a23;
+        a33 += o.a33;
+        weight += o.weight;
+        return *this;
+    }
+};
+
+Quadric MakePlaneQuadric( const Vec3& p0, const Vec3& p1, const Vec3& p2 )
+{
+    Vec3   n   = Cross( p1 - p0, p2 - p0 );
+    double len = std::sqrt( Dot( n, n ) );
+    if( len <= 0.0 )
+    {
+        return {};
+    }
+
+    n = { n.x / len, n.y / len, n.z / len };
+
+    double d = -Dot( n, p0 );
+    double w = len * 0.5;
+
+    return Quadric{
+        .a00    = w * n.x * n.x,
+        .a01    = w * n.x * n.y,
+        .a02    = w * n.x * n.z,
+        .a03    = w * n.x * d,
+        .a11    = w * n.y * n.y,
+        .a12    = w * n.y * n.z,
+        .a13    = w * n.y * d,
+        .a22    = w * n.z * n.z,
+        .a23    = w * n.z * d,
+        .a33    = w * d * d,
+        .weight = w,
+    };
+}
+
+// Area-weighted mean squared distance from 'p' to the planes of the quadric,
+// so it's not a bound of the distance to any of those planes
+double Evaluate( const Quadric& q, const Vec3& p )
+{
+    double r = q.a00 * p.x * p.x + 2 * q.a01 * p.x * p.y + 2 * q.a02 * p.x * p.z +
+               2 * q.a03 * p.x + q.a11 * p.y * p.y + 2 * q.a12 * p.y * p.z + 2 * q.a13 * p.y +
+               q.a22 * p.z * p.z + 2 * q.a23 * p.z + q.a33;
+
+    return q.weight > 0.0 ? std::abs( r ) / q.weight : 0.0;
+}
+
+// Squared distance from 'p' to the triangle 'abc'
+double DistanceToTriangleSq( const Vec3& p, const Vec3& a, const Vec3& b, const Vec3& c )
+{
+    const Vec3 ab = b - a, ac = c - a, ap = p - a;
+
+    double d1 = Dot( ab, ap ), d2 = Dot( ac, ap );
+    if( d1 <= 0.0 && d2 <= 0.0 )
+    {
+        return Dot( ap, ap );
+    }
+
+    const Vec3 bp = p - b;
+    double     d3 = Dot( ab, bp ), d4 = Dot( ac, bp );
+    if( d3 >= 0.0 && d4 <= d3 )
+    {
+        return Dot( bp, bp );
+    }
+
+    const Vec3 cp = p - c;
+    double     d5 = Dot( ab, cp ), d6 = Dot( ac, cp );
+    if( d6 >= 0.0 && d5 <= d6 )
+    {
+        return Dot( cp, cp );
+    }
+
+    Vec3 closest;
+
+    double vc = d1 * d4 - d3 * d2;
+    double vb = d5 * d2 - d1 * d6;
+    double va = d3 * d6 - d5 * d4;
+
+    if( vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0 )
+    {
+        closest = a + ab * ( d1 / ( d1 - d3 ) );
+    }
+    else if( vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0 )
+    {
+        closest = a + ac * ( d2 / ( d2 - d6 ) );
+    }
+    else if( va <= 0.0 && ( d4 - d3 ) >= 0.0 && ( d5 - d6 ) >= 0.0 )
+    {
+        closest = b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+    }
+    else
+    {
+        double denom = va + vb + vc;
+        closest      = denom != 0.0 ? a + ab * ( vb / denom ) + ac * ( vc / denom ) : a;
+    }
+
+    const Vec3 delta = p - closest;
+    return Dot( delta, delta );
+}
+
+// Vertices with the same position get the same id, so attribute seams are not torn apart
+std::vector< uint32_t > WeldByPosition( std::span< const RgPrimitiveVertex > vertices )
+{
+    const auto vertexCount = uint32_t( vertices.size() );
+
+    auto order = std::vector< uint32_t >( vertexCount );
+    std::iota( order.begin(), order.end(), 0 );
+
+    auto positionLess = [ &vertices ]( uint32_t a, uint32_t b ) {
+        return std::lexicographical_compare( std::begin( vertices[ a ].position ),
+                                             std::end( vertices[ a ].position ),
+                                             std::begin( vertices[ b ].position ),
+                                             std::end( vertices[ b ].position ) );
+    };
+    std::ranges::sort( order, positionLess );
+
+    auto welded = std::vector< uint32_t >( vertexCount );
+    for( uint32_t i = 0; i < vertexCount; i++ )
+    {
+        bool samePosition = i > 0 && !positionLess( order[ i - 1 ], order[ i ] );
+
+        welded[ order[ i ] ] = samePosition ? welded[ order[ i - 1 ] ] : order[ i ];
+    }
+    return welded;
+}
+
+bool IsDegenerate( const uint32_t* tri, const std::vector< uint32_t >& welded )
+{
+    return welded[ tri[ 0 ] ] == welded[ tri[ 1 ] ] || welded[ tri[ 1 ] ] == welded[ tri[ 2 ] ] ||
+           welded[ tri[ 2 ] ] == welded[ tri[ 0 ] ];
+}
+
+// Seam vertices, and the ones on the edges that don't have exactly two triangles
+std::vector< bool > FindLockedVertices( std::span< const uint32_t >    indices,
+                                        const std::vector< uint32_t >& welded )
+{
+    auto locked = std::vector< bool >( welded.size(), false );
+
+    for( uint32_t v = 0; v < welded.size(); v++ )
+    {
+        if( welded[ v ] != v )
+        {
+            locked[ v ]            = true;
+            locked[ welded[ v ] ] = true;
+        }
+    }
+
+    std::vector< std::pair< uint32_t, uint32_t > > edges;
+    edges.reserve( indices.size() );
+
+    for( size_t t = 0; t < indices.size(); t += 3 )
+    {
+        for( size_t k = 0; k < 3; k++ )
+        {
+            uint32_t a = welded[ indices[ t + k ] ];
+            uint32_t b = welded[ indices[ t + ( k + 1 ) % 3 ] ];
+            edges.emplace_back( std::min( a, b ), std::max( a, b ) );
+        }
+    }
+    std::ranges::sort( edges );
+
+    for( size_t i = 0; i < edges.size(); )
+    {
+        size_t j = i + 1;
+        while( j < edges.size() && edges[ j ] == edges[ i ] )
+        {
+            j++;
+        }
+
+        if( j - i != 2 )
+        {
+            locked[ edges[ i ].first ]  = true;
+            locked[ edges[ i ].second ] = true;
+        }
+        i = j;
+    }
+
+    return locked;
+}
+
+struct Adjacency
+{
+    // triangles of vertex 'v' are in [offsets[v], offsets[v+1])
+    std::vector< uint32_t > offsets;
+    std::vector< uint32_t > triangles;
+};
+
+Adjacency MakeAdjacency( std::span< const uint32_t > indices, uint32_t vertexCount )
+{
+    Adjacency adj = {
+        .offsets   = std::vector< uint32_t >( vertexCount + 1, 0 ),
+        .triangles = std::vector< uint32_t >( indices.size() ),
+    };
+
+    for( uint32_t v : indices )
+    {
+        adj.offsets[ v + 1 ]++;
+    }
+    for( uint32_t v = 0; v < vertexCount; v++ )
+    {
+        adj.offsets[ v + 1 ] += adj.offsets[ v ];
+    }
+
+    auto cursor = std::vector< uint32_t >( adj.offsets.begin(), adj.offsets.end() - 1 );
+    for( size_t i = 0; i < indices.size(); i++ )
+    {
+        adj.triangles[ cursor[ indices[ i ] ]++ ] = uint32_t( i / 3 );
+    }
+
+    return adj;
+}
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    double   error;
+};
+
+}
+
+auto RTGL1::MeshSimplification::Simplify( std::span< const RgPrimitiveVertex > vertices,
+                                          std::span< const uint32_t >          srcIndices,
+                                          float                                targetRatio,
+                                          float                                maxError ) -> Result
+{
+    const auto vertexCount = uint32_t( vertices.size() );
+
+    if( srcIndices.size() % 3 != 0 || srcIndices.empty() || vertexCount == 0 )
+    {
+        return {};
+    }
+
+    for( uint32_t v : srcIndices )
+    {
+        if( v >= vertexCount )
+        {
+            return {};
+        }
+    }
+
+    auto positions = std::vector< Vec3 >( vertexCount );
+    Vec3 boundsMin = ToVec3( vertices[ 0 ].position );
+    Vec3 boundsMax = boundsMin;
+
+    for( uint32_t v = 0; v < vertexCount; v++ )
+    {
+        const Vec3& p = positions[ v ] = ToVec3( vertices[ v ].position );
+
+        boundsMin = { std::min( boundsMin.x, p.x ),
+                      std::min( boundsMin.y, p.y ),
+                      std::min( boundsMin.z, p.z ) };
+        boundsMax = { std::max( boundsMax.x, p.x ),
+                      std::max( boundsMax.y, p.y ),
+                      std::max( boundsMax.z, p.z ) };
+    }
+
+    const Vec3   extent     = boundsMax - boundsMin;
+    const double maxErrorSq = Dot( extent, extent ) * double( maxError ) * double( maxError );
+
+    const std::vector< uint32_t > welded = WeldByPosition( vertices );
+
+    auto indices = std::vector< uint32_t >();
+    indices.reserve( srcIndices.size() );
+
+    for( size_t t = 0; t < srcIndices.size(); t += 3 )
+    {
+        if( !IsDegenerate( &srcIndices[ t ], welded ) )
+        {
+            indices.insert( indices.end(), &srcIndices[ t ], &srcIndices[ t ] + 3 );
+        }
+    }
+
+    const std::vector< bool > locked = FindLockedVertices( indices, welded );
+
+    // quadrics are accumulated by welded ids, so seam vertices share the same one
+    auto quadrics = std::vector< Quadric >( vertexCount, Quadric{} );
+
+    for( size_t t = 0; t < indices.size(); t += 3 )
+    {
+        Quadric q = MakePlaneQuadric( positions[ indices[ t + 0 ] ],
+                                      positions[ indices[ t + 1 ] ],
+                                      positions[ indices[ t + 2 ] ] );
+
+        for( size_t k = 0; k < 3; k++ )
+        {
+            quadrics[ welded[ indices[ t + k ] ] ] += q;
+        }
+    }
+
+    const size_t srcTriangleCount = indices.size() / 3;
+    const size_t targetTriangleCount =
+        std::max< size_t >( 1, size_t( double( srcTriangleCount ) * targetRatio ) );
+
+    std::vector< Collapse > candidates;
+    std::vector< bool >     touched;
+
+    // the vertex, into which each of the original ones was collapsed
+    auto collapsedTo = std::vector< uint32_t >( vertexCount );
+    std::iota( collapsedTo.begin(), collapsedTo.end(), 0 );
+
+    for( uint32_t pass = 0; pass < MaxPasses; pass++ )
+    {
+        size_t triangleCount = indices.size() / 3;
+        if( triangleCount <= targetTriangleCount )
+        {
+            break;
+        }
+
+        const Adjacency adj = MakeAdjacency( indices, vertexCount );
+
+        candidates.clear();
+        for( size_t t = 0; t < indices.size(); t += 3 )
+        {
+            for( size_t k = 0; k < 3; k++ )
+            {
+                uint32_t a = indices[ t + k ];
+                uint32_t b = indices[ t + ( k + 1 ) % 3 ];
+
+                for( auto [ from, to ] : { std::pair{ a, b }, std::pair{ b, a } } )
+                {
+                    if( locked[ from ] )
+                    {
+                        continue;
+                    }
+
+                    Quadric q = quadrics[ welded[ from ] ];
+                    q += quadrics[ welded[ to ] ];
+
+                    double error = Evaluate( q, positions[ to ] );
+                    if( error <= maxErrorSq )
+                    {
+                        candidates.push_back( { .from = from, .to = to, .error = error } );
+                    }
+                }
+            }
+        }
+
+        std::ranges::sort( candidates, {}, &Collapse::error );
+
+        auto remap = std::vector< uint32_t >( vertexCount );
+        std::iota( remap.begin(), remap.end(), 0 );
+
+        touched.assign( vertexCount, false );
+
+        size_t removed = 0;
+
+        for( const Collapse& c : candidates )
+        {
+            if( touched[ c.from ] || touched[ c.to ] )
+            {
+                continue;
+            }
+
+            auto fromTriangles = std::span( adj.triangles )
+                                     .subspan( adj.offsets[ c.from ],
+                                               adj.offsets[ c.from + 1 ] - adj.offsets[ c.from ] );
+
+            // reject, if any of the remaining triangles would flip
+            size_t collapsedTriangles = 0;
+            bool   flips              = false;
+
+            for( uint32_t t : fromTriangles )
+            {
+                const uint32_t* tri = &indices[ size_t( t ) * 3 ];
+
+                if( welded[ tri[ 0 ] ] == welded[ c.to ] || welded[ tri[ 1 ] ] == welded[ c.to ] ||
+                    welded[ tri[ 2 ] ] == welded[ c.to ] )
+                {
+                    collapsedTriangles++;
+                    continue;
+                }
+
+                Vec3 p[ 3 ], moved[ 3 ];
+                for( uint32_t k = 0; k < 3; k++ )
+                {
+                    p[ k ]     = positions[ tri[ k ] ];
+                    moved[ k ] = tri[ k ] == c.from ? positions[ c.to ] : p[ k ];
+                }
+
+                Vec3 n0 = Cross( p[ 1 ] - p[ 0 ], p[ 2 ] - p[ 0 ] );
+                Vec3 n1 = Cross( moved[ 1 ] - moved[ 0 ], moved[ 2 ] - moved[ 0 ] );
+
+                if( Dot( n0, n1 ) <= MinNormalDot * std::sqrt( Dot( n0, n0 ) * Dot( n1, n1 ) ) )
+                {
+                    flips = true;
+                    break;
+                }
+            }
+
+            if( flips )
+            {
+                continue;
+            }
+
+            remap[ c.from ] = c.to;
+            quadrics[ welded[ c.to ] ] += quadrics[ welded[ c.from ] ];
+
+            // neighbors' triangles are changed, so they are not considered until the next pass
+            for( uint32_t t : fromTriangles )
+            {
+                for( uint32_t k = 0; k < 3; k++ )
+                {
+                    touched[ indices[ size_t( t ) * 3 + k ] ] = true;
+                }
+            }
+
+            removed += collapsedTriangles;
+            if( triangleCount - std::min( removed, triangleCount ) <= targetTriangleCount )
+            {
+                break;
+            }
+        }
+
+        if( removed == 0 )
+        {
+            break;
+        }
+
+        for( uint32_t& to : collapsedTo )
+        {
+            to = remap[ to ];
+        }
+
+        size_t dst = 0;
+        for( size_t t = 0; t < indices.size(); t += 3 )
+        {
+            uint32_t tri[] = {
+                remap[ indices[ t + 0 ] ],
+                remap[ indices[ t + 1 ] ],
+                remap[ indices[ t + 2 ] ],
+            };
+
+            if( !IsDegenerate( tri, welded ) )
+            {
+                std::ranges::copy( tri, &indices[ dst ] );
+                dst += 3;
+            }
+        }
+        indices.resize( dst );
+    }
+
+    if( indices.empty() || indices.size() >= srcIndices.size() )
+    {
+        return {};
+    }
+
+    // kept vertices are not moved, so the surfaces differ the most at the removed ones:
+    // measure the distance from each of them to the triangles around its collapse target
+    double maxDeviationSq = 0.0;
+    {
+        const Adjacency adj = MakeAdjacency( indices, vertexCount );
+
+        for( uint32_t v = 0; v < vertexCount; v++ )
+        {
+            const uint32_t to = collapsedTo[ v ];
+            if( to == v || adj.offsets[ to ] == adj.offsets[ to + 1 ] )
+            {
+                continue;
+            }
+
+            double nearestSq = std::numeric_limits< double >::max();
+            for( uint32_t i = adj.offsets[ to ]; i < adj.offsets[ to + 1 ]; i++ )
+            {
+                const uint32_t* tri = &indices[ size_t( adj.triangles[ i ] ) * 3 ];
+
+                nearestSq = std::min( nearestSq,
+                                      DistanceToTriangleSq( positions[ v ],
+                                                            positions[ tri[ 0 ] ],
+                                                            positions[ tri[ 1 ] ],
+                                                            positions[ tri[ 2 ] ] ) );
+            }
+            maxDeviationSq = std::max( maxDeviationSq, nearestSq );
+        }
+    }
+
+    // keep only the referenced vertices, in the order of their first use
+    Result result;
+    result.maxDeviation = float( std::sqrt( maxDeviationSq ) );
+    result.indices      = std::move( indices );
+
+    auto newIndex = std::vector< uint32_t >( vertexCount, NoVertex );
+    for( uint32_t& v : result.indices )
+    {
+        if( newIndex[ v ] == NoVertex )
+        {
+            newIndex[ v ] = uint32_t( result.vertices.size() );
+            result.vertices.push_back( vertices[ v ] );
+        }
+        v = newIndex[ v ];
+    }
+
+    return result;
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+
+#include <span>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Quadric error metrics simplification of triangle lists, for coarse levels of detail
+namespace MeshSimplification
+{
+    struct Result
+    {
+        std::vector< RgPrimitiveVertex > vertices;
+        std::vector< uint32_t >          indices;
+        // Max distance from the removed vertices to the simplified surface
+        float                            maxDeviation = 0.0f;
+    };
+
+    // Collapse edges, until the triangle count is 'targetRatio' of the original,
+    // or until the next collapse would move the surface by more than 'maxError' on average
+    // (relative to the size of the mesh). Vertices on borders and attribute seams are never
+    // removed, and the kept ones are not modified, so texture coordinates stay valid.
+    // Empty, if the mesh can't be simplified
+    Result Simplify( std::span< const RgPrimitiveVertex > vertices,
+                     std::span< const uint32_t >          indices,
+                     float                                targetRatio,
+                     float                                maxError );
+}
+
+}
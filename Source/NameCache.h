@@ -0,0 +1,99 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Direct-mapped cache of lookups by a C string. The same names usually come with the same
+// pointers every frame, so a hit costs only a pointer hash and a string compare, instead of
+// hashing the string and probing a hash map. Keys are compared by content, so buffers that
+// are reused for different names are safe.
+template< typename T, uint32_t Size = 1024 >
+class NameCache
+{
+    static_assert( std::has_single_bit( Size ) && Size > 1 );
+
+public:
+    NameCache() : entries( Size ) {}
+
+    // Must be called, if a value returned by the lookup function might be outdated
+    void Clear()
+    {
+        generation++;
+
+        // on a wrap, old entries could become valid again
+        if( generation == 0 )
+        {
+            for( Entry& e : entries )
+            {
+                e.generation = 0;
+            }
+            generation = 1;
+        }
+    }
+
+    template< typename LookupFunc >
+    T Find( const char* name, LookupFunc&& lookup )
+    {
+        Entry& e = entries[ ToIndex( name ) ];
+
+        if( e.generation == generation && e.ptr == name && e.key == name )
+        {
+            return e.value;
+        }
+
+        e.ptr        = name;
+        e.generation = generation;
+        e.key.assign( name );
+        e.value = lookup( std::string_view( e.key ) );
+
+        return e.value;
+    }
+
+private:
+    static uint32_t ToIndex( const char* ptr )
+    {
+        constexpr int shift = 64 - std::countr_zero( Size );
+        return uint32_t( ( uint64_t( uintptr_t( ptr ) ) * 0x9E3779B97F4A7C15ull ) >> shift );
+    }
+
+private:
+    struct Entry
+    {
+        const char* ptr{ nullptr };
+        uint32_t    generation{ 0 };
+        std::string key{};
+        T           value{};
+    };
+
+    std::vector< Entry > entries;
+    uint32_t             generation{ 1 };
+};
+
+}
@@ -200,6 +200,51 @@ RgResult rgUploadMeshPrimitive( RgInstance instance, const RgMeshInfo* pMesh, co
     return Call( instance, &RTGL1::VulkanDevice::UploadMeshPrimitive, pMesh, pPrimitive );
 }
 
+RgResult rgUploadMeshPrimitives( RgInstance instance, uint32_t meshCount, const RgMeshInfo* pMeshes, const uint32_t* pPrimitiveCounts, const RgMeshPrimitiveInfo* pPrimitives )
+{
+    return Call( instance, &RTGL1::VulkanDevice::UploadMeshPrimitives, meshCount, pMeshes, pPrimitiveCounts, pPrimitives );
+}
+
+RgResult rgCreateMesh( RgInstance instance, const RgMeshCreateInfo* pInfo, RgMesh* pResult )
+{
+    if( pResult == nullptr )
+    {
+        return RG_RESULT_WRONG_FUNCTION_ARGUMENT;
+    }
+    *pResult = RG_NULL_HANDLE;
+
+    // mesh data is kept on CPU, so it's created even if the device is suspended
+    try
+    {
+        *pResult = GetDevice( instance ).CreateMesh( pInfo );
+    }
+    catch( RTGL1::RgException& e )
+    {
+        RTGL1::debug::Error( e.what() );
+        return e.GetErrorCode();
+    }
+    return RG_RESULT_SUCCESS;
+}
+
+RgResult rgDrawMeshInstance( RgInstance instance, RgMesh mesh, const RgMeshInstanceInfo* pInfo )
+{
+    return Call( instance, &RTGL1::VulkanDevice::DrawMeshInstance, mesh, pInfo );
+}
+
+RgResult rgDestroyMesh( RgInstance instance, RgMesh mesh )
+{
+    try
+    {
+        GetDevice( instance ).DestroyMesh( mesh );
+    }
+    catch( RTGL1::RgException& e )
+    {
+        RTGL1::debug::Error( e.what() );
+        return e.GetErrorCode();
+    }
+    return RG_RESULT_SUCCESS;
+}
+
 RgResult rgUploadNonWorldPrimitive( RgInstance instance, const RgMeshPrimitiveInfo* pPrimitive, const float* pViewProjection, const RgViewport* pViewport )
 {
     return Call( instance, &RTGL1::VulkanDevice::UploadNonWorldPrimitive, pPrimitive, pViewProjection, pViewport );
@@ -250,6 +295,12 @@ RgResult rgMarkOriginalTextureAsDeleted( RgInstance instance, const char* pTextu
     return Call( instance, &RTGL1::VulkanDevice::MarkOriginalTextureAsDeleted, pTextureName );
 }
 
+RgResult rgUpdateOriginalTextureRegion( RgInstance                         instance,
+                                        const RgOriginalTextureRegionInfo* pInfo )
+{
+    return Call( instance, &RTGL1::VulkanDevice::UpdateOriginalTextureRegion, pInfo );
+}
+
 RgResult rgStartFrame( RgInstance instance, const RgStartFrameInfo* pInfo )
 {
     return Call( instance, &RTGL1::VulkanDevice::StartFrame, pInfo );
@@ -132,6 +132,7 @@ RTGL1::RayTracingPipeline::RayTracingPipeline( VkDevice
         ShaderStageInfo{ "RMissShadow",         std::nullopt },
         ShaderStageInfo{ "RClsOpaque",          std::nullopt },
         ShaderStageInfo{ "RAlphaTest",          std::nullopt },
+        ShaderStageInfo{ "RCoarseLod",          std::nullopt },
     };
     // clang-format on
 
@@ -170,6 +171,8 @@ RTGL1::RayTracingPipeline::RayTracingPipeline( VkDevice
     AddHitGroup( toIndex( "RClsOpaque" ) );             assert( hitGroupCount - 1 == SBT_INDEX_HITGROUP_FULLY_OPAQUE );
     // alpha tested and then opaque
     AddHitGroup( toIndex( "RClsOpaque" ), toIndex( "RAlphaTest" ) ); assert( hitGroupCount - 1 == SBT_INDEX_HITGROUP_ALPHA_TESTED );
+    // coarse level of detail, its hits near the ray origin are skipped
+    AddHitGroup( toIndex( "RClsOpaque" ), toIndex( "RCoarseLod" ) ); assert( hitGroupCount - 1 == SBT_INDEX_HITGROUP_COARSE_LOD );
 
     CreatePipeline( &_shaderManager );
     CreateSBT();
@@ -0,0 +1,164 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RetainedMeshes.h"
+
+#include "RgException.h"
+#include "Utils.h"
+
+#include <type_traits>
+
+namespace
+{
+
+RgMesh ToHandle( uint64_t id )
+{
+    if constexpr( std::is_pointer_v< RgMesh > )
+    {
+        return reinterpret_cast< RgMesh >( static_cast< uintptr_t >( id ) );
+    }
+    else
+    {
+        return RgMesh( id );
+    }
+}
+
+uint64_t FromHandle( RgMesh handle )
+{
+    if constexpr( std::is_pointer_v< RgMesh > )
+    {
+        return static_cast< uint64_t >( reinterpret_cast< uintptr_t >( handle ) );
+    }
+    else
+    {
+        return uint64_t( handle );
+    }
+}
+
+template< typename T >
+std::vector< T > CopyArray( const T* src, uint32_t count )
+{
+    return src ? std::vector< T >( src, src + count ) : std::vector< T >{};
+}
+
+const char* KeepNull( const std::string& str, const char* original )
+{
+    return original ? str.c_str() : nullptr;
+}
+
+// 'dst' must be at its final location, as pointers to its fields are stored
+void CopyPrimitive( const RgMeshPrimitiveInfo& src, RTGL1::RetainedMeshes::Primitive& dst )
+{
+    dst.primitiveName = RTGL1::Utils::SafeCstr( src.pPrimitiveNameInMesh );
+    dst.textureName   = RTGL1::Utils::SafeCstr( src.pTextureName );
+    dst.vertices      = CopyArray( src.pVertices, src.vertexCount );
+    dst.indices       = CopyArray( src.pIndices, src.indexCount );
+
+    dst.info                      = src;
+    dst.info.pPrimitiveNameInMesh = KeepNull( dst.primitiveName, src.pPrimitiveNameInMesh );
+    dst.info.pTextureName         = KeepNull( dst.textureName, src.pTextureName );
+    dst.info.pVertices            = dst.vertices.empty() ? nullptr : dst.vertices.data();
+    dst.info.vertexCount          = uint32_t( dst.vertices.size() );
+    dst.info.pIndices             = dst.indices.empty() ? nullptr : dst.indices.data();
+    dst.info.indexCount           = uint32_t( dst.indices.size() );
+    dst.info.pEditorInfo          = nullptr;
+
+    if( !src.pEditorInfo )
+    {
+        return;
+    }
+
+    dst.editor = *src.pEditorInfo;
+
+    const RgBool32 layerExists[] = {
+        dst.editor.layer1Exists,
+        dst.editor.layer2Exists,
+        dst.editor.layer3Exists,
+    };
+    RgEditorTextureLayerInfo* layers[] = {
+        &dst.editor.layer1,
+        &dst.editor.layer2,
+        &dst.editor.layer3,
+    };
+
+    for( uint32_t i = 0; i < std::size( layers ); i++ )
+    {
+        if( !layerExists[ i ] )
+        {
+            continue;
+        }
+
+        RgEditorTextureLayerInfo& l = *layers[ i ];
+
+        dst.layerTexCoords[ i ]    = CopyArray( l.pTexCoord, src.vertexCount );
+        dst.layerTextureNames[ i ] = RTGL1::Utils::SafeCstr( l.pTextureName );
+
+        l.pTexCoord    = dst.layerTexCoords[ i ].empty() ? nullptr : dst.layerTexCoords[ i ].data();
+        l.pTextureName = KeepNull( dst.layerTextureNames[ i ], l.pTextureName );
+    }
+
+    dst.info.pEditorInfo = &dst.editor;
+}
+
+}
+
+RgMesh RTGL1::RetainedMeshes::Create( const RgMeshCreateInfo& info )
+{
+    if( info.primitiveCount > 0 && info.pPrimitives == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Primitives are null" );
+    }
+
+    auto mesh  = std::make_unique< Mesh >();
+    mesh->name = Utils::SafeCstr( info.pMeshName );
+
+    // allocate once, so the pointers to the primitives' fields stay valid
+    mesh->primitives.resize( info.primitiveCount );
+    for( uint32_t i = 0; i < info.primitiveCount; i++ )
+    {
+        CopyPrimitive( info.pPrimitives[ i ], mesh->primitives[ i ] );
+        mesh->primitives[ i ].id = ++lastPrimitiveID;
+    }
+
+    uint64_t id = ++lastID;
+    meshes.emplace( id, std::move( mesh ) );
+    version++;
+
+    return ToHandle( id );
+}
+
+bool RTGL1::RetainedMeshes::Destroy( RgMesh handle )
+{
+    // vertex collectors copy the data to their staging buffers,
+    // so the memory is not referenced after this call
+    if( meshes.erase( FromHandle( handle ) ) == 0 )
+    {
+        return false;
+    }
+
+    version++;
+    return true;
+}
+
+auto RTGL1::RetainedMeshes::Find( RgMesh handle ) const -> const Mesh*
+{
+    auto found = meshes.find( FromHandle( handle ) );
+    return found != meshes.end() ? found->second.get() : nullptr;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "Containers.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Meshes created by rgCreateMesh. All data is copied on creation, so the application
+// doesn't need to keep it, and only the instance info is passed on each frame.
+// Dynamic vertex collectors keep the vertex data of these meshes on the device (see
+// VertexCollector::SetRetained), so an instance costs only a transform and a geometry info.
+class RetainedMeshes
+{
+public:
+    struct Primitive
+    {
+        // unique among all primitives of all meshes, never reused
+        uint64_t            id;
+        // pointers reference the fields below
+        RgMeshPrimitiveInfo info;
+        RgEditorInfo        editor;
+
+        std::string                      primitiveName;
+        std::string                      textureName;
+        std::vector< RgPrimitiveVertex > vertices;
+        std::vector< uint32_t >          indices;
+        std::vector< RgFloat2D >         layerTexCoords[ 3 ];
+        std::string                      layerTextureNames[ 3 ];
+    };
+
+    struct Mesh
+    {
+        std::string              name;
+        std::vector< Primitive > primitives;
+    };
+
+public:
+    RgMesh Create( const RgMeshCreateInfo& info );
+    bool   Destroy( RgMesh handle );
+
+    // Null, if the handle is not valid
+    const Mesh* Find( RgMesh handle ) const;
+
+    // Changed on any Create / Destroy
+    uint64_t GetVersion() const { return version; }
+
+    // Primitives are enumerated in the same order, while the version is the same
+    template< typename Func >
+    void ForEachPrimitive( Func&& func ) const
+    {
+        for( const auto& [ id, mesh ] : meshes )
+        {
+            for( const Primitive& p : mesh->primitives )
+            {
+                func( p.id, p.info );
+            }
+        }
+    }
+
+private:
+    rgl::unordered_map< uint64_t, std::unique_ptr< Mesh > > meshes;
+    uint64_t                                                lastID{ 0 };
+    uint64_t                                                lastPrimitiveID{ 0 };
+    uint64_t                                                version{ 0 };
+};
+
+}
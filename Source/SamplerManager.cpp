@@ -20,6 +20,8 @@
 
 #include "SamplerManager.h"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 #include "RgException.h"
@@ -176,6 +178,24 @@ namespace
         assert( i != 0 );
         return i;
     }
+
+    // DLSS / FSR2 biases are in [-3, 0], so small steps are enough to be unnoticeable
+    constexpr float    MipLodBiasStep      = 0.25f;
+    constexpr float    MipLodBiasMin       = -4.0f;
+    constexpr float    MipLodBiasMax       = 2.0f;
+    constexpr uint32_t MipLodBiasBankCount =
+        uint32_t( ( MipLodBiasMax - MipLodBiasMin ) / MipLodBiasStep ) + 1;
+
+    uint32_t ToBankIndex( float mipLodBias )
+    {
+        float b = std::round( ( mipLodBias - MipLodBiasMin ) / MipLodBiasStep );
+        return uint32_t( std::clamp( b, 0.0f, float( MipLodBiasBankCount - 1 ) ) );
+    }
+
+    float FromBankIndex( uint32_t bank )
+    {
+        return MipLodBiasMin + float( bank ) * MipLodBiasStep;
+    }
 }
 }
 
@@ -184,35 +204,31 @@ RTGL1::SamplerManager::SamplerManager( VkDevice _device,
                                        uint32_t _anisotropy,
                                        bool     _forceMinificationFilterLinear )
     : device( _device )
-    , mipLodBias( 0.0f )
+    , banks( MipLodBiasBankCount )
+    , currentBank( ToBankIndex( 0.0f ) )
     , anisotropy( _anisotropy )
     , forceMinificationFilterLinear( _forceMinificationFilterLinear )
 {
-    CreateAllSamplers( anisotropy, mipLodBias );
+    CreateAllSamplers( banks[ currentBank ], anisotropy, FromBankIndex( currentBank ) );
 }
 
 RTGL1::SamplerManager::~SamplerManager()
 {
-    for( auto& p : samplers )
+    for( auto& bank : banks )
     {
-        vkDestroySampler( device, p.second, nullptr );
-    }
-
-    for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-    {
-        for( VkSampler s : samplersToDelete[ i ] )
+        for( auto& p : bank )
         {
-            vkDestroySampler( device, s, nullptr );
+            vkDestroySampler( device, p.second, nullptr );
         }
-
-        samplersToDelete[ i ].clear();
-    };
-    samplers.clear();
+    }
+    banks.clear();
 }
 
-void RTGL1::SamplerManager::CreateAllSamplers( uint32_t _anisotropy, float _mipLodBias )
+void RTGL1::SamplerManager::CreateAllSamplers( Bank&    target,
+                                               uint32_t _anisotropy,
+                                               float    _mipLodBias )
 {
-    assert( samplers.empty() );
+    assert( target.empty() );
     assert( _anisotropy == 0 || _anisotropy == 2 || _anisotropy == 4 || _anisotropy == 8 ||
             _anisotropy == 16 );
 
@@ -257,38 +273,20 @@ void RTGL1::SamplerManager::CreateAllSamplers( uint32_t _anisotropy, float _mipL
                 VkResult r = vkCreateSampler( device, &info, nullptr, &sampler );
                 VK_CHECKERROR( r );
 
-                assert( samplers.find( index ) == samplers.end() );
+                assert( target.find( index ) == target.end() );
 
-                samplers[ index ] = sampler;
+                target[ index ] = sampler;
             }
         }
     }
 }
 
-void RTGL1::SamplerManager::AddAllSamplersToDestroy( uint32_t frameIndex )
-{
-    for( auto& p : samplers )
-    {
-        samplersToDelete[ frameIndex ].push_back( p.second );
-    }
-
-    samplers.clear();
-}
-
-void RTGL1::SamplerManager::PrepareForFrame( uint32_t frameIndex )
-{
-    for( VkSampler s : samplersToDelete[ frameIndex ] )
-    {
-        vkDestroySampler( device, s, nullptr );
-    }
-
-    samplersToDelete[ frameIndex ].clear();
-}
-
 VkSampler RTGL1::SamplerManager::GetSampler( RgSamplerFilter      filter,
                                              RgSamplerAddressMode addressModeU,
                                              RgSamplerAddressMode addressModeV ) const
 {
+    const Bank& samplers = banks[ currentBank ];
+
     auto f = samplers.find( ToIndex( filter, addressModeU, addressModeV ) );
 
     if( f == samplers.end() )
@@ -303,8 +301,17 @@ VkSampler RTGL1::SamplerManager::GetSampler( RgSamplerFilter      filter,
 }
 
 VkSampler RTGL1::SamplerManager::GetSampler( const Handle& handle ) const
+{
+    return GetSampler( handle, currentBank );
+}
+
+VkSampler RTGL1::SamplerManager::GetSampler( const Handle& handle, uint32_t bank ) const
 {
     assert( handle.internalIndex != 0 );
+    assert( bank < banks.size() && !banks[ bank ].empty() );
+
+    const Bank& samplers = banks[ bank ];
+
     auto f = samplers.find( handle.internalIndex );
 
     if( f == samplers.end() )
@@ -317,19 +324,22 @@ VkSampler RTGL1::SamplerManager::GetSampler( const Handle& handle ) const
     return f->second;
 }
 
-bool RTGL1::SamplerManager::TryChangeMipLodBias( uint32_t frameIndex, float newMipLodBias )
+bool RTGL1::SamplerManager::TryChangeMipLodBias( float newMipLodBias )
 {
-    constexpr float delta = 0.025f;
+    uint32_t newBank = ToBankIndex( newMipLodBias );
 
-    if( std::abs( newMipLodBias - mipLodBias ) < delta )
+    if( newBank == currentBank )
     {
         return false;
     }
 
-    AddAllSamplersToDestroy( frameIndex );
-    CreateAllSamplers( anisotropy, newMipLodBias );
+    // samplers of the previous bank are kept, as they still can be referenced by descriptors
+    if( banks[ newBank ].empty() )
+    {
+        CreateAllSamplers( banks[ newBank ], anisotropy, FromBankIndex( newBank ) );
+    }
 
-    mipLodBias = newMipLodBias;
+    currentBank = newBank;
     return true;
 }
 
@@ -50,6 +50,12 @@ public:
 
         bool SetIfHasDynamicSamplerFilter( RgSamplerFilter newDynamicSamplerFilter );
 
+        // Stable only until SetIfHasDynamicSamplerFilter is called
+        uint64_t GetHash() const
+        {
+            return uint64_t( internalIndex ) | ( uint64_t( hasDynamicSamplerFilter ) << 32 );
+        }
+
     private:
         uint32_t internalIndex;
         bool     hasDynamicSamplerFilter;
@@ -64,33 +70,35 @@ public:
     SamplerManager& operator=( const SamplerManager& other )     = delete;
     SamplerManager& operator=( SamplerManager&& other ) noexcept = delete;
 
-    void PrepareForFrame( uint32_t frameIndex );
-
     VkSampler GetSampler( RgSamplerFilter      filter,
                           RgSamplerAddressMode addressModeU,
                           RgSamplerAddressMode addressModeV ) const;
 
-    // In case, if mip load bias was updated and a fresh sampler is required
+    // Sampler from the currently selected mip lod bias bank
     VkSampler GetSampler( const Handle& handle ) const;
+    VkSampler GetSampler( const Handle& handle, uint32_t bank ) const;
 
-    // Wait idle and recreate all the samplers with new lod bias
-    bool TryChangeMipLodBias( uint32_t frameIndex, float newMipLodBias );
+    // Mip lod bias is quantized, each step has its own set of samplers that is created once,
+    // so changing the bias only selects another bank. Returns true, if the bank was changed
+    bool     TryChangeMipLodBias( float newMipLodBias );
+    uint32_t GetMipLodBiasBank() const { return currentBank; }
 
     static std::pair< RgSamplerAddressMode, RgSamplerAddressMode > AccessAddressModes(
         const Handle& handle );
 
 private:
-    void CreateAllSamplers( uint32_t anisotropy, float mipLodBias );
-    void AddAllSamplersToDestroy( uint32_t frameIndex );
+    using Bank = rgl::unordered_map< uint32_t, VkSampler >;
+
+    void CreateAllSamplers( Bank& target, uint32_t anisotropy, float mipLodBias );
 
 private:
     VkDevice device;
 
-    rgl::unordered_map< uint32_t, VkSampler > samplers;
-    std::vector< VkSampler >                  samplersToDelete[ MAX_FRAMES_IN_FLIGHT ];
-    float                                     mipLodBias;
-    uint32_t                                  anisotropy;
-    bool                                      forceMinificationFilterLinear;
+    // index is a quantized mip lod bias, empty if a bank wasn't requested yet
+    std::vector< Bank > banks;
+    uint32_t            currentBank;
+    uint32_t            anisotropy;
+    bool                forceMinificationFilterLinear;
 };
 
 }
\ No newline at end of file
@@ -25,9 +25,45 @@
 #include "GltfImporter.h"
 #include "RgException.h"
 #include "UniqueID.h"
+#include "Utils.h"
 
 #include "Generated/ShaderCommonC.h"
 
+namespace
+{
+
+// Local deviation of a coarse LOD, scaled by the transform to world units
+float ToWorldDeviation( const RgMeshInfo& mesh, float localDeviation )
+{
+    const auto& m     = mesh.transform.matrix;
+    float       scale = 0.0f;
+    for( int c = 0; c < 3; c++ )
+    {
+        const float column[] = { m[ 0 ][ c ], m[ 1 ][ c ], m[ 2 ][ c ] };
+        scale                = std::max( scale, RTGL1::Utils::Length( column ) );
+    }
+
+    return localDeviation * scale;
+}
+
+// Static vertex data can be shared, if it's preprocessed in the same way
+std::optional< uint64_t > MakeStaticDataID( std::optional< uint64_t > dataHash,
+                                            RgMeshPrimitiveFlags      flags,
+                                            RTGL1::GeometryLod        lod )
+{
+    if( !dataHash )
+    {
+        return std::nullopt;
+    }
+
+    uint64_t id = *dataHash;
+    RTGL1::Utils::HashCombine( id, flags );
+    RTGL1::Utils::HashCombine( id, lod == RTGL1::GeometryLod::Coarse );
+    return id;
+}
+
+}
+
 RTGL1::Scene::Scene( VkDevice                                _device,
                      const PhysicalDevice&                   _physDevice,
                      std::shared_ptr< MemoryAllocator >&     _allocator,
@@ -55,9 +91,10 @@ RTGL1::Scene::Scene( VkDevice                                _device,
         std::make_shared< VertexPreprocessing >( _device, _uniform, *asManager, _shaderManager );
 }
 
-void RTGL1::Scene::PrepareForFrame( VkCommandBuffer cmd,
-                                    uint32_t        frameIndex,
-                                    bool            _ignoreExternalGeometry )
+void RTGL1::Scene::PrepareForFrame( VkCommandBuffer       cmd,
+                                    uint32_t              frameIndex,
+                                    bool                  _ignoreExternalGeometry,
+                                    const RetainedMeshes& retainedMeshes )
 {
     assert( !makingDynamic );
     assert( !makingStatic );
@@ -65,7 +102,7 @@ void RTGL1::Scene::PrepareForFrame( VkCommandBuffer cmd,
 
     geomInfoMgr->PrepareForFrame( frameIndex );
 
-    makingDynamic = asManager->BeginDynamicGeometry( cmd, frameIndex );
+    makingDynamic = asManager->BeginDynamicGeometry( cmd, frameIndex, retainedMeshes );
     dynamicUniqueIDs.clear();
 }
 
@@ -107,7 +144,10 @@ RTGL1::UploadResult RTGL1::Scene::UploadPrimitive( uint32_t                   fr
                                                    const RgMeshInfo&          mesh,
                                                    const RgMeshPrimitiveInfo& primitive,
                                                    const TextureManager&      textureManager,
-                                                   bool                       isStatic )
+                                                   bool                       isStatic,
+                                                   const RgMeshPrimitiveInfo* coarseLod,
+                                                   float                      coarseLodMaxDeviation,
+                                                   std::optional< uint64_t >  retainedPrimitiveID )
 {
     uint64_t uniqueID = UniqueID::MakeForPrimitive( mesh, primitive );
 
@@ -133,8 +173,41 @@ RTGL1::UploadResult RTGL1::Scene::UploadPrimitive( uint32_t                   fr
         return UploadResult::Fail;
     }
 
-    if( !asManager->AddMeshPrimitive(
-            frameIndex, mesh, primitive, uniqueID, isStatic, textureManager, *geomInfoMgr ) )
+    bool useLod = isStatic && coarseLod &&
+                  VertexCollectorFilterTypeFlags_IsLodApplicable(
+                      VertexCollectorFilterTypeFlags_GetForGeometry( mesh, primitive, isStatic ) );
+
+    // coarse is added first: if it fails, the original is still visible for all rays;
+    // it's not a separate primitive for the scene, so the same unique ID is used
+    if( useLod )
+    {
+        useLod = asManager->AddMeshPrimitive( frameIndex,
+                                              mesh,
+                                              *coarseLod,
+                                              uniqueID,
+                                              isStatic,
+                                              textureManager,
+                                              *geomInfoMgr,
+                                              GeometryLod::Coarse,
+                                              ToWorldDeviation( mesh, coarseLodMaxDeviation ),
+                                              MakeStaticDataID( retainedPrimitiveID,
+                                                                coarseLod->flags,
+                                                                GeometryLod::Coarse ) );
+    }
+
+    if( !asManager->AddMeshPrimitive( frameIndex,
+                                      mesh,
+                                      primitive,
+                                      uniqueID,
+                                      isStatic,
+                                      textureManager,
+                                      *geomInfoMgr,
+                                      useLod ? GeometryLod::Detail : GeometryLod::None,
+                                      0.0f,
+                                      isStatic ? MakeStaticDataID( retainedPrimitiveID,
+                                                                   primitive.flags,
+                                                                   GeometryLod::None )
+                                               : retainedPrimitiveID ) )
     {
         return UploadResult::Fail;
     }
@@ -144,6 +217,13 @@ RTGL1::UploadResult RTGL1::Scene::UploadPrimitive( uint32_t                   fr
                : ( mesh.isExportable ? UploadResult::ExportableDynamic : UploadResult::Dynamic );
 }
 
+void RTGL1::Scene::ReserveDynamic( size_t count )
+{
+    // robin_hood tables are a power of two in size, so a reserve per batch grows them
+    // geometrically, and rehashes only when the size is crossed
+    dynamicUniqueIDs.reserve( dynamicUniqueIDs.size() + count );
+}
+
 RTGL1::UploadResult RTGL1::Scene::UploadLight( uint32_t               frameIndex,
                                                const GenericLightPtr& light,
                                                LightManager*          lightManager,
@@ -188,30 +268,13 @@ void RTGL1::Scene::SubmitStaticLights( uint32_t          frameIndex,
                                        bool              isUnderwater,
                                        RgColor4DPacked32 underwaterColor ) const
 {
-    for( const GenericLight& l : staticLights )
-    {
-        std::visit(
-            [ & ]< typename T >( const T& specific ) {
-
-                // SHIPPING HACK - BEGIN: tint sun if underwater
-                if constexpr( std::is_same_v< RgDirectionalLightUploadInfo, T > )
-                {
-                    if( isUnderwater )
-                    {
-                        RgDirectionalLightUploadInfo tinted = specific;
-
-                        tinted.color = underwaterColor;
-
-                        lightManager.Add( frameIndex, tinted );
-                        return;
-                    }
-                }
-                // SHIPPING HACK - END
-
-                lightManager.Add( frameIndex, specific );
-            },
-            l );
-    }
+    // static lights are encoded again only if the list was changed
+    lightManager.SubmitStaticLights( frameIndex,
+                                     staticLights,
+                                     staticLightsVersion,
+                                     // SHIPPING HACK: tint sun if underwater
+                                     isUnderwater ? std::optional( underwaterColor )
+                                                  : std::nullopt );
 }
 
 bool RTGL1::Scene::InsertPrimitiveInfo( uint64_t                   uniqueID,
@@ -222,7 +285,9 @@ bool RTGL1::Scene::InsertPrimitiveInfo( uint64_t                   uniqueID,
     if( isStatic )
     {
         assert( !Utils::IsCstrEmpty( mesh.pMeshName ) );
-        if( !Utils::IsCstrEmpty( mesh.pMeshName ) )
+        // a mesh consists of many primitives, so avoid constructing a string for each
+        if( !Utils::IsCstrEmpty( mesh.pMeshName ) &&
+            !staticMeshNames.contains( std::string_view( mesh.pMeshName ) ) )
         {
             staticMeshNames.emplace( mesh.pMeshName );
         }
@@ -286,6 +351,7 @@ bool RTGL1::Scene::InsertLightInfo( bool isStatic, const GenericLightPtr& light
         std::visit(
             [ this ]( auto&& specific ) { return this->staticLights.push_back( *specific ); },
             light );
+        staticLightsVersion++;
         return true;
     }
     else
@@ -294,32 +360,57 @@ bool RTGL1::Scene::InsertLightInfo( bool isStatic, const GenericLightPtr& light
     }
 }
 
-void RTGL1::Scene::NewScene( VkCommandBuffer           cmd,
-                             uint32_t                  frameIndex,
+void RTGL1::Scene::NewScene( uint32_t                  frameIndex,
                              const GltfImporter&       staticScene,
                              TextureManager&           textureManager,
-                             const TextureMetaManager& textureMeta )
+                             const TextureMetaManager& textureMeta,
+                             bool                      allowKeepingGeometry )
 {
-    staticUniqueIDs.clear();
-    staticMeshNames.clear();
+    // static geometry holds texture indices of the original materials too,
+    // so it can be kept only on a reimport of the same map
+    const auto geometry     = staticScene ? staticScene.DescribeStaticGeometry( textureMeta )
+                                          : GltfImporter::StaticGeometryInfo{};
+    const bool keepGeometry = allowKeepingGeometry && staticGeometryHash == geometry.hash;
+
+    if( !keepGeometry )
+    {
+        staticUniqueIDs.clear();
+        staticMeshNames.clear();
+    }
     staticLights.clear();
+    staticLightsVersion++;
 
-    textureManager.FreeAllImportedMaterials( frameIndex );
+    // unchanged imported materials are kept, so their texture indices stay the same
+    textureManager.BeginImportedMaterials( frameIndex );
 
     assert( !makingStatic );
-    makingStatic = asManager->BeginStaticGeometry();
+    if( !keepGeometry )
+    {
+        // on a reimport, only the vertex data of the changed primitives is copied
+        makingStatic = asManager->BeginStaticGeometry(
+            allowKeepingGeometry, geometry.vertexCount, geometry.indexCount );
+    }
 
     if( staticScene )
     {
-        staticScene.UploadToScene( cmd, frameIndex, *this, textureManager, textureMeta );
+        staticScene.UploadToScene( frameIndex, *this, textureManager, textureMeta, !keepGeometry );
     }
     else
     {
         debug::Info( "New scene is empty" );
     }
 
+    textureManager.EndImportedMaterials( frameIndex );
+
+    if( keepGeometry )
+    {
+        debug::Info( "Static geometry is unchanged, only lights and materials were updated" );
+        return;
+    }
+
     debug::Info( "Rebuilding static geometry. Waiting device idle..." );
     asManager->SubmitStaticGeometry( makingStatic );
+    staticGeometryHash = geometry.hash;
 
     debug::Info( "Static geometry was rebuilt" );
 }
@@ -365,7 +456,7 @@ bool RTGL1::Scene::StaticMeshExists( const RgMeshInfo& mesh ) const
 
     // TODO: actually, need to consider RgMeshInfo::uniqueObjectID,
     // as there might be different instances of the same mesh
-    return staticMeshNames.contains( std::string( mesh.pMeshName ) );
+    return staticMeshNames.contains( std::string_view( mesh.pMeshName ) );
 }
 
 bool RTGL1::Scene::StaticLightExists( const GenericLightPtr& light ) const
@@ -377,11 +468,15 @@ bool RTGL1::Scene::StaticLightExists( const GenericLightPtr& light ) const
 }
 
 
-RTGL1::SceneImportExport::SceneImportExport( std::filesystem::path _scenesFolder,
-                                             const RgFloat3D&      _worldUp,
-                                             const RgFloat3D&      _worldForward,
-                                             const float&          _worldScale )
+RTGL1::SceneImportExport::SceneImportExport( std::filesystem::path         _scenesFolder,
+                                             const RgFloat3D&              _worldUp,
+                                             const RgFloat3D&              _worldForward,
+                                             const float&                  _worldScale,
+                                             bool                          _optimizeMeshes,
+                                             std::shared_ptr< ThreadPool > _threadPool )
     : scenesFolder( std::move( _scenesFolder ) )
+    , threadPool( std::move( _threadPool ) )
+    , optimizeMeshes( _optimizeMeshes )
     , worldUp( Utils::SafeNormalize( _worldUp, { 0, 1, 0 } ) )
     , worldForward( Utils::SafeNormalize( _worldForward, { 0, 0, 1 } ) )
     , worldScale( std::max( 0.0f, _worldScale ) )
@@ -392,13 +487,13 @@ void RTGL1::SceneImportExport::PrepareForFrame()
 {
     if( exportRequested )
     {
-        exporter        = std::make_unique< GltfExporter >( MakeWorldTransform(), GetWorldScale() );
+        exporter = std::make_unique< GltfExporter >(
+            MakeWorldTransform(), GetWorldScale(), optimizeMeshes, threadPool );
         exportRequested = false;
     }
 }
 
 void RTGL1::SceneImportExport::CheckForNewScene( std::string_view    mapName,
-                                                 VkCommandBuffer     cmd,
                                                  uint32_t            frameIndex,
                                                  Scene&              scene,
                                                  TextureManager&     textureManager,
@@ -409,16 +504,28 @@ void RTGL1::SceneImportExport::CheckForNewScene( std::string_view    mapName,
         reimportRequested = false;
         debug::Verbose( "Starting new scene..." );
 
+        const bool isSameMap = currentMap == mapName;
+
+        if( !isSameMap )
+        {
+            textureManager.BeginMapPrefetch(
+                mapName.empty() ? std::filesystem::path()
+                                : MakeGltfPath( mapName ).replace_extension( ".prefetch.json" ) );
+        }
+
         currentMap = mapName;
 
         // before importer, as it relies on texture properties
         textureMeta.RereadFromFiles( GetImportMapName() );
 
         {
-            auto staticScene = GltfImporter(
-                MakeGltfPath( GetImportMapName() ), MakeWorldTransform(), GetWorldScale() );
+            auto staticScene = GltfImporter( MakeImportPath( GetImportMapName() ),
+                                             MakeWorldTransform(),
+                                             GetWorldScale(),
+                                             optimizeMeshes,
+                                             threadPool );
 
-            scene.NewScene( cmd, frameIndex, staticScene, textureManager, textureMeta );
+            scene.NewScene( frameIndex, staticScene, textureManager, textureMeta, isSameMap );
         }
         debug::Verbose( "New scene is ready" );
     }
@@ -428,7 +535,7 @@ void RTGL1::SceneImportExport::TryExport( TextureManager& textureManager )
 {
     if( exporter )
     {
-        exporter->ExportToFiles( MakeGltfPath( GetExportMapName() ), textureManager );
+        exporter->ExportToFiles( MakeExportPath( GetExportMapName() ), textureManager );
         exporter.reset();
     }
 }
@@ -440,7 +547,7 @@ void RTGL1::SceneImportExport::RequestReimport()
 
 void RTGL1::SceneImportExport::OnFileChanged( FileType type, const std::filesystem::path& filepath )
 {
-    if( type == FileType::GLTF && filepath == MakeGltfPath( GetImportMapName() ) )
+    if( type == FileType::GLTF && filepath == MakeImportPath( GetImportMapName() ) )
     {
         debug::Info( "Hot-reloading GLTF..." );
         RequestReimport();
@@ -523,6 +630,28 @@ std::filesystem::path RTGL1::SceneImportExport::MakeGltfPath( std::string_view m
     return scenesFolder / exportName / ( exportName + ".gltf" );
 }
 
+std::filesystem::path RTGL1::SceneImportExport::MakeImportPath( std::string_view mapName )
+{
+    auto glbPath = MakeGltfPath( mapName ).replace_extension( ".glb" );
+
+    std::error_code ec;
+    if( std::filesystem::exists( glbPath, ec ) )
+    {
+        return glbPath;
+    }
+    return MakeGltfPath( mapName );
+}
+
+std::filesystem::path RTGL1::SceneImportExport::MakeExportPath( std::string_view mapName )
+{
+    auto path = MakeGltfPath( mapName );
+    if( dev.exportAsGlb )
+    {
+        path.replace_extension( ".glb" );
+    }
+    return path;
+}
+
 void RTGL1::SceneImportExport::RequestExport()
 {
     exportRequested = true;
@@ -24,6 +24,7 @@
 #include "GltfExporter.h"
 #include "GltfImporter.h"
 #include "LightManager.h"
+#include "RetainedMeshes.h"
 #include "VertexPreprocessing.h"
 #include "TextureMeta.h"
 
@@ -60,7 +61,10 @@ public:
     Scene& operator=( const Scene& other )     = delete;
     Scene& operator=( Scene&& other ) noexcept = delete;
 
-    void PrepareForFrame( VkCommandBuffer cmd, uint32_t frameIndex, bool ignoreExternalGeometry );
+    void PrepareForFrame( VkCommandBuffer       cmd,
+                          uint32_t              frameIndex,
+                          bool                  ignoreExternalGeometry,
+                          const RetainedMeshes& retainedMeshes );
     void SubmitForFrame( VkCommandBuffer                         cmd,
                          uint32_t                                frameIndex,
                          const std::shared_ptr< GlobalUniform >& uniform,
@@ -68,11 +72,22 @@ public:
                          bool                                    allowGeometryWithSkyFlag,
                          bool                                    disableRTGeometry );
 
+    // 'coarseLod' is a simplified version of the static primitive,
+    // it's used instead of the original one by distant indirect and shadow rays;
+    // 'coarseLodMaxDeviation' is how far it is from the original, in the mesh's local units;
+    // 'retainedPrimitiveID' is set, if the primitive belongs to a retained mesh;
+    // for a static primitive, it's a hash of its vertex data, to reuse it if it's unchanged
     UploadResult UploadPrimitive( uint32_t                   frameIndex,
                                   const RgMeshInfo&          mesh,
                                   const RgMeshPrimitiveInfo& primitive,
                                   const TextureManager&      textureManager,
-                                  bool                       isStatic );
+                                  bool                       isStatic,
+                                  const RgMeshPrimitiveInfo* coarseLod             = nullptr,
+                                  float                      coarseLodMaxDeviation = 0.0f,
+                                  std::optional< uint64_t >  retainedPrimitiveID   = std::nullopt );
+
+    // Prepare for 'count' more dynamic primitives in this frame
+    void ReserveDynamic( size_t count );
 
     UploadResult UploadLight( uint32_t               frameIndex,
                               const GenericLightPtr& light,
@@ -84,11 +99,11 @@ public:
                              bool              isUnderwater,
                              RgColor4DPacked32 underwaterColor ) const;
 
-    void NewScene( VkCommandBuffer           cmd,
-                   uint32_t                  frameIndex,
+    void NewScene( uint32_t                  frameIndex,
                    const GltfImporter&       staticScene,
                    TextureManager&           textureManager,
-                   const TextureMetaManager& textureMeta );
+                   const TextureMetaManager& textureMeta,
+                   bool                      allowKeepingGeometry );
 
     const std::shared_ptr< ASManager >&           GetASManager();
     const std::shared_ptr< VertexPreprocessing >& GetVertexPreprocessing();
@@ -115,8 +130,12 @@ private:
     // Dynamic indices are cleared every frame
     rgl::unordered_set< uint64_t >    dynamicUniqueIDs;
     rgl::unordered_set< uint64_t >    staticUniqueIDs;
-    rgl::unordered_set< std::string > staticMeshNames;
+    rgl::string_set                   staticMeshNames;
     std::vector< GenericLight >       staticLights;
+    // Changed on any modification of staticLights
+    uint64_t                          staticLightsVersion{ 0 };
+    // To skip the static geometry rebuild, if a reimported scene has the same geometry
+    std::optional< uint64_t >         staticGeometryHash;
 
     StaticGeometryToken  makingStatic{};
     DynamicGeometryToken makingDynamic{};
@@ -128,10 +147,12 @@ private:
 class SceneImportExport : public IFileDependency
 {
 public:
-    SceneImportExport( std::filesystem::path _scenesFolder,
-                       const RgFloat3D&      _worldUp,
-                       const RgFloat3D&      _worldForward,
-                       const float&          _worldScale );
+    SceneImportExport( std::filesystem::path         _scenesFolder,
+                       const RgFloat3D&              _worldUp,
+                       const RgFloat3D&              _worldForward,
+                       const float&                  _worldScale,
+                       bool                          _optimizeMeshes,
+                       std::shared_ptr< ThreadPool > _threadPool );
     ~SceneImportExport() override = default;
 
     SceneImportExport( const SceneImportExport& other )                = delete;
@@ -141,7 +162,6 @@ public:
 
     void PrepareForFrame();
     void CheckForNewScene( std::string_view    mapName,
-                           VkCommandBuffer     cmd,
                            uint32_t            frameIndex,
                            Scene&              scene,
                            TextureManager&     textureManager,
@@ -162,10 +182,15 @@ public:
     float            GetWorldScale() const;
 
     std::filesystem::path MakeGltfPath( std::string_view mapName );
+    // .glb, if it exists, otherwise .gltf
+    std::filesystem::path MakeImportPath( std::string_view mapName );
+    std::filesystem::path MakeExportPath( std::string_view mapName );
     RgTransform           MakeWorldTransform() const;
 
 private:
-    std::filesystem::path scenesFolder;
+    std::filesystem::path         scenesFolder;
+    std::shared_ptr< ThreadPool > threadPool;
+    bool                          optimizeMeshes;
 
     bool reimportRequested{ false };
 
@@ -194,6 +219,7 @@ public:
 
         DevField importName;
         DevField exportName;
+        bool     exportAsGlb{ false };
 
         struct
         {
@@ -0,0 +1,474 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "SceneCache.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+
+constexpr uint32_t SceneCacheMagic   = 0x4E435352; // RSCN
+constexpr uint32_t SceneCacheVersion = 5;
+
+constexpr size_t SectionAlignment = 16;
+
+enum SectionIndex : uint32_t
+{
+    SectionDependencies,
+    SectionMaterials,
+    SectionPrimitives,
+    SectionLights,
+    SectionVertices,
+    SectionIndices,
+    SectionStrings,
+    SectionCount,
+};
+
+struct SectionInfo
+{
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct SceneCacheHeader
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    key;
+    SectionInfo sections[ SectionCount ];
+};
+
+std::optional< std::vector< uint8_t > > ReadWholeFile( const std::filesystem::path& path )
+{
+    std::ifstream file( path, std::ios::binary | std::ios::ate );
+    if( !file.is_open() )
+    {
+        return std::nullopt;
+    }
+
+    auto size = file.tellg();
+    if( size <= 0 )
+    {
+        return std::nullopt;
+    }
+
+    auto bytes = std::vector< uint8_t >( size_t( size ) );
+
+    file.seekg( 0 );
+    if( !file.read( reinterpret_cast< char* >( bytes.data() ), size ) )
+    {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+// the hashes are stored in the cache file, so they must be the same on all platforms
+uint64_t HashBytes( std::span< const uint8_t > bytes )
+{
+    return RTGL1::Utils::HashFnv1a( bytes.data(), bytes.size() );
+}
+
+template< typename T >
+    requires( std::is_trivially_copyable_v< T > )
+void HashValue( uint64_t& hash, const T& v )
+{
+    hash = RTGL1::Utils::HashFnv1a( &v, sizeof( v ), hash );
+}
+
+size_t AlignUp( size_t v )
+{
+    return ( v + SectionAlignment - 1 ) / SectionAlignment * SectionAlignment;
+}
+
+template< typename T >
+std::span< const uint8_t > AsBytes( const T& container )
+{
+    return { reinterpret_cast< const uint8_t* >( std::data( container ) ),
+             std::size( container ) * sizeof( *std::data( container ) ) };
+}
+
+}
+
+template< typename T >
+std::span< const T > RTGL1::SceneCache::Section( uint32_t index ) const
+{
+    SceneCacheHeader header;
+    memcpy( &header, bytes.data(), sizeof( header ) );
+
+    const SectionInfo& s = header.sections[ index ];
+    return std::span( reinterpret_cast< const T* >( bytes.data() + s.offset ), size_t( s.count ) );
+}
+
+RTGL1::SceneCache::StringRef RTGL1::SceneCache::Writer::AddString( std::string_view str )
+{
+    auto ref = StringRef{
+        .offset = uint32_t( strings.size() ),
+        .size   = uint32_t( str.size() ),
+    };
+
+    strings.append( str );
+    strings.push_back( '\0' );
+
+    return ref;
+}
+
+bool RTGL1::SceneCache::Writer::AddDependency( const std::filesystem::path& path,
+                                               std::string_view             relativePath )
+{
+    auto hash = HashFile( path );
+    if( !hash )
+    {
+        return false;
+    }
+
+    dependencies.push_back( Dependency{
+        .path = AddString( relativePath ),
+        .hash = *hash,
+    } );
+    return true;
+}
+
+uint32_t RTGL1::SceneCache::Writer::AddMaterial( const Material& material )
+{
+    materials.push_back( material );
+    return uint32_t( materials.size() - 1 );
+}
+
+void RTGL1::SceneCache::Writer::AddPrimitive( Primitive                            primitive,
+                                              std::span< const RgPrimitiveVertex > vs,
+                                              std::span< const uint32_t >          is,
+                                              std::span< const RgPrimitiveVertex > lodVs,
+                                              std::span< const uint32_t >          lodIs )
+{
+    primitive.vertexCount = uint32_t( vs.size() );
+    primitive.indexCount  = uint32_t( is.size() );
+    primitive.firstVertex = vertices.size();
+    primitive.firstIndex  = indices.size();
+
+    vertices.insert( vertices.end(), vs.begin(), vs.end() );
+    indices.insert( indices.end(), is.begin(), is.end() );
+
+    primitive.lodVertexCount = uint32_t( lodVs.size() );
+    primitive.lodIndexCount  = uint32_t( lodIs.size() );
+    primitive.lodFirstVertex = vertices.size();
+    primitive.lodFirstIndex  = indices.size();
+
+    vertices.insert( vertices.end(), lodVs.begin(), lodVs.end() );
+    indices.insert( indices.end(), lodIs.begin(), lodIs.end() );
+
+    primitives.push_back( primitive );
+}
+
+void RTGL1::SceneCache::Writer::AddLight( const Light& light )
+{
+    lights.push_back( light );
+}
+
+std::vector< uint8_t > RTGL1::SceneCache::Writer::Finish( uint64_t key )
+{
+    const std::span< const uint8_t > sources[] = {
+        AsBytes( dependencies ), AsBytes( materials ), AsBytes( primitives ), AsBytes( lights ),
+        AsBytes( vertices ),     AsBytes( indices ),   AsBytes( strings ),
+    };
+    const size_t counts[] = {
+        dependencies.size(), materials.size(), primitives.size(), lights.size(),
+        vertices.size(),     indices.size(),   strings.size(),
+    };
+    static_assert( std::size( sources ) == SectionCount );
+    static_assert( std::size( counts ) == SectionCount );
+
+    SceneCacheHeader header = {
+        .magic    = SceneCacheMagic,
+        .version  = SceneCacheVersion,
+        .key      = key,
+        .sections = {},
+    };
+
+    size_t size = AlignUp( sizeof( header ) );
+    for( uint32_t i = 0; i < SectionCount; i++ )
+    {
+        header.sections[ i ] = { .offset = size, .count = counts[ i ] };
+        size                 = AlignUp( size + sources[ i ].size() );
+    }
+
+    auto result = std::vector< uint8_t >( size );
+
+    memcpy( result.data(), &header, sizeof( header ) );
+    for( uint32_t i = 0; i < SectionCount; i++ )
+    {
+        if( !sources[ i ].empty() )
+        {
+            memcpy( &result[ header.sections[ i ].offset ],
+                    sources[ i ].data(),
+                    sources[ i ].size() );
+        }
+    }
+
+    *this = {};
+    return result;
+}
+
+std::optional< RTGL1::SceneCache > RTGL1::SceneCache::Load( const std::filesystem::path& cachePath,
+                                                            const std::filesystem::path& gltfFolder,
+                                                            uint64_t                     key )
+{
+    auto bytes = ReadWholeFile( cachePath );
+    if( !bytes )
+    {
+        return std::nullopt;
+    }
+
+    auto cache = FromBytes( std::move( *bytes ), key );
+    if( !cache )
+    {
+        debug::Verbose( "{}: Scene cache is outdated or invalid, ignoring", cachePath.string() );
+        return std::nullopt;
+    }
+
+    // .bin files might be changed without touching the .gltf
+    for( const Dependency& d : cache->Section< Dependency >( SectionDependencies ) )
+    {
+        auto path = gltfFolder / cache->GetString( d.path );
+
+        if( HashFile( path ) != d.hash )
+        {
+            debug::Verbose( "{}: Scene cache is outdated, as {} was changed",
+                            cachePath.string(),
+                            path.string() );
+            return std::nullopt;
+        }
+    }
+
+    return cache;
+}
+
+std::optional< RTGL1::SceneCache > RTGL1::SceneCache::FromBytes( std::vector< uint8_t > bytes,
+                                                                 uint64_t               key )
+{
+    SceneCache cache;
+    cache.bytes = std::move( bytes );
+
+    if( !cache.IsValid() )
+    {
+        return std::nullopt;
+    }
+
+    SceneCacheHeader header;
+    memcpy( &header, cache.bytes.data(), sizeof( header ) );
+
+    if( header.key != key )
+    {
+        return std::nullopt;
+    }
+
+    return cache;
+}
+
+bool RTGL1::SceneCache::Save( const std::filesystem::path& cachePath,
+                              std::span< const uint8_t >   bytes )
+{
+    // write to a temporary file first, so a crash won't leave a broken cache
+    auto tempPath = std::filesystem::path( cachePath ).concat( ".tmp" );
+    {
+        std::ofstream file( tempPath, std::ios::binary | std::ios::trunc );
+        if( !file.is_open() )
+        {
+            return false;
+        }
+
+        if( !file.write( reinterpret_cast< const char* >( bytes.data() ),
+                         std::streamsize( bytes.size() ) ) )
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename( tempPath, cachePath, ec );
+    if( ec )
+    {
+        std::filesystem::remove( tempPath, ec );
+        return false;
+    }
+    return true;
+}
+
+std::optional< uint64_t > RTGL1::SceneCache::MakeKey( const std::filesystem::path& gltfPath,
+                                                      const RgTransform&           worldTransform,
+                                                      float oneGameUnitInMeters,
+                                                      bool  optimizeMeshes )
+{
+    auto gltfHash = HashFile( gltfPath );
+    if( !gltfHash )
+    {
+        return std::nullopt;
+    }
+
+    uint64_t key = *gltfHash;
+    HashValue( key, SceneCacheVersion );
+    HashValue( key, oneGameUnitInMeters );
+    HashValue( key, uint8_t( optimizeMeshes ) );
+    HashValue( key, worldTransform.matrix );
+    return key;
+}
+
+std::optional< uint64_t > RTGL1::SceneCache::HashFile( const std::filesystem::path& path )
+{
+    if( auto bytes = ReadWholeFile( path ) )
+    {
+        return HashBytes( *bytes );
+    }
+    return std::nullopt;
+}
+
+bool RTGL1::SceneCache::IsValid() const
+{
+    SceneCacheHeader header;
+
+    if( bytes.size() < sizeof( header ) )
+    {
+        return false;
+    }
+    memcpy( &header, bytes.data(), sizeof( header ) );
+
+    if( header.magic != SceneCacheMagic || header.version != SceneCacheVersion )
+    {
+        return false;
+    }
+
+    const size_t elementSizes[] = {
+        sizeof( Dependency ),        sizeof( Material ), sizeof( Primitive ), sizeof( Light ),
+        sizeof( RgPrimitiveVertex ), sizeof( uint32_t ), sizeof( char ),
+    };
+    static_assert( std::size( elementSizes ) == SectionCount );
+
+    for( uint32_t i = 0; i < SectionCount; i++ )
+    {
+        const SectionInfo& s = header.sections[ i ];
+
+        if( s.offset % SectionAlignment != 0 || s.offset > bytes.size() ||
+            s.count > ( bytes.size() - s.offset ) / elementSizes[ i ] )
+        {
+            return false;
+        }
+    }
+
+    // strings must be null-terminated, and ranges must be inside the sections
+    const uint64_t stringsSize = header.sections[ SectionStrings ].count;
+    const auto     isStringOk  = [ & ]( const StringRef& r ) {
+        return uint64_t( r.offset ) + r.size < stringsSize &&
+               bytes[ header.sections[ SectionStrings ].offset + r.offset + r.size ] == '\0';
+    };
+
+    for( const Dependency& d : Section< Dependency >( SectionDependencies ) )
+    {
+        if( !isStringOk( d.path ) )
+        {
+            return false;
+        }
+    }
+
+    for( const Material& m : Section< Material >( SectionMaterials ) )
+    {
+        if( !isStringOk( m.name ) || !std::ranges::all_of( m.paths, isStringOk ) )
+        {
+            return false;
+        }
+    }
+
+    const uint64_t materialCount = header.sections[ SectionMaterials ].count;
+
+    for( const Primitive& p : Section< Primitive >( SectionPrimitives ) )
+    {
+        if( !isStringOk( p.meshName ) ||
+            ( p.material != NoMaterial && p.material >= materialCount ) ||
+            p.firstVertex + p.vertexCount > header.sections[ SectionVertices ].count ||
+            p.firstIndex + p.indexCount > header.sections[ SectionIndices ].count ||
+            p.lodFirstVertex + p.lodVertexCount > header.sections[ SectionVertices ].count ||
+            p.lodFirstIndex + p.lodIndexCount > header.sections[ SectionIndices ].count )
+        {
+            return false;
+        }
+    }
+
+    for( const Light& l : Section< Light >( SectionLights ) )
+    {
+        if( l.type != Light::Directional && l.type != Light::Spherical && l.type != Light::Spot )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto RTGL1::SceneCache::GetMaterials() const -> std::span< const Material >
+{
+    return Section< Material >( SectionMaterials );
+}
+
+auto RTGL1::SceneCache::GetPrimitives() const -> std::span< const Primitive >
+{
+    return Section< Primitive >( SectionPrimitives );
+}
+
+auto RTGL1::SceneCache::GetLights() const -> std::span< const Light >
+{
+    return Section< Light >( SectionLights );
+}
+
+auto RTGL1::SceneCache::GetVertices( const Primitive& primitive ) const
+    -> std::span< const RgPrimitiveVertex >
+{
+    return Section< RgPrimitiveVertex >( SectionVertices )
+        .subspan( primitive.firstVertex, primitive.vertexCount );
+}
+
+auto RTGL1::SceneCache::GetIndices( const Primitive& primitive ) const
+    -> std::span< const uint32_t >
+{
+    return Section< uint32_t >( SectionIndices )
+        .subspan( primitive.firstIndex, primitive.indexCount );
+}
+
+auto RTGL1::SceneCache::GetLodVertices( const Primitive& primitive ) const
+    -> std::span< const RgPrimitiveVertex >
+{
+    return Section< RgPrimitiveVertex >( SectionVertices )
+        .subspan( primitive.lodFirstVertex, primitive.lodVertexCount );
+}
+
+auto RTGL1::SceneCache::GetLodIndices( const Primitive& primitive ) const
+    -> std::span< const uint32_t >
+{
+    return Section< uint32_t >( SectionIndices )
+        .subspan( primitive.lodFirstIndex, primitive.lodIndexCount );
+}
+
+const char* RTGL1::SceneCache::GetString( StringRef ref ) const
+{
+    return Section< char >( SectionStrings ).data() + ref.offset;
+}
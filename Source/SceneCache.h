@@ -0,0 +1,184 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Common.h"
+#include "Const.h"
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Compiled static scene: vertices, indices, primitive, material and light tables of
+// an imported glTF in one flat file, so the next loads don't need to parse it again.
+// Materials and texture meta are applied on upload, so only the glTF data is stored.
+class SceneCache
+{
+public:
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    // A file that the glTF references, e.g. a .bin buffer
+    struct Dependency
+    {
+        StringRef path;
+        uint64_t  hash;
+    };
+
+    static constexpr uint32_t NoMaterial = UINT32_MAX;
+
+    struct Material
+    {
+        // explicit name of the base color image, empty if none
+        StringRef name;
+        // relative to the glTF folder, empty if none
+        StringRef paths[ TEXTURES_PER_MATERIAL_COUNT ];
+        uint32_t  filters[ TEXTURES_PER_MATERIAL_COUNT ];
+        uint32_t  addressModesU[ TEXTURES_PER_MATERIAL_COUNT ];
+        uint32_t  addressModesV[ TEXTURES_PER_MATERIAL_COUNT ];
+        uint32_t  pbrSwizzling;
+    };
+
+    struct Primitive
+    {
+        StringRef   meshName;
+        uint32_t    uniqueObjectID;
+        uint32_t    primitiveIndex;
+        RgTransform transform;
+        // before texture meta is applied
+        uint32_t    flags;
+        // from glTF extras, applied after texture meta
+        uint32_t    extraFlags;
+        // index in the material table, or NoMaterial
+        uint32_t    material;
+        uint32_t    color;
+        float       emissive;
+        float       metallicFactor;
+        float       roughnessFactor;
+        uint32_t    vertexCount;
+        uint32_t    indexCount;
+        uint64_t    firstVertex;
+        uint64_t    firstIndex;
+        // simplified geometry for distant rays, zero counts if none
+        uint32_t    lodVertexCount;
+        uint32_t    lodIndexCount;
+        uint64_t    lodFirstVertex;
+        uint64_t    lodFirstIndex;
+        // how far the simplified surface is from the original, in local units
+        float       lodMaxDeviation;
+        // FNV-1a of the vertex data of both versions, to find unchanged ones on reimport
+        uint64_t    dataHash;
+    };
+
+    struct Light
+    {
+        enum Type : uint32_t
+        {
+            Directional,
+            Spherical,
+            Spot,
+        };
+
+        Type type;
+        union
+        {
+            RgDirectionalLightUploadInfo directional;
+            RgSphericalLightUploadInfo   spherical;
+            RgSpotLightUploadInfo        spot;
+        };
+    };
+
+    class Writer
+    {
+    public:
+        StringRef AddString( std::string_view str );
+        bool      AddDependency( const std::filesystem::path& path, std::string_view relativePath );
+        uint32_t  AddMaterial( const Material& material );
+        void      AddPrimitive( Primitive                            primitive,
+                                std::span< const RgPrimitiveVertex > vertices,
+                                std::span< const uint32_t >          indices,
+                                std::span< const RgPrimitiveVertex > lodVertices = {},
+                                std::span< const uint32_t >          lodIndices  = {} );
+        void      AddLight( const Light& light );
+
+        // Move everything into a file image
+        std::vector< uint8_t > Finish( uint64_t key );
+
+    private:
+        std::vector< Dependency >        dependencies;
+        std::vector< Material >          materials;
+        std::vector< Primitive >         primitives;
+        std::vector< Light >             lights;
+        std::vector< RgPrimitiveVertex > vertices;
+        std::vector< uint32_t >          indices;
+        // starts with an empty string, so zero-initialized refs are valid
+        std::string                      strings = std::string( 1, '\0' );
+    };
+
+public:
+    // Null, if the file doesn't exist, is invalid, or was compiled from other sources
+    static std::optional< SceneCache > Load( const std::filesystem::path& cachePath,
+                                             const std::filesystem::path& gltfFolder,
+                                             uint64_t                     key );
+    static std::optional< SceneCache > FromBytes( std::vector< uint8_t > bytes, uint64_t key );
+
+    static bool Save( const std::filesystem::path& cachePath, std::span< const uint8_t > bytes );
+
+    // Hash of the source glTF file's content and the parameters that affect the import
+    static std::optional< uint64_t > MakeKey( const std::filesystem::path& gltfPath,
+                                              const RgTransform&           worldTransform,
+                                              float                        oneGameUnitInMeters,
+                                              bool                         optimizeMeshes );
+
+    static std::optional< uint64_t > HashFile( const std::filesystem::path& path );
+
+    std::span< const Material >          GetMaterials() const;
+    std::span< const Primitive >         GetPrimitives() const;
+    std::span< const Light >             GetLights() const;
+    std::span< const RgPrimitiveVertex > GetVertices( const Primitive& primitive ) const;
+    std::span< const uint32_t >          GetIndices( const Primitive& primitive ) const;
+    std::span< const RgPrimitiveVertex > GetLodVertices( const Primitive& primitive ) const;
+    std::span< const uint32_t >          GetLodIndices( const Primitive& primitive ) const;
+    // Null-terminated
+    const char*                          GetString( StringRef ref ) const;
+
+private:
+    SceneCache() = default;
+
+    template< typename T >
+    std::span< const T > Section( uint32_t index ) const;
+
+    bool IsValid() const;
+
+private:
+    std::vector< uint8_t > bytes;
+};
+
+}
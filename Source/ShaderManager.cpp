@@ -52,6 +52,7 @@ static ShaderModuleDefinition G_SHADERS[] =
     { "RMissShadow",                "RtMissShadowCheck.rmiss.spv"           },
     { "RClsOpaque",                 "RtClsOpaque.rchit.spv"                 },
     { "RAlphaTest",                 "RtAlphaTest.rahit.spv"                 },
+    { "RCoarseLod",                 "RtCoarseLod.rahit.spv"                 },
     { "CLightGridBuild",            "CmLightGridBuild.comp.spv"             },
     { "CPrepareFinal",              "CmPrepareFinal.comp.spv"               },
     { "CLuminanceHistogram",        "CmLuminanceHistogram.comp.spv"         },
@@ -0,0 +1,89 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LIGHT_TREE_H_
+#define LIGHT_TREE_H_
+
+// Must be larger than the depth of the tree that is built on CPU
+#define LIGHT_TREE_MAX_DEPTH 32
+
+
+// Lightcuts-like estimate: power of a node falls off with the squared distance to it,
+// but not faster than if the point was on its bounding sphere
+float getLightTreeNodeImportance(const ShLightTreeNode node, const vec3 position)
+{
+    const vec3 halfExtent = (node.boundsMax - node.boundsMin) * 0.5;
+    const vec3 toCenter   = (node.boundsMin + halfExtent) - position;
+
+    return node.power / max(max(dot(toCenter, toCenter), dot(halfExtent, halfExtent)), 0.0001);
+}
+
+// Descend the light tree, choosing a child proportionally to its importance for the position.
+// Returns LIGHT_INDEX_NONE, if there are no regular lights.
+uint sampleLightTree(const vec3 position, float rnd, out float pdf)
+{
+    pdf = 1.0;
+    uint nodeIndex = 0;
+
+    for (int depth = 0; depth < LIGHT_TREE_MAX_DEPTH; depth++)
+    {
+        const ShLightTreeNode node = lightTree[nodeIndex];
+
+        if ((node.childOrLightIndex & LIGHT_TREE_NODE_LEAF_BIT) != 0)
+        {
+            if (node.power <= 0.0)
+            {
+                break;
+            }
+            return node.childOrLightIndex & ~LIGHT_TREE_NODE_LEAF_BIT;
+        }
+
+        const uint  left  = node.childOrLightIndex;
+        const float wLeft = getLightTreeNodeImportance(lightTree[left], position);
+        const float wSum  = wLeft + getLightTreeNodeImportance(lightTree[left + 1], position);
+
+        if (wSum <= 0.0)
+        {
+            break;
+        }
+
+        const float pLeft = wLeft / wSum;
+
+        // reuse the random number, rescaling it to the chosen interval
+        if (rnd < pLeft)
+        {
+            rnd       = rnd / pLeft;
+            pdf      *= pLeft;
+            nodeIndex = left;
+        }
+        else
+        {
+            rnd       = (rnd - pLeft) / (1.0 - pLeft);
+            pdf      *= 1.0 - pLeft;
+            nodeIndex = left + 1;
+        }
+        rnd = min(rnd, 0.99999);
+    }
+
+    pdf = 0.0;
+    return LIGHT_INDEX_NONE;
+}
+
+#endif // LIGHT_TREE_H_
@@ -54,6 +54,7 @@
 #include "Surface.inl"
 #include "Light.h"
 #include "LightGrid.h"
+#include "LightTree.h"
 #include "Media.h"
 #include "RayCone.h"
 
@@ -100,14 +101,33 @@ layout(location = PAYLOAD_INDEX_SHADOW) rayPayloadEXT ShPayloadShadow g_payloadS
 
 
 
+// Static geometry that has a simplified version is split into detail and coarse instances,
+// both of them are a part of world 0
+uint addLodCullMask(uint world, bool coarse)
+{
+    if ((world & INSTANCE_MASK_WORLD_0) == 0)
+    {
+        return world;
+    }
+
+    return world | (coarse ? INSTANCE_MASK_WORLD_0_COARSE : INSTANCE_MASK_WORLD_0_DETAIL);
+}
+
+// Only secondary rays that start far from the camera can use the coarse geometry
+bool isCoarseLodAllowed(vec3 rayOrigin)
+{
+    return globalUniform.coarseLodDistance > 0.0 &&
+           distance(rayOrigin, globalUniform.cameraPosition.xyz) > globalUniform.coarseLodDistance;
+}
+
 uint getPrimaryVisibilityCullMask()
 {
-    return globalUniform.rayCullMaskWorld | INSTANCE_MASK_REFRACT | INSTANCE_MASK_FIRST_PERSON;
+    return addLodCullMask(globalUniform.rayCullMaskWorld, false) | INSTANCE_MASK_REFRACT | INSTANCE_MASK_FIRST_PERSON;
 }
 
 uint getReflectionRefractionCullMask(uint surfInstCustomIndex, uint geometryInstanceFlags, bool isRefraction)
 {
-    uint world = globalUniform.rayCullMaskWorld | INSTANCE_MASK_REFRACT;
+    uint world = addLodCullMask(globalUniform.rayCullMaskWorld, false) | INSTANCE_MASK_REFRACT;
 
     if( ( geometryInstanceFlags & GEOM_INST_FLAG_IGNORE_REFRACT_AFTER ) != 0 )
     {
@@ -134,9 +154,9 @@ uint getReflectionRefractionCullMask(uint surfInstCustomIndex, uint geometryInst
         world | INSTANCE_MASK_FIRST_PERSON_VIEWER;
 }
 
-uint getShadowCullMask(uint surfInstCustomIndex)
+uint getShadowCullMask(uint surfInstCustomIndex, vec3 surfPosition)
 {
-    const uint world = globalUniform.rayCullMaskWorld_Shadow;
+    const uint world = addLodCullMask(globalUniform.rayCullMaskWorld_Shadow, isCoarseLodAllowed(surfPosition));
 
     if ((surfInstCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON) != 0)
     {
@@ -155,9 +175,9 @@ uint getShadowCullMask(uint surfInstCustomIndex)
     }
 }
 
-uint getIndirectIlluminationCullMask(uint surfInstCustomIndex)
+uint getIndirectIlluminationCullMask(uint surfInstCustomIndex, vec3 surfPosition)
 {
-    const uint world = globalUniform.rayCullMaskWorld;
+    const uint world = addLodCullMask(globalUniform.rayCullMaskWorld, isCoarseLodAllowed(surfPosition));
     
     if ((surfInstCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON) != 0)
     {
@@ -254,7 +274,7 @@ ShPayload traceIndirectRay(uint surfInstCustomIndex, vec3 surfPosition, vec3 bou
 {
     resetPayload();
 
-    uint cullMask = getIndirectIlluminationCullMask(surfInstCustomIndex);
+    uint cullMask = getIndirectIlluminationCullMask(surfInstCustomIndex, surfPosition);
 
     traceRayEXT(
         topLevelAS,
@@ -324,7 +344,7 @@ bool traceShadowRay(uint surfInstCustomIndex, vec3 start, vec3 end, bool ignoreF
     // prepare shadow payload
     g_payloadShadow.isShadowed = 1;  
 
-    uint cullMask = getShadowCullMask(surfInstCustomIndex);
+    uint cullMask = getShadowCullMask(surfInstCustomIndex, start);
 
     if (ignoreFirstPersonViewer)
     {
@@ -430,13 +450,17 @@ Reservoir calcInitialReservoir(uint seed, uint salt, const Surface surf, const v
     {      
         for (int i = 0; i < INITIAL_SAMPLES; i++)
         {
-            // uniform distribution as a coarse source pdf
-            float rnd = rnd16(seed, salt++);
-            uint xi = LIGHT_ARRAY_REGULAR_LIGHTS_OFFSET + clamp(uint(rnd * globalUniform.lightCount), 0, globalUniform.lightCount - 1);
-            float oneOverSourcePdf_xi = globalUniform.lightCount;
+            // light tree gives a source pdf that accounts for power and distance
+            float sourcePdf_xi;
+            uint xi = sampleLightTree(surf.position, rnd16(seed, salt++), sourcePdf_xi);
+            float oneOverSourcePdf_xi = safePositiveRcp(sourcePdf_xi);
 
-            LightSample lightSample = sampleLight(lightSources[xi], surf.position, pointRnd);
-            float targetPdf_xi = targetPdfForLightSample(lightSample, surf);
+            float targetPdf_xi = 0.0;
+            if (xi != LIGHT_INDEX_NONE)
+            {
+                LightSample lightSample = sampleLight(lightSources[xi], surf.position, pointRnd);
+                targetPdf_xi = targetPdfForLightSample(lightSample, surf);
+            }
 
             float rndRis = rnd16(seed, salt++);
             updateReservoir(regularReservoir, xi, targetPdf_xi, oneOverSourcePdf_xi, rndRis);
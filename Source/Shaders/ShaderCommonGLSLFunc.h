@@ -198,6 +198,11 @@ layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_INITIAL_LIGHTS_GRID_PREV)
 {
     ShLightInCell initialLightsGrid_Prev[];
 };
+
+layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_LIGHT_TREE) readonly buffer LightTree_BT
+{
+    ShLightTreeNode lightTree[];
+};
 #endif
 
 
@@ -26,26 +26,40 @@ using namespace RTGL1;
 TextureDescriptors::TextureDescriptors( VkDevice                          _device,
                                         std::shared_ptr< SamplerManager > _samplerManager,
                                         uint32_t                          _maxTextureCount,
-                                        uint32_t                          _bindingIndex )
+                                        uint32_t                          _bindingIndex,
+                                        uint32_t                          _residentBankCount )
     : device( _device )
     , samplerManager( std::move( _samplerManager ) )
     , bindingIndex( _bindingIndex )
     , descPool( VK_NULL_HANDLE )
     , descLayout( VK_NULL_HANDLE )
-    , descSets{}
+    , activeSlot{}
+    , selectCounter( 0 )
     , emptyTextureImageView( VK_NULL_HANDLE )
     , emptyTextureImageLayout( VK_IMAGE_LAYOUT_UNDEFINED )
     , currentWriteCount( 0 )
 {
+    assert( _residentBankCount > 0 );
+
     writeImageInfos.resize( _maxTextureCount );
     writeInfos.resize( _maxTextureCount );
 
-    for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+    for( auto& slots : bankSlots )
     {
-        writeCache[ i ].resize( _maxTextureCount );
+        slots.resize( _residentBankCount );
+
+        for( auto& slot : slots )
+        {
+            slot.bank     = UINT32_MAX;
+            slot.lastUsed = 0;
+            slot.descSet  = VK_NULL_HANDLE;
+            slot.writeCache.resize( _maxTextureCount );
+        }
+
+        slots[ 0 ].bank = samplerManager->GetMipLodBiasBank();
     }
 
-    CreateDescriptors( _maxTextureCount );
+    CreateDescriptors( _maxTextureCount, _residentBankCount );
 }
 
 TextureDescriptors::~TextureDescriptors()
@@ -56,7 +70,65 @@ TextureDescriptors::~TextureDescriptors()
 
 VkDescriptorSet TextureDescriptors::GetDescSet( uint32_t frameIndex ) const
 {
-    return descSets[ frameIndex ];
+    return ActiveSlot( frameIndex ).descSet;
+}
+
+TextureDescriptors::BankSlot& TextureDescriptors::ActiveSlot( uint32_t frameIndex )
+{
+    return bankSlots[ frameIndex ][ activeSlot[ frameIndex ] ];
+}
+
+const TextureDescriptors::BankSlot& TextureDescriptors::ActiveSlot( uint32_t frameIndex ) const
+{
+    return bankSlots[ frameIndex ][ activeSlot[ frameIndex ] ];
+}
+
+bool TextureDescriptors::SelectBank( uint32_t frameIndex, uint32_t bank )
+{
+    auto& slots = bankSlots[ frameIndex ];
+
+    selectCounter++;
+
+    if( ActiveSlot( frameIndex ).bank == bank )
+    {
+        ActiveSlot( frameIndex ).lastUsed = selectCounter;
+        return false;
+    }
+
+    // pending writes reference the previous set
+    assert( currentWriteCount == 0 );
+
+    uint32_t target = 0;
+    for( uint32_t i = 0; i < slots.size(); i++ )
+    {
+        if( slots[ i ].bank == bank )
+        {
+            target = i;
+            break;
+        }
+
+        // otherwise, evict the least recently used
+        if( slots[ i ].lastUsed < slots[ target ].lastUsed )
+        {
+            target = i;
+        }
+    }
+
+    BankSlot& slot = slots[ target ];
+
+    if( slot.bank != bank )
+    {
+        // the set's frame is not in flight, so its content can be overwritten
+        slot.bank = bank;
+        for( auto& c : slot.writeCache )
+        {
+            c = { VK_NULL_HANDLE, SamplerManager::Handle() };
+        }
+    }
+
+    slot.lastUsed            = selectCounter;
+    activeSlot[ frameIndex ] = target;
+    return true;
 }
 
 VkDescriptorSetLayout TextureDescriptors::GetDescSetLayout() const
@@ -70,7 +142,7 @@ void TextureDescriptors::SetEmptyTextureInfo( VkImageView view )
     emptyTextureImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
 
-void TextureDescriptors::CreateDescriptors( uint32_t maxTextureCount )
+void TextureDescriptors::CreateDescriptors( uint32_t maxTextureCount, uint32_t residentBankCount )
 {
     {
         VkDescriptorSetLayoutBinding binding = {
@@ -96,12 +168,12 @@ void TextureDescriptors::CreateDescriptors( uint32_t maxTextureCount )
     {
         VkDescriptorPoolSize poolSize = {
             .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = maxTextureCount * MAX_FRAMES_IN_FLIGHT,
+            .descriptorCount = maxTextureCount * MAX_FRAMES_IN_FLIGHT * residentBankCount,
         };
 
         VkDescriptorPoolCreateInfo poolInfo = {
             .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets       = MAX_FRAMES_IN_FLIGHT,
+            .maxSets       = MAX_FRAMES_IN_FLIGHT * residentBankCount,
             .poolSizeCount = 1,
             .pPoolSizes    = &poolSize,
         };
@@ -119,13 +191,16 @@ void TextureDescriptors::CreateDescriptors( uint32_t maxTextureCount )
             .descriptorSetCount = 1,
             .pSetLayouts        = &descLayout,
         };
-        for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+        for( auto& slots : bankSlots )
         {
-            VkResult r = vkAllocateDescriptorSets( device, &setInfo, &descSets[ i ] );
+            for( auto& slot : slots )
+            {
+                VkResult r = vkAllocateDescriptorSets( device, &setInfo, &slot.descSet );
 
-            VK_CHECKERROR( r );
-            SET_DEBUG_NAME(
-                device, descSets[ i ], VK_OBJECT_TYPE_DESCRIPTOR_SET, "Textures desc set" );
+                VK_CHECKERROR( r );
+                SET_DEBUG_NAME(
+                    device, slot.descSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Textures desc set" );
+            }
         }
     }
 }
@@ -135,8 +210,8 @@ bool TextureDescriptors::IsCached( uint32_t               frameIndex,
                                    VkImageView            view,
                                    SamplerManager::Handle samplerHandle )
 {
-    return writeCache[ frameIndex ][ textureIndex ].view == view &&
-           writeCache[ frameIndex ][ textureIndex ].samplerHandle == samplerHandle;
+    const auto& c = ActiveSlot( frameIndex ).writeCache[ textureIndex ];
+    return c.view == view && c.samplerHandle == samplerHandle;
 }
 
 void TextureDescriptors::AddToCache( uint32_t               frameIndex,
@@ -144,23 +219,28 @@ void TextureDescriptors::AddToCache( uint32_t               frameIndex,
                                      VkImageView            view,
                                      SamplerManager::Handle samplerHandle )
 {
-    writeCache[ frameIndex ][ textureIndex ].view          = view;
-    writeCache[ frameIndex ][ textureIndex ].samplerHandle = samplerHandle;
+    auto& c         = ActiveSlot( frameIndex ).writeCache[ textureIndex ];
+    c.view          = view;
+    c.samplerHandle = samplerHandle;
 }
 
 void TextureDescriptors::ResetCache( uint32_t frameIndex, uint32_t textureIndex )
 {
-    writeCache[ frameIndex ][ textureIndex ] = { VK_NULL_HANDLE, SamplerManager::Handle() };
+    ActiveSlot( frameIndex ).writeCache[ textureIndex ] = { VK_NULL_HANDLE,
+                                                            SamplerManager::Handle() };
 }
 
 void RTGL1::TextureDescriptors::ResetAllCache( uint32_t frameIndex )
 {
-    for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+    for( auto& slots : bankSlots )
     {
-        for( auto& f : writeCache[ i ] )
+        for( auto& slot : slots )
         {
-            f.view          = VK_NULL_HANDLE;
-            f.samplerHandle = SamplerManager::Handle();
+            for( auto& f : slot.writeCache )
+            {
+                f.view          = VK_NULL_HANDLE;
+                f.samplerHandle = SamplerManager::Handle();
+            }
         }
     }
 }
@@ -184,14 +264,16 @@ void TextureDescriptors::UpdateTextureDesc( uint32_t               frameIndex,
         return;
     }
 
+    const BankSlot& slot = ActiveSlot( frameIndex );
+
     writeImageInfos[ currentWriteCount ] = VkDescriptorImageInfo{
-        .sampler     = samplerManager->GetSampler( samplerHandle ),
+        .sampler     = samplerManager->GetSampler( samplerHandle, slot.bank ),
         .imageView   = view,
         .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
     };
     writeInfos[ currentWriteCount ] = VkWriteDescriptorSet{
         .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet          = descSets[ frameIndex ],
+        .dstSet          = slot.descSet,
         .dstBinding      = bindingIndex,
         .dstArrayElement = textureIndex,
         .descriptorCount = 1,
@@ -34,7 +34,8 @@ public:
     explicit TextureDescriptors( VkDevice                          device,
                                  std::shared_ptr< SamplerManager > samplerManager,
                                  uint32_t                          maxTextureCount,
-                                 uint32_t                          bindingIndex );
+                                 uint32_t                          bindingIndex,
+                                 uint32_t                          residentBankCount = 1 );
     ~TextureDescriptors();
 
     TextureDescriptors( const TextureDescriptors& other )     = delete;
@@ -49,6 +50,12 @@ public:
     void                  ResetTextureDesc( uint32_t frameIndex, uint32_t textureIndex );
     void                  ResetAllCache( uint32_t frameIndex );
 
+    // Switch to a descriptor set that is filled with samplers of the given mip lod bias bank.
+    // A few banks are kept resident, so returning to a recent one requires rewriting only
+    // the descriptors that were changed since. Returns true, if the set was switched,
+    // then all textures must be updated again to find such differences
+    bool                  SelectBank( uint32_t frameIndex, uint32_t bank );
+
     // Must be called after a series of UpdateTextureDesc and
     // ResetTextureDesc to make an actual desc write
     void                  FlushDescWrites();
@@ -60,7 +67,7 @@ public:
     void                  SetEmptyTextureInfo( VkImageView view );
 
 private:
-    void CreateDescriptors( uint32_t maxTextureCount );
+    void CreateDescriptors( uint32_t maxTextureCount, uint32_t residentBankCount );
 
     bool IsCached( uint32_t               frameIndex,
                    uint32_t               textureIndex,
@@ -79,6 +86,17 @@ private:
         SamplerManager::Handle samplerHandle;
     };
 
+    struct BankSlot
+    {
+        uint32_t                        bank;
+        uint64_t                        lastUsed;
+        VkDescriptorSet                 descSet;
+        std::vector< UpdatedDescCache > writeCache;
+    };
+
+    BankSlot&       ActiveSlot( uint32_t frameIndex );
+    const BankSlot& ActiveSlot( uint32_t frameIndex ) const;
+
 private:
     VkDevice                             device;
     std::shared_ptr< SamplerManager >    samplerManager;
@@ -87,7 +105,9 @@ private:
 
     VkDescriptorPool                     descPool;
     VkDescriptorSetLayout                descLayout;
-    VkDescriptorSet                      descSets[ MAX_FRAMES_IN_FLIGHT ];
+    std::vector< BankSlot >              bankSlots[ MAX_FRAMES_IN_FLIGHT ];
+    uint32_t                             activeSlot[ MAX_FRAMES_IN_FLIGHT ];
+    uint64_t                             selectCounter;
 
     VkImageView                          emptyTextureImageView;
     VkImageLayout                        emptyTextureImageLayout;
@@ -95,8 +115,6 @@ private:
     uint32_t                             currentWriteCount;
     std::vector< VkDescriptorImageInfo > writeImageInfos;
     std::vector< VkWriteDescriptorSet >  writeInfos;
-
-    std::vector< UpdatedDescCache >      writeCache[ MAX_FRAMES_IN_FLIGHT ];
 };
 
 }
\ No newline at end of file
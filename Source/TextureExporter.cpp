@@ -23,6 +23,7 @@
 
 #include "Stb/stb_image_write.h"
 
+#include <algorithm>
 #include <span>
 
 namespace
@@ -30,6 +31,10 @@ namespace
 
 constexpr uint64_t DstBytesPerPixel = 4;
 
+// limits for one command buffer with its readback buffer
+constexpr uint64_t MaxBatchBytes  = 64 * 1024 * 1024;
+constexpr size_t   MaxBatchImages = 64;
+
 enum class PrepareResult
 {
     Fail,
@@ -73,6 +78,33 @@ PrepareResult PrepareTargetFile( const std::filesystem::path& filepath, bool ove
 
 }
 
+RTGL1::TextureExporter::TextureExporter( std::shared_ptr< MemoryAllocator >      _allocator,
+                                         std::shared_ptr< CommandBufferManager > _cmdManager,
+                                         std::shared_ptr< ThreadPool >           _threadPool )
+    : device( _allocator->GetDevice() )
+    , allocator( std::move( _allocator ) )
+    , cmdManager( std::move( _cmdManager ) )
+    , threadPool( std::move( _threadPool ) )
+{
+}
+
+RTGL1::TextureExporter::~TextureExporter()
+{
+    FlushExports();
+
+    for( Batch& b : inFlight )
+    {
+        Utils::WaitForFence( device, b.fence );
+    }
+    Poll();
+    assert( inFlight.empty() );
+
+    for( auto& w : fileWrites )
+    {
+        w.wait();
+    }
+}
+
 bool RTGL1::TextureExporter::WriteTGA( std::filesystem::path filepath,
                                        const void*           pixels,
                                        const RgExtent2D&     size )
@@ -92,20 +124,43 @@ bool RTGL1::TextureExporter::WriteTGA( std::filesystem::path filepath,
     return true;
 }
 
-bool RTGL1::TextureExporter::ExportAsTGA( MemoryAllocator&             allocator,
-                                          CommandBufferManager&        cmdManager,
-                                          VkImage                      srcImage,
-                                          RgExtent2D                   srcImageSize,
-                                          VkFormat                     srcImageFormat,
-                                          const std::filesystem::path& filepath,
-                                          bool                         exportAsSRGB,
-                                          bool                         overwriteFiles )
+bool RTGL1::TextureExporter::WritePNG( std::filesystem::path filepath,
+                                       const void*           pixels,
+                                       const RgExtent2D&     size )
 {
-    VkDevice device = allocator.GetDevice();
+    assert( std::filesystem::exists( filepath.parent_path() ) );
+
+    if( !stbi_write_png( filepath.replace_extension( ".png" ).string().c_str(),
+                         int( size.width ),
+                         int( size.height ),
+                         DstBytesPerPixel,
+                         pixels,
+                         int( size.width * DstBytesPerPixel ) ) )
+    {
+        debug::Warning( "{}: stbi_write_png fail", filepath.string() );
+        return false;
+    }
 
+    return true;
+}
+
+bool RTGL1::TextureExporter::Export( VkImage                      srcImage,
+                                     RgExtent2D                   srcImageSize,
+                                     VkFormat                     srcImageFormat,
+                                     const std::filesystem::path& filepath,
+                                     bool                         exportAsSRGB,
+                                     bool                         overwriteFiles )
+{
     const VkFormat dstImageFormat =
         exportAsSRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
 
+    // a texture can be shared by materials, so it might be already queued
+    if( std::ranges::any_of( queued,
+                             [ & ]( const Request& r ) { return r.filepath == filepath; } ) )
+    {
+        return true;
+    }
+
     switch( PrepareTargetFile( filepath, overwriteFiles ) )
     {
         case PrepareResult::AlreadyExists: return true;
@@ -114,15 +169,54 @@ bool RTGL1::TextureExporter::ExportAsTGA( MemoryAllocator&             allocator
         default: return false;
     }
 
-    if( !CheckSupport( allocator.GetPhysicalDevice(), srcImageFormat, dstImageFormat ) )
+    if( !CheckSupport( allocator->GetPhysicalDevice(), srcImageFormat, dstImageFormat ) )
     {
         return false;
     }
 
-    vkDeviceWaitIdle( device );
-    VkCommandBuffer cmd = cmdManager.StartGraphicsCmd();
+    queued.push_back( Request{
+        .srcImage  = srcImage,
+        .size      = srcImageSize,
+        .dstFormat = dstImageFormat,
+        .filepath  = filepath,
+    } );
+    return true;
+}
 
-    constexpr VkImageLayout srcImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+void RTGL1::TextureExporter::FlushExports()
+{
+    size_t   batchStart = 0;
+    uint64_t batchBytes = 0;
+
+    for( size_t i = 0; i < queued.size(); i++ )
+    {
+        uint64_t bytes = DstBytesPerPixel * queued[ i ].size.width * queued[ i ].size.height;
+
+        bool full = ( i - batchStart >= MaxBatchImages ) ||
+                    ( i > batchStart && batchBytes + bytes > MaxBatchBytes );
+
+        if( full )
+        {
+            SubmitBatch( std::span( queued ).subspan( batchStart, i - batchStart ) );
+
+            batchStart = i;
+            batchBytes = 0;
+        }
+
+        batchBytes += bytes;
+    }
+
+    if( batchStart < queued.size() )
+    {
+        SubmitBatch( std::span( queued ).subspan( batchStart ) );
+    }
+
+    queued.clear();
+}
+
+void RTGL1::TextureExporter::SubmitBatch( std::span< Request > requests )
+{
+    Batch batch = {};
 
     const VkImageSubresourceRange subresRange = {
         .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -131,107 +225,114 @@ bool RTGL1::TextureExporter::ExportAsTGA( MemoryAllocator&             allocator
         .baseArrayLayer = 0,
         .layerCount     = 1,
     };
-    const VkImageSubresource subres = {
-        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-        .mipLevel   = 0,
-        .arrayLayer = 0,
+    const VkImageSubresourceLayers subresLayers = {
+        .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevel       = 0,
+        .baseArrayLayer = 0,
+        .layerCount     = 1,
     };
 
-    // Can't vkCmdBlit into a linear tiling directly
     // Can't vkCmdCopy directly from a compressed format (diff block extents with rgba8)
     // 1. Blit from compressed to optimal rgba8
-    // 2. Copy from optimal rgba8 to linear rgba8
+    // 2. Copy from optimal rgba8 to a host-visible buffer, which is tightly packed
 
-    VkImage dstImage_Optimal = VK_NULL_HANDLE;
-    VkImage dstImage_Linear  = VK_NULL_HANDLE;
+    VkDeviceSize readbackSize = 0;
+    for( const Request& r : requests )
     {
+        batch.offsets.push_back( readbackSize );
+        readbackSize += DstBytesPerPixel * r.size.width * r.size.height;
+
         VkImageCreateInfo info = {
             .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .pNext       = nullptr,
-            .flags       = 0,
             .imageType   = VK_IMAGE_TYPE_2D,
-            .format      = dstImageFormat,
-            .extent      = { srcImageSize.width, srcImageSize.height, 1 },
+            .format      = r.dstFormat,
+            .extent      = { r.size.width, r.size.height, 1 },
             .mipLevels   = 1,
             .arrayLayers = 1,
             .samples     = VK_SAMPLE_COUNT_1_BIT,
-            .tiling      = VK_IMAGE_TILING_OPTIMAL, /* optimal */
-            .usage =
-                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, /* dst + src */
-            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 0,
-            .pQueueFamilyIndices   = nullptr,
-            .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
         };
 
-        VkResult r = vkCreateImage( device, &info, nullptr, &dstImage_Optimal );
-        VK_CHECKERROR( r );
-        SET_DEBUG_NAME(
-            device, dstImage_Optimal, VK_OBJECT_TYPE_IMAGE, "Export dst image (optimal)" );
+        VkImage  image;
+        VkResult res = vkCreateImage( device, &info, nullptr, &image );
+        VK_CHECKERROR( res );
+        SET_DEBUG_NAME( device, image, VK_OBJECT_TYPE_IMAGE, "Export dst image (optimal)" );
+
+        VkMemoryRequirements memReqs = {};
+        vkGetImageMemoryRequirements( device, image, &memReqs );
+
+        VkDeviceMemory memory = allocator->AllocDedicated( memReqs,
+                                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           MemoryAllocator::AllocType::DEFAULT,
+                                                           "Export dst image (optimal)" );
+
+        res = vkBindImageMemory( device, image, memory, 0 );
+        VK_CHECKERROR( res );
+
+        batch.intermediateImages.push_back( image );
+        batch.intermediateMemories.push_back( memory );
     }
 
     {
-        VkImageCreateInfo info = {
-            .sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .pNext                 = nullptr,
-            .flags                 = 0,
-            .imageType             = VK_IMAGE_TYPE_2D,
-            .format                = dstImageFormat,
-            .extent                = { srcImageSize.width, srcImageSize.height, 1 },
-            .mipLevels             = 1,
-            .arrayLayers           = 1,
-            .samples               = VK_SAMPLE_COUNT_1_BIT,
-            .tiling                = VK_IMAGE_TILING_LINEAR,          /* linear */
-            .usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT, /* dst */
-            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 0,
-            .pQueueFamilyIndices   = nullptr,
-            .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED,
+        VkBufferCreateInfo info = {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = readbackSize,
+            .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         };
 
-        VkResult r = vkCreateImage( device, &info, nullptr, &dstImage_Linear );
-        VK_CHECKERROR( r );
-        SET_DEBUG_NAME( device,
-                        dstImage_Linear,
-                        VK_OBJECT_TYPE_IMAGE,
-                        "Export dst image (linear, host-readable)" );
-    }
+        VkResult res = vkCreateBuffer( device, &info, nullptr, &batch.readback );
+        VK_CHECKERROR( res );
+        SET_DEBUG_NAME( device, batch.readback, VK_OBJECT_TYPE_BUFFER, "Export readback" );
 
-    VkDeviceMemory dstMemory_Optimal = VK_NULL_HANDLE;
-    VkDeviceMemory dstMemory_Linear  = VK_NULL_HANDLE;
-    {
         VkMemoryRequirements memReqs = {};
-        vkGetImageMemoryRequirements( device, dstImage_Optimal, &memReqs );
+        vkGetBufferMemoryRequirements( device, batch.readback, &memReqs );
 
-        dstMemory_Optimal = allocator.AllocDedicated( memReqs,
-                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                      MemoryAllocator::AllocType::DEFAULT,
-                                                      "Export dst image (optimal)" );
+        batch.readbackMemory = allocator->AllocDedicated( memReqs,
+                                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                          MemoryAllocator::AllocType::DEFAULT,
+                                                          "Export readback" );
 
-        VkResult r = vkBindImageMemory( device, dstImage_Optimal, dstMemory_Optimal, 0 );
-        VK_CHECKERROR( r );
+        res = vkBindBufferMemory( device, batch.readback, batch.readbackMemory, 0 );
+        VK_CHECKERROR( res );
     }
+
     {
-        VkMemoryRequirements memReqs = {};
-        vkGetImageMemoryRequirements( device, dstImage_Linear, &memReqs );
+        VkFenceCreateInfo info = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        };
 
-        dstMemory_Linear = allocator.AllocDedicated( memReqs,
-                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                                     MemoryAllocator::AllocType::DEFAULT,
-                                                     "Export dst image (linear, host-readable)" );
+        VkResult res = vkCreateFence( device, &info, nullptr, &batch.fence );
+        VK_CHECKERROR( res );
+    }
 
-        VkResult r = vkBindImageMemory( device, dstImage_Linear, dstMemory_Linear, 0 );
-        VK_CHECKERROR( r );
+    // the same image can be requested multiple times, but transition it only once
+    std::vector< VkImage > uniqueSrc;
+    for( const Request& r : requests )
+    {
+        if( std::ranges::find( uniqueSrc, r.srcImage ) == uniqueSrc.end() )
+        {
+            uniqueSrc.push_back( r.srcImage );
+        }
     }
 
-    // blit srcImage -> dstImage_Optimal
+    constexpr VkImageLayout srcImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+
+    // srcImage to transfer src, intermediate to transfer dst
     {
-        VkImageMemoryBarrier2 bs[] = {
-            // srcImage to transfer src
-            {
+        std::vector< VkImageMemoryBarrier2 > bs;
+
+        for( VkImage src : uniqueSrc )
+        {
+            bs.push_back( VkImageMemoryBarrier2{
                 .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
+                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
                 .srcAccessMask       = VK_ACCESS_2_SHADER_READ_BIT,
                 .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
                 .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,
@@ -239,13 +340,16 @@ bool RTGL1::TextureExporter::ExportAsTGA( MemoryAllocator&             allocator
                 .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = srcImage,
+                .image               = src,
                 .subresourceRange    = subresRange,
-            },
-            // dstImage_Optimal to transfer dst
-            {
+            } );
+        }
+
+        for( VkImage dst : batch.intermediateImages )
+        {
+            bs.push_back( VkImageMemoryBarrier2{
                 .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
+                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
                 .srcAccessMask       = VK_ACCESS_2_NONE,
                 .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
                 .dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
@@ -253,231 +357,234 @@ bool RTGL1::TextureExporter::ExportAsTGA( MemoryAllocator&             allocator
                 .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = dstImage_Optimal,
+                .image               = dst,
                 .subresourceRange    = subresRange,
-            },
-        };
+            } );
+        }
 
         VkDependencyInfoKHR dependencyInfo = {
             .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
-            .imageMemoryBarrierCount = std::size( bs ),
-            .pImageMemoryBarriers    = std::data( bs ),
+            .imageMemoryBarrierCount = uint32_t( bs.size() ),
+            .pImageMemoryBarriers    = bs.data(),
         };
 
         svkCmdPipelineBarrier2KHR( cmd, &dependencyInfo );
     }
+
+    // blit srcImage -> intermediate
+    for( size_t i = 0; i < requests.size(); i++ )
     {
+        const RgExtent2D& size = requests[ i ].size;
+
         VkImageBlit blit = {
-            .srcSubresource = { .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                                .mipLevel       = 0,
-                                .baseArrayLayer = 0,
-                                .layerCount     = 1 },
-            .srcOffsets     = { { 0, 0, 0 },
-                                { int32_t( srcImageSize.width ), int32_t( srcImageSize.height ), 1 } },
-            .dstSubresource = { .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                                .mipLevel       = 0,
-                                .baseArrayLayer = 0,
-                                .layerCount     = 1 },
-            .dstOffsets     = { { 0, 0, 0 },
-                                { int32_t( srcImageSize.width ), int32_t( srcImageSize.height ), 1 } },
+            .srcSubresource = subresLayers,
+            .srcOffsets     = { { 0, 0, 0 }, { int32_t( size.width ), int32_t( size.height ), 1 } },
+            .dstSubresource = subresLayers,
+            .dstOffsets     = { { 0, 0, 0 }, { int32_t( size.width ), int32_t( size.height ), 1 } },
         };
 
         vkCmdBlitImage( cmd,
-                        srcImage,
+                        requests[ i ].srcImage,
                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                        dstImage_Optimal,
+                        batch.intermediateImages[ i ],
                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                         1,
                         &blit,
                         VK_FILTER_NEAREST );
     }
 
-    // copy dstImage_Optimal -> dstImage_Linear
+    // srcImage to original layout, intermediate to transfer src
     {
-        VkImageMemoryBarrier2 bs[] = {
-            {
-                // dstImage_Optimal to transfer src
+        std::vector< VkImageMemoryBarrier2 > bs;
+
+        for( VkImage src : uniqueSrc )
+        {
+            bs.push_back( VkImageMemoryBarrier2{
                 .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
                 .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
-                .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
-                .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,
-                .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .srcAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,
+                .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                .dstAccessMask       = VK_ACCESS_2_SHADER_READ_BIT,
+                .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .newLayout           = srcImageLayout,
                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = dstImage_Optimal,
+                .image               = src,
                 .subresourceRange    = subresRange,
-            },
-            {
-                // dstImage_Linear to transfer dst
+            } );
+        }
+
+        for( VkImage dst : batch.intermediateImages )
+        {
+            bs.push_back( VkImageMemoryBarrier2{
                 .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
-                .srcAccessMask       = VK_ACCESS_2_NONE,
+                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
                 .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
-                .dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-                .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,
+                .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = dstImage_Linear,
+                .image               = dst,
                 .subresourceRange    = subresRange,
-            },
-        };
+            } );
+        }
 
         VkDependencyInfoKHR dependencyInfo = {
             .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
-            .imageMemoryBarrierCount = std::size( bs ),
-            .pImageMemoryBarriers    = std::data( bs ),
+            .imageMemoryBarrierCount = uint32_t( bs.size() ),
+            .pImageMemoryBarriers    = bs.data(),
         };
 
         svkCmdPipelineBarrier2KHR( cmd, &dependencyInfo );
     }
+
+    // copy intermediate -> readback buffer
+    for( size_t i = 0; i < requests.size(); i++ )
     {
-        VkImageCopy region = {
-            .srcSubresource = { .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                                .mipLevel       = 0,
-                                .baseArrayLayer = 0,
-                                .layerCount     = 1 },
-            .srcOffset      = { 0, 0, 0 },
-            .dstSubresource = { .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                                .mipLevel       = 0,
-                                .baseArrayLayer = 0,
-                                .layerCount     = 1 },
-            .dstOffset      = { 0, 0, 0 },
-            .extent         = { srcImageSize.width, srcImageSize.height, 1 },
+        const RgExtent2D& size = requests[ i ].size;
+
+        VkBufferImageCopy region = {
+            .bufferOffset      = batch.offsets[ i ],
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = subresLayers,
+            .imageOffset       = { 0, 0, 0 },
+            .imageExtent       = { size.width, size.height, 1 },
         };
 
-        vkCmdCopyImage( cmd,
-                        dstImage_Optimal,
-                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                        dstImage_Linear,
-                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                        1,
-                        &region );
+        vkCmdCopyImageToBuffer( cmd,
+                                batch.intermediateImages[ i ],
+                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                batch.readback,
+                                1,
+                                &region );
     }
 
+    // readback to host read
     {
-        VkImageMemoryBarrier2 bs[] = {
-            {
-                // srcImage to original layout
-                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
-                .srcAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,
-                .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
-                .dstAccessMask       = VK_ACCESS_2_SHADER_READ_BIT,
-                .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                .newLayout           = srcImageLayout,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = srcImage,
-                .subresourceRange    = subresRange,
-            },
-            {
-                // dstImage_Linear to host read
-                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-                .srcStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
-                .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                .dstStageMask        = VK_PIPELINE_STAGE_2_HOST_BIT,
-                .dstAccessMask       = VK_ACCESS_2_HOST_READ_BIT,
-                .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image               = dstImage_Linear,
-                .subresourceRange    = subresRange,
-            },
+        VkMemoryBarrier2 b = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR,
+            .srcStageMask  = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask  = VK_PIPELINE_STAGE_2_HOST_BIT,
+            .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
         };
 
         VkDependencyInfoKHR dependencyInfo = {
-            .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
-            .imageMemoryBarrierCount = std::size( bs ),
-            .pImageMemoryBarriers    = std::data( bs ),
+            .sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers    = &b,
         };
 
         svkCmdPipelineBarrier2KHR( cmd, &dependencyInfo );
     }
 
-    cmdManager.Submit( cmd );
-    cmdManager.WaitGraphicsIdle();
+    cmdManager->Submit( cmd, batch.fence );
 
-    bool success = false;
+    batch.requests.assign( std::make_move_iterator( requests.begin() ),
+                           std::make_move_iterator( requests.end() ) );
+    inFlight.push_back( std::move( batch ) );
+}
+
+void RTGL1::TextureExporter::Poll()
+{
+    for( auto it = inFlight.begin(); it != inFlight.end(); )
     {
-        VkSubresourceLayout subresLayout = {};
-        vkGetImageSubresourceLayout( device, dstImage_Linear, &subres, &subresLayout );
+        if( vkGetFenceStatus( device, it->fence ) == VK_SUCCESS )
+        {
+            FinishBatch( *it );
+            DestroyBatch( *it );
 
-        if( subresLayout.rowPitch == DstBytesPerPixel * srcImageSize.width )
+            it = inFlight.erase( it );
+        }
+        else
         {
-            assert( subresLayout.size ==
-                    DstBytesPerPixel * srcImageSize.width * srcImageSize.height );
+            ++it;
+        }
+    }
+
+    // remove finished writes
+    std::erase_if( fileWrites, []( std::future< bool >& w ) {
+        return w.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+    } );
+}
+
+bool RTGL1::TextureExporter::IsBusy() const
+{
+    return !queued.empty() || !inFlight.empty() || !fileWrites.empty();
+}
+
+bool RTGL1::TextureExporter::IsReadingImage( VkImage image ) const
+{
+    auto isSource = [ image ]( const Request& r ) { return r.srcImage == image; };
+
+    if( std::ranges::any_of( queued, isSource ) )
+    {
+        return true;
+    }
+
+    return std::ranges::any_of(
+        inFlight, [ & ]( const Batch& b ) { return std::ranges::any_of( b.requests, isSource ); } );
+}
+
+void RTGL1::TextureExporter::FinishBatch( Batch& batch )
+{
+    uint8_t* data{ nullptr };
+    VkResult r = vkMapMemory(
+        device, batch.readbackMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast< void** >( &data ) );
+    VK_CHECKERROR( r );
+
+    for( size_t i = 0; i < batch.requests.size(); i++ )
+    {
+        Request& req = batch.requests[ i ];
 
-            uint8_t* data{ nullptr };
-            VkResult r = vkMapMemory( device,
-                                      dstMemory_Linear,
-                                      0,
-                                      VK_WHOLE_SIZE,
-                                      0,
-                                      reinterpret_cast< void** >( &data ) );
-            VK_CHECKERROR( r );
+        // copy out, so the readback memory can be freed right now
+        const uint64_t bytes = DstBytesPerPixel * req.size.width * req.size.height;
+        const uint8_t* src    = data + batch.offsets[ i ];
+        auto           pixels = std::vector< uint8_t >( src, src + bytes );
 
-            success = WriteTGA( filepath, &data[ subresLayout.offset ], srcImageSize );
+        auto write = [ filepath = std::move( req.filepath ),
+                       pixels   = std::move( pixels ),
+                       size     = req.size ]() {
+            if( filepath.extension() == ".png" )
+            {
+                return WritePNG( filepath, pixels.data(), size );
+            }
+            return WriteTGA( filepath, pixels.data(), size );
+        };
 
-            vkUnmapMemory( device, dstMemory_Linear );
+        if( threadPool )
+        {
+            fileWrites.push_back( threadPool->Enqueue( std::move( write ) ) );
         }
         else
         {
-            // manually, if small enough
-            if( srcImageSize.width <= 64 && srcImageSize.height <= 64 )
-            {
-                auto pixels = std::make_unique< uint8_t[] >( DstBytesPerPixel * srcImageSize.width *
-                                                             srcImageSize.height );
-                {
-                    uint8_t* rawData{ nullptr };
-                    VkResult r = vkMapMemory( device,
-                                              dstMemory_Linear,
-                                              0,
-                                              VK_WHOLE_SIZE,
-                                              0,
-                                              reinterpret_cast< void** >( &rawData ) );
-                    VK_CHECKERROR( r );
-
-                    uint8_t* beginData = &rawData[ subresLayout.offset ];
-                    uint8_t* endData   = &rawData[ subresLayout.offset + subresLayout.size ];
-
-                    uint8_t* dstPtr = pixels.get();
-
-                    for( uint8_t* ptr = beginData; ptr < endData; ptr += subresLayout.rowPitch )
-                    {
-                        memcpy( dstPtr, ptr, DstBytesPerPixel * srcImageSize.width );
-                        dstPtr += DstBytesPerPixel * srcImageSize.width;
-                    }
-
-                    vkUnmapMemory( device, dstMemory_Linear );
-                }
-                success = WriteTGA( filepath, pixels.get(), srcImageSize );
-            }
-            else
-            {
-                debug::Warning(
-                    "Can't export to image file, as mapped data is not tightly packed: {}. "
-                    "VkSubresourceLayout::rowPitch is {}; expected "
-                    "( {} bytes per pixel * {} pixels in a row )",
-                    filepath.string(),
-                    subresLayout.rowPitch,
-                    DstBytesPerPixel,
-                    srcImageSize.width );
-            }
+            write();
         }
     }
-    {
-        vkFreeMemory( device, dstMemory_Linear, nullptr );
-        vkFreeMemory( device, dstMemory_Optimal, nullptr );
 
-        vkDestroyImage( device, dstImage_Linear, nullptr );
-        vkDestroyImage( device, dstImage_Optimal, nullptr );
+    vkUnmapMemory( device, batch.readbackMemory );
+}
+
+void RTGL1::TextureExporter::DestroyBatch( Batch& batch )
+{
+    vkDestroyFence( device, batch.fence, nullptr );
+
+    vkDestroyBuffer( device, batch.readback, nullptr );
+    MemoryAllocator::FreeDedicated( device, batch.readbackMemory );
+
+    for( VkImage image : batch.intermediateImages )
+    {
+        vkDestroyImage( device, image, nullptr );
+    }
+    for( VkDeviceMemory memory : batch.intermediateMemories )
+    {
+        MemoryAllocator::FreeDedicated( device, memory );
     }
 
-    return success;
+    batch = {};
 }
 
 bool RTGL1::TextureExporter::CheckSupport( VkPhysicalDevice physDevice,
@@ -502,15 +609,10 @@ bool RTGL1::TextureExporter::CheckSupport( VkPhysicalDevice physDevice,
             debug::Warning( "BLIT_DST not supported for VkFormat {}", uint32_t( dstImageFormat ) );
             return false;
         }
-        if( !( formatProps.linearTilingFeatures & VK_FORMAT_FEATURE_TRANSFER_SRC_BIT ) )
-        {
-            debug::Warning( "TRANSFER_SRC not supported for VkFormat {} (linear tiling)",
-                            uint32_t( dstImageFormat ) );
-            return false;
-        }
-        if( !( formatProps.linearTilingFeatures & VK_FORMAT_FEATURE_TRANSFER_DST_BIT ) )
+        // intermediate image is optimal, and it's copied to a buffer
+        if( !( formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_TRANSFER_SRC_BIT ) )
         {
-            debug::Warning( "TRANSFER_DST not supported for VkFormat {} (linear tiling)",
+            debug::Warning( "TRANSFER_SRC not supported for VkFormat {}",
                             uint32_t( dstImageFormat ) );
             return false;
         }
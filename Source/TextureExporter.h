@@ -22,17 +22,25 @@
 
 #include "CommandBufferManager.h"
 #include "MemoryAllocator.h"
+#include "ThreadPool.h"
 
 #include <filesystem>
+#include <future>
+#include <span>
 
 namespace RTGL1
 {
 
+// Exports textures to image files without stalling the render loop: GPU copies are batched
+// into a few command buffers, their fences are polled each frame, and the pixel data
+// is encoded and written to files by worker threads.
 class TextureExporter
 {
 public:
-    TextureExporter() = default;
-    ~TextureExporter() = default;
+    TextureExporter( std::shared_ptr< MemoryAllocator >      allocator,
+                     std::shared_ptr< CommandBufferManager > cmdManager,
+                     std::shared_ptr< ThreadPool >           threadPool );
+    ~TextureExporter();
 
     TextureExporter( const TextureExporter& other )                = delete;
     TextureExporter( TextureExporter&& other ) noexcept            = delete;
@@ -42,21 +50,68 @@ public:
     static bool WriteTGA( std::filesystem::path filepath,
                           const void*           pixels,
                           const RgExtent2D&     size );
+    static bool WritePNG( std::filesystem::path filepath,
+                          const void*           pixels,
+                          const RgExtent2D&     size );
+
+    // Queue an export of the first mip level of an image. The file format
+    // is chosen by the extension (.png or .tga). The image must be alive
+    // while IsReadingImage is true; returns false, if it can't be exported.
+    bool Export( VkImage                      srcImage,
+                 RgExtent2D                   srcImageSize,
+                 VkFormat                     srcImageFormat,
+                 const std::filesystem::path& filepath,
+                 bool                         exportAsSRGB,
+                 bool                         overwriteFiles = true );
+
+    // Record and submit copies of all queued images, doesn't wait for them
+    void FlushExports();
+
+    // Pass the finished copies to the workers, should be called each frame
+    void Poll();
+
+    bool IsBusy() const;
 
-    bool ExportAsTGA( MemoryAllocator&             allocator,
-                      CommandBufferManager&        cmdManager,
-                      VkImage                      srcImage,
-                      RgExtent2D                   srcImageSize,
-                      VkFormat                     srcImageFormat,
-                      const std::filesystem::path& filepath,
-                      bool                         exportAsSRGB,
-                      bool                         overwriteFiles = true );
+    // True, if the image is queued or its copy is still executed on GPU
+    bool IsReadingImage( VkImage image ) const;
+
+private:
+    struct Request
+    {
+        VkImage               srcImage;
+        RgExtent2D            size;
+        VkFormat              dstFormat;
+        std::filesystem::path filepath;
+    };
+
+    struct Batch
+    {
+        VkFence                       fence;
+        VkBuffer                      readback;
+        VkDeviceMemory                readbackMemory;
+        std::vector< VkImage >        intermediateImages;
+        std::vector< VkDeviceMemory > intermediateMemories;
+        std::vector< Request >        requests;
+        std::vector< VkDeviceSize >   offsets;
+    };
+
+    void SubmitBatch( std::span< Request > requests );
+    void FinishBatch( Batch& batch );
+    void DestroyBatch( Batch& batch );
 
     bool CheckSupport( VkPhysicalDevice physDevice,
                        VkFormat         srcImageFormat,
                        VkFormat         dstImageFormat );
 
 private:
+    VkDevice                                device;
+    std::shared_ptr< MemoryAllocator >      allocator;
+    std::shared_ptr< CommandBufferManager > cmdManager;
+    std::shared_ptr< ThreadPool >           threadPool;
+
+    std::vector< Request >             queued;
+    std::vector< Batch >               inFlight;
+    std::vector< std::future< bool > > fileWrites;
 };
 
 }
@@ -28,6 +28,7 @@
 
 #include "Generated/ShaderCommonC.h"
 
+#include <bit>
 #include <numeric>
 
 using namespace RTGL1;
@@ -46,6 +47,9 @@ static_assert( TEXTURES_PER_MATERIAL_COUNT == 4 );
 
 constexpr bool PreferExistingMaterials = true;
 
+// dynamic resolution usually jumps between a few lod biases
+constexpr uint32_t ResidentLodBiasBankCount = 3;
+
 template< typename T >
 constexpr const T* DefaultIfNull( const T* pData, const T* pDefault )
 {
@@ -71,6 +75,51 @@ auto FindEmptySlot( std::vector< Texture >& textures )
     } );
 }
 
+// Stable between runs, as it's saved to the export manifest
+uint64_t HashTextureExport( const ImageLoader::ResultInfo&      info,
+                            std::optional< RgTextureSwizzling > swizzling )
+{
+    const uint32_t values[] = {
+        info.baseSize.width,
+        info.baseSize.height,
+        uint32_t( info.format ),
+        info.isPregenerated ? info.levelCount : 0,
+        swizzling ? uint32_t( *swizzling ) + 1 : 0,
+    };
+
+    uint64_t h = Utils::HashFnv1a( info.pData, info.dataSize );
+    h          = Utils::HashFnv1a( values, sizeof( values ), h );
+
+    // 0 is reserved for 'not known'
+    return h != 0 ? h : 1;
+}
+
+uint64_t HashTextureContent( uint64_t exportHash, const SamplerManager::Handle& samplerHandle )
+{
+    uint64_t h = exportHash;
+    Utils::HashCombine( h, samplerHandle.GetHash() );
+
+    // 0 is reserved for 'not registered'
+    return h != 0 ? h : 1;
+}
+
+uint64_t HashImportedMaterial( std::span< const std::filesystem::path >  fullPaths,
+                               std::span< const SamplerManager::Handle > samplers,
+                               RgTextureSwizzling                        swizzling )
+{
+    uint64_t h = 0;
+    for( const auto& p : fullPaths )
+    {
+        Utils::HashCombine( h, p.native() );
+    }
+    for( const auto& s : samplers )
+    {
+        Utils::HashCombine( h, s.GetHash() );
+    }
+    Utils::HashCombine( h, uint32_t( swizzling ) );
+    return h;
+}
+
 }
 
 
@@ -78,15 +127,23 @@ TextureManager::TextureManager( VkDevice                                _device,
                                 std::shared_ptr< MemoryAllocator >      _memAllocator,
                                 std::shared_ptr< SamplerManager >       _samplerMgr,
                                 std::shared_ptr< CommandBufferManager > _cmdManager,
+                                std::shared_ptr< ThreadPool >           _threadPool,
                                 const std::filesystem::path&            _waterNormalTexturePath,
                                 const std::filesystem::path&            _dirtMaskTexturePath,
+                                const std::filesystem::path&            _devCompressedCacheFolder,
                                 RgTextureSwizzling                      _pbrSwizzling,
                                 bool                                    _forceNormalMapFilterLinear,
                                 const LibraryConfig&                    _config )
     : device( _device )
     , pbrSwizzling( _pbrSwizzling )
-    , imageLoaderKtx( std::make_shared< ImageLoader >() )
-    , imageLoaderRaw( std::make_shared< ImageLoaderDev >() )
+    , prefetcher( std::make_shared< TexturePrefetcher >(
+          _threadPool,
+          _config.compressDevTextures ? _devCompressedCacheFolder : std::filesystem::path() ) )
+    , imageLoaderKtx( std::make_shared< ImageLoader >( prefetcher ) )
+    , imageLoaderRaw( std::make_shared< ImageLoaderDev >(
+          _config.compressDevTextures ? _devCompressedCacheFolder : std::filesystem::path(),
+          _threadPool,
+          prefetcher ) )
     , isdevmode( _config.developerMode )
     , memAllocator( std::move( _memAllocator ) )
     , cmdManager( std::move( _cmdManager ) )
@@ -104,11 +161,21 @@ TextureManager::TextureManager( VkDevice                                _device,
     , forceNormalMapFilterLinear(_forceNormalMapFilterLinear  )
 {
     textureDesc = std::make_shared< TextureDescriptors >(
-        device, samplerMgr, TEXTURE_COUNT_MAX, BINDING_TEXTURES );
+        device, samplerMgr, TEXTURE_COUNT_MAX, BINDING_TEXTURES, ResidentLodBiasBankCount );
     textureUploader = std::make_shared< TextureUploader >( device, memAllocator );
+    textureExporter =
+        std::make_shared< TextureExporter >( memAllocator, cmdManager, std::move( _threadPool ) );
 
     textures.resize( TEXTURE_COUNT_MAX );
 
+    static_assert( TEXTURE_COUNT_MAX % 64 == 0 );
+    for( auto& dirty : dirtySlots )
+    {
+        dirty.resize( TEXTURE_COUNT_MAX / 64 );
+    }
+    // all descriptors must be initialized
+    MarkAllSlotsDirty();
+
     // submit cmd to create empty texture
     {
         VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
@@ -254,6 +321,9 @@ uint32_t TextureManager::CreateDirtMaskTexture( VkCommandBuffer              cmd
 
 TextureManager::~TextureManager()
 {
+    // wait for pending exports, as they read from the textures
+    textureExporter.reset();
+
     for( auto& texture : textures )
     {
         assert( ( texture.image == VK_NULL_HANDLE && texture.view == VK_NULL_HANDLE ) ||
@@ -272,13 +342,39 @@ TextureManager::~TextureManager()
             DestroyTexture( texture );
         }
     }
+
+    for( auto& texture : texturesToDestroyAfterExport )
+    {
+        DestroyTexture( texture );
+    }
 }
 
 void TextureManager::PrepareForFrame( uint32_t frameIndex )
 {
+    // submit exports that were requested during the previous frame,
+    // and write to disk the ones that were read back
+    textureExporter->FlushExports();
+    textureExporter->Poll();
+
+    // textures that are read by an export can be destroyed only after its batch is done,
+    // the batch is submitted at the next frame, so its fence is not covered by the frame's
+    std::erase_if( texturesToDestroyAfterExport, [ this ]( const Texture& t ) {
+        if( textureExporter->IsReadingImage( t.image ) )
+        {
+            return false;
+        }
+        DestroyTexture( t );
+        return true;
+    } );
+
     // destroy delayed textures
     for( auto& t : texturesToDestroy[ frameIndex ] )
     {
+        if( textureExporter->IsReadingImage( t.image ) )
+        {
+            texturesToDestroyAfterExport.push_back( std::move( t ) );
+            continue;
+        }
         DestroyTexture( t );
     }
     texturesToDestroy[ frameIndex ].clear();
@@ -287,6 +383,23 @@ void TextureManager::PrepareForFrame( uint32_t frameIndex )
     textureUploader->ClearStaging( frameIndex );
 }
 
+void TextureManager::BeginMapPrefetch( const std::filesystem::path& manifestPath )
+{
+    prefetcher->BeginMap( manifestPath, [ this ]( std::string_view materialName ) {
+        return materials.contains( materialName );
+    } );
+}
+
+bool TextureManager::IsStagingExhausted( uint32_t frameIndex ) const
+{
+    return textureUploader->IsStagingExhausted( frameIndex );
+}
+
+void TextureManager::ResetStaging( uint32_t frameIndex )
+{
+    textureUploader->ClearStaging( frameIndex );
+}
+
 void TextureManager::TryHotReload( VkCommandBuffer cmd, uint32_t frameIndex )
 {
     uint32_t count = 0;
@@ -316,7 +429,10 @@ void TextureManager::TryHotReload( VkCommandBuffer cmd, uint32_t frameIndex )
                 {
                     const auto prevSampler   = slot->samplerHandle;
                     const auto prevSwizzling = slot->swizzling;
+                    const auto prevRefCount  = slot->refCount;
 
+                    // contents are changed, so it can't be shared by the old hash
+                    UnregisterContentHash( *slot );
                     AddToBeDestroyed( frameIndex, *slot );
 
                     auto tindex = PrepareTexture( cmd,
@@ -332,6 +448,8 @@ void TextureManager::TryHotReload( VkCommandBuffer cmd, uint32_t frameIndex )
 
                     // must match, so materials' indices are still correct
                     assert( tindex == std::distance( textures.begin(), slot ) );
+                    slot->refCount   = prevRefCount;
+                    slot->exportHash = HashTextureExport( *ovrd.result, prevSwizzling );
 
                     count++;
                     break;
@@ -348,40 +466,63 @@ void TextureManager::TryHotReload( VkCommandBuffer cmd, uint32_t frameIndex )
     texturesToReload.clear();
 }
 
+void TextureManager::SubmitTextureUpdates( VkCommandBuffer cmd, uint32_t frameIndex )
+{
+    textureUploader->FlushImageUpdates( cmd, frameIndex );
+}
+
 void TextureManager::SubmitDescriptors( uint32_t                         frameIndex,
-                                        const RgDrawFrameTexturesParams& texturesParams,
-                                        bool                             forceUpdateAllDescriptors )
+                                        const RgDrawFrameTexturesParams& texturesParams )
 {
     // check if dynamic sampler filter was changed
     RgSamplerFilter newDynamicSamplerFilter = texturesParams.dynamicSamplerFilter;
 
+    bool checkAllSlots = false;
+
     if( currentDynamicSamplerFilter != newDynamicSamplerFilter )
     {
         currentDynamicSamplerFilter = newDynamicSamplerFilter;
-        forceUpdateAllDescriptors   = true;
+        checkAllSlots               = true;
     }
 
-
-    if( forceUpdateAllDescriptors )
+    // if mip lod bias was changed
+    if( textureDesc->SelectBank( frameIndex, samplerMgr->GetMipLodBiasBank() ) )
     {
-        textureDesc->ResetAllCache( frameIndex );
+        checkAllSlots = true;
     }
 
-    // update desc set with current values
-    for( uint32_t i = 0; i < textures.size(); i++ )
+    // descriptor cache is kept, so only the actually changed descriptors are written
+    if( checkAllSlots )
     {
-        textures[ i ].samplerHandle.SetIfHasDynamicSamplerFilter( newDynamicSamplerFilter );
+        MarkAllSlotsDirty();
+    }
 
+    // update desc set only for the slots that were changed
+    auto& dirty = dirtySlots[ frameIndex ];
 
-        if( textures[ i ].image != VK_NULL_HANDLE )
-        {
-            textureDesc->UpdateTextureDesc(
-                frameIndex, i, textures[ i ].view, textures[ i ].samplerHandle );
-        }
-        else
+    for( uint32_t w = 0; w < dirty.size(); w++ )
+    {
+        uint64_t bits = dirty[ w ];
+        dirty[ w ]    = 0;
+
+        while( bits != 0 )
         {
-            // reset descriptor to empty texture
-            textureDesc->ResetTextureDesc( frameIndex, i );
+            uint32_t i = w * 64 + uint32_t( std::countr_zero( bits ) );
+            bits &= bits - 1;
+
+            textures[ i ].samplerHandle.SetIfHasDynamicSamplerFilter( newDynamicSamplerFilter );
+
+
+            if( textures[ i ].image != VK_NULL_HANDLE )
+            {
+                textureDesc->UpdateTextureDesc(
+                    frameIndex, i, textures[ i ].view, textures[ i ].samplerHandle );
+            }
+            else
+            {
+                // reset descriptor to empty texture
+                textureDesc->ResetTextureDesc( frameIndex, i );
+            }
         }
     }
 
@@ -407,7 +548,7 @@ bool TextureManager::TryCreateMaterial( VkCommandBuffer              cmd,
 
     if( PreferExistingMaterials )
     {
-        if( materials.contains( info.pTextureName ) )
+        if( materials.contains( std::string_view( info.pTextureName ) ) )
         {
             debug::Verbose( "Material with the same name already exists, ignoring new data: {}",
                             info.pTextureName );
@@ -449,7 +590,28 @@ bool TextureManager::TryCreateMaterial( VkCommandBuffer              cmd,
     static_assert( TEXTURE_OCCLUSION_ROUGHNESS_METALLIC_INDEX == 1 );
 
 
-    MakeMaterial( cmd, frameIndex, info.pTextureName, ovrd, samplers, swizzlings );
+    // remember, to load them ahead next time;
+    // gathered before MakeMaterial, as it moves the paths out
+    {
+        TexturePrefetchFile files[ TEXTURES_PER_MATERIAL_COUNT ];
+        uint32_t            fileCount = 0;
+
+        for( const auto& o : ovrd )
+        {
+            if( o.isFromFile )
+            {
+                files[ fileCount++ ] = TexturePrefetchFile{
+                    .path   = o.path.string(),
+                    .isSRGB = o.isSRGB,
+                };
+            }
+        }
+
+        prefetcher->Record( info.pTextureName, std::span( files, fileCount ) );
+    }
+
+    MakeMaterial(
+        cmd, frameIndex, info.pTextureName, ovrd, samplers, swizzlings, !!info.isUpdateable );
     return true;
 }
 
@@ -458,27 +620,32 @@ void TextureManager::MakeMaterial( VkCommandBuffer
                                    std::string_view                                 materialName,
                                    std::span< TextureOverrides >                    ovrd,
                                    std::span< SamplerManager::Handle >              samplers,
-                                   std::span< std::optional< RgTextureSwizzling > > swizzlings )
+                                   std::span< std::optional< RgTextureSwizzling > > swizzlings,
+                                   bool                                             isUpdateable )
 {
     assert( ovrd.size() == TEXTURES_PER_MATERIAL_COUNT );
     assert( samplers.size() == TEXTURES_PER_MATERIAL_COUNT );
     assert( swizzlings.size() == TEXTURES_PER_MATERIAL_COUNT );
 
-    constexpr bool isUpdateable = false;
+    // only the provided pixels can be updated, a replacement file takes precedence over them
+    isUpdateable = isUpdateable && ovrd[ TEXTURE_ALBEDO_ALPHA_INDEX ].result &&
+                   !ovrd[ TEXTURE_ALBEDO_ALPHA_INDEX ].isFromFile;
 
     MaterialTextures mtextures = {};
     for( uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++ )
     {
-        mtextures.indices[ i ] = PrepareTexture( cmd,
-                                                 frameIndex,
-                                                 ovrd[ i ].result,
-                                                 samplers[ i ],
-                                                 true,
-                                                 ovrd[ i ].debugname,
-                                                 isUpdateable,
-                                                 swizzlings[ i ],
-                                                 std::move( ovrd[ i ].path ),
-                                                 FindEmptySlot( textures ) );
+        mtextures.indices[ i ] =
+            FindOrPrepareTexture( cmd,
+                                  frameIndex,
+                                  ovrd[ i ],
+                                  samplers[ i ],
+                                  swizzlings[ i ],
+                                  isUpdateable && i == TEXTURE_ALBEDO_ALPHA_INDEX );
+    }
+
+    if( mtextures.indices[ TEXTURE_ALBEDO_ALPHA_INDEX ] == EMPTY_TEXTURE_INDEX )
+    {
+        isUpdateable = false;
     }
 
     InsertMaterial( frameIndex,
@@ -489,8 +656,7 @@ void TextureManager::MakeMaterial( VkCommandBuffer
                     } );
 }
 
-bool TextureManager::TryCreateImportedMaterial( VkCommandBuffer                     cmd,
-                                                uint32_t                            frameIndex,
+bool TextureManager::TryCreateImportedMaterial( uint32_t                            frameIndex,
                                                 const std::string&                  materialName,
                                                 std::span< std::filesystem::path >  fullPaths,
                                                 std::span< SamplerManager::Handle > samplers,
@@ -498,6 +664,7 @@ bool TextureManager::TryCreateImportedMaterial( VkCommandBuffer
 {
     assert( fullPaths.size() == TEXTURES_PER_MATERIAL_COUNT );
     assert( samplers.size() == TEXTURES_PER_MATERIAL_COUNT );
+    assert( importCmd != VK_NULL_HANDLE );
 
     if( materialName.empty() )
     {
@@ -505,6 +672,21 @@ bool TextureManager::TryCreateImportedMaterial( VkCommandBuffer
         return false;
     }
 
+    const uint64_t signature = HashImportedMaterial( fullPaths, samplers, customPbrSwizzling );
+
+    if( auto prev = importedMaterials.find( materialName ); prev != importedMaterials.end() )
+    {
+        if( prev->second == signature && materials.contains( materialName ) )
+        {
+            touchedImportedMaterials.insert( materialName );
+            return true;
+        }
+
+        // source data was changed, recreate
+        TryDestroyMaterial( frameIndex, materialName.c_str() );
+        importedMaterials.erase( prev );
+    }
+
     if( PreferExistingMaterials )
     {
         if( materials.contains( materialName ) )
@@ -555,19 +737,148 @@ bool TextureManager::TryCreateImportedMaterial( VkCommandBuffer
     static_assert( TEXTURE_OCCLUSION_ROUGHNESS_METALLIC_INDEX == 1 );
 
     // to free later / to prevent export from ExportOriginalMaterialTextures
-    importedMaterials.insert( materialName );
+    importedMaterials[ materialName ] = signature;
+    touchedImportedMaterials.insert( materialName );
+
+    MakeMaterial( importCmd, frameIndex, materialName, ovrd, samplers, swizzlings, false );
+
+    // throttle big imports: flush, so the staging after the mark can be reused;
+    // the staging before the mark is still referenced by the frame's command buffer
+    if( textureUploader->IsStagingExhausted( frameIndex ) )
+    {
+        cmdManager->Submit( importCmd );
+        cmdManager->WaitGraphicsIdle();
+        textureUploader->RewindStaging( frameIndex, importStagingMark );
 
-    MakeMaterial( cmd, frameIndex, materialName, ovrd, samplers, swizzlings );
+        importCmd = cmdManager->StartGraphicsCmd();
+    }
     return true;
 }
 
+uint32_t TextureManager::FindOrPrepareTexture( VkCommandBuffer                     cmd,
+                                               uint32_t                            frameIndex,
+                                               TextureOverrides&                   ovrd,
+                                               SamplerManager::Handle              samplerHandle,
+                                               std::optional< RgTextureSwizzling > swizzling,
+                                               bool                                isUpdateable )
+{
+    constexpr bool useMipmaps = true;
+
+    // in devmode, hot-reload finds a texture by its file path,
+    // so each file must have its own slot;
+    // updateable texture must not be shared, as its contents will change
+    const bool dedup = ovrd.result && !isdevmode && !isUpdateable;
+
+    // contents of updateable texture are not known at the export time
+    const uint64_t exportHash =
+        ovrd.result && !isUpdateable ? HashTextureExport( *ovrd.result, swizzling ) : 0;
+
+    uint64_t contentHash = 0;
+
+    if( dedup )
+    {
+        contentHash = HashTextureContent( exportHash, samplerHandle );
+
+        auto f = texturesByContent.find( contentHash );
+        if( f != texturesByContent.end() )
+        {
+            Texture& existing = textures[ f->second ];
+
+            // protect from hash collisions
+            if( existing.size.width == ovrd.result->baseSize.width &&
+                existing.size.height == ovrd.result->baseSize.height &&
+                existing.format == ovrd.result->format && existing.swizzling == swizzling )
+            {
+                assert( existing.refCount > 0 );
+                existing.refCount++;
+                return f->second;
+            }
+        }
+    }
+
+    uint32_t index = PrepareTexture( cmd,
+                                     frameIndex,
+                                     ovrd.result,
+                                     samplerHandle,
+                                     useMipmaps,
+                                     ovrd.debugname,
+                                     isUpdateable,
+                                     swizzling,
+                                     std::move( ovrd.path ),
+                                     FindEmptySlot( textures ) );
+
+    if( index != EMPTY_TEXTURE_INDEX )
+    {
+        textures[ index ].exportHash = exportHash;
+    }
+
+    if( dedup && index != EMPTY_TEXTURE_INDEX )
+    {
+        textures[ index ].contentHash    = contentHash;
+        texturesByContent[ contentHash ] = index;
+    }
+
+    return index;
+}
+
+void TextureManager::UnregisterContentHash( Texture& texture )
+{
+    if( texture.contentHash == 0 )
+    {
+        return;
+    }
+
+    auto f = texturesByContent.find( texture.contentHash );
+
+    // on a collision, the entry might point to another texture
+    if( f != texturesByContent.end() && &textures[ f->second ] == &texture )
+    {
+        texturesByContent.erase( f );
+    }
+
+    texture.contentHash = 0;
+}
+
 void TextureManager::FreeAllImportedMaterials( uint32_t frameIndex )
 {
-    for( const auto& materialName : importedMaterials )
+    for( const auto& [ materialName, signature ] : importedMaterials )
     {
         TryDestroyMaterial( frameIndex, materialName.c_str() );
     }
     importedMaterials.clear();
+    touchedImportedMaterials.clear();
+}
+
+void TextureManager::BeginImportedMaterials( uint32_t frameIndex )
+{
+    assert( importCmd == VK_NULL_HANDLE );
+
+    touchedImportedMaterials.clear();
+    importCmd         = cmdManager->StartGraphicsCmd();
+    importStagingMark = textureUploader->MarkStaging( frameIndex );
+}
+
+void TextureManager::EndImportedMaterials( uint32_t frameIndex )
+{
+    // the frame's fence covers this submission, so the staging is freed with the frame's
+    cmdManager->Submit( importCmd );
+    importCmd = VK_NULL_HANDLE;
+
+    std::vector< std::string > toFree;
+    for( const auto& [ materialName, signature ] : importedMaterials )
+    {
+        if( !touchedImportedMaterials.contains( materialName ) )
+        {
+            toFree.push_back( materialName );
+        }
+    }
+
+    for( const std::string& materialName : toFree )
+    {
+        TryDestroyMaterial( frameIndex, materialName.c_str() );
+        importedMaterials.erase( materialName );
+    }
+    touchedImportedMaterials.clear();
 }
 
 uint32_t TextureManager::PrepareTexture( VkCommandBuffer                                 cmd,
@@ -639,6 +950,8 @@ uint32_t TextureManager::PrepareTexture( VkCommandBuffer
         return EMPTY_TEXTURE_INDEX;
     }
 
+    MarkSlotDirty( uint32_t( std::distance( textures.begin(), targetSlot ) ) );
+
     // insert
     *targetSlot = Texture{
         .image         = image,
@@ -648,6 +961,7 @@ uint32_t TextureManager::PrepareTexture( VkCommandBuffer
         .samplerHandle = samplerHandle,
         .swizzling     = uploadInfo.swizzling,
         .filepath      = std::move( filepath ),
+        .refCount      = 1,
     };
     return uint32_t( std::distance( textures.begin(), targetSlot ) );
 }
@@ -657,6 +971,7 @@ void TextureManager::InsertMaterial( uint32_t         frameIndex,
                                      const Material&  material )
 {
     auto [ iter, insertednew ] = materials.insert( { std::string( materialName ), material } );
+    materialLookupCache.Clear();
 
     if( !insertednew )
     {
@@ -685,7 +1000,18 @@ void TextureManager::DestroyMaterialTextures( uint32_t frameIndex, const Materia
     {
         if( t != EMPTY_TEXTURE_INDEX )
         {
-            AddToBeDestroyed( frameIndex, textures[ t ] );
+            Texture& texture = textures[ t ];
+
+            // destroy only if no other material uses it
+            assert( texture.refCount > 0 );
+            if( texture.refCount > 1 )
+            {
+                texture.refCount--;
+                continue;
+            }
+
+            UnregisterContentHash( texture );
+            AddToBeDestroyed( frameIndex, texture );
         }
     }
 }
@@ -697,7 +1023,7 @@ bool TextureManager::TryDestroyMaterial( uint32_t frameIndex, const char* materi
         return false;
     }
 
-    auto it = materials.find( materialName );
+    auto it = materials.find( std::string_view( materialName ) );
     if( it == materials.end() )
     {
         return false;
@@ -705,10 +1031,51 @@ bool TextureManager::TryDestroyMaterial( uint32_t frameIndex, const char* materi
 
     DestroyMaterialTextures( frameIndex, it->second );
     materials.erase( it );
+    materialLookupCache.Clear();
 
     return true;
 }
 
+bool TextureManager::TryUpdateMaterialRegion( const RgOriginalTextureRegionInfo& info )
+{
+    if( Utils::IsCstrEmpty( info.pTextureName ) )
+    {
+        debug::Warning(
+            "RgOriginalTextureRegionInfo::pTextureName must not be null or an empty string" );
+        return false;
+    }
+
+    if( info.pPixels == nullptr )
+    {
+        debug::Warning( "RgOriginalTextureRegionInfo::pPixels must not be null" );
+        return false;
+    }
+
+    auto it = materials.find( std::string_view( info.pTextureName ) );
+    if( it == materials.end() )
+    {
+        debug::Warning( "Material to update is not found: {}", info.pTextureName );
+        return false;
+    }
+
+    if( !it->second.isUpdateable )
+    {
+        debug::Warning( "Material was not created as updateable: {}", info.pTextureName );
+        return false;
+    }
+
+    const uint32_t albedo = it->second.textures.indices[ TEXTURE_ALBEDO_ALPHA_INDEX ];
+    assert( albedo != EMPTY_TEXTURE_INDEX && albedo < textures.size() );
+
+    const auto region = VkRect2D{
+        .offset = { int32_t( info.offsetX ), int32_t( info.offsetY ) },
+        .extent = { info.size.width, info.size.height },
+    };
+
+    return textureUploader->UpdateImageRegion(
+        textures[ albedo ].image, region, info.pPixels, info.rowPitch );
+}
+
 void TextureManager::DestroyTexture( const Texture& texture )
 {
     assert( texture.image != VK_NULL_HANDLE && texture.view != VK_NULL_HANDLE );
@@ -720,27 +1087,50 @@ void TextureManager::AddToBeDestroyed( uint32_t frameIndex, Texture& texture )
 {
     assert( texture.image != VK_NULL_HANDLE && texture.view != VK_NULL_HANDLE );
 
+    assert( &texture >= textures.data() && &texture < textures.data() + textures.size() );
+    MarkSlotDirty( uint32_t( &texture - textures.data() ) );
+
     texturesToDestroy[ frameIndex ].push_back( std::move( texture ) );
 
     // nullify the slot
     texture = {};
 }
 
-MaterialTextures TextureManager::GetMaterialTextures( const char* materialName ) const
+void TextureManager::MarkSlotDirty( uint32_t textureIndex )
 {
-    if( Utils::IsCstrEmpty( materialName ) )
+    assert( textureIndex < textures.size() );
+
+    for( auto& dirty : dirtySlots )
     {
-        return EmptyMaterialTextures;
+        dirty[ textureIndex / 64 ] |= uint64_t( 1 ) << ( textureIndex % 64 );
     }
+}
 
-    const auto it = materials.find( materialName );
+void TextureManager::MarkAllSlotsDirty()
+{
+    for( auto& dirty : dirtySlots )
+    {
+        std::ranges::fill( dirty, ~uint64_t( 0 ) );
+    }
+}
 
-    if( it == materials.end() )
+MaterialTextures TextureManager::GetMaterialTextures( const char* materialName ) const
+{
+    if( Utils::IsCstrEmpty( materialName ) )
     {
         return EmptyMaterialTextures;
     }
 
-    return it->second.textures;
+    return materialLookupCache.Find( materialName, [ this ]( std::string_view name ) {
+        const auto it = materials.find( name );
+
+        if( it == materials.end() )
+        {
+            return EmptyMaterialTextures;
+        }
+
+        return it->second.textures;
+    } );
 }
 
 VkDescriptorSet TextureManager::GetDescSet( uint32_t frameIndex ) const
@@ -759,6 +1149,9 @@ void TextureManager::OnFileChanged( FileType type, const std::filesystem::path&
         type == FileType::JPG )
     {
         texturesToReload.push_back( filepath );
+
+        // prefetched data is outdated
+        prefetcher->Forget( filepath );
     }
 }
 
@@ -799,9 +1192,11 @@ std::array< RgColor4DPacked32, 4 > TextureManager::GetColorForLayers(
     };
 }
 
-auto TextureManager::ExportMaterialTextures( const char*                  materialName,
-                                             const std::filesystem::path& folder,
-                                             bool                         overwriteExisting ) const
+auto TextureManager::ExportMaterialTextures(
+    const char*                        materialName,
+    const std::filesystem::path&       folder,
+    bool                               overwriteExisting,
+    const rgl::string_map< uint64_t >* previousHashes ) const
     -> std::array< ExportResult, TEXTURES_PER_MATERIAL_COUNT >
 {
     std::array< ExportResult, TEXTURES_PER_MATERIAL_COUNT > arr;
@@ -835,17 +1230,31 @@ auto TextureManager::ExportMaterialTextures( const char*                  materi
         bool asSrgb = ( i == TEXTURE_ALBEDO_ALPHA_INDEX ) || ( i == TEXTURE_EMISSIVE_INDEX );
         assert( asSrgb == Utils::IsSRGB( info.format ) );
 
-        bool exported = TextureExporter().ExportAsTGA( *memAllocator,
-                                                       *cmdManager,
-                                                       info.image,
-                                                       info.size,
-                                                       info.format,
-                                                       folder / relativeFilePath,
-                                                       asSrgb,
-                                                       overwriteExisting );
+        bool overwrite = overwriteExisting;
+        bool upToDate  = false;
+
+        if( previousHashes && info.exportHash != 0 )
+        {
+            auto prev = previousHashes->find( relativeFilePath.generic_string() );
+            if( prev != previousHashes->end() )
+            {
+                upToDate = prev->second == info.exportHash &&
+                           std::filesystem::exists( folder / relativeFilePath );
+                // content was changed since the last export
+                overwrite = true;
+            }
+        }
+
+        bool exported = upToDate || textureExporter->Export( info.image,
+                                                             info.size,
+                                                             info.format,
+                                                             folder / relativeFilePath,
+                                                             asSrgb,
+                                                             overwrite );
         if( exported )
         {
             arr[ i ].relativePath = relativeFilePath.string();
+            arr[ i ].contentHash  = info.exportHash;
 
             std::tie( arr[ i ].addressModeU, arr[ i ].addressModeV ) =
                 SamplerManager::AccessAddressModes( info.samplerHandle );
@@ -894,16 +1303,16 @@ void TextureManager::ExportOriginalMaterialTextures( const std::filesystem::path
             bool asSrgb = ( i == TEXTURE_ALBEDO_ALPHA_INDEX ) || ( i == TEXTURE_EMISSIVE_INDEX );
             assert( asSrgb == Utils::IsSRGB( info.format ) );
 
-            TextureExporter().ExportAsTGA( *memAllocator,
-                                           *cmdManager,
-                                           info.image,
-                                           info.size,
-                                           info.format,
-                                           folder / relativeFilePath,
-                                           asSrgb,
-                                           overwriteExisting );
+            textureExporter->Export( info.image,
+                                     info.size,
+                                     info.format,
+                                     folder / relativeFilePath,
+                                     asSrgb,
+                                     overwriteExisting );
         }
     }
+
+    textureExporter->FlushExports();
 }
 
 std::vector< TextureManager::Debug_MaterialInfo > TextureManager::Debug_GetMaterials() const
@@ -32,9 +32,13 @@
 #include "JsonParser.h"
 #include "Material.h"
 #include "MemoryAllocator.h"
+#include "NameCache.h"
 #include "SamplerManager.h"
 #include "TextureDescriptors.h"
+#include "TextureExporter.h"
+#include "ThreadPool.h"
 #include "TextureOverrides.h"
+#include "TexturePrefetcher.h"
 #include "TextureUploader.h"
 
 namespace RTGL1
@@ -51,8 +55,10 @@ public:
                     std::shared_ptr< MemoryAllocator >      memAllocator,
                     std::shared_ptr< SamplerManager >       samplerManager,
                     std::shared_ptr< CommandBufferManager > cmdManager,
+                    std::shared_ptr< ThreadPool >           threadPool,
                     const std::filesystem::path&            waterNormalTexturePath,
                     const std::filesystem::path&            dirtMaskTexturePath,
+                    const std::filesystem::path&            devCompressedCacheFolder,
                     RgTextureSwizzling                      pbrSwizzling,
                     bool                                    forceNormalMapFilterLinear,
                     const LibraryConfig&                    config );
@@ -66,26 +72,45 @@ public:
     void PrepareForFrame( uint32_t frameIndex );
     void TryHotReload( VkCommandBuffer cmd, uint32_t frameIndex );
 
-    void SubmitDescriptors( uint32_t                         frameIndex,
-                            const RgDrawFrameTexturesParams& texturesParams,
-                            bool                             forceUpdateAllDescriptors =
-                                false /* true, if mip lod bias was changed, for example */ );
+    // Save the list of files that were loaded on the previous map,
+    // and start decoding the files that were loaded on the new map last time
+    void BeginMapPrefetch( const std::filesystem::path& manifestPath );
+
+    // If true, uploads recorded with this frame index should be submitted and waited,
+    // then ResetStaging must be called, so the staging memory could be reused
+    bool IsStagingExhausted( uint32_t frameIndex ) const;
+    void ResetStaging( uint32_t frameIndex );
+
+    // Record copies of the regions of updateable textures that were changed this frame
+    void SubmitTextureUpdates( VkCommandBuffer cmd, uint32_t frameIndex );
+
+    void SubmitDescriptors( uint32_t frameIndex, const RgDrawFrameTexturesParams& texturesParams );
 
     bool TryCreateMaterial( VkCommandBuffer              cmd,
                             uint32_t                     frameIndex,
                             const RgOriginalTextureInfo& info,
                             const std::filesystem::path& ovrdFolder );
 
-    bool TryCreateImportedMaterial( VkCommandBuffer                     cmd,
-                                    uint32_t                            frameIndex,
+    // Must be called between BeginImportedMaterials / EndImportedMaterials
+    bool TryCreateImportedMaterial( uint32_t                            frameIndex,
                                     const std::string&                  materialName,
                                     std::span< std::filesystem::path >  fullPaths,
                                     std::span< SamplerManager::Handle > samplers,
                                     RgTextureSwizzling                  customPbrSwizzling );
     void FreeAllImportedMaterials( uint32_t frameIndex );
 
+    // Imported materials that are created again with the same data between Begin / End
+    // are kept as is, the rest is freed in EndImportedMaterials.
+    // Imported materials are recorded to a separate command buffer, which is flushed
+    // when the staging is exhausted, as the frame's command buffer can't be submitted early
+    void BeginImportedMaterials( uint32_t frameIndex );
+    void EndImportedMaterials( uint32_t frameIndex );
+
     bool TryDestroyMaterial( uint32_t frameIndex, const char* materialName );
 
+    // Changes a region of the albedo of a material that was created as updateable
+    bool TryUpdateMaterialRegion( const RgOriginalTextureRegionInfo& info );
+
 
     VkDescriptorSet       GetDescSet( uint32_t frameIndex ) const;
     VkDescriptorSetLayout GetDescSetLayout() const;
@@ -107,11 +132,16 @@ public:
         std::string          relativePath;
         RgSamplerAddressMode addressModeU{ RG_SAMPLER_ADDRESS_MODE_REPEAT };
         RgSamplerAddressMode addressModeV{ RG_SAMPLER_ADDRESS_MODE_REPEAT };
+        // 0, if the content is not known
+        uint64_t             contentHash{ 0 };
     };
 
-    auto ExportMaterialTextures( const char*                  materialName,
-                                 const std::filesystem::path& folder,
-                                 bool                         overwriteExisting ) const
+    // 'previousHashes' are content hashes of the files (relative to 'folder') from the last
+    // export: a file with the same hash is skipped, and with a different one is overwritten
+    auto ExportMaterialTextures( const char*                        materialName,
+                                 const std::filesystem::path&       folder,
+                                 bool                               overwriteExisting,
+                                 const rgl::string_map< uint64_t >* previousHashes = nullptr ) const
         -> std::array< ExportResult, TEXTURES_PER_MATERIAL_COUNT >;
 
     void ExportOriginalMaterialTextures( const std::filesystem::path& folder ) const;
@@ -140,7 +170,8 @@ private:
                        std::string_view                                 materialName,
                        std::span< TextureOverrides >                    ovrd,
                        std::span< SamplerManager::Handle >              samplers,
-                       std::span< std::optional< RgTextureSwizzling > > swizzlings );
+                       std::span< std::optional< RgTextureSwizzling > > swizzlings,
+                       bool                                             isUpdateable );
 
     uint32_t PrepareTexture( VkCommandBuffer                                 cmd,
                              uint32_t                                        frameIndex,
@@ -153,9 +184,21 @@ private:
                              std::filesystem::path&&                         filepath,
                              std::vector< Texture >::iterator                targetSlot );
 
+    uint32_t FindOrPrepareTexture( VkCommandBuffer                     cmd,
+                                   uint32_t                            frameIndex,
+                                   TextureOverrides&                   ovrd,
+                                   SamplerManager::Handle              samplerHandle,
+                                   std::optional< RgTextureSwizzling > swizzling,
+                                   bool                                isUpdateable );
+
+    void UnregisterContentHash( Texture& texture );
+
     void DestroyTexture( const Texture& texture );
     void AddToBeDestroyed( uint32_t frameIndex, Texture& texture );
 
+    void MarkSlotDirty( uint32_t textureIndex );
+    void MarkAllSlotsDirty();
+
     void InsertMaterial( uint32_t         frameIndex,
                          std::string_view materialName,
                          const Material&  material );
@@ -197,9 +240,10 @@ private:
     VkDevice           device;
     RgTextureSwizzling pbrSwizzling;
 
-    std::shared_ptr< ImageLoader >    imageLoaderKtx;
-    std::shared_ptr< ImageLoaderDev > imageLoaderRaw;
-    bool                              isdevmode;
+    std::shared_ptr< TexturePrefetcher > prefetcher;
+    std::shared_ptr< ImageLoader >       imageLoaderKtx;
+    std::shared_ptr< ImageLoaderDev >    imageLoaderRaw;
+    bool                                 isdevmode;
 
     std::shared_ptr< MemoryAllocator >      memAllocator;
     std::shared_ptr< CommandBufferManager > cmdManager;
@@ -207,15 +251,28 @@ private:
     std::shared_ptr< SamplerManager >     samplerMgr;
     std::shared_ptr< TextureDescriptors > textureDesc;
     std::shared_ptr< TextureUploader >    textureUploader;
+    std::shared_ptr< TextureExporter >    textureExporter;
 
     std::vector< Texture >               textures;
     // Textures are not destroyed immediately, but only when they are not in use anymore
     std::vector< Texture >               texturesToDestroy[ MAX_FRAMES_IN_FLIGHT ];
+    // Textures that were due to be destroyed, but a pending export still reads them
+    std::vector< Texture >               texturesToDestroyAfterExport;
     std::vector< std::filesystem::path > texturesToReload;
-
-    // TODO: string keys pool
-    rgl::unordered_map< std::string, Material > materials;
-    rgl::unordered_set< std::string >           importedMaterials;
+    // Bit per texture slot, if descriptor must be rewritten; per frame, as each has its own set
+    std::vector< uint64_t >              dirtySlots[ MAX_FRAMES_IN_FLIGHT ];
+    // Content hash to texture index, to share identical images between materials
+    rgl::unordered_map< uint64_t, uint32_t > texturesByContent;
+
+    rgl::string_map< Material > materials;
+    // Imported material name to the hash of its source data
+    rgl::string_map< uint64_t > importedMaterials;
+    rgl::string_set             touchedImportedMaterials;
+    // Imported materials are recorded here, not to the frame's command buffer
+    VkCommandBuffer              importCmd{ VK_NULL_HANDLE };
+    TextureUploader::StagingMark importStagingMark{};
+    // GetMaterialTextures is called for each primitive, mostly with the same name pointers
+    mutable NameCache< MaterialTextures > materialLookupCache;
 
     uint32_t waterNormalTextureIndex;
     uint32_t dirtMaskTextureIndex;
@@ -66,27 +66,144 @@ RTGL1::TextureMetaManager::TextureMetaManager( std::filesystem::path _databaseFo
 auto RTGL1::TextureMetaManager::Access( const char* pTextureName ) const
     -> std::optional< TextureMeta >
 {
-    if( Utils::IsCstrEmpty( pTextureName ) )
+    if( const Entry* e = Find( pTextureName ) )
     {
-        return std::nullopt;
+        return e->source;
     }
+    return std::nullopt;
+}
 
-    auto strTextureName = std::string( pTextureName );
+auto RTGL1::TextureMetaManager::Find( const char* pTextureName ) const -> const Entry*
+{
+    if( Utils::IsCstrEmpty( pTextureName ) )
     {
-        auto found = dataScene.find( strTextureName );
-        if( found != dataScene.end() )
+        return nullptr;
+    }
+
+    return lookupCache.Find( pTextureName, [ this ]( std::string_view name ) -> const Entry* {
         {
-            return found->second;
+            auto found = dataScene.find( name );
+            if( found != dataScene.end() )
+            {
+                return &found->second;
+            }
+        }
+        {
+            auto found = dataGlobal.find( name );
+            if( found != dataGlobal.end() )
+            {
+                return &found->second;
+            }
         }
+        return nullptr;
+    } );
+}
+
+auto RTGL1::TextureMetaManager::Compile( const TextureMeta& meta ) -> Compiled
+{
+    constexpr RgMeshPrimitiveFlags AllMedia = RG_MESH_PRIMITIVE_WATER | RG_MESH_PRIMITIVE_GLASS |
+                                              RG_MESH_PRIMITIVE_MIRROR | RG_MESH_PRIMITIVE_ACID;
+
+    RgMeshPrimitiveFlags andMask = ~0u;
+    RgMeshPrimitiveFlags orMask  = 0;
+
+    if( meta.forceGenerateNormals )
+    {
+        andMask &= ~RG_MESH_PRIMITIVE_DONT_GENERATE_NORMALS;
     }
+
+    if( meta.forceExactNormals )
+    {
+        orMask |= RG_MESH_PRIMITIVE_FORCE_EXACT_NORMALS;
+    }
+
+    if( meta.forceAlphaTest )
     {
-        auto found = dataGlobal.find( strTextureName );
-        if( found != dataGlobal.end() )
+        orMask |= RG_MESH_PRIMITIVE_ALPHA_TESTED;
+    }
+
+    if( meta.forceOpaque )
+    {
+        andMask &= ~( RG_MESH_PRIMITIVE_TRANSLUCENT | AllMedia );
+    }
+    else if( meta.forceTranslucent )
+    {
+        orMask |= RG_MESH_PRIMITIVE_TRANSLUCENT;
+    }
+
+    // these bits are not touched by the media selection below
+    if( meta.isGlassIfSmooth )
+    {
+        orMask |= RG_MESH_PRIMITIVE_GLASS_IF_SMOOTH;
+    }
+    else if( meta.isMirrorIfSmooth )
+    {
+        orMask |= RG_MESH_PRIMITIVE_MIRROR_IF_SMOOTH;
+    }
+
+    if( meta.isThinMedia )
+    {
+        orMask |= RG_MESH_PRIMITIVE_THIN_MEDIA;
+    }
+
+    auto selectMedia = [ & ]( bool isTranslucent ) -> RgMeshPrimitiveFlags {
+        if( meta.isWater || ( meta.isWaterIfTranslucent && isTranslucent ) )
+        {
+            return RG_MESH_PRIMITIVE_WATER;
+        }
+        if( meta.isGlass || ( meta.isGlassIfTranslucent && isTranslucent ) )
+        {
+            return RG_MESH_PRIMITIVE_GLASS;
+        }
+        if( meta.isMirror )
+        {
+            return RG_MESH_PRIMITIVE_MIRROR;
+        }
+        if( meta.isAcid )
         {
-            return found->second;
+            return RG_MESH_PRIMITIVE_ACID;
         }
+        return 0;
+    };
+
+    Compiled c = {
+        .andMask               = andMask,
+        .orMask                = orMask,
+        .forceOpaqueAlpha      = meta.forceOpaque,
+        .andMaskByTranslucency = {},
+        .orMaskByTranslucency  = {},
+        .ignoreByTranslucency  = {},
+        .emissive              = Utils::Saturate( meta.emissiveMult ),
+        .pbrInfo =
+            RgEditorPBRInfo{
+                .metallicDefault  = Utils::Saturate( meta.metallicDefault ),
+                .roughnessDefault = Utils::Saturate( meta.roughnessDefault ),
+            },
+        .attachedLightIntensity     = meta.attachedLightIntensity,
+        .attachedLightColor         = Utils::PackColor( meta.attachedLightColor[ 0 ],
+                                                meta.attachedLightColor[ 1 ],
+                                                meta.attachedLightColor[ 2 ],
+                                                255 ),
+        .attachedLightExists        = false,
+        .attachedLightEvenOnDynamic = meta.attachedLightEvenOnDynamic,
+    };
+
+    c.attachedLightExists = c.attachedLightIntensity > 0.0f &&
+                            !Utils::IsColor4DPacked32Zero< false >( c.attachedLightColor );
+
+    for( int isTranslucent = 0; isTranslucent < 2; isTranslucent++ )
+    {
+        RgMeshPrimitiveFlags media = selectMedia( isTranslucent );
+
+        // if media is selected, it replaces others; otherwise, flags are kept
+        c.andMaskByTranslucency[ isTranslucent ] = media ? ~AllMedia : ~0u;
+        c.orMaskByTranslucency[ isTranslucent ]  = media;
+
+        c.ignoreByTranslucency[ isTranslucent ] =
+            meta.forceIgnore || ( meta.forceIgnoreIfRasterized && isTranslucent );
     }
-    return std::nullopt;
+
+    return c;
 }
 
 void RTGL1::TextureMetaManager::RereadFromFiles( std::filesystem::path sceneFile )
@@ -95,6 +212,7 @@ void RTGL1::TextureMetaManager::RereadFromFiles( std::filesystem::path sceneFile
 
     dataGlobal.clear();
     dataScene.clear();
+    lookupCache.Clear();
 
     auto reread = [ this ]( const std::filesystem::path& filepath, auto& data ) {
         if( !std::filesystem::exists( filepath ) )
@@ -109,7 +227,12 @@ void RTGL1::TextureMetaManager::RereadFromFiles( std::filesystem::path sceneFile
                 if( !data.contains( v.textureName ) )
                 {
                     std::string key = v.textureName;
-                    data.insert_or_assign( key, std::move( v ) );
+                    Compiled    c   = Compile( v );
+                    data.insert_or_assign( key,
+                                           Entry{
+                                               .source   = std::move( v ),
+                                               .compiled = c,
+                                           } );
                 }
                 else
                 {
@@ -133,121 +256,41 @@ bool RTGL1::TextureMetaManager::Modify( RgMeshPrimitiveInfo& prim,
 {
     assert( prim.pEditorInfo == &editor );
 
-    if( auto meta = Access( prim.pTextureName ) )
+    const Entry* e = Find( prim.pTextureName );
+    if( !e )
     {
-        if( meta->forceGenerateNormals )
-        {
-            prim.flags &= ~RG_MESH_PRIMITIVE_DONT_GENERATE_NORMALS;
-        }
-
-        if( meta->forceExactNormals )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_FORCE_EXACT_NORMALS;
-        }
-
-        if( meta->forceAlphaTest )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_ALPHA_TESTED;
-        }
-
-        if( meta->forceOpaque )
-        {
-            prim.flags &= ~RG_MESH_PRIMITIVE_TRANSLUCENT;
-            prim.flags &= ~RG_MESH_PRIMITIVE_WATER;
-            prim.flags &= ~RG_MESH_PRIMITIVE_GLASS;
-            prim.flags &= ~RG_MESH_PRIMITIVE_MIRROR;
-            prim.flags &= ~RG_MESH_PRIMITIVE_ACID;
-
-            auto c     = Utils::UnpackColor4DPacked32Components( prim.color );
-            prim.color = Utils::PackColor( c[ 0 ], c[ 1 ], c[ 2 ], 255 );
-        }
-        else if( meta->forceTranslucent )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_TRANSLUCENT;
-        }
-        bool isTranslucent =
-            ( prim.flags & RG_MESH_PRIMITIVE_TRANSLUCENT ) ||
-            ( Utils::UnpackAlphaFromPacked32( prim.color ) < MESH_TRANSLUCENT_ALPHA_THRESHOLD );
-
-        {
-            editor.attachedLight.intensity = meta->attachedLightIntensity;
-            editor.attachedLight.color     = Utils::PackColor( meta->attachedLightColor[ 0 ],
-                                                           meta->attachedLightColor[ 1 ],
-                                                           meta->attachedLightColor[ 2 ],
-                                                           255 );
-            editor.attachedLightExists =
-                editor.attachedLight.intensity > 0.0f &&
-                !Utils::IsColor4DPacked32Zero< false >( editor.attachedLight.color );
-
-            if( meta->attachedLightEvenOnDynamic )
-            {
-                editor.attachedLightEvenOnDynamic = true;
-            }
-        }
-
-        if( ( meta->isWater ) || ( meta->isWaterIfTranslucent && isTranslucent ) )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_WATER;
-            prim.flags &= ~RG_MESH_PRIMITIVE_GLASS;
-            prim.flags &= ~RG_MESH_PRIMITIVE_MIRROR;
-            prim.flags &= ~RG_MESH_PRIMITIVE_ACID;
-        }
-        else if( ( meta->isGlass ) || ( meta->isGlassIfTranslucent && isTranslucent ) )
-        {
-            prim.flags &= ~RG_MESH_PRIMITIVE_WATER;
-            prim.flags |= RG_MESH_PRIMITIVE_GLASS;
-            prim.flags &= ~RG_MESH_PRIMITIVE_MIRROR;
-            prim.flags &= ~RG_MESH_PRIMITIVE_ACID;
-        }
-        else if( meta->isMirror )
-        {
-            prim.flags &= ~RG_MESH_PRIMITIVE_WATER;
-            prim.flags &= ~RG_MESH_PRIMITIVE_GLASS;
-            prim.flags |= RG_MESH_PRIMITIVE_MIRROR;
-            prim.flags &= ~RG_MESH_PRIMITIVE_ACID;
-        }
-        else if( meta->isAcid )
-        {
-            prim.flags &= ~RG_MESH_PRIMITIVE_WATER;
-            prim.flags &= ~RG_MESH_PRIMITIVE_GLASS;
-            prim.flags &= ~RG_MESH_PRIMITIVE_MIRROR;
-            prim.flags |= RG_MESH_PRIMITIVE_ACID;
-        }
+        return true;
+    }
+    const Compiled& c = e->compiled;
 
-        if( meta->isGlassIfSmooth )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_GLASS_IF_SMOOTH;
-        }
-        else if( meta->isMirrorIfSmooth )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_MIRROR_IF_SMOOTH;
-        }
+    prim.flags = ( prim.flags & c.andMask ) | c.orMask;
 
-        if( meta->isThinMedia )
-        {
-            prim.flags |= RG_MESH_PRIMITIVE_THIN_MEDIA;
-        }
+    if( c.forceOpaqueAlpha )
+    {
+        prim.color |= Utils::PackColor( 0, 0, 0, 255 );
+    }
 
-        prim.emissive = Utils::Saturate( meta->emissiveMult );
+    const int isTranslucent =
+        ( prim.flags & RG_MESH_PRIMITIVE_TRANSLUCENT ) ||
+        ( Utils::UnpackAlphaFromPacked32( prim.color ) < MESH_TRANSLUCENT_ALPHA_THRESHOLD );
 
-        editor.pbrInfoExists = true;
-        {
-            editor.pbrInfo.metallicDefault  = Utils::Saturate( meta->metallicDefault );
-            editor.pbrInfo.roughnessDefault = Utils::Saturate( meta->roughnessDefault );
-        }
+    prim.flags = ( prim.flags & c.andMaskByTranslucency[ isTranslucent ] ) |
+                 c.orMaskByTranslucency[ isTranslucent ];
 
-        if( meta->forceIgnore )
-        {
-            return false;
-        }
+    prim.emissive = c.emissive;
 
-        if( meta->forceIgnoreIfRasterized && isTranslucent )
-        {
-            return false;
-        }
+    editor.attachedLight.intensity = c.attachedLightIntensity;
+    editor.attachedLight.color     = c.attachedLightColor;
+    editor.attachedLightExists     = c.attachedLightExists;
+    if( c.attachedLightEvenOnDynamic )
+    {
+        editor.attachedLightEvenOnDynamic = true;
     }
 
-    return true;
+    editor.pbrInfoExists = true;
+    editor.pbrInfo       = c.pbrInfo;
+
+    return !c.ignoreByTranslucency[ isTranslucent ];
 }
 
 void RTGL1::TextureMetaManager::RereadFromFiles( std::string_view currentSceneName )
@@ -24,6 +24,7 @@
 #include "Containers.h"
 #include "IFileDependency.h"
 #include "JsonParser.h"
+#include "NameCache.h"
 
 #include <string>
 
@@ -48,7 +49,38 @@ public:
     void OnFileChanged( FileType type, const std::filesystem::path& filepath ) override;
 
 private:
-    void RereadFromFiles( std::filesystem::path sceneFile );
+    // TextureMeta reduced to what Modify needs, so it's applied with a few bitwise operations
+    struct Compiled
+    {
+        // applied first
+        RgMeshPrimitiveFlags andMask;
+        RgMeshPrimitiveFlags orMask;
+        bool                 forceOpaqueAlpha;
+
+        // applied after, index is 1 if primitive is translucent after the first step
+        RgMeshPrimitiveFlags andMaskByTranslucency[ 2 ];
+        RgMeshPrimitiveFlags orMaskByTranslucency[ 2 ];
+        bool                 ignoreByTranslucency[ 2 ];
+
+        float             emissive;
+        RgEditorPBRInfo   pbrInfo;
+        float             attachedLightIntensity;
+        RgColor4DPacked32 attachedLightColor;
+        bool              attachedLightExists;
+        bool              attachedLightEvenOnDynamic;
+    };
+
+    struct Entry
+    {
+        TextureMeta source;
+        Compiled    compiled;
+    };
+
+    static Compiled Compile( const TextureMeta& meta );
+
+private:
+    void         RereadFromFiles( std::filesystem::path sceneFile );
+    const Entry* Find( const char* pTextureName ) const;
 
 private:
     std::filesystem::path databaseFolder;
@@ -56,8 +88,11 @@ private:
     std::filesystem::path sourceGlobal;
     std::filesystem::path sourceScene;
 
-    rgl::unordered_map< std::string, TextureMeta > dataGlobal;
-    rgl::unordered_map< std::string, TextureMeta > dataScene;
+    rgl::string_map< Entry > dataGlobal;
+    rgl::string_map< Entry > dataScene;
+
+    // pointers to the values of dataScene / dataGlobal
+    mutable NameCache< const Entry* > lookupCache;
 };
 
 }
\ No newline at end of file
@@ -52,11 +52,25 @@ namespace loader
     namespace detail
     {
         template< typename T >
-        auto LoadByFullPath( T& specificLoader, const std::filesystem::path& filepath )
+        auto LoadSpecific( T& specificLoader, const std::filesystem::path& filepath, bool isSRGB )
+        {
+            // only raw images need a color space, to filter their generated mip chain
+            if constexpr( std::is_same_v< T, ImageLoaderDev > )
+            {
+                return specificLoader.Load( filepath, isSRGB );
+            }
+            else
+            {
+                return specificLoader.Load( filepath );
+            }
+        }
+
+        template< typename T >
+        auto LoadByFullPath( T& specificLoader, const std::filesystem::path& filepath, bool isSRGB )
         {
             if( std::filesystem::is_regular_file( filepath ) )
             {
-                if( auto r = specificLoader.Load( filepath ) )
+                if( auto r = LoadSpecific( specificLoader, filepath, isSRGB ) )
                 {
                     return r;
                 }
@@ -71,6 +85,7 @@ namespace loader
                           const std::filesystem::path&,
                           std::string_view,
                           std::string_view,
+                          bool,
                           std::filesystem::path& outPath )
         {
             assert( outPath.empty() );
@@ -83,6 +98,7 @@ namespace loader
                           const std::filesystem::path& ovrdFolder,
                           std::string_view             name,
                           std::string_view             postfix,
+                          bool                         isSRGB,
                           std::filesystem::path&       outPath )
         {
             if( auto l = std::get< I >( loaders ) )
@@ -96,7 +112,7 @@ namespace loader
                     auto filepath =
                         TextureOverrides::GetTexturePath( basePath, name, postfix, ext );
 
-                    if( auto r = LoadByFullPath( *l, filepath ) )
+                    if( auto r = LoadByFullPath( *l, filepath, isSRGB ) )
                     {
                         outPath = std::move( filepath );
                         return r;
@@ -104,29 +120,31 @@ namespace loader
                 }
             }
 
-            return LoadByIndex< I + 1 >( loaders, ovrdFolder, name, postfix, outPath );
+            return LoadByIndex< I + 1 >( loaders, ovrdFolder, name, postfix, isSRGB, outPath );
         }
 
         template< size_t I, typename Loaders >
             requires( I >= std::tuple_size_v< Loaders > )
-        auto LoadByFullPathByIndex( Loaders&, const std::filesystem::path& )
+        auto LoadByFullPathByIndex( Loaders&, const std::filesystem::path&, bool )
         {
             return std::optional< ImageLoader::ResultInfo >{};
         }
 
         template< size_t I, typename Loaders >
             requires( I < std::tuple_size_v< Loaders > )
-        auto LoadByFullPathByIndex( Loaders& loaders, const std::filesystem::path& filepath )
+        auto LoadByFullPathByIndex( Loaders&                     loaders,
+                                    const std::filesystem::path& filepath,
+                                    bool                         isSRGB )
         {
             if( auto l = std::get< I >( loaders ) )
             {
-                if( auto r = LoadByFullPath( *l, filepath ) )
+                if( auto r = LoadByFullPath( *l, filepath, isSRGB ) )
                 {
                     return r;
                 }
             }
 
-            return LoadByFullPathByIndex< I + 1 >( loaders, filepath );
+            return LoadByFullPathByIndex< I + 1 >( loaders, filepath, isSRGB );
         }
     }
 
@@ -135,15 +153,16 @@ namespace loader
                const std::filesystem::path& ovrdFolder,
                std::string_view             name,
                std::string_view             postfix,
+               bool                         isSRGB,
                std::filesystem::path&       outPath )
     {
-        return detail::LoadByIndex< 0 >( loaders, ovrdFolder, name, postfix, outPath );
+        return detail::LoadByIndex< 0 >( loaders, ovrdFolder, name, postfix, isSRGB, outPath );
     }
 
     template< typename Loaders >
-    auto Load( Loaders& loaders, const std::filesystem::path& fullpath )
+    auto Load( Loaders& loaders, const std::filesystem::path& fullpath, bool isSRGB )
     {
-        return detail::LoadByFullPathByIndex< 0 >( loaders, fullpath );
+        return detail::LoadByFullPathByIndex< 0 >( loaders, fullpath, isSRGB );
     }
 
     template< typename Loaders >
@@ -174,19 +193,23 @@ TextureOverrides::TextureOverrides( const std::filesystem::path& _ovrdFolder,
                                     const RgExtent2D&            _defaultSize,
                                     VkFormat                     _defaultFormat,
                                     Loader                       _loader )
-    : result{ std::nullopt }, debugname{}, iloader( std::move( _loader ) )
+    : result{ std::nullopt }
+    , debugname{}
+    , isFromFile{ false }
+    , isSRGB{ Utils::IsSRGB( _defaultFormat ) }
+    , iloader( std::move( _loader ) )
 {
     Utils::SafeCstrCopy( debugname, _name );
 
     
     std::visit(
         [ & ]( auto&& specific ) {
-            if( auto r = loader::Load( specific, _ovrdFolder, _name, _postfix, path ) )
+            if( auto r = loader::Load( specific, _ovrdFolder, _name, _postfix, isSRGB, path ) )
             {
-                r->format = Utils::IsSRGB( _defaultFormat ) ? Utils::ToSRGB( r->format )
-                                                            : Utils::ToUnorm( r->format );
+                r->format = isSRGB ? Utils::ToSRGB( r->format ) : Utils::ToUnorm( r->format );
 
-                result = r;
+                result     = r;
+                isFromFile = true;
             }
         },
         iloader );
@@ -219,18 +242,23 @@ TextureOverrides::TextureOverrides( const std::filesystem::path& _ovrdFolder,
 TextureOverrides::TextureOverrides( const std::filesystem::path& _fullPath,
                                     bool                         _isSRGB,
                                     Loader                       _loader )
-    : result{ std::nullopt }, debugname{}, iloader( std::move( _loader ) )
+    : result{ std::nullopt }
+    , debugname{}
+    , isFromFile{ false }
+    , isSRGB{ _isSRGB }
+    , iloader( std::move( _loader ) )
 {
     Utils::SafeCstrCopy( debugname, _fullPath.string() );
 
     std::visit(
         [ & ]( auto&& specific ) {
-            if( auto r = loader::Load( specific, _fullPath ) )
+            if( auto r = loader::Load( specific, _fullPath, isSRGB ) )
             {
-                r->format = _isSRGB ? Utils::ToSRGB( r->format ) : Utils::ToUnorm( r->format );
+                r->format = isSRGB ? Utils::ToSRGB( r->format ) : Utils::ToUnorm( r->format );
 
-                result = r;
-                path   = _fullPath;
+                result     = r;
+                path       = _fullPath;
+                isFromFile = true;
             }
         },
         iloader );
@@ -65,6 +65,9 @@ struct TextureOverrides
     std::optional< ImageLoader::ResultInfo > result;
     char                                     debugname[ TEXTURE_DEBUG_NAME_MAX_LENGTH ];
     std::filesystem::path                    path;
+    // false, if defaults are used
+    bool                                     isFromFile;
+    bool                                     isSRGB;
 
 private:
     Loader iloader;
@@ -0,0 +1,233 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "TexturePrefetcher.h"
+
+#include "ImageLoaderDev.h"
+#include "ThreadPool.h"
+
+namespace
+{
+
+// Load a file by a separate loader instance, that is owned by the result,
+// as loaders are not thread-safe and free all their data at once
+template< typename Loader, typename... Args >
+std::optional< RTGL1::TexturePrefetcher::Prefetched > LoadWithOwnLoader(
+    const std::filesystem::path& filepath, bool isSRGB, Args&&... args )
+{
+    auto loader = std::shared_ptr< Loader >( new Loader( std::forward< Args >( args )... ),
+                                             []( Loader* l ) {
+                                                 l->FreeLoaded();
+                                                 delete l;
+                                             } );
+
+    // only raw images need a color space, to filter their generated mip chain
+    std::optional< RTGL1::ImageLoader::ResultInfo > r;
+    if constexpr( std::is_same_v< Loader, RTGL1::ImageLoaderDev > )
+    {
+        r = loader->Load( filepath, isSRGB );
+    }
+    else
+    {
+        r = loader->Load( filepath );
+    }
+
+    if( r )
+    {
+        return RTGL1::TexturePrefetcher::Prefetched{
+            .result = *r,
+            .owner  = std::move( loader ),
+        };
+    }
+
+    return std::nullopt;
+}
+
+bool IsKTX2( const std::filesystem::path& filepath )
+{
+    for( const char* ext : RTGL1::ImageLoader::GetExtensions() )
+    {
+        if( filepath.extension() == ext )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+RTGL1::TexturePrefetcher::TexturePrefetcher( std::shared_ptr< ThreadPool > _threadPool,
+                                             std::filesystem::path         _devCacheFolder )
+    : threadPool( std::move( _threadPool ) ), cacheFolder( std::move( _devCacheFolder ) )
+{
+}
+
+RTGL1::TexturePrefetcher::~TexturePrefetcher()
+{
+    SaveManifest();
+}
+
+void RTGL1::TexturePrefetcher::BeginMap(
+    const std::filesystem::path&                     newManifestPath,
+    const std::function< bool( std::string_view ) >& isMaterialLoaded )
+{
+    SaveManifest();
+
+    // unused files of the previous map are freed when their decoding is done
+    pending.clear();
+    recorded.clear();
+    recordedNames.clear();
+
+    manifestPath = newManifestPath;
+
+    if( !threadPool )
+    {
+        return;
+    }
+
+    auto manifest = json_parser::ReadFileAs< TexturePrefetchManifest >( manifestPath );
+    if( !manifest )
+    {
+        return;
+    }
+
+    for( const TexturePrefetchEntry& entry : manifest->array )
+    {
+        if( isMaterialLoaded( entry.materialName ) )
+        {
+            continue;
+        }
+
+        for( const TexturePrefetchFile& file : entry.files )
+        {
+            if( pending.contains( file.path ) )
+            {
+                continue;
+            }
+
+            auto task = [ filepath = std::filesystem::path( file.path ),
+                          isSRGB   = file.isSRGB,
+                          folder   = cacheFolder,
+                          pool     = threadPool ]() -> Prefetched {
+                std::optional< Prefetched > r;
+
+                if( IsKTX2( filepath ) )
+                {
+                    r = LoadWithOwnLoader< ImageLoader >( filepath, isSRGB );
+                }
+                else
+                {
+                    r = LoadWithOwnLoader< ImageLoaderDev >( filepath, isSRGB, folder, pool );
+                }
+
+                // empty owner, if failed
+                return r ? std::move( *r ) : Prefetched{};
+            };
+
+            pending.emplace( file.path,
+                             Pending{
+                                 .isSRGB = file.isSRGB,
+                                 .result = threadPool->Enqueue( std::move( task ) ),
+                             } );
+        }
+    }
+
+    debug::Verbose( "Prefetching {} texture files from {}", pending.size(), manifestPath.string() );
+}
+
+void RTGL1::TexturePrefetcher::Record( std::string_view                       materialName,
+                                       std::span< const TexturePrefetchFile > files )
+{
+    if( manifestPath.empty() || files.empty() )
+    {
+        return;
+    }
+
+    if( recordedNames.contains( std::string( materialName ) ) )
+    {
+        return;
+    }
+    recordedNames.emplace( materialName );
+
+    recorded.push_back( TexturePrefetchEntry{
+        .materialName = std::string( materialName ),
+        .files        = std::vector( files.begin(), files.end() ),
+    } );
+}
+
+auto RTGL1::TexturePrefetcher::TryTake( const std::filesystem::path& filepath, bool isSRGB )
+    -> std::optional< Prefetched >
+{
+    if( pending.empty() )
+    {
+        return std::nullopt;
+    }
+
+    auto found = pending.find( filepath.string() );
+    if( found == pending.end() )
+    {
+        return std::nullopt;
+    }
+
+    // mips were generated for another color space
+    if( found->second.isSRGB != isSRGB )
+    {
+        pending.erase( found );
+        return std::nullopt;
+    }
+
+    // don't block the main thread, if the decoding is still in progress: the caller
+    // loads the file by itself, and the prefetched result is dropped when done
+    if( found->second.result.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+    {
+        pending.erase( found );
+        return std::nullopt;
+    }
+
+    Prefetched p = found->second.result.get();
+    pending.erase( found );
+
+    if( !p.owner )
+    {
+        return std::nullopt;
+    }
+    return p;
+}
+
+void RTGL1::TexturePrefetcher::Forget( const std::filesystem::path& filepath )
+{
+    pending.erase( filepath.string() );
+}
+
+void RTGL1::TexturePrefetcher::SaveManifest() const
+{
+    // nothing was touched, keep the old manifest
+    if( manifestPath.empty() || recorded.empty() )
+    {
+        return;
+    }
+
+    json_parser::WriteFile( manifestPath,
+                            TexturePrefetchManifest{
+                                .array = recorded,
+                            } );
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "Containers.h"
+#include "ImageLoader.h"
+#include "JsonParser.h"
+
+#include <functional>
+#include <future>
+
+namespace RTGL1
+{
+
+class ThreadPool;
+
+// Records override files that were loaded while a map was active, and on the next load
+// of that map, decodes them ahead on worker threads, so they are ready when the game
+// provides the original textures during the first frames.
+class TexturePrefetcher
+{
+public:
+    struct Prefetched
+    {
+        ImageLoader::ResultInfo result;
+        // keeps result.pData alive
+        std::shared_ptr< void > owner;
+    };
+
+public:
+    TexturePrefetcher( std::shared_ptr< ThreadPool > threadPool,
+                       std::filesystem::path         devCompressedCacheFolder );
+    ~TexturePrefetcher();
+
+    TexturePrefetcher( const TexturePrefetcher& other )                = delete;
+    TexturePrefetcher( TexturePrefetcher&& other ) noexcept            = delete;
+    TexturePrefetcher& operator=( const TexturePrefetcher& other )     = delete;
+    TexturePrefetcher& operator=( TexturePrefetcher&& other ) noexcept = delete;
+
+    // Save the manifest of the previous map, drop its unused prefetched files,
+    // and start decoding the files from the manifest of the new map.
+    // Materials for which isMaterialLoaded returns true are skipped.
+    void BeginMap( const std::filesystem::path&                   manifestPath,
+                   const std::function< bool( std::string_view ) >& isMaterialLoaded );
+
+    void Record( std::string_view materialName, std::span< const TexturePrefetchFile > files );
+
+    // If the file was prefetched in the same color space and its decoding is done,
+    // gives away the ownership
+    std::optional< Prefetched > TryTake( const std::filesystem::path& filepath, bool isSRGB );
+    void                        Forget( const std::filesystem::path& filepath );
+
+private:
+    struct Pending
+    {
+        bool                      isSRGB;
+        std::future< Prefetched > result;
+    };
+
+    void SaveManifest() const;
+
+private:
+    std::shared_ptr< ThreadPool > threadPool;
+    std::filesystem::path         cacheFolder;
+
+    std::filesystem::path                      manifestPath;
+    std::vector< TexturePrefetchEntry >        recorded;
+    rgl::unordered_set< std::string >          recordedNames;
+    rgl::unordered_map< std::string, Pending > pending;
+};
+
+}
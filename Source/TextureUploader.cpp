@@ -28,10 +28,108 @@
 
 using namespace RTGL1;
 
+namespace
+{
+// multiple of any texel block size, and of 4, as required by vkCmdCopyBufferToImage
+constexpr VkDeviceSize StagingAlignment = 16;
+
+// if there are more dirty regions, they're merged into one
+constexpr size_t MaxDirtyRects = 8;
+
+uint64_t RectArea( const VkRect2D& r )
+{
+    return uint64_t( r.extent.width ) * r.extent.height;
+}
+
+VkRect2D RectUnion( const VkRect2D& a, const VkRect2D& b )
+{
+    int32_t x0 = std::min( a.offset.x, b.offset.x );
+    int32_t y0 = std::min( a.offset.y, b.offset.y );
+    int32_t x1 = std::max( a.offset.x + int32_t( a.extent.width ),
+                           b.offset.x + int32_t( b.extent.width ) );
+    int32_t y1 = std::max( a.offset.y + int32_t( a.extent.height ),
+                           b.offset.y + int32_t( b.extent.height ) );
+
+    return VkRect2D{
+        .offset = { x0, y0 },
+        .extent = { uint32_t( x1 - x0 ), uint32_t( y1 - y0 ) },
+    };
+}
+
+void MergeDirtyRect( std::vector< VkRect2D >& rects, VkRect2D r )
+{
+    // merge while the bounding rect is not larger than the separate ones,
+    // i.e. they overlap or touch
+    for( size_t i = 0; i < rects.size(); )
+    {
+        VkRect2D u = RectUnion( rects[ i ], r );
+
+        if( RectArea( u ) <= RectArea( rects[ i ] ) + RectArea( r ) )
+        {
+            r = u;
+            rects.erase( rects.begin() + ptrdiff_t( i ) );
+
+            // the grown rect might touch the already checked ones
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if( rects.size() >= MaxDirtyRects )
+    {
+        for( const VkRect2D& other : rects )
+        {
+            r = RectUnion( r, other );
+        }
+        rects.clear();
+    }
+
+    rects.push_back( r );
+}
+}
+
 TextureUploader::TextureUploader( VkDevice                           _device,
-                                  std::shared_ptr< MemoryAllocator > _memAllocator )
-    : device( _device ), memAllocator( std::move( _memAllocator ) )
+                                  std::shared_ptr< MemoryAllocator > _memAllocator,
+                                  VkDeviceSize                       _stagingRingSize )
+    : device( _device ), memAllocator( std::move( _memAllocator ) ), stagingRingSize( 0 )
 {
+    VkBufferCreateInfo ringInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size  = _stagingRingSize,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    };
+
+    for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+    {
+        void* mapped = nullptr;
+
+        VkBuffer buffer = memAllocator->CreateStagingSrcTextureBuffer(
+            &ringInfo, "Texture staging ring", &mapped );
+
+        if( buffer == VK_NULL_HANDLE )
+        {
+            // all uploads will use dedicated buffers
+            debug::Warning( "Couldn't allocate texture staging ring of size {}", _stagingRingSize );
+
+            for( uint32_t j = 0; j < i; j++ )
+            {
+                memAllocator->DestroyStagingSrcTextureBuffer( stagingRings[ j ].buffer );
+                stagingRings[ j ] = {};
+            }
+            return;
+        }
+        SET_DEBUG_NAME( device, buffer, VK_OBJECT_TYPE_BUFFER, "Texture staging ring" );
+
+        stagingRings[ i ] = StagingRing{
+            .buffer = buffer,
+            .mapped = static_cast< uint8_t* >( mapped ),
+        };
+    }
+
+    stagingRingSize = _stagingRingSize;
 }
 
 TextureUploader::~TextureUploader()
@@ -42,11 +140,16 @@ TextureUploader::~TextureUploader()
         {
             memAllocator->DestroyStagingSrcTextureBuffer( staging );
         }
+
+        if( stagingRings[ i ].buffer != VK_NULL_HANDLE )
+        {
+            memAllocator->DestroyStagingSrcTextureBuffer( stagingRings[ i ].buffer );
+        }
     }
 
     for( auto& p : updateableImageInfos )
     {
-        memAllocator->DestroyStagingSrcTextureBuffer( p.second.stagingBuffer );
+        DestroyUpdateableStaging( p.second );
     }
 }
 
@@ -59,6 +162,90 @@ void TextureUploader::ClearStaging( uint32_t frameIndex )
     }
 
     stagingToFree[ frameIndex ].clear();
+
+    stagingRings[ frameIndex ].offset    = 0;
+    stagingRings[ frameIndex ].exhausted = false;
+}
+
+bool TextureUploader::IsStagingExhausted( uint32_t frameIndex ) const
+{
+    return stagingRings[ frameIndex ].exhausted;
+}
+
+TextureUploader::StagingMark TextureUploader::MarkStaging( uint32_t frameIndex ) const
+{
+    return StagingMark{
+        .ringOffset     = stagingRings[ frameIndex ].offset,
+        .dedicatedCount = stagingToFree[ frameIndex ].size(),
+    };
+}
+
+void TextureUploader::RewindStaging( uint32_t frameIndex, const StagingMark& mark )
+{
+    auto& dedicated = stagingToFree[ frameIndex ];
+    assert( mark.dedicatedCount <= dedicated.size() );
+
+    for( size_t i = mark.dedicatedCount; i < dedicated.size(); i++ )
+    {
+        memAllocator->DestroyStagingSrcTextureBuffer( dedicated[ i ] );
+    }
+    dedicated.resize( mark.dedicatedCount );
+
+    assert( mark.ringOffset <= stagingRings[ frameIndex ].offset );
+    stagingRings[ frameIndex ].offset    = mark.ringOffset;
+    stagingRings[ frameIndex ].exhausted = false;
+}
+
+TextureUploader::StagingAllocation TextureUploader::AllocateStaging( uint32_t     frameIndex,
+                                                                     VkDeviceSize size,
+                                                                     const char*  pDebugName )
+{
+    StagingRing& ring = stagingRings[ frameIndex ];
+
+    if( ring.buffer != VK_NULL_HANDLE && size <= stagingRingSize )
+    {
+        VkDeviceSize start = Utils::Align( ring.offset, StagingAlignment );
+
+        if( start + size <= stagingRingSize )
+        {
+            ring.offset = start + size;
+
+            return StagingAllocation{
+                .buffer = ring.buffer,
+                .offset = start,
+                .mapped = ring.mapped + start,
+            };
+        }
+
+        // the ring is full: spill, and notify the caller to flush the uploads
+        ring.exhausted = true;
+    }
+
+
+    // too large, or the ring is full: dedicated buffer
+    VkBufferCreateInfo stagingInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size  = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    };
+
+    void*    mapped = nullptr;
+    VkBuffer buffer =
+        memAllocator->CreateStagingSrcTextureBuffer( &stagingInfo, pDebugName, &mapped );
+    if( buffer == VK_NULL_HANDLE )
+    {
+        return {};
+    }
+    SET_DEBUG_NAME( device, buffer, VK_OBJECT_TYPE_BUFFER, pDebugName );
+
+    // destroy when it won't be in use
+    stagingToFree[ frameIndex ].push_back( buffer );
+
+    return StagingAllocation{
+        .buffer = buffer,
+        .offset = 0,
+        .mapped = mapped,
+    };
 }
 
 bool TextureUploader::DoesFormatSupportBlit( VkFormat format ) const
@@ -175,13 +362,14 @@ void TextureUploader::PrepareMipmaps( VkCommandBuffer cmd,
 
 void TextureUploader::CopyStagingToImage( VkCommandBuffer   cmd,
                                           VkBuffer          staging,
+                                          VkDeviceSize      stagingOffset,
                                           VkImage           image,
                                           const RgExtent2D& size,
                                           uint32_t          baseLayer,
                                           uint32_t          layerCount )
 {
     VkBufferImageCopy copyRegion = {};
-    copyRegion.bufferOffset      = 0;
+    copyRegion.bufferOffset      = stagingOffset;
     // tigthly packed
     copyRegion.bufferRowLength                 = 0;
     copyRegion.bufferImageHeight               = 0;
@@ -198,6 +386,7 @@ void TextureUploader::CopyStagingToImage( VkCommandBuffer   cmd,
 
 void TextureUploader::CopyStagingToImageMipmaps( VkCommandBuffer   cmd,
                                                  VkBuffer          staging,
+                                                 VkDeviceSize      stagingOffset,
                                                  VkImage           image,
                                                  uint32_t          layerIndex,
                                                  const UploadInfo& info )
@@ -214,7 +403,7 @@ void TextureUploader::CopyStagingToImageMipmaps( VkCommandBuffer   cmd,
         auto& cr = copyRegions[ mipLevel ];
 
         cr                                 = {};
-        cr.bufferOffset                    = info.pLevelDataOffsets[ mipLevel ];
+        cr.bufferOffset                    = stagingOffset + info.pLevelDataOffsets[ mipLevel ];
         cr.bufferRowLength                 = 0;
         cr.bufferImageHeight               = 0;
         cr.imageExtent                     = { mipWidth, mipHeight, 1 };
@@ -264,10 +453,11 @@ bool TextureUploader::CreateImage( const UploadInfo& info, VkImage* result )
     return true;
 }
 
-void TextureUploader::PrepareImage( VkImage           image,
-                                    VkBuffer          staging[],
-                                    const UploadInfo& info,
-                                    ImagePrepareType  prepareType )
+void TextureUploader::PrepareImage( VkImage            image,
+                                    const VkBuffer     staging[],
+                                    const VkDeviceSize stagingOffsets[],
+                                    const UploadInfo&  info,
+                                    ImagePrepareType   prepareType )
 {
     VkCommandBuffer   cmd         = info.cmd;
     const RgExtent2D& size        = info.baseSize;
@@ -315,11 +505,8 @@ void TextureUploader::PrepareImage( VkImage           image,
     {
         if( AreMipmapsPregenerated( info ) )
         {
-            // copy all mip levels from memory
-
-            assert( layerCount == 1 );
-
-            const uint32_t layerIndex = 0;
+            // copy all mip levels from memory;
+            // for cubemaps, each face has its own mip chain with the same level offsets
 
             // set layout for copying
             Utils::BarrierImage( cmd,
@@ -337,7 +524,15 @@ void TextureUploader::PrepareImage( VkImage           image,
             curLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
             curStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
-            CopyStagingToImageMipmaps( cmd, staging[ layerIndex ], image, layerIndex, info );
+            for( uint32_t layer = 0; layer < layerCount; layer++ )
+            {
+                CopyStagingToImageMipmaps( cmd,
+                                           staging[ layer ],
+                                           stagingOffsets ? stagingOffsets[ layer ] : 0,
+                                           image,
+                                           layer,
+                                           info );
+            }
         }
         else
         {
@@ -362,7 +557,13 @@ void TextureUploader::PrepareImage( VkImage           image,
                 curStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
                 // copy only first mipmap
-                CopyStagingToImage( cmd, staging[ layer ], image, size, layer, 1 );
+                CopyStagingToImage( cmd,
+                                    staging[ layer ],
+                                    stagingOffsets ? stagingOffsets[ layer ] : 0,
+                                    image,
+                                    size,
+                                    layer,
+                                    1 );
             }
         }
     }
@@ -541,33 +742,43 @@ TextureUploader::UploadResult TextureUploader::UploadImage( const UploadInfo& in
     }
 
 
-    VkResult r;
-    void*    mappedData;
-    VkImage  image;
+    VkImage image;
 
+    // updateable images own their staging buffers for the whole lifetime
+    UpdateableImageInfo updateInfo = {};
 
-    // 1. Allocate and fill buffer
 
-    VkBufferCreateInfo stagingInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size  = dataSize,
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    };
+    // 1. Allocate and fill buffer
 
-    VkBuffer stagingBuffer =
-        memAllocator->CreateStagingSrcTextureBuffer( &stagingInfo, info.pDebugName, &mappedData );
-    if( stagingBuffer == VK_NULL_HANDLE )
+    if( info.isUpdateable )
     {
-        return {};
+        VkBufferCreateInfo stagingInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size  = dataSize,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        };
+
+        for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+        {
+            updateInfo.stagingBuffers[ i ] = memAllocator->CreateStagingSrcTextureBuffer(
+                &stagingInfo, info.pDebugName, &updateInfo.mappedData[ i ] );
+
+            if( updateInfo.stagingBuffers[ i ] == VK_NULL_HANDLE )
+            {
+                DestroyUpdateableStaging( updateInfo );
+                return {};
+            }
+            SET_DEBUG_NAME(
+                device, updateInfo.stagingBuffers[ i ], VK_OBJECT_TYPE_BUFFER, info.pDebugName );
+        }
     }
-    SET_DEBUG_NAME( device, stagingBuffer, VK_OBJECT_TYPE_BUFFER, info.pDebugName );
 
 
     bool wasCreated = CreateImage( info, &image );
     if( !wasCreated )
     {
         // clean created resources
-        memAllocator->DestroyStagingSrcTextureBuffer( stagingBuffer );
+        DestroyUpdateableStaging( updateInfo );
         return {};
     }
 
@@ -576,15 +787,32 @@ TextureUploader::UploadResult TextureUploader::UploadImage( const UploadInfo& in
     if( info.isUpdateable && data == nullptr )
     {
         // create image without copying
-        PrepareImage( image, VK_NULL_HANDLE, info, ImagePrepareType::INIT_WITHOUT_COPYING );
+        PrepareImage( image, nullptr, nullptr, info, ImagePrepareType::INIT_WITHOUT_COPYING );
     }
-    else
+    else if( info.isUpdateable )
     {
         // copy image data to buffer
-        memcpy( mappedData, data, dataSize );
+        memcpy( updateInfo.mappedData[ info.frameIndex ], data, dataSize );
 
         // and copy it to image
-        PrepareImage( image, &stagingBuffer, info, ImagePrepareType::INIT );
+        PrepareImage( image,
+                      &updateInfo.stagingBuffers[ info.frameIndex ],
+                      nullptr,
+                      info,
+                      ImagePrepareType::INIT );
+    }
+    else
+    {
+        StagingAllocation staging = AllocateStaging( info.frameIndex, dataSize, info.pDebugName );
+        if( staging.buffer == VK_NULL_HANDLE )
+        {
+            memAllocator->DestroyTextureImage( image );
+            return {};
+        }
+
+        memcpy( staging.mapped, data, dataSize );
+
+        PrepareImage( image, &staging.buffer, &staging.offset, info, ImagePrepareType::INIT );
     }
 
 
@@ -597,24 +825,21 @@ TextureUploader::UploadResult TextureUploader::UploadImage( const UploadInfo& in
     // save info about created image
     if( info.isUpdateable )
     {
-        // for updateable images: save pointer for updating the image data in the future
+        // for updateable images: save pointers for updating the image data in the future
 
-        updateableImageInfos[ image ] = UpdateableImageInfo{
-            .stagingBuffer   = stagingBuffer,
-            .mappedData      = mappedData,
-            .dataSize        = static_cast< uint32_t >( dataSize ),
-            .imageSize       = size,
-            .generateMipmaps = info.useMipmaps,
-            .format          = info.format,
-        };
-    }
-    else
-    {
-        // for static images that won't be updated:
-        // push staging buffer to be deleted when it won't be in use
-        stagingToFree[ info.frameIndex ].push_back( stagingBuffer );
-    }
+        updateInfo.shadow.resize( dataSize );
+        if( data != nullptr )
+        {
+            memcpy( updateInfo.shadow.data(), data, dataSize );
+        }
 
+        updateInfo.dataSize        = static_cast< uint32_t >( dataSize );
+        updateInfo.imageSize       = size;
+        updateInfo.generateMipmaps = info.useMipmaps;
+        updateInfo.format          = info.format;
+
+        updateableImageInfos[ image ] = std::move( updateInfo );
+    }
 
     return UploadResult{
         .wasUploaded = true,
@@ -623,7 +848,10 @@ TextureUploader::UploadResult TextureUploader::UploadImage( const UploadInfo& in
     };
 }
 
-void TextureUploader::UpdateImage( VkCommandBuffer cmd, VkImage targetImage, const void* data )
+void TextureUploader::UpdateImage( VkCommandBuffer cmd,
+                                   uint32_t        frameIndex,
+                                   VkImage         targetImage,
+                                   const void*     data )
 {
     assert( targetImage != VK_NULL_HANDLE );
     assert( data != nullptr );
@@ -634,17 +862,314 @@ void TextureUploader::UpdateImage( VkCommandBuffer cmd, VkImage targetImage, con
     {
         auto& updateInfo = it->second;
 
-        assert( updateInfo.mappedData != nullptr );
-        memcpy( updateInfo.mappedData, data, updateInfo.dataSize );
+        memcpy( updateInfo.shadow.data(), data, updateInfo.dataSize );
 
-        UploadInfo info = {};
-        info.cmd        = cmd;
-        info.baseSize   = updateInfo.imageSize;
-        info.useMipmaps = updateInfo.generateMipmaps;
-        info.format     = updateInfo.format;
+        // whole image is overwritten
+        updateInfo.dirtyRects = {
+            VkRect2D{
+                .offset = { 0, 0 },
+                .extent = { updateInfo.imageSize.width, updateInfo.imageSize.height },
+            },
+        };
 
-        // copy from staging
-        PrepareImage( targetImage, &updateInfo.stagingBuffer, info, ImagePrepareType::UPDATE );
+        RecordImageUpdate( cmd, frameIndex, targetImage, updateInfo );
+    }
+}
+
+bool TextureUploader::UpdateImageRegion( VkImage         targetImage,
+                                         const VkRect2D& region,
+                                         const void*     pData,
+                                         uint32_t        rowPitch )
+{
+    assert( targetImage != VK_NULL_HANDLE );
+    assert( pData != nullptr );
+
+    auto it = updateableImageInfos.find( targetImage );
+    if( it == updateableImageInfos.end() )
+    {
+        debug::Warning( "UpdateImageRegion: image is not updateable" );
+        return false;
+    }
+
+    auto& updateInfo = it->second;
+
+    if( !DoesFormatSupportBlit( updateInfo.format ) )
+    {
+        debug::Warning( "UpdateImageRegion: only RGBA8 images support region updates" );
+        return false;
+    }
+
+    if( region.extent.width == 0 || region.extent.height == 0 )
+    {
+        return true;
+    }
+
+    if( region.offset.x < 0 || region.offset.y < 0 ||
+        uint32_t( region.offset.x ) + region.extent.width > updateInfo.imageSize.width ||
+        uint32_t( region.offset.y ) + region.extent.height > updateInfo.imageSize.height )
+    {
+        debug::Warning( "UpdateImageRegion: region ({},{}) ({}x{}) is out of image bounds ({}x{})",
+                        region.offset.x,
+                        region.offset.y,
+                        region.extent.width,
+                        region.extent.height,
+                        updateInfo.imageSize.width,
+                        updateInfo.imageSize.height );
+        return false;
+    }
+
+    constexpr uint32_t texelSize = 4;
+
+    const uint32_t srcRowSize = region.extent.width * texelSize;
+    const uint32_t srcPitch   = rowPitch != 0 ? rowPitch : srcRowSize;
+    const uint32_t dstPitch   = updateInfo.imageSize.width * texelSize;
+
+    const auto* src = static_cast< const uint8_t* >( pData );
+    uint8_t*    dst = updateInfo.shadow.data() + uint64_t( region.offset.y ) * dstPitch +
+                   uint64_t( region.offset.x ) * texelSize;
+
+    for( uint32_t row = 0; row < region.extent.height; row++ )
+    {
+        memcpy( dst, src, srcRowSize );
+
+        src += srcPitch;
+        dst += dstPitch;
+    }
+
+    MergeDirtyRect( updateInfo.dirtyRects, region );
+    return true;
+}
+
+void TextureUploader::FlushImageUpdates( VkCommandBuffer cmd, uint32_t frameIndex )
+{
+    for( auto& p : updateableImageInfos )
+    {
+        if( !p.second.dirtyRects.empty() )
+        {
+            RecordImageUpdate( cmd, frameIndex, p.first, p.second );
+        }
+    }
+}
+
+void TextureUploader::RecordImageUpdate( VkCommandBuffer      cmd,
+                                         uint32_t             frameIndex,
+                                         VkImage              image,
+                                         UpdateableImageInfo& updateInfo )
+{
+    auto& rects = updateInfo.dirtyRects;
+    if( rects.empty() )
+    {
+        return;
+    }
+
+    // only regions are copied to the frame's staging, as the other frame
+    // might still be reading its own staging
+    constexpr uint32_t texelSize = 4;
+    assert( DoesFormatSupportBlit( updateInfo.format ) );
+
+    const uint32_t pitch   = updateInfo.imageSize.width * texelSize;
+    auto*          staging = static_cast< uint8_t* >( updateInfo.mappedData[ frameIndex ] );
+
+    VkBufferImageCopy copyRegions[ MaxDirtyRects ];
+    assert( rects.size() <= MaxDirtyRects );
+
+    for( uint32_t i = 0; i < rects.size(); i++ )
+    {
+        const VkRect2D& r = rects[ i ];
+
+        const uint64_t offset =
+            uint64_t( r.offset.y ) * pitch + uint64_t( r.offset.x ) * texelSize;
+
+        for( uint32_t row = 0; row < r.extent.height; row++ )
+        {
+            memcpy( staging + offset + uint64_t( row ) * pitch,
+                    updateInfo.shadow.data() + offset + uint64_t( row ) * pitch,
+                    r.extent.width * texelSize );
+        }
+
+        copyRegions[ i ] = VkBufferImageCopy{
+            .bufferOffset      = offset,
+            .bufferRowLength   = updateInfo.imageSize.width,
+            .bufferImageHeight = updateInfo.imageSize.height,
+            .imageSubresource =
+                {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = 0,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1,
+                },
+            .imageOffset = { r.offset.x, r.offset.y, 0 },
+            .imageExtent = { r.extent.width, r.extent.height, 1 },
+        };
+    }
+
+
+    UploadInfo info = {};
+    info.cmd        = cmd;
+    info.baseSize   = updateInfo.imageSize;
+    info.useMipmaps = updateInfo.generateMipmaps;
+    info.format     = updateInfo.format;
+
+    const uint32_t mipmapCount = GetMipmapCount( info.baseSize, info );
+
+    auto levelRange = []( uint32_t level, uint32_t count ) {
+        return VkImageSubresourceRange{
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = level,
+            .levelCount     = count,
+            .baseArrayLayer = 0,
+            .layerCount     = 1,
+        };
+    };
+
+    constexpr VkPipelineStageFlags shaderStages =
+        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+
+    // 1. Copy regions to the first mip, the layout transition
+    //    preserves the contents, as only the regions are overwritten
+
+    Utils::BarrierImage( cmd,
+                         image,
+                         VK_ACCESS_SHADER_READ_BIT,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         shaderStages,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         levelRange( 0, 1 ) );
+
+    vkCmdCopyBufferToImage( cmd,
+                            updateInfo.stagingBuffers[ frameIndex ],
+                            image,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            uint32_t( rects.size() ),
+                            copyRegions );
+
+    if( mipmapCount <= 1 )
+    {
+        Utils::BarrierImage( cmd,
+                             image,
+                             VK_ACCESS_TRANSFER_WRITE_BIT,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             shaderStages,
+                             levelRange( 0, 1 ) );
+
+        rects.clear();
+        return;
+    }
+
+
+    // 2. Regenerate only the affected regions of the other mips
+
+    Utils::BarrierImage( cmd,
+                         image,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         levelRange( 0, 1 ) );
+
+    VkImageBlit blits[ MaxDirtyRects ];
+
+    uint32_t prevWidth  = updateInfo.imageSize.width;
+    uint32_t prevHeight = updateInfo.imageSize.height;
+
+    for( uint32_t mipLevel = 1; mipLevel < mipmapCount; mipLevel++ )
+    {
+        uint32_t width  = std::max( prevWidth >> 1, 1u );
+        uint32_t height = std::max( prevHeight >> 1, 1u );
+
+        Utils::BarrierImage( cmd,
+                             image,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_ACCESS_TRANSFER_WRITE_BIT,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             shaderStages,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             levelRange( mipLevel, 1 ) );
+
+        for( uint32_t i = 0; i < rects.size(); i++ )
+        {
+            const VkRect2D& r = rects[ i ];
+
+            // texels of this level that are affected by the region of the base level
+            const uint32_t baseX0 = uint32_t( r.offset.x );
+            const uint32_t baseY0 = uint32_t( r.offset.y );
+            const uint32_t baseX1 = baseX0 + r.extent.width;
+            const uint32_t baseY1 = baseY0 + r.extent.height;
+            const uint32_t round  = ( 1u << mipLevel ) - 1;
+
+            uint32_t dstX0 = std::min( baseX0 >> mipLevel, width - 1 );
+            uint32_t dstY0 = std::min( baseY0 >> mipLevel, height - 1 );
+            uint32_t dstX1 = std::min( ( baseX1 + round ) >> mipLevel, width );
+            uint32_t dstY1 = std::min( ( baseY1 + round ) >> mipLevel, height );
+
+            // on odd sizes, the last texel of the full-size blit also covers the last column / row
+            uint32_t srcX1 = dstX1 == width ? prevWidth : std::min( dstX1 * 2, prevWidth );
+            uint32_t srcY1 = dstY1 == height ? prevHeight : std::min( dstY1 * 2, prevHeight );
+
+            blits[ i ] = VkImageBlit{
+                .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel - 1, 0, 1 },
+                .srcOffsets     = { { int32_t( dstX0 * 2 ), int32_t( dstY0 * 2 ), 0 },
+                                    { int32_t( srcX1 ), int32_t( srcY1 ), 1 } },
+                .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 0, 1 },
+                .dstOffsets     = { { int32_t( dstX0 ), int32_t( dstY0 ), 0 },
+                                    { int32_t( dstX1 ), int32_t( dstY1 ), 1 } },
+            };
+        }
+
+        vkCmdBlitImage( cmd,
+                        image,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        image,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        uint32_t( rects.size() ),
+                        blits,
+                        VK_FILTER_LINEAR );
+
+        Utils::BarrierImage( cmd,
+                             image,
+                             VK_ACCESS_TRANSFER_WRITE_BIT,
+                             VK_ACCESS_TRANSFER_READ_BIT,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             levelRange( mipLevel, 1 ) );
+
+        prevWidth  = width;
+        prevHeight = height;
+    }
+
+    Utils::BarrierImage( cmd,
+                         image,
+                         VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_ACCESS_SHADER_READ_BIT,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         shaderStages,
+                         levelRange( 0, mipmapCount ) );
+
+    rects.clear();
+}
+
+void TextureUploader::DestroyUpdateableStaging( UpdateableImageInfo& updateInfo )
+{
+    for( auto& b : updateInfo.stagingBuffers )
+    {
+        if( b != VK_NULL_HANDLE )
+        {
+            memAllocator->DestroyStagingSrcTextureBuffer( b );
+            b = VK_NULL_HANDLE;
+        }
     }
 }
 
@@ -655,9 +1180,9 @@ void TextureUploader::DestroyImage( VkImage image, VkImageView view )
     // if it's updateable
     if( it != updateableImageInfos.end() )
     {
-        // destroy its staging buffer, as it exists during
+        // destroy its staging buffers, as they exist during
         // the overall lifetime of an updateable image
-        memAllocator->DestroyStagingSrcTextureBuffer( it->second.stagingBuffer );
+        DestroyUpdateableStaging( it->second );
 
         updateableImageInfos.erase( it );
     }
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "Common.h"
+#include "Const.h"
 #include "MemoryAllocator.h"
 #include "RTGL1/RTGL1.h"
 
@@ -66,7 +67,9 @@ public:
     };
 
 public:
-    TextureUploader( VkDevice device, std::shared_ptr< MemoryAllocator > memAllocator );
+    TextureUploader( VkDevice                           device,
+                     std::shared_ptr< MemoryAllocator > memAllocator,
+                     VkDeviceSize stagingRingSize = TEXTURE_STAGING_RING_SIZE );
     virtual ~TextureUploader();
 
     TextureUploader( const TextureUploader& other )     = delete;
@@ -76,11 +79,39 @@ public:
 
     // Clear staging buffer for given frame index.
     void                 ClearStaging( uint32_t frameIndex );
+    // True, if uploads didn't fit into the staging ring of the frame, and had to spill
+    // to dedicated buffers. The caller should submit and wait, and then call ClearStaging.
+    bool                 IsStagingExhausted( uint32_t frameIndex ) const;
+
+    struct StagingMark
+    {
+        VkDeviceSize ringOffset;
+        size_t       dedicatedCount;
+    };
+    // Staging allocated after the mark can be reused with RewindStaging, when the commands
+    // that read it are completed, while the staging before the mark is still in use
+    StagingMark          MarkStaging( uint32_t frameIndex ) const;
+    void                 RewindStaging( uint32_t frameIndex, const StagingMark& mark );
 
     virtual UploadResult UploadImage( const UploadInfo& info );
-    void                 UpdateImage( VkCommandBuffer cmd, VkImage targetImage, const void* data );
     void                 DestroyImage( VkImage image, VkImageView view );
 
+    // Replace the whole image data of an updateable image, the copy is recorded immediately.
+    void                 UpdateImage( VkCommandBuffer cmd,
+                                      uint32_t        frameIndex,
+                                      VkImage         targetImage,
+                                      const void*     data );
+    // Replace a sub-rectangle of an updateable image. pData points to the first texel
+    // of the region, rowPitch is in bytes (0, if tightly packed). Copies are deferred
+    // until the next FlushImageUpdates, so the overlapping regions are merged.
+    bool                 UpdateImageRegion( VkImage         targetImage,
+                                            const VkRect2D& region,
+                                            const void*     pData,
+                                            uint32_t        rowPitch );
+    // Record copies of all regions that were updated since the last flush,
+    // using the staging of this frame index
+    void                 FlushImageUpdates( VkCommandBuffer cmd, uint32_t frameIndex );
+
 protected:
     enum class ImagePrepareType
     {
@@ -106,46 +137,89 @@ protected:
     // Image must have TRANSFER_DST layout
     static void CopyStagingToImage( VkCommandBuffer   cmd,
                                     VkBuffer          staging,
+                                    VkDeviceSize      stagingOffset,
                                     VkImage           image,
                                     const RgExtent2D& size,
                                     uint32_t          baseLayer,
                                     uint32_t          layerCount );
     void        CopyStagingToImageMipmaps( VkCommandBuffer   cmd,
                                            VkBuffer          staging,
+                                           VkDeviceSize      stagingOffset,
                                            VkImage           image,
                                            uint32_t          layerIndex,
                                            const UploadInfo& info );
 
     bool        CreateImage( const UploadInfo& info, VkImage* result );
     // Create mipmaps and prepare image for usage in shaders
-    void        PrepareImage( VkImage           image,
-                              VkBuffer          staging[],
-                              const UploadInfo& info,
-                              ImagePrepareType  prepareType );
+    // stagingOffsets can be null, if data starts at the beginning of each staging buffer
+    void        PrepareImage( VkImage            image,
+                              const VkBuffer     staging[],
+                              const VkDeviceSize stagingOffsets[],
+                              const UploadInfo&  info,
+                              ImagePrepareType   prepareType );
     VkImageView CreateImageView( VkImage                             image,
                                  VkFormat                            format,
                                  bool                                isCubemap,
                                  uint32_t                            mipmapCount,
                                  std::optional< RgTextureSwizzling > swizzling );
 
+    struct StagingAllocation
+    {
+        VkBuffer     buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        void*        mapped = nullptr;
+    };
+
+    // Sub-allocate from the frame's staging ring, or create a dedicated buffer
+    // if the data is too large or the ring is full. Returned memory is valid
+    // until ClearStaging with the same frame index.
+    StagingAllocation AllocateStaging( uint32_t     frameIndex,
+                                       VkDeviceSize size,
+                                       const char*  pDebugName );
+
 private:
+    struct StagingRing
+    {
+        VkBuffer     buffer    = VK_NULL_HANDLE;
+        uint8_t*     mapped    = nullptr;
+        VkDeviceSize offset    = 0;
+        bool         exhausted = false;
+    };
+
     struct UpdateableImageInfo
     {
-        VkBuffer   stagingBuffer;
-        void*      mappedData;
-        uint32_t   dataSize;
-        RgExtent2D imageSize;
-        bool       generateMipmaps;
-        VkFormat   format;
+        // double-buffered, so writes for the next frame don't race with the copy of the current
+        VkBuffer                stagingBuffers[ MAX_FRAMES_IN_FLIGHT ];
+        void*                   mappedData[ MAX_FRAMES_IN_FLIGHT ];
+        // latest image data on CPU, dirty regions are copied from it to the frame's staging
+        std::vector< uint8_t >  shadow;
+        uint32_t                dataSize;
+        RgExtent2D              imageSize;
+        bool                    generateMipmaps;
+        VkFormat                format;
+        // pending until the next flush, regardless of the frame they were made in
+        std::vector< VkRect2D > dirtyRects;
     };
 
+private:
+    void RecordImageUpdate( VkCommandBuffer      cmd,
+                            uint32_t             frameIndex,
+                            VkImage              image,
+                            UpdateableImageInfo& updateInfo );
+    void DestroyUpdateableStaging( UpdateableImageInfo& updateInfo );
+
 protected:
     VkDevice                                           device;
 
     std::shared_ptr< MemoryAllocator >                 memAllocator;
 
-    // Staging buffers that were used for uploading must be destroyed
-    // on the frame with same index when it'll be certainly not in use
+    // Persistently mapped, reset on the frame with same index
+    // when it'll be certainly not in use
+    StagingRing                                        stagingRings[ MAX_FRAMES_IN_FLIGHT ];
+    VkDeviceSize                                       stagingRingSize;
+
+    // Dedicated staging buffers for uploads that didn't fit into the ring,
+    // must be destroyed on the frame with same index
     std::vector< VkBuffer >                            stagingToFree[ MAX_FRAMES_IN_FLIGHT ];
 
     // Each dynamic image has its pointer to HOST_VISIBLE data for updating.
@@ -0,0 +1,149 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+RTGL1::ThreadPool::ThreadPool( uint32_t threadCount )
+{
+    if( threadCount == 0 )
+    {
+        // leave one core for the main thread
+        threadCount = std::max( 1u, std::thread::hardware_concurrency() - 1 );
+    }
+
+    workers.reserve( threadCount );
+    for( uint32_t i = 0; i < threadCount; i++ )
+    {
+        workers.emplace_back( [ this ]( std::stop_token stop ) { WorkerLoop( stop ); } );
+    }
+}
+
+RTGL1::ThreadPool::~ThreadPool()
+{
+    for( auto& w : workers )
+    {
+        w.request_stop();
+    }
+    cv.notify_all();
+
+    // jthread joins on destruction
+    workers.clear();
+}
+
+void RTGL1::ThreadPool::Push( std::function< void() > task )
+{
+    {
+        auto lock = std::scoped_lock( mutex );
+        tasks.push_back( std::move( task ) );
+    }
+    cv.notify_one();
+}
+
+void RTGL1::ThreadPool::WorkerLoop( std::stop_token stop )
+{
+    while( true )
+    {
+        std::function< void() > task;
+        {
+            auto lock = std::unique_lock( mutex );
+
+            if( !cv.wait( lock, stop, [ this ] { return !tasks.empty(); } ) )
+            {
+                // stop was requested
+                return;
+            }
+
+            task = std::move( tasks.front() );
+            tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void RTGL1::ThreadPool::ParallelFor( size_t                                          count,
+                                     size_t                                          grainSize,
+                                     const std::function< void( size_t, size_t ) >& f )
+{
+    if( count == 0 )
+    {
+        return;
+    }
+
+    grainSize = std::max< size_t >( grainSize, 1 );
+
+    const size_t chunkCount = ( count + grainSize - 1 ) / grainSize;
+
+    if( chunkCount == 1 || workers.empty() )
+    {
+        f( 0, count );
+        return;
+    }
+
+    struct Shared
+    {
+        std::atomic< size_t >   nextChunk{ 0 };
+        std::atomic< size_t >   doneChunks{ 0 };
+        std::mutex              doneMutex;
+        std::condition_variable doneCv;
+    };
+    auto shared = std::make_shared< Shared >();
+
+    // helpers only grab the chunks that are left, so if all workers are busy,
+    // the caller processes everything by itself
+    auto process = [ shared, chunkCount, count, grainSize, &f ]() {
+        while( true )
+        {
+            size_t chunk = shared->nextChunk.fetch_add( 1 );
+            if( chunk >= chunkCount )
+            {
+                return;
+            }
+
+            size_t begin = chunk * grainSize;
+            f( begin, std::min( begin + grainSize, count ) );
+
+            if( shared->doneChunks.fetch_add( 1 ) + 1 == chunkCount )
+            {
+                auto lock = std::scoped_lock( shared->doneMutex );
+                shared->doneCv.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min( chunkCount - 1, workers.size() );
+    for( size_t i = 0; i < helperCount; i++ )
+    {
+        Push( process );
+    }
+
+    process();
+
+    // wait for chunks that were grabbed by helpers;
+    // 'f' is captured by reference, so it must outlive all calls
+    auto lock = std::unique_lock( shared->doneMutex );
+    shared->doneCv.wait( lock, [ &shared, chunkCount ] {
+        return shared->doneChunks.load() == chunkCount;
+    } );
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2023 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Fixed set of worker threads for CPU-heavy jobs: image decoding / encoding,
+// file I/O, geometry processing. Vulkan calls must stay on the calling thread.
+class ThreadPool
+{
+public:
+    // If threadCount is 0, it's chosen from the hardware concurrency
+    explicit ThreadPool( uint32_t threadCount = 0 );
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool& other )                = delete;
+    ThreadPool( ThreadPool&& other ) noexcept            = delete;
+    ThreadPool& operator=( const ThreadPool& other )     = delete;
+    ThreadPool& operator=( ThreadPool&& other ) noexcept = delete;
+
+    template< typename Func >
+    auto Enqueue( Func&& f ) -> std::future< std::invoke_result_t< Func > >
+    {
+        using ReturnType = std::invoke_result_t< Func >;
+
+        // std::function requires copyable
+        auto task =
+            std::make_shared< std::packaged_task< ReturnType() > >( std::forward< Func >( f ) );
+        auto result = task->get_future();
+
+        Push( [ task ]() { ( *task )(); } );
+        return result;
+    }
+
+    // Call f( begin, end ) for subranges of [0, count), and wait for all of them.
+    // The calling thread participates too, so it's safe to call from a worker.
+    void ParallelFor( size_t                                       count,
+                      size_t                                       grainSize,
+                      const std::function< void( size_t, size_t ) >& f );
+
+    uint32_t GetThreadCount() const { return uint32_t( workers.size() ); }
+
+private:
+    void Push( std::function< void() > task );
+    void WorkerLoop( std::stop_token stop );
+
+private:
+    std::vector< std::jthread >          workers;
+    std::mutex                           mutex;
+    std::condition_variable_any          cv;
+    std::deque< std::function< void() > > tasks;
+};
+
+}
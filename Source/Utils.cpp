@@ -474,3 +474,16 @@ uint32_t Utils::GetWorkGroupCount( uint32_t size, uint32_t groupSize )
 
     return 1 + ( size + ( groupSize - 1 ) ) / groupSize;
 }
+
+uint64_t Utils::HashFnv1a( const void* data, size_t size, uint64_t hash )
+{
+    constexpr uint64_t FnvPrime = 0x100000001b3ull;
+
+    const auto* bytes = static_cast< const uint8_t* >( data );
+    for( size_t i = 0; i < size; i++ )
+    {
+        hash ^= bytes[ i ];
+        hash *= FnvPrime;
+    }
+    return hash;
+}
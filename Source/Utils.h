@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <optional>
 #include <limits>
 
@@ -322,6 +323,18 @@ namespace Utils
         return std::clamp( v, 0.0f, 1.0f );
     }
 
+    // Not stable between standard library implementations, so must not be persisted
+    template< typename T >
+    void HashCombine( uint64_t& seed, const T& v )
+    {
+        seed ^= std::hash< T >{}( v ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+    }
+
+    // 64-bit FNV-1a, it's the same on all platforms, so it can be stored in files.
+    // To hash a sequence of values, pass the previous result as 'hash'
+    constexpr uint64_t FNV1A_64_OFFSET_BASIS = 0xcbf29ce484222325ull;
+    uint64_t HashFnv1a( const void* data, size_t size, uint64_t hash = FNV1A_64_OFFSET_BASIS );
+
     constexpr RgFloat3D ApplyTransform( const RgTransform& tr, const RgFloat3D& local )
     {
         RgFloat3D global = {};
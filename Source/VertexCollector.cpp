@@ -21,6 +21,7 @@
 #include "VertexCollector.h"
 
 #include "GeomInfoManager.h"
+#include "RetainedMeshes.h"
 #include "Utils.h"
 
 #include "Generated/ShaderCommonC.h"
@@ -134,11 +135,14 @@ bool RTGL1::VertexCollector::AddPrimitive( uint32_t                          fra
                                            uint64_t                          uniqueID,
                                            std::span< MaterialTextures, 4 >  layerTextures,
                                            std::span< RgColor4DPacked32, 4 > layerColors,
-                                           GeomInfoManager&                  geomInfoManager )
+                                           GeomInfoManager&                  geomInfoManager,
+                                           GeometryLod                       lod,
+                                           float                             lodMaxDeviation,
+                                           std::optional< uint64_t >         retainedPrimitiveID )
 {
     using FT = VertexCollectorFilterTypeFlagBits;
     const VertexCollectorFilterTypeFlags geomFlags =
-        VertexCollectorFilterTypeFlags_GetForGeometry( parentMesh, info, isStatic );
+        VertexCollectorFilterTypeFlags_GetForGeometry( parentMesh, info, isStatic, lod );
 
 
     // if exceeds a limit of geometries in a group with specified geomFlags
@@ -157,23 +161,37 @@ bool RTGL1::VertexCollector::AddPrimitive( uint32_t                          fra
 
 
 
-    const uint32_t vertIndex      = AlignUpBy3( curVertexCount );
-    const uint32_t indIndex       = AlignUpBy3( curIndexCount );
+    // vertex data of a retained primitive is already in the buffers
+    const RetainedRange* retained = nullptr;
+    if( retainedPrimitiveID )
+    {
+        auto f = retainedRanges.find( *retainedPrimitiveID );
+        if( f != retainedRanges.end() )
+        {
+            retained = &f->second;
+        }
+    }
+
+    const uint32_t vertIndex      = retained ? retained->firstVertex : AlignUpBy3( curVertexCount );
+    const uint32_t indIndex       = retained ? retained->firstIndex : AlignUpBy3( curIndexCount );
     const uint32_t transformIndex = curTransformCount;
-    const uint32_t texcIndex_1    = curTexCoordCount_Layer1;
-    const uint32_t texcIndex_2    = curTexCoordCount_Layer2;
-    const uint32_t texcIndex_3    = curTexCoordCount_Layer3;
+    const uint32_t texcIndex_1 = retained ? retained->firstTexCoord[ 0 ] : curTexCoordCount_Layer1;
+    const uint32_t texcIndex_2 = retained ? retained->firstTexCoord[ 1 ] : curTexCoordCount_Layer2;
+    const uint32_t texcIndex_3 = retained ? retained->firstTexCoord[ 2 ] : curTexCoordCount_Layer3;
 
     const bool     useIndices    = info.indexCount != 0 && info.pIndices != nullptr;
     const uint32_t triangleCount = useIndices ? info.indexCount / 3 : info.vertexCount / 3;
 
-    curVertexCount = vertIndex + info.vertexCount;
-    curIndexCount  = indIndex + ( useIndices ? info.indexCount : 0 );
+    if( !retained )
+    {
+        curVertexCount = vertIndex + info.vertexCount;
+        curIndexCount  = indIndex + ( useIndices ? info.indexCount : 0 );
+        curTexCoordCount_Layer1 += GeomInfoManager::LayerExists( info, 1 ) ? info.vertexCount : 0;
+        curTexCoordCount_Layer2 += GeomInfoManager::LayerExists( info, 2 ) ? info.vertexCount : 0;
+        curTexCoordCount_Layer3 += GeomInfoManager::LayerExists( info, 3 ) ? info.vertexCount : 0;
+    }
     curPrimitiveCount += triangleCount;
     curTransformCount += 1;
-    curTexCoordCount_Layer1 += GeomInfoManager::LayerExists( info, 1 ) ? info.vertexCount : 0;
-    curTexCoordCount_Layer2 += GeomInfoManager::LayerExists( info, 2 ) ? info.vertexCount : 0;
-    curTexCoordCount_Layer3 += GeomInfoManager::LayerExists( info, 3 ) ? info.vertexCount : 0;
 
 
 
@@ -212,16 +230,30 @@ bool RTGL1::VertexCollector::AddPrimitive( uint32_t                          fra
 
 
     // copy data to buffers
-    CopyVertexDataToStaging( info, vertIndex );
-    CopyTexCoordsToStaging( 1, info, texcIndex_1 );
-    CopyTexCoordsToStaging( 2, info, texcIndex_2 );
-    CopyTexCoordsToStaging( 3, info, texcIndex_3 );
-
-    if( useIndices )
+    if( !retained )
     {
-        assert( bufIndices.mapped );
-        memcpy(
-            &bufIndices.mapped[ indIndex ], info.pIndices, info.indexCount * sizeof( uint32_t ) );
+        CopyVertexDataToStaging( info, vertIndex );
+        CopyTexCoordsToStaging( 1, info, texcIndex_1 );
+        CopyTexCoordsToStaging( 2, info, texcIndex_2 );
+        CopyTexCoordsToStaging( 3, info, texcIndex_3 );
+
+        if( useIndices )
+        {
+            assert( bufIndices.mapped );
+            memcpy( &bufIndices.mapped[ indIndex ],
+                    info.pIndices,
+                    info.indexCount * sizeof( uint32_t ) );
+        }
+
+        // static data stays in the buffers, so the same data can be reused later
+        if( isStatic && retainedPrimitiveID )
+        {
+            retainedRanges[ *retainedPrimitiveID ] = RetainedRange{
+                .firstVertex   = vertIndex,
+                .firstIndex    = indIndex,
+                .firstTexCoord = { texcIndex_1, texcIndex_2, texcIndex_3 },
+            };
+        }
     }
 
     {
@@ -331,6 +363,8 @@ bool RTGL1::VertexCollector::AddPrimitive( uint32_t                          fra
         .firstVertex_Layer1 = texcIndex_1,
         .firstVertex_Layer2 = texcIndex_2,
         .firstVertex_Layer3 = texcIndex_3,
+
+        .coarseLodMaxDeviation = lod == GeometryLod::Coarse ? lodMaxDeviation : 0.0f,
     };
 
 
@@ -396,31 +430,158 @@ void RTGL1::VertexCollector::CopyTexCoordsToStaging( uint32_t
 
 void RTGL1::VertexCollector::Reset()
 {
-    curVertexCount          = 0;
-    curIndexCount           = 0;
+    // retained data is kept
+    curVertexCount          = retainedVertexCount;
+    curIndexCount           = retainedIndexCount;
     curPrimitiveCount       = 0;
     curTransformCount       = 0;
+    curTexCoordCount_Layer1 = retainedTexCoordCount[ 0 ];
+    curTexCoordCount_Layer2 = retainedTexCoordCount[ 1 ];
+    curTexCoordCount_Layer3 = retainedTexCoordCount[ 2 ];
+
+    for( auto& f : filters )
+    {
+        f.second->Reset();
+    }
+}
+
+bool RTGL1::VertexCollector::ResetStatic( bool     keepVertexData,
+                                          uint32_t maxVertexCount,
+                                          uint32_t maxIndexCount )
+{
+    assert( !( filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ) );
+
+    // holes of the removed data are not reused, they're freed only when nothing is kept
+    keepVertexData = keepVertexData &&
+                     uint64_t( curVertexCount ) + maxVertexCount < MAX_STATIC_VERTEX_COUNT &&
+                     uint64_t( curIndexCount ) + maxIndexCount < MAX_INDEXED_PRIMITIVE_COUNT * 3;
+
+    if( !keepVertexData )
+    {
+        retainedRanges.clear();
+        curVertexCount          = 0;
+        curIndexCount           = 0;
+        curTexCoordCount_Layer1 = 0;
+        curTexCoordCount_Layer2 = 0;
+        curTexCoordCount_Layer3 = 0;
+    }
+
+    // everything that is in the buffers is already on the device
+    retainedVertexCount        = curVertexCount;
+    retainedIndexCount         = curIndexCount;
+    retainedTexCoordCount[ 0 ] = curTexCoordCount_Layer1;
+    retainedTexCoordCount[ 1 ] = curTexCoordCount_Layer2;
+    retainedTexCoordCount[ 2 ] = curTexCoordCount_Layer3;
+    retainedToCopy             = false;
+
+    Reset();
+    return keepVertexData;
+}
+
+void RTGL1::VertexCollector::SetRetained( const RetainedMeshes& retained )
+{
+    if( retained.GetVersion() == retainedVersion )
+    {
+        return;
+    }
+
+    // must be called before adding any per-frame data
+    assert( curVertexCount == retainedVertexCount && curIndexCount == retainedIndexCount );
+    assert( curTransformCount == 0 );
+
+    // the whole layout is rebuilt, the offsets of the previous one are not valid anymore
+    retainedRanges.clear();
+    curVertexCount          = 0;
+    curIndexCount           = 0;
     curTexCoordCount_Layer1 = 0;
     curTexCoordCount_Layer2 = 0;
     curTexCoordCount_Layer3 = 0;
 
-    for( auto& f : filters )
+    // most of the space is left for the per-frame geometry
+    constexpr uint32_t maxVertexCount = MAX_DYNAMIC_VERTEX_COUNT / 2;
+    constexpr uint32_t maxIndexCount  = MAX_INDEXED_PRIMITIVE_COUNT * 3 / 2;
+
+    uint32_t notFit = 0;
+
+    retained.ForEachPrimitive( [ & ]( uint64_t primitiveID, const RgMeshPrimitiveInfo& info ) {
+        if( info.vertexCount == 0 || info.pVertices == nullptr )
+        {
+            return;
+        }
+
+        const bool useIndices = info.indexCount != 0 && info.pIndices != nullptr;
+
+        const uint32_t vertIndex = AlignUpBy3( curVertexCount );
+        const uint32_t indIndex  = AlignUpBy3( curIndexCount );
+
+        if( vertIndex + info.vertexCount >= maxVertexCount ||
+            indIndex + ( useIndices ? info.indexCount : 0 ) >= maxIndexCount )
+        {
+            notFit++;
+            return;
+        }
+
+        const auto range = RetainedRange{
+            .firstVertex   = vertIndex,
+            .firstIndex    = indIndex,
+            .firstTexCoord = { curTexCoordCount_Layer1,
+                               curTexCoordCount_Layer2,
+                               curTexCoordCount_Layer3 },
+        };
+
+        CopyVertexDataToStaging( info, range.firstVertex );
+        CopyTexCoordsToStaging( 1, info, range.firstTexCoord[ 0 ] );
+        CopyTexCoordsToStaging( 2, info, range.firstTexCoord[ 1 ] );
+        CopyTexCoordsToStaging( 3, info, range.firstTexCoord[ 2 ] );
+
+        if( useIndices )
+        {
+            assert( bufIndices.mapped );
+            memcpy( &bufIndices.mapped[ range.firstIndex ],
+                    info.pIndices,
+                    info.indexCount * sizeof( uint32_t ) );
+        }
+
+        curVertexCount = vertIndex + info.vertexCount;
+        curIndexCount  = indIndex + ( useIndices ? info.indexCount : 0 );
+        curTexCoordCount_Layer1 += GeomInfoManager::LayerExists( info, 1 ) ? info.vertexCount : 0;
+        curTexCoordCount_Layer2 += GeomInfoManager::LayerExists( info, 2 ) ? info.vertexCount : 0;
+        curTexCoordCount_Layer3 += GeomInfoManager::LayerExists( info, 3 ) ? info.vertexCount : 0;
+
+        retainedRanges[ primitiveID ] = range;
+    } );
+
+    if( notFit > 0 )
     {
-        f.second->Reset();
+        debug::Warning( "{} primitives of retained meshes don't fit into the dynamic buffers, "
+                        "their vertex data will be copied each frame",
+                        notFit );
     }
+
+    retainedVertexCount        = curVertexCount;
+    retainedIndexCount         = curIndexCount;
+    retainedTexCoordCount[ 0 ] = curTexCoordCount_Layer1;
+    retainedTexCoordCount[ 1 ] = curTexCoordCount_Layer2;
+    retainedTexCoordCount[ 2 ] = curTexCoordCount_Layer3;
+
+    retainedVersion = retained.GetVersion();
+    retainedToCopy  = true;
 }
 
 bool RTGL1::VertexCollector::CopyVertexDataFromStaging( VkCommandBuffer cmd )
 {
-    if( curVertexCount == 0 )
+    // retained data is already on the device, if it wasn't changed
+    const uint32_t first = retainedToCopy ? 0 : retainedVertexCount;
+
+    if( curVertexCount <= first )
     {
         return false;
     }
 
     VkBufferCopy info = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size      = curVertexCount * sizeof( ShVertex ),
+        .srcOffset = first * sizeof( ShVertex ),
+        .dstOffset = first * sizeof( ShVertex ),
+        .size      = ( curVertexCount - first ) * sizeof( ShVertex ),
     };
 
     vkCmdCopyBuffer(
@@ -443,15 +604,17 @@ bool RTGL1::VertexCollector::CopyTexCoordsFromStaging( VkCommandBuffer cmd, uint
 
     auto& [ buf, count ] = txc;
 
-    if( count == 0 )
+    const uint32_t first = retainedToCopy ? 0 : retainedTexCoordCount[ layerIndex - 1 ];
+
+    if( count <= first )
     {
         return false;
     }
 
     VkBufferCopy info = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size      = count * sizeof( RgFloat2D ),
+        .srcOffset = first * sizeof( RgFloat2D ),
+        .dstOffset = first * sizeof( RgFloat2D ),
+        .size      = ( count - first ) * sizeof( RgFloat2D ),
     };
 
     vkCmdCopyBuffer( cmd, buf->staging.GetBuffer(), buf->deviceLocal->GetBuffer(), 1, &info );
@@ -460,15 +623,17 @@ bool RTGL1::VertexCollector::CopyTexCoordsFromStaging( VkCommandBuffer cmd, uint
 
 bool RTGL1::VertexCollector::CopyIndexDataFromStaging( VkCommandBuffer cmd )
 {
-    if( curIndexCount == 0 )
+    const uint32_t first = retainedToCopy ? 0 : retainedIndexCount;
+
+    if( curIndexCount <= first )
     {
         return false;
     }
 
     VkBufferCopy info = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size      = curIndexCount * sizeof( uint32_t ),
+        .srcOffset = first * sizeof( uint32_t ),
+        .dstOffset = first * sizeof( uint32_t ),
+        .size      = ( curIndexCount - first ) * sizeof( uint32_t ),
     };
 
     vkCmdCopyBuffer(
@@ -648,6 +813,7 @@ bool RTGL1::VertexCollector::CopyFromStaging( VkCommandBuffer cmd )
         copiedAny = true;
     }
 
+    retainedToCopy = false;
     return copiedAny;
 }
 
@@ -36,6 +36,7 @@ namespace RTGL1
 struct ShVertex;
 
 class GeomInfoManager;
+class RetainedMeshes;
 
 // The class collects vertex data to buffers with shader struct types.
 // Geometries are passed to the class by chunks and the result of collecting
@@ -59,6 +60,10 @@ public:
     VertexCollector& operator=( VertexCollector&& other ) noexcept = delete;
 
 
+    // If 'retainedPrimitiveID' was written by SetRetained, the vertex data
+    // is not copied, only the transform and the geometry info are added.
+    // For static, it identifies the vertex data: once copied, it's reused by the same ID.
+    // 'lodMaxDeviation' is how far a coarse geometry is from the original, in world units
     bool AddPrimitive( uint32_t                          frameIndex,
                        bool                              isStatic,
                        const RgMeshInfo&                 parentMesh,
@@ -66,12 +71,23 @@ public:
                        uint64_t                          uniqueID,
                        std::span< MaterialTextures, 4 >  layerTextures,
                        std::span< RgColor4DPacked32, 4 > layerColors,
-                       GeomInfoManager&                  geomInfoManager );
+                       GeomInfoManager&                  geomInfoManager,
+                       GeometryLod                       lod                 = GeometryLod::None,
+                       float                             lodMaxDeviation     = 0.0f,
+                       std::optional< uint64_t >         retainedPrimitiveID = std::nullopt );
 
 
     // Clear data that was generated while collecting.
     // Should be called when blasGeometries is not needed anymore
     void Reset();
+    // Static only, instead of Reset. If 'keepVertexData', the vertex data of the primitives
+    // that were added with an ID stays in the buffers, and new data is placed after it.
+    // Nothing is kept, if 'maxVertexCount' / 'maxIndexCount' more may not fit.
+    // Returns true, if the data was kept
+    bool ResetStatic( bool keepVertexData, uint32_t maxVertexCount, uint32_t maxIndexCount );
+    // Keep the vertex data of retained meshes at the start of the buffers, so it's copied
+    // to the device only when the set of retained meshes is changed. Must be called after Reset
+    void SetRetained( const RetainedMeshes& retained );
     // Copy buffer from staging and set barrier for processing in compute shader
     // "isStaticVertexData" is required to determine what GLSL struct to use for copying
     bool CopyFromStaging( VkCommandBuffer cmd );
@@ -136,6 +152,13 @@ private:
     uint32_t GetGeometryCount( VertexCollectorFilterTypeFlags type );
     uint32_t GetAllGeometryCount() const;
 
+    struct RetainedRange
+    {
+        uint32_t firstVertex;
+        uint32_t firstIndex;
+        uint32_t firstTexCoord[ 3 ];
+    };
+
 private:
     VkDevice                       device;
     VertexCollectorFilterTypeFlags filtersFlags;
@@ -230,6 +253,17 @@ private:
     uint32_t curTexCoordCount_Layer2{ 0 };
     uint32_t curTexCoordCount_Layer3{ 0 };
 
+    // Retained primitive ID to its data at the start of the buffers;
+    // for static, the data of the previous collectings
+    rgl::unordered_map< uint64_t, RetainedRange > retainedRanges;
+    uint64_t                                      retainedVersion{ 0 };
+    // Counts occupied by the retained data, per-frame data is placed after them
+    uint32_t                                      retainedVertexCount{ 0 };
+    uint32_t                                      retainedIndexCount{ 0 };
+    uint32_t                                      retainedTexCoordCount[ 3 ]{};
+    // If the retained data must be copied to the device on the next CopyFromStaging
+    bool                                          retainedToCopy{ false };
+
     rgl::unordered_map< VertexCollectorFilterTypeFlags, std::shared_ptr< VertexCollectorFilter > >
         filters;
 };
@@ -28,8 +28,10 @@
 
 static_assert( MAX_TOP_LEVEL_INSTANCE_COUNT ==
                    std::size( RTGL1::VertexCollectorFilterGroup_ChangeFrequency ) *
-                       std::size( RTGL1::VertexCollectorFilterGroup_PassThrough ) *
-                       std::size( RTGL1::VertexCollectorFilterGroup_PrimaryVisibility ),
+                           std::size( RTGL1::VertexCollectorFilterGroup_PassThrough ) *
+                           ( std::size( RTGL1::VertexCollectorFilterGroup_PrimaryVisibility ) -
+                             RTGL1::VertexCollectorFilterGroup_LodCount ) +
+                       RTGL1::VertexCollectorFilterGroup_LodCount,
                "It's recommended for MAX_TOP_LEVEL_INSTANCE_COUNT to be such value" );
 
 using FlagToIndexType = uint8_t;
@@ -45,7 +47,7 @@ using FL = RTGL1::VertexCollectorFilterTypeFlags;
 // max flag value in a group
 constexpr uint32_t MAX_FLAG_VALUE_CF = 4;
 constexpr uint32_t MAX_FLAG_VALUE_PT = 4;
-constexpr uint32_t MAX_FLAG_VALUE_PV = 16;
+constexpr uint32_t MAX_FLAG_VALUE_PV = 64;
 
 static FlagToIndexType FlagToIndex[ MAX_FLAG_VALUE_CF ][ MAX_FLAG_VALUE_PT ][ MAX_FLAG_VALUE_PV ];
 
@@ -69,6 +71,11 @@ void RTGL1::VertexCollectorFilterTypeFlags_Init()
         {
             for( auto flpv : VertexCollectorFilterGroup_PrimaryVisibility )
             {
+                if( !VertexCollectorFilterTypeFlags_IsValid( flcf | flpt | flpv ) )
+                {
+                    continue;
+                }
+
                 uint32_t cf = uint32_t( flcf ) >> VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_CF;
                 uint32_t pt = uint32_t( flpt ) >> VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PT;
                 uint32_t pv = uint32_t( flpv ) >> VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV;
@@ -170,6 +177,10 @@ struct FLName
 };
 
 const static FLName FL_NAMES[] = {
+    { FT::CF_STATIC_NON_MOVABLE | FT::PT_OPAQUE | FT::PV_WORLD_0_DETAIL,
+      "BLAS static opaque detail" },
+    { FT::CF_STATIC_NON_MOVABLE | FT::PT_OPAQUE | FT::PV_WORLD_0_COARSE,
+      "BLAS static opaque coarse" },
     { FT::CF_STATIC_NON_MOVABLE | FT::PT_OPAQUE, "BLAS static opaque" },
     { FT::CF_STATIC_NON_MOVABLE | FT::PT_ALPHA_TESTED, "BLAS static alpha tested" },
     { FT::CF_STATIC_NON_MOVABLE | FT::PT_REFRACT, "BLAS static refract" },
@@ -199,7 +210,8 @@ const char* RTGL1::VertexCollectorFilterTypeFlags_GetNameForBLAS( FL flags )
 
 FL RTGL1::VertexCollectorFilterTypeFlags_GetForGeometry( const RgMeshInfo&          mesh,
                                                          const RgMeshPrimitiveInfo& primitive,
-                                                         bool                       isStatic )
+                                                         bool                       isStatic,
+                                                         GeometryLod                lod )
 {
     FL flags = 0;
 
@@ -253,5 +265,19 @@ FL RTGL1::VertexCollectorFilterTypeFlags_GetForGeometry( const RgMeshInfo&
     }
 
 
+    if( lod != GeometryLod::None )
+    {
+        assert( VertexCollectorFilterTypeFlags_IsLodApplicable( flags ) );
+
+        flags &= ~FL( FT::PV_WORLD_0 );
+        flags |= FL( lod == GeometryLod::Detail ? FT::PV_WORLD_0_DETAIL : FT::PV_WORLD_0_COARSE );
+    }
+
+
     return flags;
 }
+
+bool RTGL1::VertexCollectorFilterTypeFlags_IsLodApplicable( FL flags )
+{
+    return flags == ( FT::CF_STATIC_NON_MOVABLE | FT::PT_OPAQUE | FT::PV_WORLD_0 );
+}
@@ -50,7 +50,10 @@ enum class VertexCollectorFilterTypeFlagBits : uint32_t
     PV_WORLD_2                    = 0b00000100 << VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV,
     PV_FIRST_PERSON               = 0b00001000 << VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV,
     PV_FIRST_PERSON_VIEWER        = 0b00010000 << VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV,
-    MASK_PRIMARY_VISIBILITY_GROUP = PV_WORLD_0 | PV_WORLD_1 | PV_WORLD_2 | PV_FIRST_PERSON | PV_FIRST_PERSON_VIEWER,
+    // PV_WORLD_0 geometry that has a simplified version: full and simplified ones
+    PV_WORLD_0_DETAIL             = 0b00100000 << VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV,
+    PV_WORLD_0_COARSE             = 0b01000000 << VERTEX_COLLECTOR_FILTER_TYPE_BIT_OFFSET_PV,
+    MASK_PRIMARY_VISIBILITY_GROUP = PV_WORLD_0 | PV_WORLD_1 | PV_WORLD_2 | PV_FIRST_PERSON | PV_FIRST_PERSON_VIEWER | PV_WORLD_0_DETAIL | PV_WORLD_0_COARSE,
 };
 using VertexCollectorFilterTypeFlags = uint32_t;
 
@@ -73,6 +76,20 @@ constexpr VertexCollectorFilterTypeFlagBits VertexCollectorFilterGroup_PrimaryVi
     VertexCollectorFilterTypeFlagBits::PV_WORLD_2,
     VertexCollectorFilterTypeFlagBits::PV_FIRST_PERSON,
     VertexCollectorFilterTypeFlagBits::PV_FIRST_PERSON_VIEWER,
+    VertexCollectorFilterTypeFlagBits::PV_WORLD_0_DETAIL,
+    VertexCollectorFilterTypeFlagBits::PV_WORLD_0_COARSE,
+};
+
+// Level of detail groups exist only for CF_STATIC_NON_MOVABLE | PT_OPAQUE
+constexpr uint32_t VertexCollectorFilterGroup_LodCount = 2;
+
+// Static geometry with a simplified version is placed into two separate BLAS-es,
+// so distant secondary rays could traverse only the simplified one
+enum class GeometryLod
+{
+    None,
+    Detail,
+    Coarse,
 };
 
 
@@ -106,6 +123,20 @@ inline VertexCollectorFilterTypeFlags operator&( VertexCollectorFilterTypeFlagBi
     return VertexCollectorFilterTypeFlags( a ) & b;
 }
 
+inline bool VertexCollectorFilterTypeFlags_IsValid( VertexCollectorFilterTypeFlags flags )
+{
+    using FT = VertexCollectorFilterTypeFlagBits;
+
+    if( flags & ( FT::PV_WORLD_0_DETAIL | FT::PV_WORLD_0_COARSE ) )
+    {
+        return ( flags & FT::MASK_CHANGE_FREQUENCY_GROUP ) ==
+                   VertexCollectorFilterTypeFlags( FT::CF_STATIC_NON_MOVABLE ) &&
+               ( flags & FT::MASK_PASS_THROUGH_GROUP ) ==
+                   VertexCollectorFilterTypeFlags( FT::PT_OPAQUE );
+    }
+    return true;
+}
+
 void                           VertexCollectorFilterTypeFlags_Init();
 uint32_t                       VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount();
 uint32_t                       VertexCollectorFilterTypeFlags_GetID( VertexCollectorFilterTypeFlags flags );
@@ -114,7 +145,9 @@ uint32_t                       VertexCollectorFilterTypeFlags_GetOffsetInGlobalA
 // Amount of bottom level geometries in a group with specified flags
 uint32_t                       VertexCollectorFilterTypeFlags_GetAmountInGlobalArray( VertexCollectorFilterTypeFlags flags );
 const char*                    VertexCollectorFilterTypeFlags_GetNameForBLAS( VertexCollectorFilterTypeFlags flags );
-VertexCollectorFilterTypeFlags VertexCollectorFilterTypeFlags_GetForGeometry( const RgMeshInfo &mesh, const RgMeshPrimitiveInfo& primitive, bool isStatic );
+VertexCollectorFilterTypeFlags VertexCollectorFilterTypeFlags_GetForGeometry( const RgMeshInfo &mesh, const RgMeshPrimitiveInfo& primitive, bool isStatic, GeometryLod lod = GeometryLod::None );
+// If a simplified version of the geometry with such flags can be used
+bool                           VertexCollectorFilterTypeFlags_IsLodApplicable( VertexCollectorFilterTypeFlags flags );
 
 template< typename Lambda >
 auto VertexCollectorFilterTypeFlags_IterateOverFlags( Lambda lambda )
@@ -125,7 +158,10 @@ auto VertexCollectorFilterTypeFlags_IterateOverFlags( Lambda lambda )
         {
             for( auto pm : VertexCollectorFilterGroup_PrimaryVisibility )
             {
-                lambda( cf | pt | pm );
+                if( VertexCollectorFilterTypeFlags_IsValid( cf | pt | pm ) )
+                {
+                    lambda( cf | pt | pm );
+                }
             }
         }
     }
@@ -92,8 +92,6 @@ VkCommandBuffer RTGL1::VulkanDevice::BeginFrame( const RgStartFrameInfo& info )
     cmdManager->PrepareForFrame( frameIndex );
 
     // clear the data that were created MAX_FRAMES_IN_FLIGHT ago
-    worldSamplerManager->PrepareForFrame( frameIndex );
-    genericSamplerManager->PrepareForFrame( frameIndex );
     textureManager->PrepareForFrame( frameIndex );
     cubemapManager->PrepareForFrame( frameIndex );
     rasterizer->PrepareForFrame( frameIndex );
@@ -114,15 +112,29 @@ VkCommandBuffer RTGL1::VulkanDevice::BeginFrame( const RgStartFrameInfo& info )
     BeginCmdLabel( cmd, "Prepare for frame" );
 
     textureManager->TryHotReload( cmd, frameIndex );
+    cubemapManager->UploadLoadedCubemaps( cmd, frameIndex );
     lightManager->PrepareForFrame( cmd, frameIndex );
+    {
+        const ShGlobalUniform* gu = uniform->GetData();
+
+        // the camera of this frame is not known yet, so extend the previous frame's
+        // view volume by the distance the camera moved
+        float motion[] = {
+            gu->cameraPosition[ 0 ] - gu->cameraPositionPrev[ 0 ],
+            gu->cameraPosition[ 1 ] - gu->cameraPositionPrev[ 1 ],
+            gu->cameraPosition[ 2 ] - gu->cameraPositionPrev[ 2 ],
+        };
+        lightManager->SetCullingView( gu->view, gu->projection, 2.0f * Utils::Length( motion ) );
+    }
+    attachedLightsCache.PrepareForFrame();
     scene->PrepareForFrame( cmd,
                             frameIndex,
                             info.ignoreExternalGeometry ||
-                                ( devmode && devmode->ignoreExternalGeometry ) );
+                                ( devmode && devmode->ignoreExternalGeometry ),
+                            retainedMeshes );
 
     {
         sceneImportExport->CheckForNewScene( Utils::SafeCstr( info.pMapName ),
-                                             cmd,
                                              frameIndex,
                                              *scene,
                                              *textureManager,
@@ -292,6 +304,7 @@ void RTGL1::VulkanDevice::FillUniform( RTGL1::ShGlobalUniform* gu,
         gu->gradientMultIndirect =
             std::clamp( params.indirectDiffuseSensitivityToChange, 0.0f, 1.0f );
         gu->gradientMultSpecular = std::clamp( params.specularSensitivityToChange, 0.0f, 1.0f );
+        gu->coarseLodDistance    = std::max( params.coarseLodDistance, 0.0f );
     }
 
     {
@@ -493,12 +506,12 @@ void RTGL1::VulkanDevice::Render( VkCommandBuffer cmd, const RgDrawFrameInfo& dr
     sceneImportExport->TryExport( *textureManager );
 
 
-    bool mipLodBiasUpdated =
-        worldSamplerManager->TryChangeMipLodBias( frameIndex, renderResolution.GetMipLodBias() );
+    worldSamplerManager->TryChangeMipLodBias( renderResolution.GetMipLodBias() );
     const RgFloat2D jitter = { uniform->GetData()->jitterX, uniform->GetData()->jitterY };
 
-    textureManager->SubmitDescriptors(
-        frameIndex, AccessParams< RgDrawFrameTexturesParams >( drawInfo ), mipLodBiasUpdated );
+    textureManager->SubmitTextureUpdates( cmd, frameIndex );
+    textureManager->SubmitDescriptors( frameIndex,
+                                       AccessParams< RgDrawFrameTexturesParams >( drawInfo ) );
     cubemapManager->SubmitDescriptors( frameIndex );
 
     lightManager->SetLightstyles( AccessParams< RgDrawFrameIlluminationParams >( drawInfo ) );
@@ -932,15 +945,76 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
         throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
     }
 
-    if( pPrimitive->vertexCount == 0 || pPrimitive->pVertices == nullptr )
+    UploadMeshPrimitiveInternal( *pMesh, *pPrimitive );
+}
+
+void RTGL1::VulkanDevice::UploadMeshPrimitives( uint32_t                   meshCount,
+                                                const RgMeshInfo*          pMeshes,
+                                                const uint32_t*            pPrimitiveCounts,
+                                                const RgMeshPrimitiveInfo* pPrimitives )
+{
+    if( meshCount == 0 )
     {
         return;
     }
-    Dev_TryBreak( pPrimitive->pTextureName, false );
+
+    if( pMeshes == nullptr || pPrimitiveCounts == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
+    }
+
+    size_t totalCount = 0;
+    for( uint32_t m = 0; m < meshCount; m++ )
+    {
+        totalCount += pPrimitiveCounts[ m ];
+    }
+
+    if( totalCount == 0 )
+    {
+        return;
+    }
+
+    if( pPrimitives == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
+    }
+
+    // to not rehash / reallocate on each primitive
+    scene->ReserveDynamic( totalCount );
+    if( devmode )
+    {
+        // grow geometrically, as an exact reserve per batch would reallocate on every call
+        auto& table = devmode->primitivesTable;
+        if( table.size() + totalCount > table.capacity() )
+        {
+            table.reserve( std::max( 2 * table.capacity(), table.size() + totalCount ) );
+        }
+    }
+
+    const RgMeshPrimitiveInfo* prim = pPrimitives;
+    for( uint32_t m = 0; m < meshCount; m++ )
+    {
+        for( uint32_t p = 0; p < pPrimitiveCounts[ m ]; p++, prim++ )
+        {
+            UploadMeshPrimitiveInternal( pMeshes[ m ], *prim );
+        }
+    }
+}
+
+void RTGL1::VulkanDevice::UploadMeshPrimitiveInternal(
+    const RgMeshInfo&          mesh,
+    const RgMeshPrimitiveInfo& primitive,
+    std::optional< uint64_t >  retainedPrimitiveID )
+{
+    if( primitive.vertexCount == 0 || primitive.pVertices == nullptr )
+    {
+        return;
+    }
+    Dev_TryBreak( primitive.pTextureName, false );
 
 
     // copy to modify
-    RgMeshPrimitiveInfo prim       = *pPrimitive;
+    RgMeshPrimitiveInfo prim       = primitive;
     RgEditorInfo        primEditor = prim.pEditorInfo ? *prim.pEditorInfo : RgEditorInfo{};
     prim.pEditorInfo               = &primEditor;
     if( !textureMetaManager->Modify( prim, primEditor, false ) )
@@ -956,12 +1030,12 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
     }
 
 
-    if( IsRasterized( *pMesh, prim ) )
+    if( IsRasterized( mesh, prim ) )
     {
         rasterizer->Upload( currentFrameState.GetFrameIndex(),
                             prim.flags & RG_MESH_PRIMITIVE_SKY ? GeometryRasterType::SKY
                                                                : GeometryRasterType::WORLD,
-                            pMesh->transform,
+                            mesh.transform,
                             prim,
                             nullptr,
                             nullptr );
@@ -971,8 +1045,8 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
             devmode->primitivesTable.push_back( Devmode::DebugPrim{
                 .result         = UploadResult::Dynamic,
                 .callIndex      = uint32_t( devmode->primitivesTable.size() ),
-                .objectId       = pMesh->uniqueObjectID,
-                .meshName       = Utils::SafeCstr( pMesh->pMeshName ),
+                .objectId       = mesh.uniqueObjectID,
+                .meshName       = Utils::SafeCstr( mesh.pMeshName ),
                 .primitiveIndex = prim.primitiveIndexInMesh,
                 .primitiveName  = Utils::SafeCstr( prim.pPrimitiveNameInMesh ),
                 .textureName    = Utils::SafeCstr( prim.pTextureName ),
@@ -981,16 +1055,22 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
     }
     else
     {
-        UploadResult r = scene->UploadPrimitive(
-            currentFrameState.GetFrameIndex(), *pMesh, prim, *textureManager, false );
+        UploadResult r = scene->UploadPrimitive( currentFrameState.GetFrameIndex(),
+                                                 mesh,
+                                                 prim,
+                                                 *textureManager,
+                                                 false,
+                                                 nullptr,
+                                                 0.0f,
+                                                 retainedPrimitiveID );
 
         if( devmode && devmode->primitivesTableMode == Devmode::DebugPrimMode::RayTraced )
         {
             devmode->primitivesTable.push_back( Devmode::DebugPrim{
                 .result         = r,
                 .callIndex      = uint32_t( devmode->primitivesTable.size() ),
-                .objectId       = pMesh->uniqueObjectID,
-                .meshName       = Utils::SafeCstr( pMesh->pMeshName ),
+                .objectId       = mesh.uniqueObjectID,
+                .meshName       = Utils::SafeCstr( mesh.pMeshName ),
                 .primitiveIndex = prim.primitiveIndexInMesh,
                 .primitiveName  = Utils::SafeCstr( prim.pPrimitiveNameInMesh ),
                 .textureName    = Utils::SafeCstr( prim.pTextureName ),
@@ -1001,11 +1081,11 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
         {
             if( r == UploadResult::ExportableDynamic || r == UploadResult::ExportableStatic )
             {
-                e->AddPrimitive( *pMesh, prim );
+                e->AddPrimitive( mesh, prim );
             }
 
             // SHIPPING_HACK: add lights even for non-exportable geometry
-            e->AddPrimitiveLights( *pMesh, prim );
+            e->AddPrimitiveLights( mesh, prim );
         }
 
 
@@ -1013,44 +1093,68 @@ void RTGL1::VulkanDevice::UploadMeshPrimitive( const RgMeshInfo*          pMesh,
         {
             if( prim.pEditorInfo->attachedLightEvenOnDynamic )
             {
-                GltfExporter::MakeLightsForPrimitiveDynamic( *pMesh,
-                                                             prim,
-                                                             sceneImportExport->GetWorldScale(),
-                                                             tempStorageInit,
-                                                             tempStorageLights );
+                for( auto& l : attachedLightsCache.MakeLights(
+                         mesh, prim, sceneImportExport->GetWorldScale() ) )
+                {
+                    UploadLight( &l );
+                }
+            }
+        }
+    }
+}
 
-                auto hashCombine = []< typename T >( uint64_t seed, const T& v ) {
-                    seed ^= std::hash< T >{}( v ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
-                    return seed;
-                };
+RgMesh RTGL1::VulkanDevice::CreateMesh( const RgMeshCreateInfo* pInfo )
+{
+    if( pInfo == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
+    }
 
-                uint64_t hashBase = 0;
+    return retainedMeshes.Create( *pInfo );
+}
 
-                hashBase = hashCombine( hashBase,
-                                        std::string_view( Utils::SafeCstr( prim.pTextureName ) ) );
-                hashBase = hashCombine( hashBase,
-                                        std::string_view( Utils::SafeCstr( pMesh->pMeshName ) ) );
-                hashBase = hashCombine( hashBase, prim.primitiveIndexInMesh );
+void RTGL1::VulkanDevice::DrawMeshInstance( RgMesh mesh, const RgMeshInstanceInfo* pInfo )
+{
+    if( pInfo == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
+    }
 
-                uint64_t counter = 0;
+    const RetainedMeshes::Mesh* retained = retainedMeshes.Find( mesh );
+    if( retained == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Mesh handle is not valid" );
+    }
 
-                for( auto& l : tempStorageLights )
-                {
-                    // TODO: change ID; hope that there's no collision
-                    uint64_t h32 = hashCombine( hashBase, counter ) % UINT32_MAX;
+    const RgMeshInfo meshInfo = {
+        .uniqueObjectID = pInfo->uniqueObjectID,
+        .pMeshName      = retained->name.empty() ? nullptr : retained->name.c_str(),
+        .transform      = pInfo->transform,
+        .isExportable   = pInfo->isExportable,
+        .animationName  = pInfo->animationName,
+        .animationTime  = pInfo->animationTime,
+    };
 
-                    l.uniqueID = h32 << 16ull;
-                    l.isExportable = false;
+    scene->ReserveDynamic( retained->primitives.size() );
 
-                    UploadLight( &l );
+    for( const RetainedMeshes::Primitive& p : retained->primitives )
+    {
+        RgMeshPrimitiveInfo prim = p.info;
+        if( pInfo->overrideColor )
+        {
+            prim.color = pInfo->color;
+        }
 
-                    counter++;
-                }
+        // vertex data is not copied, if it's already on the device
+        UploadMeshPrimitiveInternal( meshInfo, prim, p.id );
+    }
+}
 
-                tempStorageInit.clear();
-                tempStorageLights.clear();
-            }
-        }
+void RTGL1::VulkanDevice::DestroyMesh( RgMesh mesh )
+{
+    if( !retainedMeshes.Destroy( mesh ) )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Mesh handle is not valid" );
     }
 }
 
@@ -1223,6 +1327,8 @@ void RTGL1::VulkanDevice::ProvideOriginalTexture( const RgOriginalTextureInfo* p
                                        currentFrameState.GetFrameIndex(),
                                        *pInfo,
                                        ovrdFolder );
+
+    ThrottleOutOfFrameUploads();
 }
 
 void RTGL1::VulkanDevice::ProvideOriginalCubemapTexture( const RgOriginalCubemapInfo* pInfo )
@@ -1237,6 +1343,37 @@ void RTGL1::VulkanDevice::ProvideOriginalCubemapTexture( const RgOriginalCubemap
                                       currentFrameState.GetFrameIndex(),
                                       *pInfo,
                                       ovrdFolder );
+
+    ThrottleOutOfFrameUploads();
+}
+
+void RTGL1::VulkanDevice::ThrottleOutOfFrameUploads()
+{
+    // throttle bulk out-of-frame uploads (e.g. on level load): if the staging ring
+    // is full, flush the uploads, so the staging memory stays bounded;
+    // inside a frame, the frame's command buffer can't be submitted early
+    if( currentFrameState.WasFrameStarted() )
+    {
+        return;
+    }
+
+    const uint32_t frameIndex = currentFrameState.GetFrameIndex();
+
+    if( !textureManager->IsStagingExhausted( frameIndex ) &&
+        !cubemapManager->IsStagingExhausted( frameIndex ) )
+    {
+        return;
+    }
+
+    VkCommandBuffer preFrameCmd = currentFrameState.GetPreFrameCmdAndRemove();
+    if( preFrameCmd != VK_NULL_HANDLE )
+    {
+        cmdManager->Submit( preFrameCmd );
+        cmdManager->WaitGraphicsIdle();
+    }
+
+    textureManager->ResetStaging( frameIndex );
+    cubemapManager->ResetStaging( frameIndex );
 }
 
 void RTGL1::VulkanDevice::MarkOriginalTextureAsDeleted( const char* pTextureName )
@@ -1245,6 +1382,16 @@ void RTGL1::VulkanDevice::MarkOriginalTextureAsDeleted( const char* pTextureName
     cubemapManager->TryDestroyCubemap( currentFrameState.GetFrameIndex(), pTextureName );
 }
 
+void RTGL1::VulkanDevice::UpdateOriginalTextureRegion( const RgOriginalTextureRegionInfo* pInfo )
+{
+    if( pInfo == nullptr )
+    {
+        throw RgException( RG_RESULT_WRONG_FUNCTION_ARGUMENT, "Argument is null" );
+    }
+
+    textureManager->TryUpdateMaterialRegion( *pInfo );
+}
+
 bool RTGL1::VulkanDevice::IsSuspended() const
 {
     if( !swapchain )
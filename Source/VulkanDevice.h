@@ -64,6 +64,8 @@
 #include "SceneMeta.h"
 #include "DrawFrameInfo.h"
 #include "VulkanDevice_Dev.h"
+#include "ThreadPool.h"
+#include "RetainedMeshes.h"
 // clang-format on
 
 namespace RTGL1
@@ -84,6 +86,14 @@ public:
     VulkanDevice& operator=( VulkanDevice&& other ) noexcept = delete;
 
     void UploadMeshPrimitive( const RgMeshInfo* pMesh, const RgMeshPrimitiveInfo* pPrimitive );
+    void UploadMeshPrimitives( uint32_t                   meshCount,
+                               const RgMeshInfo*          pMeshes,
+                               const uint32_t*            pPrimitiveCounts,
+                               const RgMeshPrimitiveInfo* pPrimitives );
+    RgMesh CreateMesh( const RgMeshCreateInfo* pInfo );
+    void   DrawMeshInstance( RgMesh mesh, const RgMeshInstanceInfo* pInfo );
+    void   DestroyMesh( RgMesh mesh );
+
     void UploadNonWorldPrimitive( const RgMeshPrimitiveInfo* pPrimitive,
                                   const float*               pViewProjection,
                                   const RgViewport*          pViewport );
@@ -99,6 +109,7 @@ public:
     void ProvideOriginalTexture( const RgOriginalTextureInfo* pInfo );
     void ProvideOriginalCubemapTexture( const RgOriginalCubemapInfo* pInfo );
     void MarkOriginalTextureAsDeleted( const char* pTextureName );
+    void UpdateOriginalTextureRegion( const RgOriginalTextureRegionInfo* pInfo );
 
     void StartFrame( const RgStartFrameInfo* pInfo );
     void DrawFrame( const RgDrawFrameInfo* pInfo );
@@ -146,6 +157,14 @@ private:
     void            Render( VkCommandBuffer cmd, const RgDrawFrameInfo& drawInfo );
     void            EndFrame( VkCommandBuffer cmd );
 
+    // If uploads out of a frame exhausted the staging, submit them and wait
+    void ThrottleOutOfFrameUploads();
+
+    // Arguments must be already validated
+    void UploadMeshPrimitiveInternal( const RgMeshInfo&          mesh,
+                                      const RgMeshPrimitiveInfo& primitive,
+                                      std::optional< uint64_t >  retainedPrimitiveID = std::nullopt );
+
 private:
     void Dev_Draw() const;
     void Dev_Override( DrawFrameInfoCopy& copy ) const;
@@ -177,6 +196,8 @@ private:
 
     std::shared_ptr< CommandBufferManager > cmdManager;
 
+    std::shared_ptr< ThreadPool > threadPool;
+
     std::shared_ptr< Framebuffers >  framebuffers;
     std::shared_ptr< RestirBuffers > restirBuffers;
     std::shared_ptr< Volumetric >    volumetric;
@@ -229,9 +250,8 @@ private:
     ScratchImmediate                  scratchImmediate;
     std::unique_ptr< FolderObserver > observer;
 
-    // TODO: remove; used to not allocate on each call
-    std::vector< PositionNormal >        tempStorageInit;
-    std::vector< RgSpotLightUploadInfo > tempStorageLights;
+    AttachedLightsCache attachedLightsCache;
+    RetainedMeshes      retainedMeshes;
 
     std::unique_ptr< Devmode > devmode;
 
@@ -638,7 +638,7 @@ void RTGL1::VulkanDevice::Dev_Draw() const
             }
 
             ImGui::Text( "Import path: %s",
-                         sceneImportExport->MakeGltfPath( sceneImportExport->GetImportMapName() )
+                         sceneImportExport->MakeImportPath( sceneImportExport->GetImportMapName() )
                              .string()
                              .c_str() );
             ImGui::BeginDisabled( !dev.importName.enable );
@@ -664,7 +664,7 @@ void RTGL1::VulkanDevice::Dev_Draw() const
             ImGui::PopStyleColor( 3 );
 
             ImGui::Text( "Export path: %s",
-                         sceneImportExport->MakeGltfPath( sceneImportExport->GetExportMapName() )
+                         sceneImportExport->MakeExportPath( sceneImportExport->GetExportMapName() )
                              .string()
                              .c_str() );
             ImGui::BeginDisabled( !dev.exportName.enable );
@@ -675,6 +675,7 @@ void RTGL1::VulkanDevice::Dev_Draw() const
             ImGui::EndDisabled();
             ImGui::SameLine();
             ImGui::Checkbox( "Custom##export", &dev.exportName.enable );
+            ImGui::Checkbox( "Export as a single .glb file", &dev.exportAsGlb );
         }
         ImGui::Dummy( ImVec2( 0, 16 ) );
         ImGui::Separator();
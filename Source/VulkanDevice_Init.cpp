@@ -231,6 +231,8 @@ RTGL1::VulkanDevice::VulkanDevice( const RgInstanceCreateInfo* info )
         device, 
         queues );
 
+    threadPool = std::make_shared< ThreadPool >();
+
     uniform = std::make_shared< GlobalUniform >( 
         device, 
         memAllocator );
@@ -282,8 +284,10 @@ RTGL1::VulkanDevice::VulkanDevice( const RgInstanceCreateInfo* info )
         memAllocator, 
         worldSamplerManager,
         cmdManager,
+        threadPool,
         ovrdFolder / "WaterNormal_n.ktx2",
         ovrdFolder / "DirtMask.ktx2",
+        ovrdFolder / TEXTURES_FOLDER_DEV_CACHE,
         info->pbrTextureSwizzling,
         !!info->textureSamplerForceNormalMapFilterLinear,
         libconfig );
@@ -298,7 +302,8 @@ RTGL1::VulkanDevice::VulkanDevice( const RgInstanceCreateInfo* info )
         device, 
         memAllocator, 
         genericSamplerManager, 
-        *cmdManager );
+        *cmdManager,
+        threadPool );
 
     shaderManager = std::make_shared< ShaderManager >( 
         device, 
@@ -319,7 +324,9 @@ RTGL1::VulkanDevice::VulkanDevice( const RgInstanceCreateInfo* info )
         ovrdFolder / SCENES_FOLDER, 
         info->worldUp, 
         info->worldForward, 
-        info->worldScale );
+        info->worldScale,
+        libconfig.optimizeSceneMeshes,
+        threadPool );
 
     tonemapping = std::make_shared< Tonemapping >(
         device, 
@@ -365,7 +372,8 @@ RTGL1::VulkanDevice::VulkanDevice( const RgInstanceCreateInfo* info )
 
     lightManager = std::make_shared< LightManager >( 
         device, 
-        memAllocator );
+        memAllocator,
+        libconfig.cullLights );
 
     lightGrid = std::make_shared< LightGrid >(
         device,
@@ -549,6 +557,7 @@ RTGL1::VulkanDevice::~VulkanDevice()
     debugWindows.reset();
     devmode.reset();
     memAllocator.reset();
+    threadPool.reset();
 
     vkDestroySurfaceKHR( instance, surface, nullptr );
     DestroySyncPrimitives();
@@ -440,6 +440,7 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
 {
     RgResult r       = RG_RESULT_SUCCESS;
     uint64_t frameId = 0;
+    RgMesh   cube    = RG_NULL_HANDLE;
 
 
     // some resources can be initialized out of frame
@@ -471,6 +472,39 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
             };
 
         /* g_allMeshes = */ FillGAllMeshes( gltfPath, uploadMaterial );
+
+
+        // texture that is partially changed each frame
+        const std::vector< uint32_t > black( 8 * 8, 0xFF000000 );
+        RgOriginalTextureInfo         updateableInfo = {
+            .pTextureName = "_test_/updateable",
+            .pPixels      = black.data(),
+            .size         = { 8, 8 },
+            .filter       = RG_SAMPLER_FILTER_NEAREST,
+            .isUpdateable = true,
+        };
+        r = rgProvideOriginalTexture( instance, &updateableInfo );
+        RG_CHECK( r );
+
+
+        // cube is drawn each frame with a different transform, so keep its vertices
+        RgMeshPrimitiveInfo cubePrim = {
+            .primitiveIndexInMesh = 0,
+            .flags                = 0,
+            .pVertices            = GetCubeVertices(),
+            .vertexCount          = std::size( s_CubePositions ),
+            .pTextureName         = "_test_/updateable",
+            .textureFrame         = 0,
+            .color                = rgUtilPackColorByte4D( 128, 255, 128, 128 ),
+            .pEditorInfo          = nullptr,
+        };
+        RgMeshCreateInfo cubeInfo = {
+            .pMeshName      = "test",
+            .primitiveCount = 1,
+            .pPrimitives    = &cubePrim,
+        };
+        r = rgCreateMesh( instance, &cubeInfo, &cube );
+        RG_CHECK( r );
     }
 
 
@@ -492,6 +526,25 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
         }
 
 
+        // move a 2x2 white square over the updateable texture
+        {
+            const uint32_t cell   = uint32_t( frameId / 30 ) % 16;
+            const uint32_t clr    = ( frameId / 30 / 16 ) % 2 ? 0xFF000000 : 0xFFFFFFFF;
+            const uint32_t quad[] = { clr, clr, clr, clr };
+
+            RgOriginalTextureRegionInfo region = {
+                .pTextureName = "_test_/updateable",
+                .pPixels      = quad,
+                .offsetX      = ( cell % 4 ) * 2,
+                .offsetY      = ( cell / 4 ) * 2,
+                .size         = { 2, 2 },
+                .rowPitch     = 0,
+            };
+            r = rgUpdateOriginalTextureRegion( instance, &region );
+            RG_CHECK( r );
+        }
+
+
         for( auto& [ meshName, src ] : g_allMeshes )
         {
             auto& [ transform, primitives ] = src;
@@ -533,9 +586,8 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
 
 
         {
-            RgMeshInfo mesh = {
+            RgMeshInstanceInfo cubeInstance = {
                 .uniqueObjectID = 10,
-                .pMeshName      = "test",
                 .transform      = { {
                     { 1,
                            0,
@@ -547,20 +599,10 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
                 .isExportable   = false,
                 .animationName  = nullptr,
                 .animationTime  = 0.0f,
+                .overrideColor  = false,
             };
 
-            RgMeshPrimitiveInfo prim = {
-                .primitiveIndexInMesh = 0,
-                .flags                = 0,
-                .pVertices            = GetCubeVertices(),
-                .vertexCount          = std::size( s_CubePositions ),
-                .pTextureName         = nullptr,
-                .textureFrame         = 0,
-                .color                = rgUtilPackColorByte4D( 128, 255, 128, 128 ),
-                .pEditorInfo          = nullptr,
-            };
-
-            r = rgUploadMeshPrimitive( instance, &mesh, &prim );
+            r = rgDrawMeshInstance( instance, cube, &cubeInstance );
             RG_CHECK( r );
         }
 
@@ -700,6 +742,9 @@ void MainLoop( RgInstance instance, std::string_view gltfPath )
 
         frameId++;
     }
+
+    r = rgDestroyMesh( instance, cube );
+    RG_CHECK( r );
 }
 
 